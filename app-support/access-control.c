@@ -82,9 +82,12 @@ typedef struct ndn_access_control {
 
 ndn_access_control_t _ac_self_state;
 bool _ac_initialized = false;
+/* Timer of the next key expiration */
+static struct ndn_timer* _ac_timer = NULL;
 
 int _express_dkey_interest(uint8_t service);
 int _express_ekey_interest(uint8_t service);
+void _ac_timeout(void* arg);
 
 /* Initialize the AccessControlState */
 void
@@ -103,9 +106,35 @@ _init_ac_state()
   _ac_initialized = true;
 }
 
+/* Schedule _ac_timeout() when the first key not in renewal expires */
 void
-_ac_timeout()
+_ac_schedule_timeout()
 {
+  uint64_t deadline = NDN_TIMER_NO_DEADLINE;
+  for (int i = 0; i < 10; i++) {
+    if (_ac_self_state.access_keys[i].key_id != NDN_SEC_INVALID_KEY_ID &&
+        _ac_self_state.access_keys[i].in_renewal == false &&
+        _ac_self_state.access_keys[i].expires_at < deadline) {
+      deadline = _ac_self_state.access_keys[i].expires_at;
+    }
+    if (_ac_self_state.ekeys[i].key_id != NDN_SEC_INVALID_KEY_ID &&
+        _ac_self_state.ekeys[i].in_renewal == false &&
+        _ac_self_state.ekeys[i].expires_at < deadline) {
+      deadline = _ac_self_state.ekeys[i].expires_at;
+    }
+  }
+  ndn_timer_cancel(_ac_timer);
+  _ac_timer = NULL;
+  if (deadline != NDN_TIMER_NO_DEADLINE) {
+    // a key expires after its expiration time
+    _ac_timer = ndn_timer_schedule(deadline + 1, _ac_timeout, NULL);
+  }
+}
+
+void
+_ac_timeout(void* arg)
+{
+  (void)arg;
   ndn_time_ms_t now = ndn_time_now_ms();
   if (!_ac_initialized) {
     NDN_LOG_ERROR("[ACCESSCTL] Access Control module not initialized\n");
@@ -131,7 +160,7 @@ _ac_timeout()
         }
   }
 
-  ndn_msgqueue_post(NULL, _ac_timeout, 0, NULL);
+  _ac_schedule_timeout();
 }
 
 int
@@ -260,7 +289,7 @@ _on_ekey_data(const uint8_t* raw_data, uint32_t data_size, void* userdata)
   NDN_LOG_DEBUG("[ACCESSCTL] Key update: %" PRI_ndn_time_us_t "ms\n", m_measure_tp2 - m_measure_tp1);
 #endif
 
- // _ac_timeout();
+  _ac_schedule_timeout();
 }
 
 /**
@@ -356,7 +385,7 @@ _on_dkey_data(const uint8_t* raw_data, uint32_t data_size, void* userdata)
       NDN_LOG_ERROR("[ACCESSCTL] No empty AES key in local key storage\n");
     }
   }
-  //_ac_timeout();
+  _ac_schedule_timeout();
 }
 
 void
@@ -579,7 +608,7 @@ ndn_ac_after_bootstrapping()
     NDN_LOG_ERROR("[ACCESSCTL] Cannot register notification prefix: ");
     NDN_LOG_ERROR_NAME(&name);
   }
-  _ac_timeout();
+  _ac_timeout(NULL);
 }
 
 int
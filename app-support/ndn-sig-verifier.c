@@ -12,6 +12,7 @@
 #include "ndn-sig-verifier.h"
 #include "../encode/signed-interest.h"
 #include "../encode/key-storage.h"
+#include "../encode/packet-view.h"
 #include "../util/uniform-time.h"
 #include "../util/logger.h"
 
@@ -42,17 +43,22 @@ sig_verifier_on_data(const uint8_t* raw_data, uint32_t data_size, void* userdata
 {
   ndn_sig_verifier_userdata_t* dataptr = (ndn_sig_verifier_userdata_t*)userdata;
 
-  ndn_data_t cert;
-  uint32_t start, end;
-  ndn_data_tlv_decode_no_verify(&cert, raw_data, data_size, &start, &end);
-  NDN_LOG_DEBUG("[SIGVERIFIER] SigVerifier received certificate: ");
-  NDN_LOG_DEBUG_NAME(&cert.name);
-  // use trust anchor key to verify
+  ndn_data_view_t view;
+  ndn_signature_view_t signature;
+  // use trust anchor key to verify, before decoding anything
   ndn_key_storage_t* keys = ndn_key_storage_get_instance();
-  int result = ndn_ecdsa_verify(raw_data + start, end - start,
-                                cert.signature.sig_value, cert.signature.sig_size, &keys->trust_anchor_key);
+  int result = ndn_data_view_init(&view, (uint8_t*)raw_data, data_size);
+  if (result == NDN_SUCCESS)
+    result = ndn_data_view_signature(&view, &signature);
+  if (result == NDN_SUCCESS)
+    result = ndn_ecdsa_verify(signature.signed_portion, signature.signed_size,
+                              signature.sig_value, signature.sig_size, &keys->trust_anchor_key);
   if (result == NDN_SUCCESS) {
     // add the received certificate to key storage
+    ndn_data_t cert;
+    ndn_data_tlv_decode_no_verify(&cert, raw_data, data_size, NULL, NULL);
+    NDN_LOG_DEBUG("[SIGVERIFIER] SigVerifier received certificate: ");
+    NDN_LOG_DEBUG_NAME(&cert.name);
     ndn_key_storage_add_trusted_certificate(&cert);
     ndn_ecc_pub_t* pub_key = NULL;
     // verify the original interest/data
@@ -76,12 +82,18 @@ sig_verifier_on_data(const uint8_t* raw_data, uint32_t data_size, void* userdata
       pub_key = ndn_key_storage_get_ecc_pub_key(keyid);
 
       ndn_encoder_t encoder;
-      encoder_init(&encoder, verifier_buf, sizeof(verifier_buf));
+      encoder_init_nozero(&encoder, verifier_buf, sizeof(verifier_buf));
       ndn_data_tlv_encode(&encoder, original_dat);
       if (!pub_key) {
           NDN_LOG_ERROR("[SIGVERIFIER] Still cannot get public key from local key storage\n");
       }
-      result = ndn_data_tlv_decode_ecdsa_verify(original_dat, verifier_buf, encoder.offset, pub_key);
+      // The Data is already decoded, so only the signature is checked on the encoding
+      result = ndn_data_view_init(&view, encoder.output_value, encoder.offset);
+      if (result == NDN_SUCCESS)
+        result = ndn_data_view_signature(&view, &signature);
+      if (result == NDN_SUCCESS)
+        result = ndn_ecdsa_verify(signature.signed_portion, signature.signed_size,
+                                  signature.sig_value, signature.sig_size, pub_key);
       if (result == NDN_SUCCESS) {
         on_data_verification_success on_success = (on_data_verification_success)(dataptr->on_success_cbk);
         on_success(original_dat, dataptr->on_success_userdata);
@@ -119,15 +131,18 @@ int
 sig_verifier_on_interest(const uint8_t* raw_int, uint32_t raw_int_size, void* userdata)
 {
   (void) userdata;
-  ndn_interest_t interest;
-  ndn_interest_from_block(&interest, raw_int, raw_int_size);
-  NDN_LOG_DEBUG("[SIGVERIFIER] SigVerifier received certificate fetching Interest: ");
-  ndn_name_print(&interest.name);
+  // Only the name is needed, so the Interest is not decoded
+  ndn_interest_view_t interest;
+  if (ndn_interest_view_init(&interest, (uint8_t*)raw_int, raw_int_size) != NDN_SUCCESS) {
+    NDN_LOG_ERROR("[SIGVERIFIER] Malformed certificate fetching Interest\n");
+    return NDN_FWD_STRATEGY_SUPPRESS;
+  }
+  NDN_LOG_DEBUG("[SIGVERIFIER] SigVerifier received certificate fetching Interest\n");
   ndn_key_storage_t* storage = ndn_key_storage_get_instance();
   for (int i = 0; i < NDN_SEC_CERT_SIZE; i++) {
-    if (ndn_name_is_prefix_of(&interest.name, &storage->self_cert[i].name) == NDN_SUCCESS) {
+    if (ndn_name_view_is_prefix_of(interest.name, interest.name_size, &storage->self_cert[i].name) == 0) {
       ndn_encoder_t encoder;
-      encoder_init(&encoder, verifier_buf, sizeof(verifier_buf));
+      encoder_init_nozero(&encoder, verifier_buf, sizeof(verifier_buf));
       ndn_data_tlv_encode(&encoder, &storage->self_cert[i]);
       NDN_LOG_DEBUG("[SIGVERIFIER] Giving back self certificate: \n");
       NDN_LOG_DEBUG_NAME(&storage->self_cert[i].name);
@@ -227,7 +242,7 @@ ndn_sig_verifier_verify_int(const uint8_t* raw_pkt, size_t pkt_size,
     ndn_interest_set_CanBePrefix(&cert_interest, true);
     ndn_interest_set_MustBeFresh(&cert_interest, true);
     ndn_encoder_t encoder;
-    encoder_init(&encoder, verifier_buf, sizeof(verifier_buf));
+    encoder_init_nozero(&encoder, verifier_buf, sizeof(verifier_buf));
     ndn_interest_tlv_encode(&encoder, &cert_interest);
     m_userdata.is_interest = true;
     m_userdata.original_pkt = (void*)&interest;
@@ -353,7 +368,7 @@ ndn_sig_verifier_verify_data(const uint8_t* raw_pkt, size_t pkt_size,
     ndn_interest_set_MustBeFresh(&cert_interest, false);
     cert_interest.lifetime = 8000;
     ndn_encoder_t encoder;
-    encoder_init(&encoder, verifier_buf, sizeof(verifier_buf));
+    encoder_init_nozero(&encoder, verifier_buf, sizeof(verifier_buf));
     ndn_time_delay(80);
     ndn_interest_tlv_encode(&encoder, &cert_interest);
     m_userdata.is_interest = false;
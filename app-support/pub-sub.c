@@ -110,6 +110,9 @@ typedef struct pub_sub_state {
   /** Timepoint for the next fetching
    */
   ndn_time_ms_t m_next_send;
+  /** Timer of the next fetching. NULL before bootstrapping.
+   */
+  struct ndn_timer* fetch_timer;
 } pub_sub_state_t;
 
 static uint8_t pkt_encoding_buf[512];
@@ -138,6 +141,7 @@ _ps_topics_init()
     m_pub_sub_state.pub_topics[i].service = NDN_SD_NONE;
   }
   m_pub_sub_state.m_next_send = 0;
+  m_pub_sub_state.fetch_timer = NULL;
   m_pub_sub_state.min_interval = 1000*60*60;
   m_has_initialized = true;
 }
@@ -352,16 +356,10 @@ _construct_sub_interest(ndn_name_t* name, sub_topic_t* topic)
  * Helper function to periodically fetch from the Subsribed Topic.
  */
 void
-_periodic_sub_content_fetching(void *self, size_t param_length, void *param)
+_periodic_sub_content_fetching(void *arg)
 {
-  (void)self;
-  (void)param_length;
-  (void)param;
+  (void)arg;
   ndn_time_ms_t now = ndn_time_now_ms();
-  if (now < m_pub_sub_state.m_next_send) {
-    ndn_msgqueue_post(NULL, _periodic_sub_content_fetching, 0, NULL);
-    return;
-  }
   m_pub_sub_state.m_next_send = now + m_pub_sub_state.min_interval;
   sub_topic_t* topic = NULL;
   ndn_name_t name;
@@ -390,9 +388,14 @@ _periodic_sub_content_fetching(void *self, size_t param_length, void *param)
         topic->next_interest = now + topic->interval;
       }
     }
+    if (topic->service != NDN_SD_NONE && topic->is_cmd == false &&
+        topic->next_interest < m_pub_sub_state.m_next_send) {
+      m_pub_sub_state.m_next_send = topic->next_interest;
+    }
   }
-  // register the event to the message queue again with the smallest time period
-  ndn_msgqueue_post(NULL, _periodic_sub_content_fetching, 0, NULL);
+  // run again when the next topic is due
+  m_pub_sub_state.fetch_timer = ndn_timer_schedule(m_pub_sub_state.m_next_send,
+                                                   _periodic_sub_content_fetching, NULL);
 }
 
 int
@@ -519,6 +522,13 @@ _subscribe_to(uint8_t service, bool is_cmd, const char* scope,
       m_pub_sub_state.min_interval = topic->interval;
     }
     topic->next_interest = ndn_time_now_ms() + topic->interval;
+    // fetch earlier if this topic is due first
+    if (m_pub_sub_state.fetch_timer != NULL && topic->next_interest < m_pub_sub_state.m_next_send) {
+      ndn_timer_cancel(m_pub_sub_state.fetch_timer);
+      m_pub_sub_state.m_next_send = topic->next_interest;
+      m_pub_sub_state.fetch_timer = ndn_timer_schedule(m_pub_sub_state.m_next_send,
+                                                       _periodic_sub_content_fetching, NULL);
+    }
   }
   else {
     topic->interval = 0;
@@ -557,7 +567,8 @@ ps_after_bootstrapping()
 {
   if (!m_has_initialized)
     _ps_topics_init();
-  _periodic_sub_content_fetching(NULL, 0, NULL);
+  ndn_timer_cancel(m_pub_sub_state.fetch_timer);
+  _periodic_sub_content_fetching(NULL);
 }
 
 void
@@ -43,7 +43,6 @@ typedef struct ndn_sec_boot_state {
 
 static uint8_t sec_boot_buf[4096];
 static ndn_sec_boot_state_t m_sec_boot_state;
-static ndn_time_ms_t m_callback_after = 0;
 
 #if ENABLE_NDN_LOG_DEBUG
 static ndn_time_ms_t m_measure_tp0 = 0;
@@ -58,12 +57,9 @@ int sec_boot_send_cert_interest();
 void _prepare_sec_boot_send_cert_interest(ndn_interest_t* interest, uint8_t service);
 
 void
-_sec_boot_call_app_callback()
+_sec_boot_call_app_callback(void* arg)
 {
-  if (ndn_time_now_ms() < m_callback_after) {
-    ndn_msgqueue_post(NULL, _sec_boot_call_app_callback, 0, NULL);
-    return;
-  }
+  (void)arg;
   // call application-defined after_bootstrapping function
   m_sec_boot_state.after_sec_boot();
 }
@@ -96,8 +92,7 @@ _sec_boot_after_bootstrapping()
 
   NDN_LOG_INFO("[BOOTSTRAPPING]: Successfully finished NDN security bootstrapping");
 
-  m_callback_after = ndn_time_now_ms() + 1500;
-  ndn_msgqueue_post(NULL, _sec_boot_call_app_callback, 0, NULL);
+  ndn_timer_schedule(ndn_time_now_ms() + 1500, _sec_boot_call_app_callback, NULL);
 }
 
 void
@@ -75,7 +75,7 @@ static bool m_has_bootstrapped = false;
 static bool m_is_my_own_sd_int = false;
 static const uint8_t SERVICE_STATUS_MASK = 0x3F;
 static uint8_t sd_buf[4096];
-static ndn_time_ms_t m_next_adv;
+static struct ndn_timer* m_adv_timer;
 
 int _on_sd_interest(const uint8_t* raw_int, uint32_t raw_int_size, void* userdata);
 void _on_query_or_sd_meta_data(const uint8_t* raw_data, uint32_t data_size, void* userdata);
@@ -109,7 +109,7 @@ _ndn_sd_init()
     m_sys_state.cached_services[i].components_size = NDN_FWD_INVALID_NAME_COMPONENT_SIZE;
     m_sys_state.expire_tps[i] = 0;
   }
-  m_next_adv = 0;
+  m_adv_timer = NULL;
   m_has_initialized = true;
 }
 
@@ -132,15 +132,14 @@ _sd_listen(ndn_face_intf_t *face)
 }
 
 void
-_sd_start_adv_self_services()
+_sd_start_adv_self_services(void* arg)
 {
   int service_cnt;
-  ndn_time_ms_t now = ndn_time_now_ms();
-  if (now < m_next_adv) {
-    ndn_msgqueue_post(NULL, _sd_start_adv_self_services, 0, NULL);
-    return;
-  }
-  m_next_adv = now + (uint64_t)SD_ADV_INTERVAL;
+  (void)arg;
+  // schedule the next advertisement first, so it is sent even if this one fails
+  ndn_timer_cancel(m_adv_timer);
+  m_adv_timer = ndn_timer_schedule(ndn_time_now_ms() + (uint64_t)SD_ADV_INTERVAL,
+                                   _sd_start_adv_self_services, NULL);
   // Format: /[home-prefix]/SD/ADV/[locator]
   int ret = 0;
   ndn_interest_t interest;
@@ -157,13 +156,12 @@ _sd_start_adv_self_services()
   }
   if (ret != NDN_SUCCESS) {
     NDN_LOG_ERROR("Cannot construct NDN name for SD adv Interest. Error code: %d", ret);
-    ndn_msgqueue_post(NULL, _sd_start_adv_self_services, 0, NULL);
     return;
   }
   ndn_interest_set_MustBeFresh(&interest, true);
   // Parameter: uint32_t (freshness period), byte array
   ndn_encoder_t encoder;
-  encoder_init(&encoder, sd_buf, sizeof(sd_buf));
+  encoder_init_nozero(&encoder, sd_buf, sizeof(sd_buf));
   encoder_append_uint32_value(&encoder, SD_ADV_INTERVAL);
   service_cnt = 0;
   for (int i = 0; i < 10; i++) {
@@ -178,15 +176,13 @@ _sd_start_adv_self_services()
     ret = ndn_signed_interest_ecdsa_sign(&interest, NULL, NULL);
     if (ret != NDN_SUCCESS) {
       NDN_LOG_ERROR("Cannot sign the advertisement Interest. Error code: %d", ret);
-      ndn_msgqueue_post(NULL, _sd_start_adv_self_services, 0, NULL);
       return;
     }
     // Express Interest
-    encoder_init(&encoder, sd_buf, sizeof(sd_buf));
+    encoder_init_nozero(&encoder, sd_buf, sizeof(sd_buf));
     ret = ndn_interest_tlv_encode(&encoder, &interest);
     if (ret != NDN_SUCCESS) {
       NDN_LOG_ERROR("Cannot TLV encode Interest packet. Error code: %d", ret);
-      ndn_msgqueue_post(NULL, _sd_start_adv_self_services, 0, NULL);
       return;
     }
 
@@ -195,7 +191,6 @@ _sd_start_adv_self_services()
     m_is_my_own_sd_int = false;
     if (ret != NDN_SUCCESS) {
       NDN_LOG_ERROR("Fail to send out adv Interest. Error Code: %d", ret);
-      ndn_msgqueue_post(NULL, _sd_start_adv_self_services, 0, NULL);
       return;
     }
     else {
@@ -203,7 +198,6 @@ _sd_start_adv_self_services()
       ndn_name_print(&interest.name);
     }
   }
-  ndn_msgqueue_post(NULL, _sd_start_adv_self_services, 0, NULL);
 }
 
 void
@@ -235,7 +229,7 @@ ndn_sd_after_bootstrapping(ndn_face_intf_t *face)
 
   // start listening on corresponding prefixes
   _sd_listen(face);
-  _sd_start_adv_self_services();
+  _sd_start_adv_self_services(NULL);
 }
 
 int
@@ -394,7 +388,7 @@ _on_sd_interest(const uint8_t* raw_int, uint32_t raw_int_size, void* userdata)
     ndn_name_print(&interest.name);
 
     ndn_encoder_t encoder;
-    encoder_init(&encoder, sd_buf, sizeof(sd_buf));
+    encoder_init_nozero(&encoder, sd_buf, sizeof(sd_buf));
     uint8_t interested_service = interest.name.components[2].value[0];
     // query Interest format: /home-prefix/SD/service-id/locator*/ANY-OR
     bool match_my_self = _match_locator(&interest.name.components[3], interest.name.components_size - 4,
@@ -510,7 +504,7 @@ _sd_query_sys_services(const uint8_t* service_ids, size_t size)
 
   // Express Interest
   ndn_encoder_t encoder;
-  encoder_init(&encoder, sd_buf, sizeof(sd_buf));
+  encoder_init_nozero(&encoder, sd_buf, sizeof(sd_buf));
   ndn_interest_tlv_encode(&encoder, &interest);
   m_is_my_own_sd_int = true;
   ret = ndn_forwarder_express_interest(encoder.output_value, encoder.offset,
@@ -554,7 +548,7 @@ sd_query_service(uint8_t service_id, const ndn_name_t* granularity, bool is_any)
   ndn_interest_set_MustBeFresh(&interest, true);
   // send Interest out
   ndn_encoder_t encoder;
-  encoder_init(&encoder, sd_buf, sizeof(sd_buf));
+  encoder_init_nozero(&encoder, sd_buf, sizeof(sd_buf));
   ndn_interest_tlv_encode(&encoder, &interest);
   m_is_my_own_sd_int = true;
   ret = ndn_forwarder_express_interest(encoder.output_value, encoder.offset,
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include "compact-name.h"
+#include "forwarder-helper.h"
+#include "../ndn-error-code.h"
+#include <string.h>
+
+int
+ndn_compact_name_from_block(ndn_compact_name_t* name, uint8_t* block, size_t block_size,
+                            uint32_t* offsets, uint32_t max_components)
+{
+  uint32_t type, len, count = 0;
+  uint8_t *ptr, *end = block + block_size, *value;
+
+  if (block == NULL)
+    return NDN_INVALID_POINTER;
+  ptr = (block_size > 0) ? tlv_scan_type_length(block, block_size, &type, &len) : NULL;
+  if (ptr == NULL)
+    return NDN_OVERSIZE_VAR;
+  if (type != TLV_Name)
+    return NDN_WRONG_TLV_TYPE;
+  if (len != block_size - (ptr - block))
+    return NDN_WRONG_TLV_LENGTH;
+
+  while (ptr < end) {
+    if (count >= max_components)
+      return NDN_OVERSIZE;
+    offsets[count++] = ptr - block;
+    value = tlv_scan_type_length(ptr, end - ptr, &type, &len);
+    if (value == NULL || len > (size_t)(end - value))
+      return NDN_OVERSIZE_VAR;
+    ptr = value + len;
+  }
+  offsets[count] = block_size;
+
+  name->block = block;
+  name->block_size = block_size;
+  name->offsets = offsets;
+  name->components_size = count;
+  return NDN_SUCCESS;
+}
+
+int
+ndn_compact_name_from_name(ndn_compact_name_t* name, const ndn_name_t* src,
+                           uint8_t* buffer, size_t buffer_size, uint32_t* offsets)
+{
+  ndn_encoder_t encoder;
+  int ret;
+
+  encoder_init(&encoder, buffer, buffer_size);
+  ret = ndn_name_tlv_encode(&encoder, src);
+  if (ret != NDN_SUCCESS)
+    return ret;
+  return ndn_compact_name_from_block(name, buffer, encoder.offset, offsets,
+                                     NDN_NAME_COMPONENTS_SIZE);
+}
+
+int
+ndn_compact_name_to_name(const ndn_compact_name_t* name, ndn_name_t* dst)
+{
+  uint32_t type, len;
+  uint8_t* value;
+  size_t size;
+
+  if (name->components_size > NDN_NAME_COMPONENTS_SIZE)
+    return NDN_OVERSIZE;
+  for (uint32_t i = 0; i < name->components_size; i++) {
+    value = ndn_compact_name_component(name, i, &size);
+    value = tlv_scan_type_length(value, size, &type, &len);
+    if (len > NDN_NAME_COMPONENT_BUFFER_SIZE)
+      return NDN_OVERSIZE;
+    dst->components[i].type = type;
+    dst->components[i].size = (uint8_t)len;
+    memcpy(dst->components[i].value, value, len);
+  }
+  dst->components_size = (uint8_t)name->components_size;
+  return NDN_SUCCESS;
+}
+
+int
+ndn_compact_name_compare(const ndn_compact_name_t* lhs, const ndn_compact_name_t* rhs)
+{
+  size_t lhs_size = ndn_compact_name_prefix_size(lhs, lhs->components_size);
+  size_t rhs_size = ndn_compact_name_prefix_size(rhs, rhs->components_size);
+  int r;
+
+  // Both values are whole components, so a common byte prefix is a common name prefix
+  r = memcmp(lhs->block + lhs->offsets[0], rhs->block + rhs->offsets[0],
+             lhs_size < rhs_size ? lhs_size : rhs_size);
+  if (r < 0) return -1;
+  else if (r > 0) return 1;
+  else if (lhs_size < rhs_size) return -2;
+  else if (lhs_size > rhs_size) return 2;
+  else return 0;
+}
+
+int
+ndn_compact_name_is_prefix_of(const ndn_compact_name_t* lhs, const ndn_compact_name_t* rhs)
+{
+  size_t size = ndn_compact_name_prefix_size(lhs, lhs->components_size);
+
+  if (lhs->components_size > rhs->components_size)
+    return 1;
+  if (ndn_compact_name_prefix_size(rhs, lhs->components_size) != size)
+    return 1;
+  if (memcmp(lhs->block + lhs->offsets[0], rhs->block + rhs->offsets[0], size) != 0)
+    return 1;
+  return 0;
+}
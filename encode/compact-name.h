@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_COMPACT_NAME_H
+#define NDN_ENCODING_COMPACT_NAME_H
+
+#include "name.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNEncodeCompactName Compact names
+ * @brief Names kept as their TLV block plus an index of component offsets.
+ * @ingroup NDNEncode
+ *
+ * Unlike @c ndn_name_t, a compact name has no limit on the number or the length of
+ * its components, and takes only the size of its TLV block and one offset per component.
+ * Both the block and the offsets are provided by the caller and must outlive the name.
+ *
+ * @code{.c}
+ * ndn_compact_name_t name;
+ * uint32_t offsets[NDN_COMPACT_NAME_OFFSETS_SIZE(16)];
+ *
+ * if (ndn_compact_name_from_block(&name, block, block_size, offsets, 16) == NDN_SUCCESS) {
+ *   // ndn_compact_name_component(&name, i, ...) is O(1)
+ * }
+ * @endcode
+ * @{
+ */
+
+/** The number of offsets needed for a name of @c n components.
+ */
+#define NDN_COMPACT_NAME_OFFSETS_SIZE(n) ((n) + 1)
+
+/**
+ * A Name in wire format with its component offsets.
+ */
+typedef struct ndn_compact_name {
+  /** The Name TLV, including T and L.
+   */
+  uint8_t* block;
+  size_t block_size;
+  /** Offset of each component TLV in @c block, followed by @c block_size.
+   * Component @c i spans from @c offsets[i] to @c offsets[i+1].
+   */
+  uint32_t* offsets;
+  /** The number of components.
+   */
+  uint32_t components_size;
+} ndn_compact_name_t;
+
+/** Make a compact name from a Name TLV, without copying it.
+ *
+ * @param[out] name The compact name.
+ * @param[in] block The Name TLV, including T and L, which must outlive @c name.
+ * @param[in] block_size The length of @c block.
+ * @param[out] offsets The offset index of @c name, which must outlive it.
+ * @param[in] max_components The most components @c offsets can index.
+ *            @c offsets holds NDN_COMPACT_NAME_OFFSETS_SIZE(max_components) entries.
+ * @retval #NDN_SUCCESS The operation succeeds.
+ * @retval #NDN_OVERSIZE_VAR A component of @c block is truncated or malicious.
+ * @retval #NDN_WRONG_TLV_TYPE The type of @c block is not #TLV_Name.
+ * @retval #NDN_WRONG_TLV_LENGTH The length of @c block is different from @c block_size.
+ * @retval #NDN_OVERSIZE @c block has more than @c max_components components.
+ */
+int
+ndn_compact_name_from_block(ndn_compact_name_t* name, uint8_t* block, size_t block_size,
+                            uint32_t* offsets, uint32_t max_components);
+
+/** Make a compact name from a Name structure.
+ *
+ * @param[out] name The compact name.
+ * @param[in] src The Name structure.
+ * @param[out] buffer The buffer to encode @c src into, which must outlive @c name.
+ * @param[in] buffer_size The size of @c buffer.
+ *            ndn_name_probe_block_size() tells the size needed.
+ * @param[out] offsets The offset index of @c name, which must outlive it.
+ *             It holds NDN_COMPACT_NAME_OFFSETS_SIZE(NDN_NAME_COMPONENTS_SIZE) entries.
+ * @retval #NDN_SUCCESS The operation succeeds.
+ * @retval #NDN_OVERSIZE @c buffer is too small.
+ */
+int
+ndn_compact_name_from_name(ndn_compact_name_t* name, const ndn_name_t* src,
+                           uint8_t* buffer, size_t buffer_size, uint32_t* offsets);
+
+/** Copy a compact name into a Name structure.
+ *
+ * @param[in] name The compact name.
+ * @param[out] dst The Name structure.
+ * @retval #NDN_SUCCESS The operation succeeds.
+ * @retval #NDN_OVERSIZE @c name has more than #NDN_NAME_COMPONENTS_SIZE components,
+ *         or one longer than #NDN_NAME_COMPONENT_BUFFER_SIZE.
+ */
+int
+ndn_compact_name_to_name(const ndn_compact_name_t* name, ndn_name_t* dst);
+
+/** Get a component of a compact name.
+ *
+ * @param[in] name The compact name.
+ * @param[in] index The index of the component, less than @c components_size.
+ * @param[out] component_size The length of the component TLV.
+ * @return The component TLV, including T and L.
+ */
+static inline uint8_t*
+ndn_compact_name_component(const ndn_compact_name_t* name, uint32_t index,
+                           size_t* component_size)
+{
+  *component_size = name->offsets[index + 1] - name->offsets[index];
+  return name->block + name->offsets[index];
+}
+
+/** Get the length of the first components of a compact name.
+ *
+ * @param[in] name The compact name.
+ * @param[in] count The number of components, up to @c components_size.
+ * @return The length of the first @c count component TLVs.
+ */
+static inline size_t
+ndn_compact_name_prefix_size(const ndn_compact_name_t* name, uint32_t count)
+{
+  return name->offsets[count] - name->offsets[0];
+}
+
+/** Compare two compact names byte by byte, as ndn_name_compare_block().
+ *
+ * @param[in] lhs Left-hand-side name.
+ * @param[in] rhs Right-hand-side name.
+ * @return 0 if @c lhs == @c rhs.
+ * @return 1, if @c lhs > @c rhs and @c rhs is not a prefix of @c lhs.
+ * @return 2, if @c lhs > @c rhs and @c rhs is a proper prefix of @c lhs.
+ * @return -1, if @c lhs < @c rhs and @c lhs is not a prefix of @c rhs.
+ * @return -2, if @c lhs < @c rhs and @c lhs is a proper prefix of @c rhs.
+ */
+int
+ndn_compact_name_compare(const ndn_compact_name_t* lhs, const ndn_compact_name_t* rhs);
+
+/** Check whether a compact name is a prefix of another.
+ *
+ * @param[in] lhs Left-hand-side name.
+ * @param[in] rhs Right-hand-side name.
+ * @return 0 if @c lhs is a prefix of @c rhs, as ndn_name_is_prefix_of(). 1 otherwise.
+ */
+int
+ndn_compact_name_is_prefix_of(const ndn_compact_name_t* lhs, const ndn_compact_name_t* rhs);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NDN_ENCODING_COMPACT_NAME_H
@@ -59,6 +59,50 @@ _ndn_data_prepare_unsigned_block(ndn_encoder_t* encoder, const ndn_data_t* data)
   return NDN_SUCCESS;
 }
 
+// the back-to-front counterpart of _ndn_data_prepare_unsigned_block
+static int
+_ndn_data_prepend_unsigned_block(ndn_prepend_encoder_t* encoder, const ndn_data_t* data)
+{
+  int ret_val = -1;
+  // signature info
+  ret_val = ndn_signature_info_tlv_prepend(encoder, &data->signature);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  // content
+  ret_val = encoder_prepend_raw_buffer_value(encoder, data->content_value, data->content_size);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  ret_val = encoder_prepend_type_length(encoder, TLV_Content, data->content_size);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  // meta info
+  ret_val = ndn_metainfo_tlv_prepend(encoder, &data->metainfo);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  // name
+  return ndn_name_tlv_prepend(encoder, &data->name);
+}
+
+// prepend the unsigned block in front of room kept for the signature value
+static int
+_ndn_data_prepend_signed_portion(ndn_prepend_encoder_t* encoder, const ndn_data_t* data)
+{
+  int ret_val = -1;
+  ret_val = prepend_encoder_reserve(encoder, encoder_probe_block_size(TLV_SignatureValue,
+                                                                      NDN_SIGNATURE_BUFFER_SIZE));
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  return _ndn_data_prepend_unsigned_block(encoder, data);
+}
+
+// append the signature value after the signed portion and prepend the data T and L
+static int
+_ndn_data_prepend_finish(ndn_prepend_encoder_t* encoder, const ndn_data_t* data)
+{
+  int ret_val = -1;
+  ndn_encoder_t tail;
+  prepend_encoder_tail(encoder, &tail);
+  ret_val = ndn_signature_value_tlv_encode(&tail, &data->signature);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  prepend_encoder_commit_tail(encoder, &tail);
+  return encoder_prepend_type_length(encoder, TLV_Data, prepend_encoder_size(encoder));
+}
+
 static void
 _prepare_signature_info(ndn_data_t* data, uint8_t signature_type,
                         const ndn_name_t* producer_identity, uint32_t key_id)
@@ -359,6 +403,88 @@ ndn_data_tlv_encode_hmac_sign(ndn_encoder_t* encoder, ndn_data_t* data,
   return 0;
 }
 
+int
+ndn_data_tlv_prepend(ndn_prepend_encoder_t* encoder, ndn_data_t* data)
+{
+  int ret_val = -1;
+  uint32_t value_end = prepend_encoder_size(encoder);
+  // signature value
+  ret_val = ndn_signature_value_tlv_prepend(encoder, &data->signature);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  ret_val = _ndn_data_prepend_unsigned_block(encoder, data);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  // data T and L
+  return encoder_prepend_type_length(encoder, TLV_Data, prepend_encoder_size(encoder) - value_end);
+}
+
+int
+ndn_data_tlv_prepend_digest_sign(ndn_prepend_encoder_t* encoder, ndn_data_t* data)
+{
+  int ret_val = -1;
+  // set signature info
+  ret_val = ndn_signature_init(&data->signature, false);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  ret_val = ndn_signature_set_signature_type(&data->signature, NDN_SIG_TYPE_DIGEST_SHA256);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+
+  ret_val = _ndn_data_prepend_signed_portion(encoder, data);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+
+  // sign data
+  uint32_t used_bytes = 0;
+  int result = ndn_sha256_sign(prepend_encoder_output(encoder), prepend_encoder_size(encoder),
+                               data->signature.sig_value, data->signature.sig_size,
+                               &used_bytes);
+  if (result < 0) return result;
+
+  return _ndn_data_prepend_finish(encoder, data);
+}
+
+int
+ndn_data_tlv_prepend_ecdsa_sign(ndn_prepend_encoder_t* encoder, ndn_data_t* data,
+                                const ndn_name_t* producer_identity, const ndn_ecc_prv_t* prv_key)
+{
+  int ret_val = -1;
+  // set signature info
+  _prepare_signature_info(data, NDN_SIG_TYPE_ECDSA_SHA256, producer_identity, prv_key->key_id);
+
+  // the length of the signature is not known in advance, but is not needed until it is appended
+  ret_val = _ndn_data_prepend_signed_portion(encoder, data);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+
+  // sign data
+  uint32_t sig_len = 0;
+  int result = ndn_ecdsa_sign(prepend_encoder_output(encoder), prepend_encoder_size(encoder),
+                              data->signature.sig_value, data->signature.sig_size,
+                              prv_key, &sig_len);
+  if (result < 0) return result;
+  // set the signature size of the signature to the size of the ASN.1 encoded ecdsa signature
+  data->signature.sig_size = sig_len;
+
+  return _ndn_data_prepend_finish(encoder, data);
+}
+
+int
+ndn_data_tlv_prepend_hmac_sign(ndn_prepend_encoder_t* encoder, ndn_data_t* data,
+                               const ndn_name_t* producer_identity, const ndn_hmac_key_t* hmac_key)
+{
+  int ret_val = -1;
+  // set signature info
+  _prepare_signature_info(data, NDN_SIG_TYPE_HMAC_SHA256, producer_identity, hmac_key->key_id);
+
+  ret_val = _ndn_data_prepend_signed_portion(encoder, data);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+
+  // sign data
+  uint32_t used_bytes = 0;
+  int result = ndn_hmac_sign(prepend_encoder_output(encoder), prepend_encoder_size(encoder),
+                             data->signature.sig_value, data->signature.sig_size,
+                             hmac_key, &used_bytes);
+  if (result < 0) return result;
+
+  return _ndn_data_prepend_finish(encoder, data);
+}
+
 int
 ndn_data_tlv_decode_no_verify(ndn_data_t* data, const uint8_t* block_value, uint32_t block_size,
                               uint32_t* be_signed_start, uint32_t* be_signed_end)
@@ -107,6 +107,55 @@ int
 ndn_data_tlv_encode_hmac_sign(ndn_encoder_t* encoder, ndn_data_t* data,
                               const ndn_name_t* producer_identity, const ndn_hmac_key_t* hmac_key);
 
+/**
+ * Encode the Data into wire format back to front, with its current signature info and value.
+ * Unlike ndn_data_tlv_encode(), the sizes of the elements need not be probed first.
+ * @param encoder. Output. The prepend encoder to keep the encoded Data.
+ *        The Data is prepended in front of its current output.
+ * @param data. Input. The data to be encoded.
+ * @return 0 if there is no error.
+ */
+int
+ndn_data_tlv_prepend(ndn_prepend_encoder_t* encoder, ndn_data_t* data);
+
+/**
+ * Use Digest (SHA256) to sign the Data and encode it back to front.
+ * The signed portion is prepended in front of room kept for the signature value,
+ * so nothing is probed or moved once signed.
+ * @param encoder. Output. The prepend encoder to keep the encoded Data.
+ *        It should be empty, with room for a signature value of #NDN_SIGNATURE_BUFFER_SIZE.
+ * @param data. Input. The data to be encoded.
+ * @return 0 if there is no error.
+ */
+int
+ndn_data_tlv_prepend_digest_sign(ndn_prepend_encoder_t* encoder, ndn_data_t* data);
+
+/**
+ * Use ECDSA Algorithm to sign the Data and encode it back to front,
+ * as ndn_data_tlv_prepend_digest_sign().
+ * @param encoder. Output. The prepend encoder to keep the encoded Data.
+ * @param data. Input. The data to be encoded.
+ * @param producer_identity. Input. The producer's identity name.
+ * @param prv_key. Input. The private ECC key used to generate the signature.
+ * @return 0 if there is no error.
+ */
+int
+ndn_data_tlv_prepend_ecdsa_sign(ndn_prepend_encoder_t* encoder, ndn_data_t* data,
+                                const ndn_name_t* producer_identity, const ndn_ecc_prv_t* prv_key);
+
+/**
+ * Use HMAC Algorithm to sign the Data and encode it back to front,
+ * as ndn_data_tlv_prepend_digest_sign().
+ * @param encoder. Output. The prepend encoder to keep the encoded Data.
+ * @param data. Input. The data to be encoded.
+ * @param producer_identity. Input. The producer's identity name.
+ * @param hmac_key. Input. The HMAC key used to generate the signature.
+ * @return 0 if there is no error.
+ */
+int
+ndn_data_tlv_prepend_hmac_sign(ndn_prepend_encoder_t* encoder, ndn_data_t* data,
+                               const ndn_name_t* producer_identity, const ndn_hmac_key_t* hmac_key);
+
 /**
  * Simply decode the encoded Data into a ndn_data_t without signature verification.
  * @param data. Output. The data to which the wired block will be decoded.
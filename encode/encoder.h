@@ -60,6 +60,23 @@ encoder_init(ndn_encoder_t* encoder, uint8_t* block_value, uint32_t block_max_si
   encoder->offset = 0;
 }
 
+/**
+ * Init an encoder without clearing the buffer.
+ * Only the first @c offset bytes of the output are meaningful after encoding,
+ * and encoders write all of them, so clearing is only needed by callers that
+ * read past @c offset. Use it for large or reused buffers.
+ * @param encoder. Output. The encoder to be inited.
+ * @param block_value. Input. The buffer to keep the wire format buffer.
+ * @param block_max_size. Input. The size of wire format buffer.
+ */
+static inline void
+encoder_init_nozero(ndn_encoder_t* encoder, uint8_t* block_value, uint32_t block_max_size)
+{
+  encoder->output_value = block_value;
+  encoder->output_max_size = block_max_size;
+  encoder->offset = 0;
+}
+
 /**
  * Probe the size of a variable-length type (T) or length (L).
  * @param var. Input. The value of the variable-length type (T) or length (L).
@@ -322,6 +339,218 @@ encoder_get_offset(const ndn_encoder_t* encoder)
   return encoder->offset;
 }
 
+/**
+ * The structure to keep the state when doing NDN TLV encoding back to front.
+ *
+ * Elements are prepended from the end of the buffer, last element first, so the
+ * length of a TLV block is known by the time its type and length are written.
+ * The output is [@c offset, @c end) of the buffer, not its beginning.
+ */
+typedef struct ndn_prepend_encoder {
+  /**
+   * The buffer to keep the encoding output.
+   */
+  uint8_t* output_value;
+  /**
+   * The size of the buffer to keep the encoding output.
+   */
+  uint32_t output_max_size;
+  /**
+   * Where the encoding output starts. Moves toward 0 as elements are prepended.
+   */
+  uint32_t offset;
+  /**
+   * Where the encoding output ends.
+   */
+  uint32_t end;
+} ndn_prepend_encoder_t;
+
+/**
+ * Init a prepend encoder by setting the buffer to keep the encoding output and its size.
+ * The buffer is not cleared, as only the output is written.
+ * @param encoder. Output. The encoder to be inited.
+ * @param block_value. Input. The buffer to keep the wire format buffer.
+ * @param block_max_size. Input. The size of wire format buffer.
+ */
+static inline void
+prepend_encoder_init(ndn_prepend_encoder_t* encoder, uint8_t* block_value, uint32_t block_max_size)
+{
+  encoder->output_value = block_value;
+  encoder->output_max_size = block_max_size;
+  encoder->offset = block_max_size;
+  encoder->end = block_max_size;
+}
+
+/**
+ * Keep room after the output for an element which can only be encoded once the
+ * output is complete, such as a signature value. Only valid on an empty encoder.
+ * @param encoder. Output. The encoder.
+ * @param size. Input. The size of the room.
+ * @return 0 if there is no error.
+ */
+static inline int
+prepend_encoder_reserve(ndn_prepend_encoder_t* encoder, uint32_t size)
+{
+  if (encoder->offset != encoder->end || size > encoder->end)
+    return NDN_OVERSIZE;
+  encoder->offset -= size;
+  encoder->end -= size;
+  return 0;
+}
+
+/**
+ * Init a forward encoder on the room kept by prepend_encoder_reserve().
+ * @param encoder. Input. The prepend encoder.
+ * @param tail. Output. The forward encoder, writing right after the output.
+ */
+static inline void
+prepend_encoder_tail(const ndn_prepend_encoder_t* encoder, ndn_encoder_t* tail)
+{
+  encoder_init_nozero(tail, encoder->output_value + encoder->end,
+                      encoder->output_max_size - encoder->end);
+}
+
+/**
+ * Add what a forward encoder from prepend_encoder_tail() wrote to the output.
+ * @param encoder. Output. The prepend encoder.
+ * @param tail. Input. The forward encoder.
+ */
+static inline void
+prepend_encoder_commit_tail(ndn_prepend_encoder_t* encoder, const ndn_encoder_t* tail)
+{
+  encoder->end += tail->offset;
+}
+
+/**
+ * Get the encoding output.
+ * @param encoder. Input. The encoder.
+ * @return the first byte of the output.
+ */
+static inline uint8_t*
+prepend_encoder_output(const ndn_prepend_encoder_t* encoder)
+{
+  return encoder->output_value + encoder->offset;
+}
+
+/**
+ * Get the size of the encoding output.
+ * Taken before and after prepending the value of a TLV block, it gives its length.
+ * @param encoder. Input. The encoder.
+ * @return the size of the output.
+ */
+static inline uint32_t
+prepend_encoder_size(const ndn_prepend_encoder_t* encoder)
+{
+  return encoder->end - encoder->offset;
+}
+
+/**
+ * Prepend a variable-length type (T) or length (L) to the wire format buffer.
+ * @param encoder. Output. The encoder will keep the encoding result and the offset will be updated.
+ * @param var. Input. The variable-length type (T) or length (L).
+ * @return 0 if there is no error.
+ */
+static inline int
+encoder_prepend_var(ndn_prepend_encoder_t* encoder, uint32_t var)
+{
+  uint8_t* ptr;
+  if (var < 253 && encoder->offset >= 1) {
+    encoder->offset -= 1;
+    encoder->output_value[encoder->offset] = var & 0xFF;
+  }
+  else if (var <= 0xFFFF && encoder->offset >= 3) {
+    encoder->offset -= 3;
+    ptr = encoder->output_value + encoder->offset;
+    ptr[0] = 253;
+    ptr[1] = (var >> 8) & 0xFF;
+    ptr[2] = var & 0xFF;
+  }
+  else if (var > 0xFFFF && encoder->offset >= 5) {
+    encoder->offset -= 5;
+    ptr = encoder->output_value + encoder->offset;
+    ptr[0] = 254;
+    ptr[1] = (var >> 24) & 0xFF;
+    ptr[2] = (var >> 16) & 0xFF;
+    ptr[3] = (var >> 8) & 0xFF;
+    ptr[4] = var & 0xFF;
+  }
+  else {
+    return NDN_OVERSIZE_VAR;
+  }
+  return 0;
+}
+
+/**
+ * Prepend the type (T) and length (L) of a TLV block whose value is already prepended.
+ * @param encoder. Output. The encoder will keep the encoding result and the offset will be updated.
+ * @param type. Input. The variable-length type (T).
+ * @param length. Input. The variable-length length (L).
+ * @return 0 if there is no error.
+ */
+static inline int
+encoder_prepend_type_length(ndn_prepend_encoder_t* encoder, uint32_t type, uint32_t length)
+{
+  int ret_val = encoder_prepend_var(encoder, length);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  return encoder_prepend_var(encoder, type);
+}
+
+/**
+ * Prepend the byte array as the value (V) to the wire format buffer.
+ * @param encoder. Output. The encoder will keep the encoding result and the offset will be updated.
+ * @param buffer. Input. The buffer to be encoded.
+ * @param size. Input. The size of the buffer to be encoded.
+ * @return 0 if there is no error.
+ */
+static inline int
+encoder_prepend_raw_buffer_value(ndn_prepend_encoder_t* encoder, const uint8_t* buffer, uint32_t size)
+{
+  if (encoder->offset < size)
+    return NDN_OVERSIZE;
+  encoder->offset -= size;
+  memcpy(encoder->output_value + encoder->offset, buffer, size);
+  return 0;
+}
+
+/**
+ * Prepend a uint32_t as the value (V) to the wire format buffer.
+ * @param encoder. Output. The encoder will keep the encoding result and the offset will be updated.
+ * @param value. Input. The uint32_t to be encoded.
+ * @return 0 if there is no error.
+ */
+static inline int
+encoder_prepend_uint32_value(ndn_prepend_encoder_t* encoder, uint32_t value)
+{
+  if (encoder->offset < 4)
+    return NDN_OVERSIZE;
+  encoder->offset -= 4;
+  for (int i = 0; i < 4; i++) {
+    encoder->output_value[encoder->offset + i] = (value >> (8 * (3 - i))) & 0xFF;
+  }
+  return 0;
+}
+
+/**
+ * Prepend a non-negative int as the value (V) to the wire format buffer.
+ * TLV-LENGTH of the TLV element MUST be either 1, 2, 4, or 8.
+ * @param encoder. Output. The encoder will keep the encoding result and the offset will be updated.
+ * @param value. Input. The uint to be encoded.
+ * @return 0 if there is no error.
+ */
+static inline int
+encoder_prepend_uint_value(ndn_prepend_encoder_t* encoder, uint64_t value)
+{
+  int size = encoder_probe_uint_length(value);
+  if (encoder->offset < (uint32_t)size)
+    return NDN_OVERSIZE;
+  for (int i = 1; i <= size; i++) {
+    encoder->output_value[encoder->offset - i] = value & 0xFF;
+    value >>= 8;
+  }
+  encoder->offset -= size;
+  return 0;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -9,6 +9,7 @@
  */
 
 #include "forwarder-helper.h"
+#include "packet-view.h"
 #include "tlv.h"
 #include "../ndn-error-code.h"
 #include "../ndn-constants.h"
@@ -90,7 +91,7 @@ tlv_get_uint(uint8_t* buf, size_t buflen)
 {
   uint64_t ret = 0;
   while(buflen --){
-    ret = (ret << (uint64_t)8) + buf[0];
+    ret = (ret << (uint64_t)8) + *buf++;
   }
   return ret;
 }
@@ -196,6 +197,21 @@ tlv_data_get_name(uint8_t* data,
   return NDN_SUCCESS;
 }
 
+int
+tlv_data_get_metainfo(uint8_t* data,
+                      size_t buflen,
+                      data_metainfo_options_t* options)
+{
+  ndn_data_view_t view;
+  int ret;
+
+  ret = ndn_data_view_init(&view, data, buflen);
+  if(ret != NDN_SUCCESS){
+    return ret;
+  }
+  return ndn_data_view_metainfo(&view, options);
+}
+
 uint8_t*
 tlv_interest_get_hoplimit_ptr(uint8_t* interest, size_t buflen){
   uint32_t real_type, real_len;
@@ -42,6 +42,21 @@ typedef struct interest_options{
   bool must_be_fresh;
 }interest_options_t;
 
+/**
+ * MetaInfo fields of a Data packet which the forwarder cares.
+ *
+ * Filled by tlv_data_get_metainfo() without copying.
+ */
+typedef struct data_metainfo_options{
+  uint64_t freshness_period;
+  /** FinalBlockId's name component, including its T and L. @c NULL if absent.
+   * Points into the Data packet.
+   */
+  uint8_t* final_block_id;
+  size_t final_block_id_len;
+  uint32_t content_type;
+}data_metainfo_options_t;
+
 /** Get the first variable of type or length from a TLV encoded form.
  *
  * @param[in] buf The buffer containing the TLV encoded form.
@@ -65,6 +80,21 @@ tlv_get_tlvar(uint8_t* buf, size_t buflen, uint32_t* var);
 uint8_t*
 tlv_get_type_length(uint8_t* buf, size_t buflen, uint32_t* type, uint32_t* length);
 
+/** Get type and length from a TLV encoded form, as tlv_get_type_length().
+ *
+ * Inlined for one-byte type and length, the common case within packets.
+ */
+static inline uint8_t*
+tlv_scan_type_length(uint8_t* buf, size_t buflen, uint32_t* type, uint32_t* length)
+{
+  if (buflen >= 2 && buf[0] < 253 && buf[1] < 253) {
+    *type = buf[0];
+    *length = buf[1];
+    return buf + 2;
+  }
+  return tlv_get_type_length(buf, buflen, type, length);
+}
+
 /** Check the type and length of a TLV block.
  *
  * @param[in] buf [Optional] The buffer containing the TLV block.
@@ -118,6 +148,24 @@ tlv_data_get_name(uint8_t* data,
                   uint8_t** name,
                   size_t* name_len);
 
+/** Get the MetaInfo fields of a Data packet.
+ *
+ * Only the outer Data TLV and the Name are skipped; nothing is decoded or copied.
+ * @param[in] data The Data packet.
+ * @param[in] buflen The length of @c data.
+ * @param[out] options MetaInfo fields of @c data. Absent fields are set to
+ *                     #NDN_CONTENT_TYPE_BLOB, a FreshnessPeriod of 0 and a @c NULL FinalBlockId.
+ * @retval #NDN_SUCCESS The operation succeeds.
+ * @retval #NDN_OVERSIZE_VAR Either type of length in @c buf is truncated or malicious.
+ * @retval #NDN_WRONG_TLV_TYPE The type of @c buf is not #TLV_Data.
+ * @retval #NDN_WRONG_TLV_LENGTH The length of @c buf is different from @c length.
+ * @retval #NDN_UNSUPPORTED_FORMAT The first element of @c data is not #TLV_Name.
+ */
+int
+tlv_data_get_metainfo(uint8_t* data,
+                      size_t buflen,
+                      data_metainfo_options_t* options);
+
 /** Get the pointer to hop limit field of a Interest packet.
  *
  * @param[in] interest The Interest packet.
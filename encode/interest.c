@@ -52,6 +52,34 @@ ndn_interest_probe_block_value_size(const ndn_interest_t* interest)
   return interest_buffer_size;
 }
 
+// append the ParametersSha256DigestComponent to the name of an unsigned Interest with parameters
+static int
+ndn_interest_append_params_digest(ndn_interest_t* interest)
+{
+  int ret_val = -1;
+  if (!ndn_interest_has_Parameters(interest) || ndn_interest_is_signed(interest))
+    return NDN_SUCCESS;
+  if (interest->name.components_size + 1 > NDN_NAME_COMPONENTS_SIZE) {
+    return NDN_OVERSIZE;
+  }
+  uint8_t be_hashed[NDN_INTEREST_PARAMS_BLOCK_SIZE];
+  ndn_encoder_t temp_encoder;
+  // only the encoded bytes are hashed
+  encoder_init_nozero(&temp_encoder, be_hashed, NDN_INTEREST_PARAMS_BLOCK_SIZE);
+  ret_val = encoder_append_type(&temp_encoder, TLV_ApplicationParameters);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  ret_val = encoder_append_length(&temp_encoder, interest->parameters.size);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  ret_val = encoder_append_raw_buffer_value(&temp_encoder, interest->parameters.value, interest->parameters.size);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  ret_val = ndn_sha256(temp_encoder.output_value, temp_encoder.offset,
+                       interest->name.components[interest->name.components_size].value);
+  interest->name.components[interest->name.components_size].type = TLV_ParametersSha256DigestComponent;
+  interest->name.components[interest->name.components_size].size = NDN_SEC_SHA256_HASH_SIZE;
+  interest->name.components_size += 1;
+  return NDN_SUCCESS;
+}
+
 /************************************************************/
 /*  Definition of Interest APIs                             */
 /************************************************************/
@@ -162,25 +190,8 @@ ndn_interest_tlv_encode(ndn_encoder_t* encoder, ndn_interest_t* interest)
 {
   int ret_val = -1;
 
-  if (ndn_interest_has_Parameters(interest) && !ndn_interest_is_signed(interest)) {
-    if (interest->name.components_size + 1 > NDN_NAME_COMPONENTS_SIZE) {
-      return NDN_OVERSIZE;
-    }
-    uint8_t be_hashed[NDN_INTEREST_PARAMS_BLOCK_SIZE] = {0};
-    ndn_encoder_t temp_encoder;
-    encoder_init(&temp_encoder, be_hashed, NDN_INTEREST_PARAMS_BLOCK_SIZE);
-    ret_val = encoder_append_type(&temp_encoder, TLV_ApplicationParameters);
-    if (ret_val != NDN_SUCCESS) return ret_val;
-    ret_val = encoder_append_length(&temp_encoder, interest->parameters.size);
-    if (ret_val != NDN_SUCCESS) return ret_val;
-    ret_val = encoder_append_raw_buffer_value(&temp_encoder, interest->parameters.value, interest->parameters.size);
-    if (ret_val != NDN_SUCCESS) return ret_val;
-    ret_val = ndn_sha256(temp_encoder.output_value, temp_encoder.offset,
-                         interest->name.components[interest->name.components_size].value);
-    interest->name.components[interest->name.components_size].type = TLV_ParametersSha256DigestComponent;
-    interest->name.components[interest->name.components_size].size = NDN_SEC_SHA256_HASH_SIZE;
-    interest->name.components_size += 1;
-  }
+  ret_val = ndn_interest_append_params_digest(interest);
+  if (ret_val != NDN_SUCCESS) return ret_val;
 
   uint32_t interest_block_value_size = ndn_interest_probe_block_value_size(interest);
   int required_size = encoder_probe_block_size(TLV_Interest, interest_block_value_size);
@@ -255,6 +266,68 @@ ndn_interest_tlv_encode(ndn_encoder_t* encoder, ndn_interest_t* interest)
   return 0;
 }
 
+int
+ndn_interest_tlv_prepend(ndn_prepend_encoder_t* encoder, ndn_interest_t* interest)
+{
+  int ret_val = -1;
+  uint32_t value_end = prepend_encoder_size(encoder);
+
+  ret_val = ndn_interest_append_params_digest(interest);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+
+  if (ndn_interest_is_signed(interest)) {
+    // signature value
+    ret_val = ndn_signature_value_tlv_prepend(encoder, &interest->signature);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    // signature info
+    ret_val = ndn_signature_info_tlv_prepend(encoder, &interest->signature);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+  // parameters
+  if (ndn_interest_has_Parameters(interest)) {
+    ret_val = encoder_prepend_raw_buffer_value(encoder, interest->parameters.value, interest->parameters.size);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_prepend_type_length(encoder, TLV_ApplicationParameters, interest->parameters.size);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+  // hop limit
+  if (ndn_interest_has_HopLimit(interest)) {
+    ret_val = encoder_prepend_uint_value(encoder, interest->hop_limit);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_prepend_type_length(encoder, TLV_HopLimit, 1);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+  // lifetime
+  ret_val = encoder_prepend_uint_value(encoder, interest->lifetime);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  ret_val = encoder_prepend_type_length(encoder, TLV_InterestLifetime,
+                                        encoder_probe_uint_length(interest->lifetime));
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  // nonce
+  if (interest->nonce == 0) {
+    interest->nonce = (uint32_t) ndn_time_now_ms();
+  }
+  ret_val = encoder_prepend_uint32_value(encoder, interest->nonce);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  ret_val = encoder_prepend_type_length(encoder, TLV_Nonce, 4);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  // must be fresh
+  if (ndn_interest_get_MustBeFresh(interest)) {
+    ret_val = encoder_prepend_type_length(encoder, TLV_MustBeFresh, 0);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+  // can be prefix
+  if (ndn_interest_get_CanBePrefix(interest)) {
+    ret_val = encoder_prepend_type_length(encoder, TLV_CanBePrefix, 0);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+  // name
+  ret_val = ndn_name_tlv_prepend(encoder, &interest->name);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+
+  return encoder_prepend_type_length(encoder, TLV_Interest, prepend_encoder_size(encoder) - value_end);
+}
+
 int
 ndn_interest_name_compare_block(const uint8_t* lhs_block_value, uint32_t lhs_block_size,
                                 const uint8_t* rhs_block_value, uint32_t rhs_block_size)
@@ -218,6 +218,17 @@ ndn_interest_is_signed(const ndn_interest_t* interest)
 int
 ndn_interest_tlv_encode(ndn_encoder_t* encoder, ndn_interest_t* interest);
 
+/**
+ * Encode the Interest into wire format (TLV block) back to front, as ndn_interest_tlv_encode().
+ * Unlike ndn_interest_tlv_encode(), the sizes of the elements need not be probed first.
+ * @param encoder. Output. The prepend encoder who keeps the encoding result and the state.
+ *        The Interest is prepended in front of its current output.
+ * @param interest. Input. The Interest to be encoded.
+ * @return 0 if there is no error.
+ */
+int
+ndn_interest_tlv_prepend(ndn_prepend_encoder_t* encoder, ndn_interest_t* interest);
+
 /**
  * Compare two encoded Interests' names.
  * @param lhs_block_value. Input. Left-hand-side encoded Interest block value.
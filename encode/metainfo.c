@@ -136,3 +136,37 @@ ndn_metainfo_tlv_encode(ndn_encoder_t* encoder, const ndn_metainfo_t* meta)
   }
   return 0;
 }
+
+int
+ndn_metainfo_tlv_prepend(ndn_prepend_encoder_t* encoder, const ndn_metainfo_t* meta)
+{
+  int ret_val = -1;
+  uint32_t value_end = prepend_encoder_size(encoder);
+  uint32_t comp_end;
+
+  if (meta->enable_FinalBlockId) {
+    comp_end = prepend_encoder_size(encoder);
+    ret_val = name_component_tlv_prepend(encoder, &meta->final_block_id);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_prepend_type_length(encoder, TLV_FinalBlockId,
+                                          prepend_encoder_size(encoder) - comp_end);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+  if (meta->enable_FreshnessPeriod) {
+    ret_val = encoder_prepend_uint_value(encoder, meta->freshness_period);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_prepend_type_length(encoder, TLV_FreshnessPeriod,
+                                          encoder_probe_uint_length(meta->freshness_period));
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+  if (meta->enable_ContentType) {
+    ret_val = encoder_prepend_uint_value(encoder, meta->content_type);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_prepend_type_length(encoder, TLV_ContentType, 1);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+
+  if (prepend_encoder_size(encoder) == value_end)
+    return 0;
+  return encoder_prepend_type_length(encoder, TLV_MetaInfo, prepend_encoder_size(encoder) - value_end);
+}
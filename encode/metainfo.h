@@ -156,6 +156,15 @@ ndn_metainfo_probe_block_size(const ndn_metainfo_t* meta)
 int
 ndn_metainfo_tlv_encode(ndn_encoder_t* encoder, const ndn_metainfo_t* meta);
 
+/**
+ * Prepend the Metainfo structure as wire format (TLV block).
+ * @param encoder. Output. The prepend encoder who keeps the encoding result and the state.
+ * @param meta. Input. The Metainfo structure to be encoded.
+ * @return 0 if there is no error.
+ */
+int
+ndn_metainfo_tlv_prepend(ndn_prepend_encoder_t* encoder, const ndn_metainfo_t* meta);
+
 #ifdef __cplusplus
 }
 #endif
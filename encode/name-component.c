@@ -157,6 +157,15 @@ name_component_tlv_encode(ndn_encoder_t* encoder, const name_component_t* compon
   return encoder_append_raw_buffer_value(encoder, component->value, component->size);
 }
 
+int
+name_component_tlv_prepend(ndn_prepend_encoder_t* encoder, const name_component_t* component)
+{
+  int ret_val = -1;
+  ret_val = encoder_prepend_raw_buffer_value(encoder, component->value, component->size);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  return encoder_prepend_type_length(encoder, component->type, component->size);
+}
+
 void
 name_component_print(const name_component_t* component)
 {
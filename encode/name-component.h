@@ -141,6 +141,15 @@ name_component_probe_block_size(const name_component_t* component)
 int
 name_component_tlv_encode(ndn_encoder_t* encoder, const name_component_t* component);
 
+/**
+ * Prepend the Name Component structure as wire format (TLV block).
+ * @param encoder. Output. The prepend encoder who keeps the encoding result and the state.
+ * @param component. Input. The Name Component structure to be encoded.
+ * @return 0 if there is no error.
+ */
+int
+name_component_tlv_prepend(ndn_prepend_encoder_t* encoder, const name_component_t* component);
+
 void
 name_component_print(const name_component_t* component);
 
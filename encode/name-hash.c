@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include "name-hash.h"
+#include "forwarder-helper.h"
+#include "../ndn-error-code.h"
+
+// The FNV-1a offset basis until a seed is set
+static uint64_t name_hash_seed = 14695981039346656037ull;
+
+uint64_t
+ndn_name_hash_seed(void)
+{
+  return name_hash_seed;
+}
+
+void
+ndn_name_hash_set_seed(uint64_t seed)
+{
+  name_hash_seed = seed;
+}
+
+int
+ndn_name_hash_compute(ndn_name_hash_t* hash, uint8_t* name, size_t name_size)
+{
+  uint32_t type, len;
+  uint8_t *ptr, *end = name + name_size, *value;
+  uint64_t h = name_hash_seed;
+  bool is_short = true;
+  size_t size;
+
+  hash->hashes[0] = h;
+  hash->components_size = 0;
+  hash->depth = hash->short_depth = 0;
+  ptr = (name_size > 0) ? tlv_scan_type_length(name, name_size, &type, &len) : NULL;
+  if (ptr == NULL)
+    return NDN_OVERSIZE_VAR;
+  while (ptr < end) {
+    value = tlv_scan_type_length(ptr, end - ptr, &type, &len);
+    if (value == NULL || len > (size_t)(end - value))
+      return NDN_OVERSIZE_VAR;
+    size = value + len - ptr;
+    h = ndn_name_hash_extend(h, ptr, size);
+    hash->components_size ++;
+    if (hash->depth < NDN_NAME_HASH_MAX_DEPTH) {
+      hash->hashes[++hash->depth] = h;
+      // The same component as walked by the NameTree
+      is_short = is_short && size <= NDN_NAME_COMPONENT_BUFFER_SIZE && (size_t)ptr[1] + 2 == size;
+      if (is_short)
+        hash->short_depth = hash->depth;
+    }
+    ptr = value + len;
+  }
+  hash->full = h;
+  return NDN_SUCCESS;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_NAME_HASH_H
+#define NDN_ENCODING_NAME_HASH_H
+
+#include "../ndn-constants.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNEncodeNameHash Name hashes
+ * @brief Hashes of all prefixes of an encoded Name, computed in one pass.
+ * @ingroup NDNEncode
+ *
+ * The hash of a prefix is FNV-1a over its component TLVs, started from a per-process
+ * seed, so it extends from the hash of the parent prefix. Tables keyed by names mix
+ * it with ndn_name_hash_mix() before taking a bucket, so the hashes of a packet
+ * computed once by ndn_name_hash_compute() serve all lookups of that packet.
+ * @{
+ */
+
+/**
+ * Hashes of the prefixes of a Name.
+ */
+typedef struct ndn_name_hash {
+  /** @c hashes[i] is the hash of the first @c i components. @c hashes[0] is the seed.
+   */
+  uint64_t hashes[NDN_NAME_HASH_MAX_DEPTH + 1];
+  /** The hash of the whole Name, however deep it is.
+   */
+  uint64_t full;
+  /** The number of components.
+   */
+  uint32_t components_size;
+  /** The number of prefixes hashed in @c hashes, at most #NDN_NAME_HASH_MAX_DEPTH.
+   */
+  uint8_t depth;
+  /** The number of leading components with one-byte type and length, no longer than
+   * #NDN_NAME_COMPONENT_BUFFER_SIZE. Tables which keep components truncated to that
+   * size, such as the NameTree, can use the hashes of prefixes up to this length.
+   */
+  uint8_t short_depth;
+} ndn_name_hash_t;
+
+/** Get the hash of the empty Name.
+ */
+uint64_t
+ndn_name_hash_seed(void);
+
+/** Set the seed of all name hashes.
+ *
+ * ndn_forwarder_init() sets a random one. Tables holding hashes must be empty
+ * when it changes.
+ * @param[in] seed The seed.
+ */
+void
+ndn_name_hash_set_seed(uint64_t seed);
+
+/** Extend the hash of a prefix with the next component.
+ *
+ * @param[in] hash The hash of the prefix.
+ * @param[in] component The component TLV.
+ * @param[in] len The length of @c component.
+ * @return The hash of the longer prefix.
+ */
+static inline uint64_t
+ndn_name_hash_extend(uint64_t hash, const uint8_t* component, size_t len)
+{
+  for (size_t i = 0; i < len; i++) {
+    hash ^= component[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+/** The SplitMix64 finalizer, so that buckets taken from any bits of a hash are uniform.
+ */
+static inline uint64_t
+ndn_name_hash_mix(uint64_t hash)
+{
+  hash ^= hash >> 30;
+  hash *= 0xbf58476d1ce4e5b9ull;
+  hash ^= hash >> 27;
+  hash *= 0x94d049bb133111ebull;
+  hash ^= hash >> 31;
+  return hash;
+}
+
+/** Hash all prefixes of an encoded Name.
+ *
+ * @param[out] hash The hashes.
+ * @param[in] name The Name TLV, including T and L.
+ * @param[in] name_size The length of @c name.
+ * @retval #NDN_SUCCESS The operation succeeds.
+ * @retval #NDN_OVERSIZE_VAR A component of @c name is truncated or malicious.
+ */
+int
+ndn_name_hash_compute(ndn_name_hash_t* hash, uint8_t* name, size_t name_size);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NDN_ENCODING_NAME_HASH_H
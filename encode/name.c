@@ -192,6 +192,18 @@ ndn_name_tlv_encode(ndn_encoder_t* encoder, const ndn_name_t *name)
   return 0;
 }
 
+int
+ndn_name_tlv_prepend(ndn_prepend_encoder_t* encoder, const ndn_name_t *name)
+{
+  int ret_val = -1;
+  uint32_t value_end = prepend_encoder_size(encoder);
+  for (size_t i = name->components_size; i > 0; i--) {
+    ret_val = name_component_tlv_prepend(encoder, &name->components[i - 1]);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+  return encoder_prepend_type_length(encoder, TLV_Name, prepend_encoder_size(encoder) - value_end);
+}
+
 int
 ndn_name_compare(const ndn_name_t* lhs, const ndn_name_t* rhs)
 {
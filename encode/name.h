@@ -143,6 +143,16 @@ ndn_name_probe_block_size(const ndn_name_t *name)
 int
 ndn_name_tlv_encode(ndn_encoder_t* encoder, const ndn_name_t *name);
 
+/**
+ * Prepend the Name structure as wire format (TLV block).
+ * Unlike ndn_name_tlv_encode(), the size of the block need not be probed first.
+ * @param encoder. Output. The prepend encoder who keeps the encoding result and the state.
+ * @param name. Input. The Name structure to be encoded.
+ * @return 0 if there is no error.
+ */
+int
+ndn_name_tlv_prepend(ndn_prepend_encoder_t* encoder, const ndn_name_t *name);
+
 /**
  * Compare two Name.
  * @param lhs. Input. Left-hand-side Name.
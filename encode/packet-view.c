@@ -0,0 +1,421 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include "packet-view.h"
+#include "tlv.h"
+#include "../ndn-error-code.h"
+#include "../ndn-constants.h"
+#include <string.h>
+
+// Read the element at *ptr, which must end by end, and move *ptr past it.
+// Returns its value, or NULL if it is truncated.
+static uint8_t*
+view_next(uint8_t** ptr, uint8_t* end, uint32_t* type, uint32_t* length)
+{
+  uint8_t* value;
+
+  if (*ptr >= end)
+    return NULL;
+  value = tlv_scan_type_length(*ptr, end - *ptr, type, length);
+  if (value == NULL || *length > (size_t)(end - value))
+    return NULL;
+  *ptr = value + *length;
+  return value;
+}
+
+// Check the outer TLV of a packet, which must be of packet_type unless it is 0.
+// Returns the position of its value.
+static int
+view_outer(uint8_t* packet, size_t length, uint32_t packet_type, uint32_t* type, uint8_t** value)
+{
+  uint32_t len;
+  uint8_t* ptr;
+
+  if (packet == NULL)
+    return NDN_INVALID_POINTER;
+  ptr = (length > 0) ? tlv_scan_type_length(packet, length, type, &len) : NULL;
+  if (ptr == NULL)
+    return NDN_OVERSIZE_VAR;
+  if (packet_type != 0 && *type != packet_type)
+    return NDN_WRONG_TLV_TYPE;
+  if (len != length - (ptr - packet))
+    return NDN_WRONG_TLV_LENGTH;
+  *value = ptr;
+  return NDN_SUCCESS;
+}
+
+// Find the Name, which starts at *ptr, and move *ptr past it
+static int
+view_name(uint8_t** ptr, uint8_t* end, uint8_t** name, size_t* name_size)
+{
+  uint32_t type, len;
+
+  *name = *ptr;
+  if (view_next(ptr, end, &type, &len) == NULL)
+    return NDN_OVERSIZE_VAR;
+  if (type != TLV_Name)
+    return NDN_UNSUPPORTED_FORMAT;
+  *name_size = *ptr - *name;
+  return NDN_SUCCESS;
+}
+
+// Decode the value of a SignatureInfo or InterestSignatureInfo
+static int
+view_signature_info(uint8_t* info, size_t info_size, ndn_signature_view_t* signature)
+{
+  uint32_t type, len;
+  uint8_t *ptr = info, *end = info + info_size, *value;
+
+  signature->key_locator_name = NULL;
+  signature->key_locator_name_size = 0;
+  signature->nonce = 0;
+  signature->timestamp = 0;
+
+  // SignatureType comes first
+  value = view_next(&ptr, end, &type, &len);
+  if (value == NULL)
+    return NDN_OVERSIZE_VAR;
+  if (type != TLV_SignatureType || len == 0)
+    return NDN_UNSUPPORTED_FORMAT;
+  signature->sig_type = (uint8_t)tlv_get_uint(value, len);
+
+  while (ptr < end) {
+    value = view_next(&ptr, end, &type, &len);
+    if (value == NULL)
+      return NDN_OVERSIZE_VAR;
+    if (type == TLV_KeyLocator) {
+      // Only a Name is supported as KeyLocator
+      signature->key_locator_name = value;
+      if (view_next(&value, ptr, &type, &len) == NULL)
+        return NDN_OVERSIZE_VAR;
+      if (type != TLV_Name)
+        return NDN_UNSUPPORTED_FORMAT;
+      signature->key_locator_name_size = value - signature->key_locator_name;
+    }
+    else if (type == TLV_Nonce && len == sizeof(signature->nonce)) {
+      signature->nonce = (uint32_t)tlv_get_uint(value, len);
+    }
+    else if (type == TLV_Timestamp) {
+      signature->timestamp = tlv_get_uint(value, len);
+    }
+  }
+  return NDN_SUCCESS;
+}
+
+// Make a view of a Data packet whose value starts at ptr
+static int
+data_view_open(ndn_data_view_t* view, uint8_t* data, size_t length, uint8_t* ptr)
+{
+  int ret = view_name(&ptr, data + length, &view->name, &view->name_size);
+
+  if (ret != NDN_SUCCESS)
+    return ret;
+  view->block = data;
+  view->block_size = length;
+  view->scanned = false;
+  return NDN_SUCCESS;
+}
+
+int
+ndn_data_view_init(ndn_data_view_t* view, uint8_t* data, size_t length)
+{
+  uint32_t type;
+  uint8_t* value;
+  int ret;
+
+  ret = view_outer(data, length, TLV_Data, &type, &value);
+  if (ret != NDN_SUCCESS)
+    return ret;
+  return data_view_open(view, data, length, value);
+}
+
+// Find the elements after the Name
+static int
+data_view_scan(ndn_data_view_t* view)
+{
+  uint32_t type, len;
+  uint8_t *ptr = view->name + view->name_size;
+  uint8_t *end = view->block + view->block_size;
+  uint8_t* value;
+
+  if (view->scanned)
+    return NDN_SUCCESS;
+  view->metainfo = view->content = NULL;
+  view->signature_info = view->signature_value = NULL;
+  view->metainfo_size = view->content_size = 0;
+  view->signature_info_size = view->signature_value_size = 0;
+  while (ptr < end) {
+    value = view_next(&ptr, end, &type, &len);
+    if (value == NULL)
+      return NDN_OVERSIZE_VAR;
+    if (type == TLV_MetaInfo) {
+      view->metainfo = value;
+      view->metainfo_size = len;
+    }
+    else if (type == TLV_Content) {
+      view->content = value;
+      view->content_size = len;
+    }
+    else if (type == TLV_SignatureInfo) {
+      view->signature_info = value;
+      view->signature_info_size = len;
+    }
+    else if (type == TLV_SignatureValue) {
+      view->signature_value = value;
+      view->signature_value_size = len;
+    }
+  }
+  view->scanned = true;
+  return NDN_SUCCESS;
+}
+
+int
+ndn_data_view_metainfo(ndn_data_view_t* view, data_metainfo_options_t* options)
+{
+  uint32_t type, len;
+  uint8_t *ptr, *end, *value;
+  int ret;
+
+  options->freshness_period = 0;
+  options->final_block_id = NULL;
+  options->final_block_id_len = 0;
+  options->content_type = NDN_CONTENT_TYPE_BLOB;
+
+  ret = data_view_scan(view);
+  if (ret != NDN_SUCCESS)
+    return ret;
+  ptr = view->metainfo;
+  end = view->metainfo + view->metainfo_size;
+  while (ptr != NULL && ptr < end) {
+    value = view_next(&ptr, end, &type, &len);
+    if (value == NULL)
+      return NDN_OVERSIZE_VAR;
+    if (type == TLV_ContentType) {
+      options->content_type = (uint32_t)tlv_get_uint(value, len);
+    }
+    else if (type == TLV_FreshnessPeriod) {
+      options->freshness_period = tlv_get_uint(value, len);
+    }
+    else if (type == TLV_FinalBlockId) {
+      options->final_block_id = value;
+      options->final_block_id_len = len;
+    }
+  }
+  return NDN_SUCCESS;
+}
+
+int
+ndn_data_view_content(ndn_data_view_t* view, uint8_t** content, size_t* content_size)
+{
+  int ret = data_view_scan(view);
+
+  if (ret != NDN_SUCCESS)
+    return ret;
+  *content = view->content;
+  *content_size = view->content_size;
+  return NDN_SUCCESS;
+}
+
+int
+ndn_data_view_signature(ndn_data_view_t* view, ndn_signature_view_t* signature)
+{
+  int ret = data_view_scan(view);
+
+  if (ret != NDN_SUCCESS)
+    return ret;
+  if (view->signature_info == NULL || view->signature_value == NULL)
+    return NDN_UNSUPPORTED_FORMAT;
+  ret = view_signature_info(view->signature_info, view->signature_info_size, signature);
+  if (ret != NDN_SUCCESS)
+    return ret;
+  signature->sig_value = view->signature_value;
+  signature->sig_size = view->signature_value_size;
+  signature->signed_portion = view->name;
+  signature->signed_size = view->signature_info + view->signature_info_size - view->name;
+  return NDN_SUCCESS;
+}
+
+// Make a view of an Interest packet whose value starts at ptr
+static int
+interest_view_open(ndn_interest_view_t* view, uint8_t* interest, size_t length, uint8_t* ptr)
+{
+  uint32_t type, len;
+  uint8_t *end = interest + length, *value;
+  interest_options_t* options = &view->options;
+  int ret;
+
+  ret = view_name(&ptr, end, &view->name, &view->name_size);
+  if (ret != NDN_SUCCESS)
+    return ret;
+  view->block = interest;
+  view->block_size = length;
+  view->hop_limit = NULL;
+  view->parameters = view->signature_info = view->signature_value = NULL;
+  view->parameters_size = view->signature_info_size = view->signature_value_size = 0;
+  options->can_be_prefix = false;
+  options->must_be_fresh = false;
+  options->lifetime = NDN_DEFAULT_INTEREST_LIFETIME;
+  options->hop_limit = 0;
+  options->nonce = 0;
+
+  while (ptr < end) {
+    value = view_next(&ptr, end, &type, &len);
+    if (value == NULL)
+      return NDN_OVERSIZE_VAR;
+    if (type == TLV_CanBePrefix) {
+      options->can_be_prefix = true;
+    }
+    else if (type == TLV_MustBeFresh) {
+      options->must_be_fresh = true;
+    }
+    else if (type == TLV_HopLimit && len == sizeof(options->hop_limit)) {
+      options->hop_limit = *value;
+      view->hop_limit = value;
+    }
+    else if (type == TLV_Nonce && len == sizeof(options->nonce)) {
+      // Kept in wire order, as tlv_interest_get_header() does
+      memcpy(&options->nonce, value, sizeof(options->nonce));
+    }
+    else if (type == TLV_InterestLifetime) {
+      options->lifetime = tlv_get_uint(value, len);
+    }
+    else if (type == TLV_ApplicationParameters) {
+      view->parameters = value;
+      view->parameters_size = len;
+    }
+    else if (type == TLV_InterestSignatureInfo) {
+      view->signature_info = value;
+      view->signature_info_size = len;
+    }
+    else if (type == TLV_InterestSignatureValue) {
+      view->signature_value = value;
+      view->signature_value_size = len;
+    }
+  }
+  return NDN_SUCCESS;
+}
+
+int
+ndn_interest_view_init(ndn_interest_view_t* view, uint8_t* interest, size_t length)
+{
+  uint32_t type;
+  uint8_t* value;
+  int ret;
+
+  ret = view_outer(interest, length, TLV_Interest, &type, &value);
+  if (ret != NDN_SUCCESS)
+    return ret;
+  return interest_view_open(view, interest, length, value);
+}
+
+int
+ndn_interest_view_signature(const ndn_interest_view_t* view, ndn_signature_view_t* signature)
+{
+  int ret;
+
+  if (view->signature_info == NULL || view->signature_value == NULL)
+    return NDN_UNSUPPORTED_FORMAT;
+  ret = view_signature_info(view->signature_info, view->signature_info_size, signature);
+  if (ret != NDN_SUCCESS)
+    return ret;
+  signature->sig_value = view->signature_value;
+  signature->sig_size = view->signature_value_size;
+  signature->signed_portion = NULL;
+  signature->signed_size = 0;
+  return NDN_SUCCESS;
+}
+
+int
+ndn_packet_index_init(ndn_packet_index_t* index, uint8_t* packet, size_t length)
+{
+  uint32_t type;
+  uint8_t* value;
+  int ret;
+
+  index->type = 0;
+  ret = view_outer(packet, length, 0, &type, &value);
+  if (ret != NDN_SUCCESS)
+    return ret;
+  if (type == TLV_Interest) {
+    index->type = type;
+    ret = interest_view_open(&index->interest, packet, length, value);
+    if (ret == NDN_SUCCESS)
+      ret = ndn_name_hash_compute(&index->name_hash, index->interest.name, index->interest.name_size);
+  }
+  else if (type == TLV_Data) {
+    index->type = type;
+    ret = data_view_open(&index->data, packet, length, value);
+    if (ret == NDN_SUCCESS)
+      ret = ndn_name_hash_compute(&index->name_hash, index->data.name, index->data.name_size);
+  }
+  else {
+    ret = NDN_WRONG_TLV_TYPE;
+  }
+  return ret;
+}
+
+int
+ndn_name_view_component(uint8_t* name, size_t name_size, int index,
+                        uint8_t** component, size_t* component_size)
+{
+  uint32_t type, len;
+  uint8_t *ptr, *end = name + name_size, *start;
+  int count = 0;
+
+  ptr = tlv_scan_type_length(name, name_size, &type, &len);
+  if (ptr == NULL)
+    return NDN_OVERSIZE_VAR;
+  if (index < 0) {
+    // Count the components first
+    start = ptr;
+    while (ptr < end) {
+      if (view_next(&ptr, end, &type, &len) == NULL)
+        return NDN_OVERSIZE_VAR;
+      count ++;
+    }
+    index += count;
+    if (index < 0)
+      return NDN_INVALID_ARG;
+    ptr = start;
+  }
+  while (ptr < end) {
+    start = ptr;
+    if (view_next(&ptr, end, &type, &len) == NULL)
+      return NDN_OVERSIZE_VAR;
+    if (index-- == 0) {
+      *component = start;
+      *component_size = ptr - start;
+      return NDN_SUCCESS;
+    }
+  }
+  return NDN_INVALID_ARG;
+}
+
+int
+ndn_name_view_is_prefix_of(uint8_t* name, size_t name_size, const ndn_name_t* rhs)
+{
+  uint32_t type, len;
+  uint8_t *ptr, *end = name + name_size, *value;
+  uint32_t i = 0;
+
+  ptr = tlv_scan_type_length(name, name_size, &type, &len);
+  if (ptr == NULL)
+    return 1;
+  while (ptr < end) {
+    value = view_next(&ptr, end, &type, &len);
+    if (value == NULL || i >= rhs->components_size)
+      return 1;
+    if (type != rhs->components[i].type || len != rhs->components[i].size ||
+        memcmp(value, rhs->components[i].value, len) != 0)
+      return 1;
+    i ++;
+  }
+  return 0;
+}
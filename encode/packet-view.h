@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_PACKET_VIEW_H
+#define NDN_ENCODING_PACKET_VIEW_H
+
+#include "forwarder-helper.h"
+#include "name.h"
+#include "name-hash.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNEncodePacketView Packet views
+ * @brief Decoded views of Data and Interest packets, without copying.
+ * @ingroup NDNEncode
+ *
+ * A view holds pointers into the wire buffer it is made from, so the buffer must
+ * outlive it and must not change meanwhile. Nothing is copied, unlike decoding into
+ * @c ndn_data_t or @c ndn_interest_t, which takes a few KB per packet.
+ *
+ * @code{.c}
+ * ndn_data_view_t view;
+ * uint8_t* content;
+ * size_t content_size;
+ *
+ * if (ndn_data_view_init(&view, data, length) == NDN_SUCCESS &&
+ *     ndn_data_view_content(&view, &content, &content_size) == NDN_SUCCESS) {
+ *   // Use content, which points into data
+ * }
+ * @endcode
+ * @{
+ */
+
+/**
+ * Signature fields of a packet.
+ *
+ * Filled by ndn_data_view_signature() and ndn_interest_view_signature().
+ */
+typedef struct ndn_signature_view {
+  uint8_t sig_type;
+  /** The Name TLV of the KeyLocator, including T and L. @c NULL if absent.
+   */
+  uint8_t* key_locator_name;
+  size_t key_locator_name_size;
+  /** SignatureNonce. 0 if absent.
+   */
+  uint32_t nonce;
+  /** Timestamp. 0 if absent.
+   */
+  uint64_t timestamp;
+  /** The value of SignatureValue, not including T and L.
+   */
+  uint8_t* sig_value;
+  size_t sig_size;
+  /** The part of a Data packet the signature is computed over, from the Name to
+   * the end of SignatureInfo. @c NULL for Interests, whose signed part is not contiguous.
+   */
+  uint8_t* signed_portion;
+  size_t signed_size;
+} ndn_signature_view_t;
+
+/**
+ * A Data packet decoded in place.
+ *
+ * ndn_data_view_init() only finds the Name. The other elements are found
+ * on the first call to an accessor needing them.
+ */
+typedef struct ndn_data_view {
+  /** The Data packet.
+   */
+  uint8_t* block;
+  size_t block_size;
+  /** The Name TLV, including T and L.
+   */
+  uint8_t* name;
+  size_t name_size;
+
+  /** The values of the elements after the Name. @c NULL if absent.
+   * Only valid once @c scanned is set, use the accessors instead.
+   */
+  uint8_t* metainfo;
+  size_t metainfo_size;
+  uint8_t* content;
+  size_t content_size;
+  uint8_t* signature_info;
+  size_t signature_info_size;
+  uint8_t* signature_value;
+  size_t signature_value_size;
+  bool scanned;
+} ndn_data_view_t;
+
+/**
+ * An Interest packet decoded in place.
+ *
+ * Interests are short, so ndn_interest_view_init() finds all elements in one pass.
+ * Only the SignatureInfo is decoded on demand.
+ */
+typedef struct ndn_interest_view {
+  /** The Interest packet.
+   */
+  uint8_t* block;
+  size_t block_size;
+  /** The Name TLV, including T and L.
+   */
+  uint8_t* name;
+  size_t name_size;
+  /** Options of the Interest.
+   */
+  interest_options_t options;
+  /** The value of HopLimit, which may be decremented in place. @c NULL if absent.
+   */
+  uint8_t* hop_limit;
+  /** The values of ApplicationParameters, InterestSignatureInfo and
+   * InterestSignatureValue. @c NULL if absent.
+   */
+  uint8_t* parameters;
+  size_t parameters_size;
+  uint8_t* signature_info;
+  size_t signature_info_size;
+  uint8_t* signature_value;
+  size_t signature_value_size;
+} ndn_interest_view_t;
+
+/**
+ * A packet indexed in one pass, so that no later stage parses it again.
+ *
+ * Elements of the packet are found as by the view of its type, and the prefixes
+ * of its Name are hashed as by ndn_name_hash_compute().
+ */
+typedef struct ndn_packet_index {
+  /** #TLV_Interest or #TLV_Data. 0 if the outer TLV is malformed.
+   */
+  uint32_t type;
+  /** The view of the packet, as selected by @c type.
+   */
+  union {
+    ndn_interest_view_t interest;
+    ndn_data_view_t data;
+  };
+  /** Hashes of the prefixes of the Name.
+   */
+  ndn_name_hash_t name_hash;
+} ndn_packet_index_t;
+
+/** Make a view of a Data packet.
+ *
+ * @param[out] view The view.
+ * @param[in] data The Data packet, which must outlive @c view.
+ * @param[in] length The length of @c data.
+ * @retval #NDN_SUCCESS The operation succeeds.
+ * @retval #NDN_OVERSIZE_VAR Either type or length in @c data is truncated or malicious.
+ * @retval #NDN_WRONG_TLV_TYPE The type of @c data is not #TLV_Data.
+ * @retval #NDN_WRONG_TLV_LENGTH The length of @c data is different from @c length.
+ * @retval #NDN_UNSUPPORTED_FORMAT The first element of @c data is not #TLV_Name.
+ */
+int
+ndn_data_view_init(ndn_data_view_t* view, uint8_t* data, size_t length);
+
+/** Get the MetaInfo fields of a Data packet.
+ *
+ * @param[in, out] view The view.
+ * @param[out] options MetaInfo fields. Absent fields are set as by tlv_data_get_metainfo().
+ * @retval #NDN_SUCCESS The operation succeeds.
+ * @retval #NDN_OVERSIZE_VAR An element of the packet is truncated or malicious.
+ */
+int
+ndn_data_view_metainfo(ndn_data_view_t* view, data_metainfo_options_t* options);
+
+/** Get the Content of a Data packet.
+ *
+ * @param[in, out] view The view.
+ * @param[out] content The value of Content. @c NULL if absent.
+ * @param[out] content_size The length of @c content. 0 if absent.
+ * @retval #NDN_SUCCESS The operation succeeds.
+ * @retval #NDN_OVERSIZE_VAR An element of the packet is truncated or malicious.
+ */
+int
+ndn_data_view_content(ndn_data_view_t* view, uint8_t** content, size_t* content_size);
+
+/** Get the signature fields of a Data packet.
+ *
+ * @param[in, out] view The view.
+ * @param[out] signature The signature fields.
+ * @retval #NDN_SUCCESS The operation succeeds.
+ * @retval #NDN_OVERSIZE_VAR An element of the packet is truncated or malicious.
+ * @retval #NDN_UNSUPPORTED_FORMAT The packet has no SignatureInfo or SignatureValue.
+ */
+int
+ndn_data_view_signature(ndn_data_view_t* view, ndn_signature_view_t* signature);
+
+/** Make a view of an Interest packet.
+ *
+ * @param[out] view The view.
+ * @param[in] interest The Interest packet, which must outlive @c view.
+ * @param[in] length The length of @c interest.
+ * @retval #NDN_SUCCESS The operation succeeds.
+ * @retval #NDN_OVERSIZE_VAR An element of @c interest is truncated or malicious.
+ * @retval #NDN_WRONG_TLV_TYPE The type of @c interest is not #TLV_Interest.
+ * @retval #NDN_WRONG_TLV_LENGTH The length of @c interest is different from @c length.
+ * @retval #NDN_UNSUPPORTED_FORMAT The first element of @c interest is not #TLV_Name.
+ */
+int
+ndn_interest_view_init(ndn_interest_view_t* view, uint8_t* interest, size_t length);
+
+/** Get the signature fields of an Interest packet.
+ *
+ * @param[in] view The view.
+ * @param[out] signature The signature fields. @c signed_portion is @c NULL.
+ * @retval #NDN_SUCCESS The operation succeeds.
+ * @retval #NDN_OVERSIZE_VAR An element of the packet is truncated or malicious.
+ * @retval #NDN_UNSUPPORTED_FORMAT The Interest is not signed.
+ */
+int
+ndn_interest_view_signature(const ndn_interest_view_t* view, ndn_signature_view_t* signature);
+
+/** Index an Interest or Data packet.
+ *
+ * @param[out] index The index.
+ * @param[in] packet The packet, which must outlive @c index.
+ * @param[in] length The length of @c packet.
+ * @retval #NDN_SUCCESS The operation succeeds.
+ * @retval #NDN_OVERSIZE_VAR An element of @c packet is truncated or malicious.
+ * @retval #NDN_WRONG_TLV_TYPE @c packet is neither an Interest nor a Data.
+ * @retval #NDN_WRONG_TLV_LENGTH The length of @c packet is different from @c length.
+ * @retval #NDN_UNSUPPORTED_FORMAT The first element of @c packet is not #TLV_Name.
+ */
+int
+ndn_packet_index_init(ndn_packet_index_t* index, uint8_t* packet, size_t length);
+
+/** Get a component of an encoded Name.
+ *
+ * @param[in] name The Name TLV, including T and L.
+ * @param[in] name_size The length of @c name.
+ * @param[in] index The index of the component. Negative ones count from the end,
+ *                  -1 being the last component.
+ * @param[out] component The component TLV, including T and L.
+ * @param[out] component_size The length of @c component.
+ * @retval #NDN_SUCCESS The operation succeeds.
+ * @retval #NDN_OVERSIZE_VAR A component of @c name is truncated or malicious.
+ * @retval #NDN_INVALID_ARG @c name has no component at @c index.
+ */
+int
+ndn_name_view_component(uint8_t* name, size_t name_size, int index,
+                        uint8_t** component, size_t* component_size);
+
+/** Check whether an encoded Name is a prefix of a Name structure.
+ *
+ * @param[in] name The Name TLV, including T and L.
+ * @param[in] name_size The length of @c name.
+ * @param[in] rhs The Name structure.
+ * @return 0 if @c name is a prefix of @c rhs, as ndn_name_is_prefix_of(). 1 otherwise.
+ */
+int
+ndn_name_view_is_prefix_of(uint8_t* name, size_t name_size, const ndn_name_t* rhs);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NDN_ENCODING_PACKET_VIEW_H
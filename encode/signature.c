@@ -140,6 +140,88 @@ ndn_signature_value_tlv_encode(ndn_encoder_t* encoder, const ndn_signature_t* si
   return 0;
 }
 
+int
+ndn_signature_info_tlv_prepend(ndn_prepend_encoder_t* encoder, const ndn_signature_t* signature)
+{
+  int ret_val = -1;
+  uint32_t info_end = prepend_encoder_size(encoder);
+  uint32_t block_end;
+
+  // validity period
+  if (signature->enable_ValidityPeriod) {
+    block_end = prepend_encoder_size(encoder);
+    ret_val = encoder_prepend_raw_buffer_value(encoder, signature->validity_period.not_after, 15);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_prepend_type_length(encoder, TLV_NotAfter, 15);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_prepend_raw_buffer_value(encoder, signature->validity_period.not_before, 15);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_prepend_type_length(encoder, TLV_NotBefore, 15);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_prepend_type_length(encoder, TLV_ValidityPeriod,
+                                          prepend_encoder_size(encoder) - block_end);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+
+  // seqnum
+  if (signature->enable_Seqnum > 0) {
+    ret_val = encoder_prepend_uint_value(encoder, signature->seqnum);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_prepend_type_length(encoder, TLV_SeqNum,
+                                          encoder_probe_uint_length(signature->seqnum));
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+
+  // timestamp
+  if (signature->enable_Timestamp > 0) {
+    ret_val = encoder_prepend_uint_value(encoder, signature->timestamp);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_prepend_type_length(encoder, TLV_Timestamp,
+                                          encoder_probe_uint_length(signature->timestamp));
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+
+  // signature nonce
+  if (signature->enable_SignatureNonce > 0) {
+    ret_val = encoder_prepend_uint32_value(encoder, signature->signature_nonce);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_prepend_type_length(encoder, TLV_Nonce, 4);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+
+  // key locator
+  if (signature->enable_KeyLocator) {
+    block_end = prepend_encoder_size(encoder);
+    ret_val = ndn_name_tlv_prepend(encoder, &signature->key_locator_name);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_prepend_type_length(encoder, TLV_KeyLocator,
+                                          prepend_encoder_size(encoder) - block_end);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+
+  // signature type
+  ret_val = encoder_prepend_uint_value(encoder, signature->sig_type);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  ret_val = encoder_prepend_type_length(encoder, TLV_SignatureType, 1);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+
+  // signatureinfo header
+  return encoder_prepend_type_length(encoder,
+                                     signature->is_interest ? TLV_InterestSignatureInfo : TLV_SignatureInfo,
+                                     prepend_encoder_size(encoder) - info_end);
+}
+
+int
+ndn_signature_value_tlv_prepend(ndn_prepend_encoder_t* encoder, const ndn_signature_t* signature)
+{
+  int ret_val = -1;
+  ret_val = encoder_prepend_raw_buffer_value(encoder, signature->sig_value, signature->sig_size);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  return encoder_prepend_type_length(encoder,
+                                     signature->is_interest ? TLV_InterestSignatureValue : TLV_SignatureValue,
+                                     signature->sig_size);
+}
+
 int
 ndn_signature_info_tlv_decode(ndn_decoder_t* decoder, ndn_signature_t* signature)
 {
@@ -294,6 +294,24 @@ ndn_signature_info_tlv_encode(ndn_encoder_t* encoder, const ndn_signature_t* sig
 int
 ndn_signature_value_tlv_encode(ndn_encoder_t* encoder, const ndn_signature_t* signature);
 
+/**
+ * Prepend the Signature info as wire format (TLV block) from Signature structure.
+ * @param encoder. Output. The prepend encoder who keeps the encoding result and the state.
+ * @param signature. Input. The Signature structure whose signature info to be encoded.
+ * @return 0 if there is no error.
+ */
+int
+ndn_signature_info_tlv_prepend(ndn_prepend_encoder_t* encoder, const ndn_signature_t* signature);
+
+/**
+ * Prepend the Signature value as wire format (TLV block) from Signature structure.
+ * @param encoder. Output. The prepend encoder who keeps the encoding result and the state.
+ * @param signature. Input. The Signature structure whose signature value to be encoded.
+ * @return 0 if there is no error.
+ */
+int
+ndn_signature_value_tlv_prepend(ndn_prepend_encoder_t* encoder, const ndn_signature_t* signature);
+
 /**
  * Decode an Signature info TLV block into an Signature structure. This function will do memory copy.
  * @param decoder. Input. The decoder who keeps the decoding result and the state.
@@ -106,9 +106,9 @@ ndn_signed_interest_ecdsa_sign(ndn_interest_t* interest,
 
   // update signature value and append the ending name component
   // prepare temp buffer to calculate signature value and the ending name component
-  uint8_t be_signed[NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE] = {0};
+  uint8_t be_signed[NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE];
   ndn_encoder_t temp_encoder;
-  encoder_init(&temp_encoder, be_signed, NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE);
+  encoder_init_nozero(&temp_encoder, be_signed, NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE);
   // the signing input starts at Name's Value (V)
   for (size_t i = 0; i < interest->name.components_size; i++) {
     ret_val = name_component_tlv_encode(&temp_encoder, &interest->name.components[i]);
@@ -168,9 +168,9 @@ ndn_signed_interest_hmac_sign(ndn_interest_t* interest,
 
   // update signature value and append the ending name component
   // prepare temp buffer to calculate signature value and the ending name component
-  uint8_t be_signed[NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE] = {0};
+  uint8_t be_signed[NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE];
   ndn_encoder_t temp_encoder;
-  encoder_init(&temp_encoder, be_signed, NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE);
+  encoder_init_nozero(&temp_encoder, be_signed, NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE);
   // the signing input starts at Name's Value (V)
   for (size_t i = 0; i < interest->name.components_size; i++) {
     ret_val = name_component_tlv_encode(&temp_encoder, &interest->name.components[i]);
@@ -232,9 +232,9 @@ ndn_signed_interest_digest_sign(ndn_interest_t* interest)
   // set timestamp
   ndn_signature_set_timestamp(&interest->signature, 0);
 
-  uint8_t be_signed[NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE] = {0};
+  uint8_t be_signed[NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE];
   ndn_encoder_t temp_encoder;
-  encoder_init(&temp_encoder, be_signed, NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE);
+  encoder_init_nozero(&temp_encoder, be_signed, NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE);
   // the signing input starts at Name's Value (V)
   for (size_t i = 0; i < interest->name.components_size; i++) {
     ret_val = name_component_tlv_encode(&temp_encoder, &interest->name.components[i]);
@@ -290,9 +290,9 @@ ndn_signed_interest_ecdsa_verify(const ndn_interest_t* interest, const ndn_ecc_p
     return NDN_UNSUPPORTED_FORMAT;
   }
   int ret_val = -1;
-  uint8_t be_signed[NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE] = {0};
+  uint8_t be_signed[NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE];
   ndn_encoder_t temp_encoder;
-  encoder_init(&temp_encoder, be_signed, NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE);
+  encoder_init_nozero(&temp_encoder, be_signed, NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE);
 
   // the signing input starts at Name's Value (V) excluding the ending component
   for (uint8_t i = 0; i < interest->name.components_size - 1; i++) {
@@ -339,9 +339,9 @@ ndn_signed_interest_hmac_verify(const ndn_interest_t* interest, const ndn_hmac_k
     return NDN_UNSUPPORTED_FORMAT;
   }
   int ret_val = -1;
-  uint8_t be_signed[NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE] = {0};
+  uint8_t be_signed[NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE];
   ndn_encoder_t temp_encoder;
-  encoder_init(&temp_encoder, be_signed, NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE);
+  encoder_init_nozero(&temp_encoder, be_signed, NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE);
 
   // the signing input starts at Name's Value (V)
   for (uint8_t i = 0; i < interest->name.components_size - 1; i++) {
@@ -387,9 +387,9 @@ ndn_signed_interest_digest_verify(const ndn_interest_t* interest)
     return NDN_UNSUPPORTED_FORMAT;
   }
   int ret_val = -1;
-  uint8_t be_signed[NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE] = {0};
+  uint8_t be_signed[NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE];
   ndn_encoder_t temp_encoder;
-  encoder_init(&temp_encoder, be_signed, NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE);
+  encoder_init_nozero(&temp_encoder, be_signed, NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE);
 
   // the signing input starts at Name's Value (V)
   for (uint8_t i = 0; i < interest->name.components_size - 1; i++) {
@@ -193,7 +193,7 @@ tlv_make_data(uint8_t* buf, size_t buflen, size_t* result_size, int argc, ...)
   }
 
   // Encode
-  encoder_init(&encoder, buf, buflen);
+  encoder_init_nozero(&encoder, buf, buflen);
   switch (data.signature.sig_type) {
     case NDN_SIG_TYPE_DIGEST_SHA256:
       ret = ndn_data_tlv_encode_digest_sign(&encoder, &data);
@@ -602,7 +602,7 @@ tlv_make_interest(uint8_t* buf, size_t buflen, size_t* result_size, int argc, ..
   }
 
   // Encode
-  encoder_init(&encoder, buf, buflen);
+  encoder_init_nozero(&encoder, buf, buflen);
   if (ndn_interest_is_signed(&interest)) {
     switch(interest.signature.sig_type) {
       case NDN_SIG_TYPE_DIGEST_SHA256:
@@ -23,6 +23,8 @@ extern "C" {
  * @param[in] interest_size The length of the @c interest .
  * @param[in] userdata [Optional] User defined data.
  * @return The forward strategy to take, only used if no Data get from this function.
+ *         Forwarded Interests go out by the strategy of the prefix.
+ * @sa ndn_forwarder_set_strategy
  */
 typedef int (*ndn_on_interest_func)(const uint8_t* interest,
                                     uint32_t interest_size,
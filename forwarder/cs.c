@@ -11,107 +11,461 @@
 #define ENABLE_NDN_LOG_DEBUG 0
 #define ENABLE_NDN_LOG_ERROR 1
 #include "cs.h"
-#include "../encode/data.h"
+#include "../ndn-error-code.h"
 #include "../util/logger.h"
+#include <string.h>
+
+#define NDN_CS_HEAP(self) ((ndn_table_id_t*)&(self)->slots[(self)->capacity])
+
+#define NDN_CS_NO_BLOCK ((uint32_t)-1)
+#define NDN_CS_BLOCK_FREE 0x80
+#define NDN_CS_BLOCK_ORDER_MASK 0x7F
+
+/** Links of a free block, stored in the block itself.
+ */
+typedef struct ndn_cs_free_block {
+  uint32_t prev;
+  uint32_t next;
+} ndn_cs_free_block_t;
+
+static inline ndn_cs_free_block_t*
+ndn_cs_block_links(ndn_cs_t* self, uint32_t block){
+  return (ndn_cs_free_block_t*)&self->arena[(size_t)block * NDN_CS_BLOCK_SIZE];
+}
+
+static void
+ndn_cs_block_push(ndn_cs_t* self, uint32_t block, uint8_t order){
+  ndn_cs_free_block_t* links = ndn_cs_block_links(self, block);
+  links->prev = NDN_CS_NO_BLOCK;
+  links->next = self->free_blocks[order];
+  if(links->next != NDN_CS_NO_BLOCK){
+    ndn_cs_block_links(self, links->next)->prev = block;
+  }
+  self->free_blocks[order] = block;
+  self->block_state[block] = NDN_CS_BLOCK_FREE | order;
+}
+
+static void
+ndn_cs_block_unlink(ndn_cs_t* self, uint32_t block, uint8_t order){
+  ndn_cs_free_block_t* links = ndn_cs_block_links(self, block);
+  if(links->prev != NDN_CS_NO_BLOCK){
+    ndn_cs_block_links(self, links->prev)->next = links->next;
+  }else{
+    self->free_blocks[order] = links->next;
+  }
+  if(links->next != NDN_CS_NO_BLOCK){
+    ndn_cs_block_links(self, links->next)->prev = links->prev;
+  }
+  self->block_state[block] = order;
+}
+
+static uint32_t
+ndn_cs_block_alloc(ndn_cs_t* self, size_t length){
+  uint8_t order = 0, found;
+  uint32_t block;
+
+  while(((size_t)NDN_CS_BLOCK_SIZE << order) < length){
+    order ++;
+    if(order >= NDN_CS_BLOCK_ORDERS){
+      return NDN_CS_NO_BLOCK;
+    }
+  }
+  for(found = order; found < NDN_CS_BLOCK_ORDERS; found ++){
+    if(self->free_blocks[found] != NDN_CS_NO_BLOCK){
+      break;
+    }
+  }
+  if(found >= NDN_CS_BLOCK_ORDERS){
+    return NDN_CS_NO_BLOCK;
+  }
+  block = self->free_blocks[found];
+  ndn_cs_block_unlink(self, block, found);
+  // Split and give back the upper halves
+  while(found > order){
+    found --;
+    ndn_cs_block_push(self, block + ((uint32_t)1 << found), found);
+  }
+  self->block_state[block] = order;
+  self->used_bytes += (size_t)NDN_CS_BLOCK_SIZE << order;
+  return block;
+}
+
+static void
+ndn_cs_block_free(ndn_cs_t* self, uint32_t block){
+  uint8_t order = self->block_state[block] & NDN_CS_BLOCK_ORDER_MASK;
+  uint32_t buddy;
+
+  self->used_bytes -= (size_t)NDN_CS_BLOCK_SIZE << order;
+  // Merge with free buddies
+  while(order + 1 < NDN_CS_BLOCK_ORDERS){
+    buddy = block ^ ((uint32_t)1 << order);
+    if(buddy >= self->block_count || self->block_state[buddy] != (NDN_CS_BLOCK_FREE | order)){
+      break;
+    }
+    ndn_cs_block_unlink(self, buddy, order);
+    if(buddy < block){
+      block = buddy;
+    }
+    order ++;
+  }
+  ndn_cs_block_push(self, block, order);
+}
+
+static inline ndn_time_ms_t
+ndn_cs_heap_key(ndn_cs_t* self, size_t pos){
+  return self->slots[NDN_CS_HEAP(self)[pos]].fresh_until;
+}
+
+static void
+ndn_cs_heap_swap(ndn_cs_t* self, size_t a, size_t b){
+  ndn_table_id_t* heap = NDN_CS_HEAP(self);
+  ndn_table_id_t tmp = heap[a];
+  heap[a] = heap[b];
+  heap[b] = tmp;
+  self->slots[heap[a]].heap_index = (ndn_table_id_t)a;
+  self->slots[heap[b]].heap_index = (ndn_table_id_t)b;
+}
+
+static void
+ndn_cs_heap_sift(ndn_cs_t* self, size_t pos){
+  size_t parent, child;
+
+  while(pos > 0){
+    parent = (pos - 1) / 2;
+    if(ndn_cs_heap_key(self, parent) <= ndn_cs_heap_key(self, pos)){
+      break;
+    }
+    ndn_cs_heap_swap(self, parent, pos);
+    pos = parent;
+  }
+  for(;;){
+    child = pos * 2 + 1;
+    if(child >= self->heap_size){
+      break;
+    }
+    if(child + 1 < self->heap_size &&
+       ndn_cs_heap_key(self, child + 1) < ndn_cs_heap_key(self, child)){
+      child ++;
+    }
+    if(ndn_cs_heap_key(self, pos) <= ndn_cs_heap_key(self, child)){
+      break;
+    }
+    ndn_cs_heap_swap(self, pos, child);
+    pos = child;
+  }
+}
+
+static void
+ndn_cs_lru_unlink(ndn_cs_t* self, ndn_cs_entry_t* entry){
+  if(entry->lru_prev != NDN_INVALID_ID){
+    self->slots[entry->lru_prev].lru_next = entry->lru_next;
+  }else{
+    self->lru_head = entry->lru_next;
+  }
+  if(entry->lru_next != NDN_INVALID_ID){
+    self->slots[entry->lru_next].lru_prev = entry->lru_prev;
+  }else{
+    self->lru_tail = entry->lru_prev;
+  }
+  entry->lru_prev = entry->lru_next = NDN_INVALID_ID;
+}
+
+static void
+ndn_cs_lru_append(ndn_cs_t* self, ndn_cs_entry_t* entry){
+  ndn_table_id_t id = (ndn_table_id_t)(entry - self->slots);
+  entry->lru_prev = self->lru_tail;
+  entry->lru_next = NDN_INVALID_ID;
+  if(self->lru_tail != NDN_INVALID_ID){
+    self->slots[self->lru_tail].lru_next = id;
+  }else{
+    self->lru_head = id;
+  }
+  self->lru_tail = id;
+}
+
+/** Release the content of an entry, detaching it from the LRU list and the heap.
+ */
+static void
+ndn_cs_release_content(ndn_cs_t* self, ndn_cs_entry_t* entry){
+  size_t pos = entry->heap_index;
+  if(entry->content == NULL){
+    return;
+  }
+  if(entry->buf != NULL){
+    ndn_pktbuf_release(entry->buf);
+    entry->buf = NULL;
+  }else{
+    ndn_cs_block_free(self, (uint32_t)((entry->content - self->arena) / NDN_CS_BLOCK_SIZE));
+  }
+  entry->content = NULL;
+  entry->content_len = 0;
+  ndn_cs_lru_unlink(self, entry);
+  self->heap_size --;
+  if(pos != self->heap_size){
+    ndn_cs_heap_swap(self, pos, self->heap_size);
+    ndn_cs_heap_sift(self, pos);
+  }
+  entry->heap_index = NDN_INVALID_ID;
+}
 
 static inline void
 ndn_cs_entry_reset(ndn_cs_entry_t* self){
   self->nametree_id = NDN_INVALID_ID;
+  self->lru_prev = NDN_INVALID_ID;
+  self->lru_next = NDN_INVALID_ID;
+  self->heap_index = NDN_INVALID_ID;
   self->last_time = 0;
   self->express_time = 0;
   self->on_data = NULL;
   self->userdata = NULL;
   self->content = NULL;
+  self->buf = NULL;
   self->content_len = 0;
   self->fresh_until = 0;
   // Don't reset options.nonce here
 }
 
 void
-ndn_cs_init(void* memory, ndn_table_id_t capacity, ndn_nametree_t* nametree){
+ndn_cs_init(void* memory, ndn_table_id_t capacity, size_t byte_count, ndn_nametree_t* nametree){
   ndn_table_id_t i;
+  uint32_t block;
+  uint8_t order;
+  uintptr_t arena;
   ndn_cs_t* self = (ndn_cs_t*)memory;
   self->capacity = capacity;
   self->nametree = nametree;
+  self->count = 0;
+  self->free_head = (capacity > 0) ? 0 : NDN_INVALID_ID;
+  self->lru_head = self->lru_tail = NDN_INVALID_ID;
+  self->heap_size = 0;
+  memset(&self->stats, 0, sizeof(self->stats));
   for(i = 0; i < capacity; i++){
     ndn_cs_entry_reset(&self->slots[i]);
     self->slots[i].options.nonce = 0;
+    self->slots[i].next_free = (i + 1 < capacity) ? i + 1 : NDN_INVALID_ID;
+  }
+
+  self->block_count = (uint32_t)(byte_count / NDN_CS_BLOCK_SIZE);
+  self->block_state = (uint8_t*)&NDN_CS_HEAP(self)[capacity];
+  arena = (uintptr_t)&self->block_state[self->block_count];
+  arena = (arena + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+  self->arena = (uint8_t*)arena;
+  self->used_bytes = 0;
+  for(order = 0; order < NDN_CS_BLOCK_ORDERS; order ++){
+    self->free_blocks[order] = NDN_CS_NO_BLOCK;
+  }
+  // Carve the arena into the largest aligned blocks
+  for(block = 0; block < self->block_count; block += (uint32_t)1 << order){
+    order = NDN_CS_BLOCK_ORDERS - 1;
+    while((block & (((uint32_t)1 << order) - 1)) != 0 ||
+          block + ((uint32_t)1 << order) > self->block_count){
+      order --;
+    }
+    ndn_cs_block_push(self, block, order);
   }
 }
 
 void
 ndn_cs_remove_entry(ndn_cs_t* self, ndn_cs_entry_t* entry){
-  ndn_nametree_at(self->nametree, entry->nametree_id)->cs_id = NDN_INVALID_ID;
+  if(entry->nametree_id == NDN_INVALID_ID){
+    return;
+  }
+  ndn_cs_release_content(self, entry);
+  nametree_entry_t* node = ndn_nametree_at(self->nametree, entry->nametree_id);
+  node->cs_id = NDN_INVALID_ID;
+  ndn_nametree_release(self->nametree, node);
   ndn_cs_entry_reset(entry);
+  entry->next_free = self->free_head;
+  self->free_head = (ndn_table_id_t)(entry - self->slots);
+  self->count --;
 }
 
-static ndn_table_id_t
-ndn_cs_add_new_entry(ndn_cs_t* cs , int nametree_id){
+void
+ndn_cs_remove_all_entries(ndn_cs_t* self){
   ndn_table_id_t i;
-  for (i = 0; i < cs->capacity; ++i) {
-    if (cs->slots[i].nametree_id == NDN_INVALID_ID) {
-      ndn_cs_entry_reset(&cs->slots[i]);
-      cs->slots[i].nametree_id = nametree_id;
-      return i;
+  for(i = 0; i < self->capacity; i++){
+    ndn_cs_remove_entry(self, &self->slots[i]);
+  }
+}
+
+/** Evict one entry with content: a stale one if any, otherwise the least recently used.
+ * @return false if there is nothing to evict.
+ */
+static bool
+ndn_cs_evict(ndn_cs_t* self){
+  ndn_cs_entry_t* victim;
+  if(self->heap_size == 0){
+    return false;
+  }
+  victim = &self->slots[NDN_CS_HEAP(self)[0]];
+  if(ndn_cs_entry_is_fresh(victim, ndn_time_now_ms())){
+    victim = &self->slots[self->lru_head];
+  }
+  NDN_LOG_DEBUG("[CS] Evict an entry\n");
+  self->stats.evictions ++;
+  ndn_cs_remove_entry(self, victim);
+  return true;
+}
+
+static ndn_table_id_t
+ndn_cs_add_new_entry(ndn_cs_t* cs , ndn_table_id_t nametree_id){
+  ndn_table_id_t i = cs->free_head;
+  if (i == NDN_INVALID_ID) {
+    if (!ndn_cs_evict(cs)) {
+      return NDN_INVALID_ID;
     }
+    i = cs->free_head;
   }
-  return NDN_INVALID_ID;
+  cs->free_head = cs->slots[i].next_free;
+  cs->count ++;
+  cs->stats.insertions ++;
+  ndn_cs_entry_reset(&cs->slots[i]);
+  cs->slots[i].nametree_id = nametree_id;
+  cs->slots[i].next_free = NDN_INVALID_ID;
+  return i;
 }
 
 ndn_cs_entry_t*
-ndn_cs_find_or_insert(ndn_cs_t* self, uint8_t* name, size_t length){
-  nametree_entry_t* entry = ndn_nametree_find_or_insert(self->nametree, name, length);
-  if(entry == NULL){
+ndn_cs_node_entry(ndn_cs_t* self, nametree_entry_t* node){
+  if(node == NULL || node->cs_id == NDN_INVALID_ID){
+    return NULL;
+  }
+  return &self->slots[node->cs_id];
+}
+
+ndn_cs_entry_t*
+ndn_cs_node_insert(ndn_cs_t* self, nametree_entry_t* node){
+  if(node == NULL){
     return NULL;
   }
-  if(entry->cs_id == NDN_INVALID_ID){
-    entry->cs_id = ndn_cs_add_new_entry(self, ndn_nametree_getid(self->nametree, entry));
+  if(node->cs_id == NDN_INVALID_ID){
+    node->cs_id = ndn_cs_add_new_entry(self, ndn_nametree_getid(self->nametree, node));
     NDN_LOG_DEBUG("[CS] Add a new CS entry\n");
-    if(entry->cs_id == NDN_INVALID_ID){
+    if(node->cs_id == NDN_INVALID_ID){
+      ndn_nametree_release(self->nametree, node);
       return NULL;
     }
   }
-  return &self->slots[entry->cs_id];
+  return &self->slots[node->cs_id];
+}
+
+ndn_cs_entry_t*
+ndn_cs_find_or_insert(ndn_cs_t* self, uint8_t* name, size_t length){
+  return ndn_cs_node_insert(self, ndn_nametree_find_or_insert(self->nametree, name, length));
 }
 
 ndn_cs_entry_t*
 ndn_cs_find(ndn_cs_t* self, uint8_t* prefix, size_t length)
 {
-  nametree_entry_t* entry = ndn_nametree_find(self->nametree, prefix, length);
-  if (entry == NULL || entry->cs_id == NDN_INVALID_ID) {
-    return NULL;
-  }
-  return &self->slots[entry->cs_id];
+  return ndn_cs_node_entry(self, ndn_nametree_find(self->nametree, prefix, length));
 }
 
 ndn_cs_entry_t*
 ndn_cs_prefix_match(ndn_cs_t* self, uint8_t* prefix, size_t length)
 {
-  nametree_entry_t* entry = ndn_nametree_prefix_match(self->nametree, prefix, length, NDN_NAMETREE_CS_TYPE);
-  if (entry == NULL || entry->cs_id == NDN_INVALID_ID) {
-    return NULL;
-  }
-  return &self->slots[entry->cs_id];
+  return ndn_cs_node_entry(self, ndn_nametree_prefix_match(self->nametree, prefix, length, NDN_NAMETREE_CS_TYPE));
 }
 
 void
-ndn_insert_cs_entry_with_content(ndn_cs_entry_t* cs_entry, uint8_t* data, size_t length){
-  ndn_data_t ndn_data_content;
+ndn_cs_touch(ndn_cs_t* self, ndn_cs_entry_t* entry){
+  if(entry->content == NULL || entry->lru_next == NDN_INVALID_ID){
+    return;
+  }
+  ndn_cs_lru_unlink(self, entry);
+  ndn_cs_lru_append(self, entry);
+}
+
+/** Drop an entry whose Data cannot be cached.
+ */
+static int
+ndn_cs_reject(ndn_cs_t* self, ndn_cs_entry_t* entry, int ret){
+  self->stats.rejections ++;
+  ndn_cs_remove_entry(self, entry);
+  return ret;
+}
 
-  // decode the data to extract the freshnessPeriod of the data
-  uint32_t be_signed_start, be_signed_end;
-  ndn_data_tlv_decode_no_verify(&ndn_data_content, data, length, &be_signed_start, &be_signed_end);
+/** Store a Data packet into an entry, sharing @c buf if set and copying the packet otherwise.
+ */
+static int
+ndn_cs_store(ndn_cs_t* self, ndn_cs_entry_t* entry, ndn_data_view_t* view, ndn_pktbuf_t* buf){
+  uint8_t* data = view->block;
+  size_t length = view->block_size;
+  data_metainfo_options_t metainfo;
+  uint32_t block;
+  int ret;
+
+  // The Data is already cached here
+  if(data == entry->content && length == entry->content_len){
+    ndn_cs_touch(self, entry);
+    return NDN_SUCCESS;
+  }
 
-  // create new CS entry with content
-  free(cs_entry->content);
-  cs_entry->content = NULL;
-  cs_entry->content = malloc(length);
-  memcpy(cs_entry->content, data, length);
-  cs_entry->content_len = length;
+  ret = ndn_data_view_metainfo(view, &metainfo);
+  if(ret != NDN_SUCCESS){
+    return ndn_cs_reject(self, entry, ret);
+  }
+
+  ndn_cs_release_content(self, entry);
+  if(buf != NULL){
+    entry->buf = ndn_pktbuf_retain(buf);
+    entry->content = data;
+  }else{
+    block = ndn_cs_block_alloc(self, length);
+    while(block == NDN_CS_NO_BLOCK && ndn_cs_evict(self)){
+      block = ndn_cs_block_alloc(self, length);
+    }
+    if(block == NDN_CS_NO_BLOCK){
+      NDN_LOG_ERROR("[CS] Data of %u bytes does not fit\n", (unsigned)length);
+      return ndn_cs_reject(self, entry, NDN_OVERSIZE);
+    }
+    entry->content = &self->arena[(size_t)block * NDN_CS_BLOCK_SIZE];
+    memcpy(entry->content, data, length);
+  }
+  entry->content_len = length;
 
   // set the timestamps and freshnessPeriod for the cs_entry
   ndn_time_ms_t now = ndn_time_now_ms();
-  cs_entry->last_time = now;
-  cs_entry->fresh_until = ndn_data_content.metainfo.freshness_period + now;
-  return;
+  entry->last_time = now;
+  entry->fresh_until = metainfo.freshness_period + now;
+
+  ndn_cs_lru_append(self, entry);
+  NDN_CS_HEAP(self)[self->heap_size] = (ndn_table_id_t)(entry - self->slots);
+  entry->heap_index = self->heap_size;
+  self->heap_size ++;
+  ndn_cs_heap_sift(self, entry->heap_index);
+  self->stats.stores ++;
+  return NDN_SUCCESS;
+}
+
+int
+ndn_cs_set_content(ndn_cs_t* self, ndn_cs_entry_t* entry, uint8_t* data, size_t length){
+  ndn_data_view_t view;
+  int ret;
+
+  ret = ndn_data_view_init(&view, data, length);
+  if(ret != NDN_SUCCESS){
+    return ndn_cs_reject(self, entry, ret);
+  }
+  return ndn_cs_store(self, entry, &view, NULL);
+}
+
+int
+ndn_cs_set_content_buf(ndn_cs_t* self, ndn_cs_entry_t* entry, ndn_pktbuf_t* buf){
+  ndn_data_view_t view;
+  int ret;
+
+  ret = ndn_data_view_init(&view, buf->data, buf->length);
+  if(ret != NDN_SUCCESS){
+    return ndn_cs_reject(self, entry, ret);
+  }
+  return ndn_cs_set_content_view(self, entry, &view, buf);
+}
+
+int
+ndn_cs_set_content_view(ndn_cs_t* self, ndn_cs_entry_t* entry, ndn_data_view_t* view, ndn_pktbuf_t* buf){
+  // Leave the receive reserve of the pool to faces
+  if(buf != NULL && buf->pool->free_count <= buf->pool->reserve){
+    buf = NULL;
+  }
+  return ndn_cs_store(self, entry, view, buf);
 }
@@ -11,6 +11,7 @@
 #ifndef FORWARDER_CS_H_
 #define FORWARDER_CS_H_
 #include "../encode/forwarder-helper.h"
+#include "../encode/packet-view.h"
 #include "../util/bit-operations.h"
 #include "face.h"
 #include "name-tree.h"
@@ -53,14 +54,20 @@ typedef struct ndn_cs_entry {
   void* userdata;
 
   /** Content of this entry.
+   * Points into the block arena of the CS, or into @c buf if it is set.
+   * NULL if there is no content.
    */
   uint8_t* content;
 
+  /** Packet buffer holding the content, or NULL if it is in the arena.
+   */
+  ndn_pktbuf_t* buf;
+
   /** Size of content
    */
   size_t content_len;
 
-  /** Relative time until this entry is fresh
+  /** Absolute time, as ndn_time_now_ms(), until which this entry is fresh.
    */
   ndn_time_ms_t fresh_until;
 
@@ -68,26 +75,137 @@ typedef struct ndn_cs_entry {
    * #NDN_INVALID_ID if the entry is empty.
    */
   ndn_table_id_t nametree_id;
+
+  /** Next empty slot if this entry is empty.
+   * Empty slots are linked as a free list starting from @c free_head.
+   */
+  ndn_table_id_t next_free;
+
+  /** Less recently used neighbour in the LRU list.
+   */
+  ndn_table_id_t lru_prev;
+
+  /** More recently used neighbour in the LRU list.
+   */
+  ndn_table_id_t lru_next;
+
+  /** Position in the freshness heap.
+   * #NDN_INVALID_ID if the entry has no content.
+   */
+  ndn_table_id_t heap_index;
 } ndn_cs_entry_t;
 
+/** Size of the smallest content block in bytes.
+ */
+#define NDN_CS_BLOCK_SIZE 64
+
+/** Number of block sizes. The largest block is
+ * <tt>NDN_CS_BLOCK_SIZE << (NDN_CS_BLOCK_ORDERS - 1)</tt> bytes.
+ */
+#define NDN_CS_BLOCK_ORDERS 16
+
+/**
+ * CS counters. Only the owner of the CS writes them.
+ */
+typedef struct ndn_cs_stats {
+  /** Entries created. */
+  uint64_t insertions;
+  /** Data stored into entries. */
+  uint64_t stores;
+  /** Entries evicted to make room. */
+  uint64_t evictions;
+  /** Data not stored because it is malformed or does not fit. */
+  uint64_t rejections;
+} ndn_cs_stats_t;
+
 /**
 * Content Store (CS).
+*
+* Data is copied into a preallocated arena managed as buddy blocks, so the CS
+* is bounded by bytes as well as by entry count. Entries holding content are
+* linked in LRU order and kept in a min-heap on @c fresh_until, stored right
+* after @c slots, so that eviction picks a stale entry first without a walk.
 */
 typedef struct ndn_cs{
   ndn_nametree_t* nametree;
+
+  /** Content blocks, #NDN_CS_BLOCK_SIZE bytes each.
+   */
+  uint8_t* arena;
+
+  /** Per-block order and free flag, valid at the start of each buddy block.
+   */
+  uint8_t* block_state;
+
+  /** Number of blocks in @c arena.
+   */
+  uint32_t block_count;
+
+  /** Bytes of blocks currently allocated.
+   */
+  size_t used_bytes;
+
+  /** First free block of each order.
+   */
+  uint32_t free_blocks[NDN_CS_BLOCK_ORDERS];
+
   ndn_table_id_t capacity;
+  /** Number of occupied slots. */
+  ndn_table_id_t count;
+  /** First empty slot. #NDN_INVALID_ID if the table is full. */
+  ndn_table_id_t free_head;
+  /** Least recently used entry with content. */
+  ndn_table_id_t lru_head;
+  /** Most recently used entry with content. */
+  ndn_table_id_t lru_tail;
+  /** Number of entries in the freshness heap. */
+  ndn_table_id_t heap_size;
+  ndn_cs_stats_t stats;
   ndn_cs_entry_t slots[];
 }ndn_cs_t;
 
-#define NDN_CS_RESERVE_SIZE(entry_count) \
-  (sizeof(ndn_cs_t) + sizeof(ndn_cs_entry_t) * (entry_count))
+/** The memory reserved for CS.
+ * @param[in] entry_count Maximum number of entries.
+ * @param[in] byte_count Maximum bytes of Data to keep.
+ */
+#define NDN_CS_RESERVE_SIZE(entry_count, byte_count) \
+  (sizeof(ndn_cs_t) + (sizeof(ndn_cs_entry_t) + sizeof(ndn_table_id_t)) * (entry_count) + \
+   ((byte_count) / NDN_CS_BLOCK_SIZE) * (NDN_CS_BLOCK_SIZE + 1) + sizeof(uint64_t) - 1)
 
+/** Initialize CS at specified memory space.
+ * @param[in, out] memory Memory reserved for CS, see #NDN_CS_RESERVE_SIZE.
+ * @param[in] capacity Maximum number of entries.
+ * @param[in] byte_count Maximum bytes of Data to keep.
+ * @param[in] nametree The NameTree.
+ */
 void
-ndn_cs_init(void* memory, ndn_table_id_t capacity, ndn_nametree_t* nametree);
+ndn_cs_init(void* memory, ndn_table_id_t capacity, size_t byte_count, ndn_nametree_t* nametree);
 
+/** Remove an entry and release its content.
+ */
 void
 ndn_cs_remove_entry(ndn_cs_t* self, ndn_cs_entry_t* entry);
 
+/** Remove all entries.
+ */
+void
+ndn_cs_remove_all_entries(ndn_cs_t* self);
+
+/** Get the CS entry attached to a NameTree node.
+ * @return NULL if @c node is NULL or has no CS entry.
+ */
+ndn_cs_entry_t*
+ndn_cs_node_entry(ndn_cs_t* self, nametree_entry_t* node);
+
+/** Get or create the CS entry attached to a NameTree node.
+ * @return NULL if @c node is NULL or the CS is full.
+ */
+ndn_cs_entry_t*
+ndn_cs_node_insert(ndn_cs_t* self, nametree_entry_t* node);
+
+/** Find or create an entry.
+ * If the CS is full, a stale entry, or else the least recently used one, is evicted.
+ */
 ndn_cs_entry_t*
 ndn_cs_find_or_insert(ndn_cs_t* self, uint8_t* name, size_t length);
 
@@ -97,8 +215,58 @@ ndn_cs_find(ndn_cs_t* self, uint8_t* prefix, size_t length);
 ndn_cs_entry_t*
 ndn_cs_prefix_match(ndn_cs_t* self, uint8_t* prefix, size_t length);
 
+/** Mark an entry as most recently used.
+ */
 void
-ndn_insert_cs_entry_with_content(ndn_cs_entry_t* cs_entry, uint8_t* data, size_t length);
+ndn_cs_touch(ndn_cs_t* self, ndn_cs_entry_t* entry);
+
+/** Return whether an entry is still fresh.
+ * @param[in] entry The CS entry.
+ * @param[in] now Current time.
+ */
+static inline bool
+ndn_cs_entry_is_fresh(const ndn_cs_entry_t* entry, ndn_time_ms_t now){
+  return entry->fresh_until > now;
+}
+
+/** Copy a Data packet into an entry, evicting other entries if space is needed.
+ * @param[in, out] self The CS.
+ * @param[in, out] entry The entry to hold @c data. Its previous content is released.
+ * @param[in] data Wire format of the Data packet.
+ * @param[in] length Length of @c data.
+ * @return #NDN_SUCCESS if the call succeeded. Otherwise @c entry is removed.
+ * @retval #NDN_OVERSIZE @c data does not fit into the CS.
+ * @retval Others @c data is malformed, see ndn_data_view_metainfo().
+ */
+int
+ndn_cs_set_content(ndn_cs_t* self, ndn_cs_entry_t* entry, uint8_t* data, size_t length);
+
+/** Cache a Data packet held in a packet buffer.
+ *
+ * The entry keeps a reference of @c buf instead of a copy, unless that would leave
+ * its pool with no more than ndn_pktbuf_pool#reserve free buffers. Then the packet
+ * is copied like ndn_cs_set_content().
+ * @param[in, out] self The CS.
+ * @param[in, out] entry The entry to hold the packet. Its previous content is released.
+ * @param[in] buf The Data packet. The caller keeps its reference.
+ * @return Same as ndn_cs_set_content().
+ */
+int
+ndn_cs_set_content_buf(ndn_cs_t* self, ndn_cs_entry_t* entry, ndn_pktbuf_t* buf);
+
+/** Cache a Data packet already decoded in place.
+ *
+ * The MetaInfo is taken from @c view, so the packet is not parsed again.
+ * @param[in, out] self The CS.
+ * @param[in, out] entry The entry to hold the packet. Its previous content is released.
+ * @param[in, out] view The view of the Data packet.
+ * @param[in] buf The packet buffer holding the packet, shared as by ndn_cs_set_content_buf().
+ *            @c NULL to copy the packet.
+ * @return Same as ndn_cs_set_content().
+ */
+int
+ndn_cs_set_content_view(ndn_cs_t* self, ndn_cs_entry_t* entry, ndn_data_view_t* view,
+                        ndn_pktbuf_t* buf);
 
 /*@}*/
 
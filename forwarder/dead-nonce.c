@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include "dead-nonce.h"
+#include "../encode/name-hash.h"
+#include <string.h>
+
+#define NDN_DNL_PERIOD (NDN_DNL_LIFETIME / NDN_DNL_GENERATIONS)
+
+void
+ndn_dnl_init(void* memory, uint32_t bucket_count)
+{
+  ndn_dnl_t* self = (ndn_dnl_t*)memory;
+
+  self->bucket_count = bucket_count;
+  self->count = 0;
+  self->generation = 0;
+  self->next_generation = 0;
+  memset(&self->stats, 0, sizeof(self->stats));
+  memset(self->slots, 0, sizeof(ndn_dnl_slot_t) * NDN_DNL_BUCKET_SIZE * bucket_count);
+}
+
+uint64_t
+ndn_dnl_hash(const uint8_t* name, size_t length, uint32_t nonce)
+{
+  return ndn_dnl_hash_name(ndn_name_hash_extend(ndn_name_hash_seed(), name, length), nonce);
+}
+
+uint64_t
+ndn_dnl_hash_name(uint64_t name_hash, uint32_t nonce)
+{
+  // The nonce continues the FNV-1a hash of the name, then the finalizer
+  // spreads it, since the fingerprint and the bucket are taken from different bits
+  uint64_t hash = name_hash;
+  size_t i;
+
+  for (i = 0; i < 4; i++) {
+    hash ^= (uint8_t)(nonce >> (8 * i));
+    hash *= 1099511628211ull;
+  }
+  return ndn_name_hash_mix(hash);
+}
+
+static inline uint16_t
+dnl_fingerprint(uint64_t hash)
+{
+  uint16_t fingerprint = (uint16_t)(hash >> 48);
+  return fingerprint != 0 ? fingerprint : 1;
+}
+
+// The other bucket of a fingerprint. Applying it twice gives back the first one,
+// which is what moving a pair needs, for any number of buckets.
+static inline uint32_t
+dnl_alt_bucket(const ndn_dnl_t* self, uint32_t bucket, uint16_t fingerprint)
+{
+  uint32_t offset = (uint32_t)(fingerprint * 0x5bd1e995u) % self->bucket_count;
+  return (offset + self->bucket_count - bucket) % self->bucket_count;
+}
+
+static inline ndn_dnl_slot_t*
+dnl_find_in(ndn_dnl_t* self, uint32_t bucket, uint16_t fingerprint)
+{
+  ndn_dnl_slot_t* slots = &self->slots[(size_t)bucket * NDN_DNL_BUCKET_SIZE];
+  int i;
+
+  for (i = 0; i < NDN_DNL_BUCKET_SIZE; i++) {
+    if (slots[i].fingerprint == fingerprint)
+      return &slots[i];
+  }
+  return NULL;
+}
+
+static inline ndn_dnl_slot_t*
+dnl_find_slot(ndn_dnl_t* self, uint64_t hash)
+{
+  uint16_t fingerprint = dnl_fingerprint(hash);
+  uint32_t bucket = (uint32_t)hash % self->bucket_count;
+  ndn_dnl_slot_t* slot = dnl_find_in(self, bucket, fingerprint);
+
+  if (slot == NULL)
+    slot = dnl_find_in(self, dnl_alt_bucket(self, bucket, fingerprint), fingerprint);
+  return slot;
+}
+
+void
+ndn_dnl_age(ndn_dnl_t* self, ndn_time_ms_t now)
+{
+  ndn_time_ms_t steps;
+  size_t i, n = (size_t)self->bucket_count * NDN_DNL_BUCKET_SIZE;
+
+  if (now < self->next_generation)
+    return;
+  steps = (now - self->next_generation) / NDN_DNL_PERIOD + 1;
+  self->next_generation += steps * NDN_DNL_PERIOD;
+  if (steps > NDN_DNL_GENERATIONS) {
+    // Every pair is older than the lifetime, e.g. on the first call
+    if (self->count > 0)
+      memset(self->slots, 0, sizeof(ndn_dnl_slot_t) * n);
+    self->count = 0;
+    self->next_generation = now + NDN_DNL_PERIOD;
+    return;
+  }
+  self->generation = (uint16_t)(self->generation + steps);
+  for (i = 0; i < n && self->count > 0; i++) {
+    if (self->slots[i].fingerprint != 0 &&
+        (uint16_t)(self->generation - self->slots[i].generation) > NDN_DNL_GENERATIONS) {
+      self->slots[i].fingerprint = 0;
+      self->count --;
+    }
+  }
+}
+
+bool
+ndn_dnl_find(ndn_dnl_t* self, uint64_t hash)
+{
+  self->stats.lookups ++;
+  if (dnl_find_slot(self, hash) == NULL)
+    return false;
+  self->stats.hits ++;
+  return true;
+}
+
+void
+ndn_dnl_insert(ndn_dnl_t* self, uint64_t hash)
+{
+  ndn_dnl_slot_t* slot = dnl_find_slot(self, hash);
+  ndn_dnl_slot_t victim, moved;
+  uint32_t bucket;
+  int kicks;
+
+  self->stats.insertions ++;
+  if (slot != NULL) {
+    slot->generation = self->generation;
+    return;
+  }
+
+  victim.fingerprint = dnl_fingerprint(hash);
+  victim.generation = self->generation;
+  bucket = (uint32_t)hash % self->bucket_count;
+  for (kicks = 0; kicks <= NDN_DNL_MAX_KICKS; kicks++) {
+    slot = dnl_find_in(self, bucket, 0);
+    if (slot == NULL)
+      slot = dnl_find_in(self, dnl_alt_bucket(self, bucket, victim.fingerprint), 0);
+    if (slot != NULL) {
+      *slot = victim;
+      self->count ++;
+      return;
+    }
+    // Both buckets are full: take the place of a pair and move it to its other bucket
+    slot = &self->slots[(size_t)bucket * NDN_DNL_BUCKET_SIZE +
+                        (victim.fingerprint + kicks) % NDN_DNL_BUCKET_SIZE];
+    moved = *slot;
+    *slot = victim;
+    victim = moved;
+    bucket = dnl_alt_bucket(self, bucket, victim.fingerprint);
+  }
+  // The last pair moved has no place left
+  self->stats.evictions ++;
+}
+
+uint32_t
+ndn_dnl_fp_rate(const ndn_dnl_t* self)
+{
+  // A lookup compares 2 * NDN_DNL_BUCKET_SIZE slots, each matching with
+  // probability 1 / 65535 if occupied
+  uint64_t slots = (uint64_t)self->bucket_count * NDN_DNL_BUCKET_SIZE;
+
+  if (slots == 0)
+    return 0;
+  return (uint32_t)((uint64_t)self->count * 2 * NDN_DNL_BUCKET_SIZE * 1000000 / (slots * 65535));
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef FORWARDER_DEAD_NONCE_H_
+#define FORWARDER_DEAD_NONCE_H_
+
+#include "../util/uniform-time.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdDNL Dead Nonce List
+ * @brief (Name, Nonce) pairs of recently seen Interests, used to detect loops.
+ * @ingroup NDNFwd
+ *
+ * A cuckoo filter of 16-bit fingerprints in fixed memory. Each pair hashes to
+ * two buckets of #NDN_DNL_BUCKET_SIZE slots and is kept in either of them.
+ * A pair is remembered for at least #NDN_DNL_LIFETIME ms, and dropped within
+ * another #NDN_DNL_LIFETIME / #NDN_DNL_GENERATIONS ms.
+ *
+ * Lookups may report a pair never inserted, with the rate returned by
+ * ndn_dnl_fp_rate(). When the filter is too full to place a pair, an older one
+ * is forgotten instead, so such a loop is no longer detected.
+ * @{
+ */
+
+/** Slots per bucket.
+ */
+#define NDN_DNL_BUCKET_SIZE 4
+
+/** Milliseconds a pair is remembered at least.
+ */
+#ifndef NDN_DNL_LIFETIME
+#define NDN_DNL_LIFETIME 6000
+#endif
+
+/** Number of steps in which pairs are aged out.
+ * More steps expire pairs closer to #NDN_DNL_LIFETIME, each by a sweep of all slots.
+ */
+#define NDN_DNL_GENERATIONS 4
+
+/** Maximum number of pairs moved to place a new one.
+ */
+#define NDN_DNL_MAX_KICKS 32
+
+/** A slot of the filter.
+ */
+typedef struct ndn_dnl_slot {
+  /** Fingerprint of the pair. 0 if the slot is empty.
+   */
+  uint16_t fingerprint;
+
+  /** Generation in which the pair was inserted or last seen.
+   */
+  uint16_t generation;
+} ndn_dnl_slot_t;
+
+/** DNL counters. Only the owner of the DNL writes them.
+ */
+typedef struct ndn_dnl_stats {
+  /** Pairs inserted or refreshed. */
+  uint64_t insertions;
+  /** Lookups. */
+  uint64_t lookups;
+  /** Lookups finding the pair. */
+  uint64_t hits;
+  /** Pairs forgotten because the filter was too full. */
+  uint64_t evictions;
+} ndn_dnl_stats_t;
+
+/** Dead Nonce List.
+ */
+typedef struct ndn_dnl {
+  /** Number of buckets.
+   */
+  uint32_t bucket_count;
+
+  /** Number of pairs held.
+   */
+  uint32_t count;
+
+  /** Current generation.
+   */
+  uint16_t generation;
+
+  /** When the next generation starts. 0 before the first call of ndn_dnl_age().
+   */
+  ndn_time_ms_t next_generation;
+
+  ndn_dnl_stats_t stats;
+  ndn_dnl_slot_t slots[];
+} ndn_dnl_t;
+
+/** The memory reserved for a DNL.
+ * @param[in] bucket_count Number of buckets. The DNL holds up to
+ *                         #NDN_DNL_BUCKET_SIZE pairs per bucket.
+ */
+#define NDN_DNL_RESERVE_SIZE(bucket_count) \
+  (sizeof(ndn_dnl_t) + sizeof(ndn_dnl_slot_t) * NDN_DNL_BUCKET_SIZE * (bucket_count))
+
+/** Initialize a DNL at specified memory space.
+ * @param[in, out] memory Memory of #NDN_DNL_RESERVE_SIZE(@c bucket_count) bytes.
+ * @param[in] bucket_count Number of buckets. Must not be 0.
+ */
+void
+ndn_dnl_init(void* memory, uint32_t bucket_count);
+
+/** Hash a (Name, Nonce) pair.
+ * @param[in] name The value of the Name TLV.
+ * @param[in] length The size of @c name.
+ * @param[in] nonce The Nonce.
+ * @return The key passed to ndn_dnl_find() and ndn_dnl_insert().
+ */
+uint64_t
+ndn_dnl_hash(const uint8_t* name, size_t length, uint32_t nonce);
+
+/** Hash a (Name, Nonce) pair from the hash of the Name.
+ * @param[in] name_hash The hash of the whole Name, @c full of ndn_name_hash_compute().
+ * @param[in] nonce The Nonce.
+ * @return The same key as ndn_dnl_hash().
+ */
+uint64_t
+ndn_dnl_hash_name(uint64_t name_hash, uint32_t nonce);
+
+/** Forget pairs older than the lifetime.
+ *
+ * Cheap unless a new generation starts. Call it before ndn_dnl_find()
+ * and ndn_dnl_insert() with a clock that does not go back.
+ * @param[in, out] self The DNL.
+ * @param[in] now Current time.
+ */
+void
+ndn_dnl_age(ndn_dnl_t* self, ndn_time_ms_t now);
+
+/** Check whether a pair was seen.
+ * @param[in, out] self The DNL.
+ * @param[in] hash The pair from ndn_dnl_hash().
+ * @return Whether the pair is held, or a different pair with the same fingerprint.
+ */
+bool
+ndn_dnl_find(ndn_dnl_t* self, uint64_t hash);
+
+/** Remember a pair, or refresh it if already held.
+ * @param[in, out] self The DNL.
+ * @param[in] hash The pair from ndn_dnl_hash().
+ */
+void
+ndn_dnl_insert(ndn_dnl_t* self, uint64_t hash);
+
+/** Estimated false-positive rate of ndn_dnl_find() at the current occupancy.
+ * @return Parts per million.
+ */
+uint32_t
+ndn_dnl_fp_rate(const ndn_dnl_t* self);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_DEAD_NONCE_H_
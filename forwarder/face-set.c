@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include "face-set.h"
+#include "../ndn-error-code.h"
+#include <string.h>
+
+#define NDN_FACE_SET_BITMAP(pool, index) (&(pool)->bits[(size_t)(index) * (pool)->words])
+
+void
+ndn_faceset_pool_init(void* memory, ndn_table_id_t block_count, ndn_table_id_t face_count)
+{
+  ndn_face_set_pool_t* pool = (ndn_face_set_pool_t*)memory;
+  ndn_table_id_t i;
+  pool->capacity = block_count;
+  pool->words = NDN_FACE_SET_WORDS(face_count);
+  pool->free_head = (block_count > 0 && pool->words > 0) ? 0 : NDN_INVALID_ID;
+  for (i = 0; i < block_count && pool->words > 0; i++) {
+    NDN_FACE_SET_BITMAP(pool, i)[0] = (i + 1 < block_count) ? i + 1 : NDN_INVALID_ID;
+  }
+}
+
+/** Move the inline members of @c set into a new bitmap.
+ */
+static int
+ndn_faceset_spill(ndn_face_set_pool_t* pool, ndn_face_set_t* set)
+{
+  ndn_table_id_t index;
+  uint64_t* bitmap;
+  size_t i;
+
+  if (pool->free_head == NDN_INVALID_ID) {
+    return NDN_OVERSIZE;
+  }
+  for (i = 0; i < NDN_FACE_SET_INLINE_SIZE; i++) {
+    if (set->ids[i] / 64 >= pool->words) {
+      return NDN_OVERSIZE;
+    }
+  }
+  index = pool->free_head;
+  bitmap = NDN_FACE_SET_BITMAP(pool, index);
+  pool->free_head = (ndn_table_id_t)bitmap[0];
+  memset(bitmap, 0, sizeof(uint64_t) * pool->words);
+  for (i = 0; i < NDN_FACE_SET_INLINE_SIZE; i++) {
+    BIT_SET(bitmap[set->ids[i] / 64], set->ids[i] % 64);
+  }
+  ndn_faceset_init(set);
+  set->ids[1] = index;
+  return NDN_SUCCESS;
+}
+
+static void
+ndn_faceset_release(ndn_face_set_pool_t* pool, ndn_face_set_t* set)
+{
+  NDN_FACE_SET_BITMAP(pool, set->ids[1])[0] = pool->free_head;
+  pool->free_head = set->ids[1];
+  ndn_faceset_init(set);
+}
+
+int
+ndn_faceset_add(ndn_face_set_pool_t* pool, ndn_face_set_t* set, ndn_table_id_t face_id)
+{
+  uint64_t* bitmap;
+  size_t i;
+  int ret;
+
+  if (face_id == NDN_INVALID_ID) {
+    return NDN_OVERSIZE;
+  }
+  if (!ndn_faceset_is_spilled(set)) {
+    for (i = 0; i < NDN_FACE_SET_INLINE_SIZE; i++) {
+      if (set->ids[i] == face_id) {
+        return NDN_SUCCESS;
+      }
+      if (set->ids[i] == NDN_INVALID_ID) {
+        set->ids[i] = face_id;
+        return NDN_SUCCESS;
+      }
+    }
+    if (pool == NULL || face_id / 64 >= pool->words) {
+      return NDN_OVERSIZE;
+    }
+    ret = ndn_faceset_spill(pool, set);
+    if (ret != NDN_SUCCESS) {
+      return ret;
+    }
+  }
+  else if (face_id / 64 >= pool->words) {
+    return NDN_OVERSIZE;
+  }
+  bitmap = NDN_FACE_SET_BITMAP(pool, set->ids[1]);
+  BIT_SET(bitmap[face_id / 64], face_id % 64);
+  return NDN_SUCCESS;
+}
+
+void
+ndn_faceset_remove(ndn_face_set_pool_t* pool, ndn_face_set_t* set, ndn_table_id_t face_id)
+{
+  ndn_face_set_t small;
+  ndn_table_id_t id, n = 0;
+  uint64_t* bitmap;
+  size_t i;
+
+  if (!ndn_faceset_is_spilled(set)) {
+    for (i = 0; i < NDN_FACE_SET_INLINE_SIZE; i++) {
+      if (set->ids[i] == face_id) {
+        // Keep members packed
+        for (; i + 1 < NDN_FACE_SET_INLINE_SIZE; i++) {
+          set->ids[i] = set->ids[i + 1];
+        }
+        set->ids[NDN_FACE_SET_INLINE_SIZE - 1] = NDN_INVALID_ID;
+        return;
+      }
+    }
+    return;
+  }
+
+  bitmap = NDN_FACE_SET_BITMAP(pool, set->ids[1]);
+  if (face_id / 64 < pool->words) {
+    BIT_CLEAR(bitmap[face_id / 64], face_id % 64);
+  }
+
+  // Go back inline if the remaining members fit
+  ndn_faceset_init(&small);
+  for (i = 0; i < pool->words; i++) {
+    uint64_t word = bitmap[i];
+    while (word != 0) {
+      if (n == NDN_FACE_SET_INLINE_SIZE) {
+        return;
+      }
+      id = (ndn_table_id_t)(i * 64 + bitset_pop_least(&word));
+      small.ids[n++] = id;
+    }
+  }
+  ndn_faceset_release(pool, set);
+  *set = small;
+}
+
+bool
+ndn_faceset_contains(const ndn_face_set_pool_t* pool, const ndn_face_set_t* set, ndn_table_id_t face_id)
+{
+  size_t i;
+  if (!ndn_faceset_is_spilled(set)) {
+    for (i = 0; i < NDN_FACE_SET_INLINE_SIZE; i++) {
+      if (set->ids[i] == face_id) {
+        return face_id != NDN_INVALID_ID;
+      }
+    }
+    return false;
+  }
+  if (face_id / 64 >= pool->words) {
+    return false;
+  }
+  return BIT_CHECK(NDN_FACE_SET_BITMAP(pool, set->ids[1])[face_id / 64], face_id % 64);
+}
+
+void
+ndn_faceset_clear(ndn_face_set_pool_t* pool, ndn_face_set_t* set)
+{
+  if (ndn_faceset_is_spilled(set)) {
+    ndn_faceset_release(pool, set);
+  }
+  else {
+    ndn_faceset_init(set);
+  }
+}
+
+void
+ndn_faceset_iter_init(ndn_face_set_iter_t* iter, const ndn_face_set_pool_t* pool, const ndn_face_set_t* set)
+{
+  iter->index = 0;
+  iter->set = *set;
+  if (ndn_faceset_is_spilled(set)) {
+    iter->bitmap = NDN_FACE_SET_BITMAP(pool, set->ids[1]);
+    iter->words = pool->words;
+    iter->word = iter->bitmap[0];
+  }
+  else {
+    iter->bitmap = NULL;
+    iter->words = 0;
+    iter->word = 0;
+  }
+}
+
+void
+ndn_faceset_iter_init_copy(ndn_face_set_iter_t* iter, const ndn_face_set_pool_t* pool,
+                           const ndn_face_set_t* set, uint64_t* copy)
+{
+  ndn_faceset_iter_init(iter, pool, set);
+  if (iter->bitmap != NULL && copy != NULL) {
+    memcpy(copy, iter->bitmap, sizeof(uint64_t) * iter->words);
+    iter->bitmap = copy;
+  }
+}
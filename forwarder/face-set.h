@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef FORWARDER_FACE_SET_H_
+#define FORWARDER_FACE_SET_H_
+
+#include "../ndn-constants.h"
+#include "../util/bit-operations.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdFaceSet Face Set
+ * @brief Sets of face IDs used by PIT and FIB entries.
+ * @ingroup NDNFwd
+ * @{
+ */
+
+/** Number of face IDs a set holds without spilling.
+ */
+#define NDN_FACE_SET_INLINE_SIZE (sizeof(uint64_t) / sizeof(ndn_table_id_t))
+
+/** A set of face IDs.
+ *
+ * Small sets keep their members in @c ids, packed at the front and followed by
+ * #NDN_INVALID_ID. A set with more than #NDN_FACE_SET_INLINE_SIZE members spills
+ * into a bitmap taken from a #ndn_face_set_pool_t. Then <tt>ids[0]</tt> is
+ * #NDN_INVALID_ID and <tt>ids[1]</tt> is the index of the bitmap.
+ */
+typedef struct ndn_face_set {
+  ndn_table_id_t ids[NDN_FACE_SET_INLINE_SIZE];
+} ndn_face_set_t;
+
+/** Bitmaps for spilled face sets.
+ *
+ * Each bitmap has one bit per face. Free bitmaps are linked as a free list
+ * through their first word.
+ */
+typedef struct ndn_face_set_pool {
+  /** Number of bitmaps.
+   */
+  ndn_table_id_t capacity;
+
+  /** First free bitmap. #NDN_INVALID_ID if all are in use.
+   */
+  ndn_table_id_t free_head;
+
+  /** Number of 64-bit words in each bitmap.
+   */
+  ndn_table_id_t words;
+
+  uint64_t bits[];
+} ndn_face_set_pool_t;
+
+/** Number of 64-bit words in a bitmap of @c face_count faces.
+ */
+#define NDN_FACE_SET_WORDS(face_count) (((face_count) + 63) / 64)
+
+/** The memory reserved for a pool.
+ * @param[in] block_count Number of bitmaps.
+ * @param[in] face_count Maximum number of faces.
+ */
+#define NDN_FACE_SET_POOL_RESERVE_SIZE(block_count, face_count) \
+  (sizeof(ndn_face_set_pool_t) + sizeof(uint64_t) * NDN_FACE_SET_WORDS(face_count) * (block_count))
+
+/** Iterator over a face set.
+ * The set must not be modified during the iteration, unless it was started
+ * by ndn_faceset_iter_init_copy().
+ */
+typedef struct ndn_face_set_iter {
+  /** Spilled bitmap. NULL for an inline set.
+   */
+  const uint64_t* bitmap;
+
+  /** Remaining bits of the current word.
+   */
+  uint64_t word;
+
+  /** Index of the current word, or of the next inline member.
+   */
+  ndn_table_id_t index;
+
+  /** Number of words of @c bitmap.
+   */
+  ndn_table_id_t words;
+
+  ndn_face_set_t set;
+} ndn_face_set_iter_t;
+
+/** Initialize a pool at specified memory space.
+ * @param[in, out] memory Memory reserved for the pool, aligned to @c uint64_t.
+ * @param[in] block_count Number of bitmaps.
+ * @param[in] face_count Maximum number of faces.
+ */
+void
+ndn_faceset_pool_init(void* memory, ndn_table_id_t block_count, ndn_table_id_t face_count);
+
+/** Initialize an empty face set.
+ */
+static inline void
+ndn_faceset_init(ndn_face_set_t* set)
+{
+  for (size_t i = 0; i < NDN_FACE_SET_INLINE_SIZE; i++) {
+    set->ids[i] = NDN_INVALID_ID;
+  }
+}
+
+static inline bool
+ndn_faceset_is_spilled(const ndn_face_set_t* set)
+{
+  return set->ids[0] == NDN_INVALID_ID && set->ids[1] != NDN_INVALID_ID;
+}
+
+static inline bool
+ndn_faceset_is_empty(const ndn_face_set_t* set)
+{
+  return set->ids[0] == NDN_INVALID_ID && set->ids[1] == NDN_INVALID_ID;
+}
+
+/** Add a face to a set.
+ * @param[in, out] pool The pool to spill into. May be NULL if sets never spill.
+ * @param[in, out] set The set.
+ * @param[in] face_id The face.
+ * @return #NDN_SUCCESS if the face is in the set.
+ * @retval #NDN_OVERSIZE The set needs to spill but @c pool has no free bitmap,
+ *                       or @c face_id does not fit in a bitmap.
+ */
+int
+ndn_faceset_add(ndn_face_set_pool_t* pool, ndn_face_set_t* set, ndn_table_id_t face_id);
+
+/** Remove a face from a set. A spilled set moves back inline once small enough.
+ * @param[in, out] pool The pool of @c set.
+ * @param[in, out] set The set.
+ * @param[in] face_id The face. Nothing happens if it is not in the set.
+ */
+void
+ndn_faceset_remove(ndn_face_set_pool_t* pool, ndn_face_set_t* set, ndn_table_id_t face_id);
+
+/** Check whether a face is in a set.
+ */
+bool
+ndn_faceset_contains(const ndn_face_set_pool_t* pool, const ndn_face_set_t* set, ndn_table_id_t face_id);
+
+/** Remove all faces from a set and return its bitmap to the pool.
+ */
+void
+ndn_faceset_clear(ndn_face_set_pool_t* pool, ndn_face_set_t* set);
+
+/** Start iterating a face set.
+ */
+void
+ndn_faceset_iter_init(ndn_face_set_iter_t* iter, const ndn_face_set_pool_t* pool, const ndn_face_set_t* set);
+
+/** Start iterating a snapshot of a face set, so the set may change or be
+ * cleared meanwhile.
+ * @param[out] iter The iterator.
+ * @param[in] pool The pool of @c set.
+ * @param[in] set The set. An inline set is copied into @c iter.
+ * @param[out] copy Memory of @c pool->words words the bitmap of a spilled set is copied to.
+ *                  If NULL, a spilled set is iterated in place as by ndn_faceset_iter_init().
+ */
+void
+ndn_faceset_iter_init_copy(ndn_face_set_iter_t* iter, const ndn_face_set_pool_t* pool,
+                           const ndn_face_set_t* set, uint64_t* copy);
+
+/** Get the next face of an iteration.
+ * @return The face ID. #NDN_INVALID_ID at the end.
+ */
+static inline ndn_table_id_t
+ndn_faceset_iter_next(ndn_face_set_iter_t* iter)
+{
+  if (iter->bitmap == NULL) {
+    if (iter->index >= NDN_FACE_SET_INLINE_SIZE) {
+      return NDN_INVALID_ID;
+    }
+    return iter->set.ids[iter->index++];
+  }
+  while (iter->word == 0) {
+    if (++iter->index >= iter->words) {
+      return NDN_INVALID_ID;
+    }
+    iter->word = iter->bitmap[iter->index];
+  }
+  return (ndn_table_id_t)(iter->index * 64 + bitset_pop_least(&iter->word));
+}
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_FACE_SET_H_
@@ -9,27 +9,45 @@
  */
 
 #include "face-table.h"
+#include <string.h>
+
+#define NDN_FACETAB_NEXT_FREE(self) ((ndn_table_id_t*)ndn_facetab_measurements(self, (self)->capacity))
 
 void ndn_facetab_init(void* memory, ndn_table_id_t capacity){
   ndn_table_id_t i;
   ndn_face_table_t* self = (ndn_face_table_t*)memory;
+  ndn_table_id_t* next_free;
   self->capacity = capacity;
+  self->count = 0;
+  self->free_head = (capacity > 0) ? 0 : NDN_INVALID_ID;
+  next_free = NDN_FACETAB_NEXT_FREE(self);
   for(i = 0; i < capacity; i ++){
     self->slots[i] = NULL;
+    next_free[i] = (i + 1 < capacity) ? i + 1 : NDN_INVALID_ID;
   }
 }
 
 ndn_table_id_t ndn_facetab_register(ndn_face_table_t* self, ndn_face_intf_t* face){
-  ndn_table_id_t i;
-  for(i = 0; i < self->capacity; i ++){
-    if(self->slots[i] == NULL){
-      self->slots[i] = face;
-      return i;
-    }
+  ndn_table_id_t i = self->free_head;
+  if(i == NDN_INVALID_ID){
+    return NDN_INVALID_ID;
   }
-  return NDN_INVALID_ID;
+  self->free_head = NDN_FACETAB_NEXT_FREE(self)[i];
+  self->count ++;
+  self->slots[i] = face;
+  memset(ndn_facetab_stats(self, i), 0, sizeof(ndn_face_stats_t));
+  ndn_measurements_reset(ndn_facetab_measurements(self, i));
+  return i;
 }
 
 void ndn_facetab_unregister(ndn_face_table_t* self, ndn_table_id_t id){
+  if(self->slots[id] == NULL){
+    return;
+  }
   self->slots[id] = NULL;
+  // Published copies of the counters should not outlive the face
+  memset(ndn_facetab_stats(self, id), 0, sizeof(ndn_face_stats_t));
+  NDN_FACETAB_NEXT_FREE(self)[id] = self->free_head;
+  self->free_head = id;
+  self->count --;
 }
@@ -12,6 +12,7 @@
 #define FORWARDER_FACE_TABLE_H_
 
 #include "face.h"
+#include "measurements.h"
 #include "../ndn-constants.h"
 
 /** @defgroup NDNFwdFaceTab Face Table
@@ -20,13 +21,36 @@
  * @{
  */
 
+/** Per-face counters.
+ */
+typedef struct ndn_face_stats {
+  /** Packets received from the face. */
+  uint64_t in_packets;
+  /** Bytes received from the face. */
+  uint64_t in_bytes;
+  /** Packets sent to the face. */
+  uint64_t out_packets;
+  /** Bytes sent to the face. */
+  uint64_t out_bytes;
+} ndn_face_stats_t;
+
 /** Face Table.
  *
  * It assigns an unique ID to all faces.
+ * The counters of each face are stored right after @c slots, followed by the measurements.
+ * Empty IDs are linked as a free list, stored after the measurements.
  */
 typedef struct ndn_face_table{
   ndn_table_id_t capacity;
 
+  /** Number of registered faces.
+   */
+  ndn_table_id_t count;
+
+  /** First empty ID. #NDN_INVALID_ID if the table is full.
+   */
+  ndn_table_id_t free_head;
+
   /** All registered faces.
    * NULL for empty entries.
    */
@@ -37,7 +61,9 @@ typedef struct ndn_face_table{
  * @param[in] entry_count Maximum number of entries.
  */
 #define NDN_FACE_TABLE_RESERVE_SIZE(entry_count) \
-  (sizeof(ndn_face_table_t) + sizeof(ndn_face_intf_t*) * (entry_count))
+  (sizeof(ndn_face_table_t) + \
+   (sizeof(ndn_face_intf_t*) + sizeof(ndn_face_stats_t) + sizeof(ndn_face_measurements_t) + \
+    sizeof(ndn_table_id_t)) * (entry_count))
 
 /** Initialize FaceTable at specified memory space.
  * @param[in, out] memory Memory reserved for FaceTable.
@@ -55,6 +81,28 @@ ndn_facetab_init(void* memory, ndn_table_id_t capacity);
 ndn_table_id_t
 ndn_facetab_register(ndn_face_table_t* self, ndn_face_intf_t* face);
 
+/** Get the counters of a face.
+ * @param[in] self FaceTable.
+ * @param[in] id The face ID.
+ * @pre <tt>id < self->ndn_face_table_t#capacity</tt>
+ */
+static inline ndn_face_stats_t*
+ndn_facetab_stats(ndn_face_table_t* self, ndn_table_id_t id)
+{
+  return &((ndn_face_stats_t*)&self->slots[self->capacity])[id];
+}
+
+/** Get the measurements of a face.
+ * @param[in] self FaceTable.
+ * @param[in] id The face ID.
+ * @pre <tt>id < self->ndn_face_table_t#capacity</tt>
+ */
+static inline ndn_face_measurements_t*
+ndn_facetab_measurements(ndn_face_table_t* self, ndn_table_id_t id)
+{
+  return &((ndn_face_measurements_t*)ndn_facetab_stats(self, self->capacity))[id];
+}
+
 /** Unregister a face from FaceTable only.
  * @param[in, out] self FaceTable.
  * @param[in] face The face to unregister.
@@ -16,6 +16,7 @@
 #include <stddef.h>
 #include "../ndn-enums.h"
 #include "../ndn-constants.h"
+#include "packet-buffer.h"
 
 #define container_of(ptr, type, member) \
   ((type *)((char *)(1 ? (ptr) : &((type *)0)->member) - offsetof(type, member)))
@@ -43,6 +44,19 @@ typedef int (*ndn_face_intf_up)(struct ndn_face_intf* self);
 typedef int (*ndn_face_intf_send)(struct ndn_face_intf* self,
                                   const uint8_t* packet, uint32_t size);
 
+/** Send out several packets at once.
+ * @sa ndn_face_send_batch
+ */
+typedef int (*ndn_face_intf_send_batch)(struct ndn_face_intf* self,
+                                        const uint8_t* const packets[],
+                                        const uint32_t sizes[],
+                                        size_t count);
+
+/** Send out a packet held in a packet buffer.
+ * @sa ndn_face_send_buf
+ */
+typedef int (*ndn_face_intf_send_buf)(struct ndn_face_intf* self, ndn_pktbuf_t* buf);
+
 /** Shutdown the face temporarily.
  * @sa ndn_face_down
  */
@@ -77,6 +91,22 @@ typedef struct ndn_face_intf {
    */
   ndn_face_intf_send send;
 
+  /** Send out several packets at once. Optional, NULL if not supported.
+   *
+   * When set, the forwarder may queue outgoing packets and hand them over
+   * in order at the end of a processing round.
+   * @sa ndn_forwarder_flush
+   */
+  ndn_face_intf_send_batch send_batch;
+
+  /** Send out a packet buffer. Optional, NULL if not supported.
+   *
+   * Takes over one reference of the buffer and releases it once the packet is
+   * sent, so the same buffer can go out through several faces without a copy.
+   * @sa ndn_face_send_buf
+   */
+  ndn_face_intf_send_buf send_buf;
+
   /** Shutdown the face temporarily.
    * @sa ndn_face_down
    */
@@ -133,6 +163,42 @@ ndn_face_send(ndn_face_intf_t* self, const uint8_t* packet, uint32_t size)
   return self->send(self, packet, size);
 }
 
+/** Send out several packets in order.
+ * @param[in, out] self The face through which to send. Must have @c send_batch.
+ * @param[in] packets The encoded packets.
+ * @param[in] sizes The size of each packet.
+ * @param[in] count The number of packets.
+ * @return #NDN_SUCCESS if the call succeeded. The error code otherwise.
+ */
+static inline int
+ndn_face_send_batch(ndn_face_intf_t* self, const uint8_t* const packets[],
+                    const uint32_t sizes[], size_t count)
+{
+  if (self->state != NDN_FACE_STATE_UP)
+    self->up(self);
+  return self->send_batch(self, packets, sizes, count);
+}
+
+/** Send out a packet buffer.
+ *
+ * Faces without @c send_buf send the bytes with @c send instead.
+ * @param[in, out] self The face through which to send.
+ * @param[in] buf The packet. The call takes over one reference of it.
+ * @return #NDN_SUCCESS if the call succeeded. The error code otherwise.
+ */
+static inline int
+ndn_face_send_buf(ndn_face_intf_t* self, ndn_pktbuf_t* buf)
+{
+  int ret;
+  if (self->state != NDN_FACE_STATE_UP)
+    self->up(self);
+  if (self->send_buf)
+    return self->send_buf(self, buf);
+  ret = self->send(self, buf->data, buf->length);
+  ndn_pktbuf_release(buf);
+  return ret;
+}
+
 /** Shutdown the face temporarily.
  * @param[in, out] self Input. The interface to turn off.
  * @return #NDN_SUCCESS if the call succeeded. The error code otherwise.
@@ -9,33 +9,215 @@
  */
 
 #include "fib.h"
+#include <string.h>
+
+#define minof2(a, b) ((a) < (b) ? (a) : (b))
+
+#if NDN_FIB_HASH_INDEX
+
+static inline ndn_fib_marker_t*
+fib_markers(ndn_fib_t* self)
+{
+  return (ndn_fib_marker_t*)&self->slots[self->capacity];
+}
+
+static inline ndn_table_id_t*
+fib_buckets(ndn_fib_t* self)
+{
+  return (ndn_table_id_t*)&fib_markers(self)[self->nametree->capacity];
+}
+
+/** Find the node of the prefix of @c depth components ending with @c component.
+ * The last component is compared, so a different prefix is only returned if
+ * it has the same depth, the same last component and the same 64-bit hash.
+ */
+static ndn_table_id_t
+fib_index_lookup(ndn_fib_t* self, uint64_t hash, uint8_t depth,
+                 const uint8_t* component, size_t len)
+{
+  ndn_fib_marker_t* markers = fib_markers(self);
+  ndn_table_id_t* buckets = fib_buckets(self);
+  uint32_t i = (uint32_t)(hash % self->bucket_count);
+  ndn_table_id_t id;
+  while ((id = buckets[i]) != NDN_INVALID_ID) {
+    if (markers[id].hash == hash && markers[id].depth == depth &&
+        memcmp(self->nametree->nodes[id].val, component, len) == 0) {
+      return id;
+    }
+    if (++i == self->bucket_count) i = 0;
+  }
+  return NDN_INVALID_ID;
+}
+
+static void
+fib_index_insert(ndn_fib_t* self, ndn_table_id_t id)
+{
+  ndn_table_id_t* buckets = fib_buckets(self);
+  uint32_t i = (uint32_t)(fib_markers(self)[id].hash % self->bucket_count);
+  // The load factor is below 1/2, so an empty bucket always exists
+  while (buckets[i] != NDN_INVALID_ID) {
+    if (++i == self->bucket_count) i = 0;
+  }
+  buckets[i] = id;
+}
+
+static void
+fib_index_remove(ndn_fib_t* self, ndn_table_id_t id)
+{
+  ndn_fib_marker_t* markers = fib_markers(self);
+  ndn_table_id_t* buckets = fib_buckets(self);
+  uint32_t n = self->bucket_count;
+  uint32_t i = (uint32_t)(markers[id].hash % n), j, home;
+  while (buckets[i] != id) {
+    if (buckets[i] == NDN_INVALID_ID) return;
+    if (++i == n) i = 0;
+  }
+  // Backward shift deletion, as in the NameTree index
+  j = i;
+  for (;;) {
+    if (++j == n) j = 0;
+    if (buckets[j] == NDN_INVALID_ID) break;
+    home = (uint32_t)(markers[buckets[j]].hash % n);
+    if (i <= j ? (i < home && home <= j) : (i < home || home <= j)) continue;
+    buckets[i] = buckets[j];
+    i = j;
+  }
+  buckets[i] = NDN_INVALID_ID;
+}
+
+/** Collect the path from the root to a node, the root excluded.
+ * @return The depth of the node. More than #NDN_FIB_INDEX_MAX_DEPTH if too deep,
+ *         in which case @c path is not filled.
+ */
+static size_t
+fib_node_path(ndn_fib_t* self, ndn_table_id_t id, ndn_table_id_t path[NDN_FIB_INDEX_MAX_DEPTH])
+{
+  size_t depth = 0, k;
+  ndn_table_id_t i;
+  for (i = id; i != 0; i = self->nametree->nodes[i].parent) {
+    depth ++;
+  }
+  if (depth > NDN_FIB_INDEX_MAX_DEPTH) {
+    return depth;
+  }
+  k = depth;
+  for (i = id; i != 0; i = self->nametree->nodes[i].parent) {
+    path[--k] = i;
+  }
+  return depth;
+}
+
+// Mark every prefix of the name of a new entry
+static void
+fib_index_add(ndn_fib_t* self, ndn_table_id_t id)
+{
+  ndn_table_id_t path[NDN_FIB_INDEX_MAX_DEPTH];
+  ndn_fib_marker_t* marker;
+  nametree_entry_t* node;
+  uint64_t hash = ndn_name_hash_seed();
+  size_t depth = fib_node_path(self, id, path), k;
+
+  if (depth > NDN_FIB_INDEX_MAX_DEPTH) {
+    self->deep_count ++;
+    return;
+  }
+  for (k = 0; k < depth; k++) {
+    node = &self->nametree->nodes[path[k]];
+    hash = ndn_name_hash_extend(hash, node->val,
+                           minof2((size_t)node->val[1] + 2, NDN_NAME_COMPONENT_BUFFER_SIZE));
+    marker = &fib_markers(self)[path[k]];
+    if (marker->ref_count++ > 0) {
+      continue;
+    }
+    marker->hash = ndn_name_hash_mix(hash);
+    marker->depth = (uint8_t)(k + 1);
+    fib_index_insert(self, path[k]);
+    if (self->depth_count[k + 1]++ == 0) {
+      self->max_depth = (uint8_t)(k + 1);
+    }
+  }
+}
+
+// Drop the markers of a removed entry
+static void
+fib_index_drop(ndn_fib_t* self, ndn_table_id_t id)
+{
+  ndn_table_id_t path[NDN_FIB_INDEX_MAX_DEPTH];
+  ndn_fib_marker_t* marker;
+  size_t depth = fib_node_path(self, id, path), k;
+
+  if (depth > NDN_FIB_INDEX_MAX_DEPTH) {
+    self->deep_count --;
+    return;
+  }
+  for (k = 0; k < depth; k++) {
+    marker = &fib_markers(self)[path[k]];
+    if (--marker->ref_count > 0) {
+      continue;
+    }
+    fib_index_remove(self, path[k]);
+    self->depth_count[k + 1] --;
+  }
+  while (self->max_depth > 0 && self->depth_count[self->max_depth] == 0) {
+    self->max_depth --;
+  }
+}
+
+#endif // NDN_FIB_HASH_INDEX
 
 static inline void
 ndn_fib_entry_reset(ndn_fib_entry_t* self)
 {
   self->nametree_id = NDN_INVALID_ID;
-  self->nexthop = 0;
+  ndn_faceset_init(&self->nexthop);
   self->on_interest = NULL;
   self->userdata = NULL;
+  self->strategy = NDN_FWD_STRATEGY_MULTICAST;
+  self->strategy_count = 0;
+  self->strategy_last = NDN_INVALID_ID;
 }
 
 void
-ndn_fib_init(void* memory, ndn_table_id_t capacity, ndn_nametree_t* nametree)
+ndn_fib_init(void* memory, ndn_table_id_t capacity, ndn_nametree_t* nametree,
+             ndn_face_set_pool_t* faces)
 {
   ndn_table_id_t i;
   ndn_fib_t* self = (ndn_fib_t*)memory;
   self->capacity = capacity;
   self->nametree = nametree;
+  self->faces = faces;
+  self->count = 0;
+  self->free_head = (capacity > 0) ? 0 : NDN_INVALID_ID;
+  memset(&self->stats, 0, sizeof(self->stats));
   for(i = 0; i < capacity; i ++){
     ndn_fib_entry_reset(&self->slots[i]);
+    self->slots[i].next_free = (i + 1 < capacity) ? i + 1 : NDN_INVALID_ID;
   }
+#if NDN_FIB_HASH_INDEX
+  self->bucket_count = NDN_FIB_BUCKET_COUNT(nametree->capacity);
+  self->deep_count = 0;
+  self->max_depth = 0;
+  memset(self->depth_count, 0, sizeof(self->depth_count));
+  memset(fib_markers(self), 0, sizeof(ndn_fib_marker_t) * nametree->capacity);
+  memset(fib_buckets(self), 0xFF, sizeof(ndn_table_id_t) * self->bucket_count);
+#endif
 }
 
 static inline void
 ndn_fib_remove_entry(ndn_fib_t* self, ndn_fib_entry_t* entry)
 {
-  ndn_nametree_at(self->nametree, entry->nametree_id)->fib_id = NDN_INVALID_ID;
+  nametree_entry_t* node = ndn_nametree_at(self->nametree, entry->nametree_id);
+#if NDN_FIB_HASH_INDEX
+  fib_index_drop(self, entry->nametree_id);
+#endif
+  node->fib_id = NDN_INVALID_ID;
+  ndn_nametree_release(self->nametree, node);
+  ndn_faceset_clear(self->faces, &entry->nexthop);
   ndn_fib_entry_reset(entry);
+  entry->next_free = self->free_head;
+  self->free_head = (ndn_table_id_t)(entry - self->slots);
+  self->count --;
+  self->stats.removals ++;
 }
 
 void
@@ -44,7 +226,7 @@ ndn_fib_remove_entry_if_empty(ndn_fib_t* self, ndn_fib_entry_t* entry)
   if(entry->nametree_id == NDN_INVALID_ID){
     return;
   }
-  if(entry->nexthop == 0 && entry->on_interest == NULL){
+  if(ndn_faceset_is_empty(&entry->nexthop) && entry->on_interest == NULL){
     ndn_fib_remove_entry(self, entry);
   }
 }
@@ -53,57 +235,128 @@ void
 ndn_fib_unregister_face(ndn_fib_t* self, ndn_table_id_t face_id)
 {
   for (ndn_table_id_t i = 0; i < self -> capacity; ++i) {
-    self->slots[i].nexthop = bitset_unset(self->slots[i].nexthop , face_id);
+    ndn_faceset_remove(self->faces, &self->slots[i].nexthop, face_id);
     ndn_fib_remove_entry_if_empty(self, &self->slots[i]);
   }
 }
 
 static ndn_table_id_t
-ndn_fib_add_new_entry(ndn_fib_t* fib , int nametree_id)
+ndn_fib_add_new_entry(ndn_fib_t* fib , ndn_table_id_t nametree_id)
 {
-  ndn_table_id_t i;
-  for (i = 0; i < fib -> capacity; ++i) {
-    if (fib->slots[i].nametree_id == NDN_INVALID_ID) {
-      ndn_fib_entry_reset(&fib->slots[i]);
-      fib->slots[i].nametree_id = nametree_id;
-      return i;
-    }
+  ndn_table_id_t i = fib->free_head;
+  if (i == NDN_INVALID_ID) {
+    fib->stats.full ++;
+    return NDN_INVALID_ID;
   }
-  return NDN_INVALID_ID;
+  fib->free_head = fib->slots[i].next_free;
+  fib->count ++;
+  fib->stats.insertions ++;
+  ndn_fib_entry_reset(&fib->slots[i]);
+  fib->slots[i].nametree_id = nametree_id;
+  fib->slots[i].next_free = NDN_INVALID_ID;
+#if NDN_FIB_HASH_INDEX
+  fib_index_add(fib, nametree_id);
+#endif
+  return i;
 }
 
 ndn_fib_entry_t*
-ndn_fib_find_or_insert(ndn_fib_t* self, uint8_t* prefix, size_t length)
+ndn_fib_node_entry(ndn_fib_t* self, nametree_entry_t* node)
+{
+  if (node == NULL || node->fib_id == NDN_INVALID_ID) {
+    return NULL;
+  }
+  return &self->slots[node->fib_id];
+}
+
+ndn_fib_entry_t*
+ndn_fib_node_insert(ndn_fib_t* self, nametree_entry_t* node)
 {
-  nametree_entry_t* entry = ndn_nametree_find_or_insert(self->nametree, prefix, length);
-  if(entry == NULL) {
+  if(node == NULL) {
     return NULL;
   }
-  if(entry->fib_id == NDN_INVALID_ID) {
-    entry->fib_id = ndn_fib_add_new_entry(self, ndn_nametree_getid(self->nametree, entry));
-    if(entry->fib_id == NDN_INVALID_ID) {
+  if(node->fib_id == NDN_INVALID_ID) {
+    node->fib_id = ndn_fib_add_new_entry(self, ndn_nametree_getid(self->nametree, node));
+    if(node->fib_id == NDN_INVALID_ID) {
+      ndn_nametree_release(self->nametree, node);
       return NULL;
     }
   }
-  return &self->slots[entry->fib_id];
+  return &self->slots[node->fib_id];
+}
+
+ndn_fib_entry_t*
+ndn_fib_find_or_insert(ndn_fib_t* self, uint8_t* prefix, size_t length)
+{
+  return ndn_fib_node_insert(self, ndn_nametree_find_or_insert(self->nametree, prefix, length));
 }
 
 ndn_fib_entry_t*
 ndn_fib_find(ndn_fib_t* self, uint8_t* prefix, size_t length)
 {
-  nametree_entry_t* entry = ndn_nametree_find(self->nametree, prefix, length);
-  if (entry == NULL || entry->fib_id == NDN_INVALID_ID) {
-    return NULL;
-  }
-  return &self->slots[entry->fib_id];
+  return ndn_fib_node_entry(self, ndn_nametree_find(self->nametree, prefix, length));
 }
 
 ndn_fib_entry_t*
 ndn_fib_prefix_match(ndn_fib_t* self, uint8_t* prefix, size_t length)
 {
-  nametree_entry_t* entry = ndn_nametree_prefix_match(self->nametree, prefix, length, NDN_NAMETREE_FIB_TYPE);
-  if (entry == NULL || entry->fib_id == NDN_INVALID_ID) {
-    return NULL;
+  return ndn_fib_prefix_match_hashed(self, prefix, length, NULL);
+}
+
+ndn_fib_entry_t*
+ndn_fib_prefix_match_hashed(ndn_fib_t* self, uint8_t* prefix, size_t length,
+                            const ndn_name_hash_t* name_hash)
+{
+#if NDN_FIB_HASH_INDEX
+  uint64_t hashes[NDN_FIB_INDEX_MAX_DEPTH + 1];
+  size_t offsets[NDN_FIB_INDEX_MAX_DEPTH + 1], lens[NDN_FIB_INDEX_MAX_DEPTH + 1];
+  uint64_t hash = ndn_name_hash_seed();
+  size_t offset, component_len, depth = 0, lo, hi, mid;
+  ndn_table_id_t found, node = 0;
+
+  if (self->deep_count > 0) {
+    return ndn_fib_node_entry(self, ndn_nametree_prefix_match(self->nametree, prefix, length, NDN_NAMETREE_FIB_TYPE));
+  }
+  if (length < 2) return NULL;
+  // Hash every prefix no deeper than the index in one pass
+  offset = (prefix[1] < 253) ? 2 : 4;
+  while (offset < length && depth < self->max_depth) {
+    component_len = prefix[offset + 1] + 2;
+    depth ++;
+    offsets[depth] = offset;
+    lens[depth] = minof2(component_len, NDN_NAME_COMPONENT_BUFFER_SIZE);
+    if (name_hash != NULL && depth <= name_hash->short_depth)
+      hash = name_hash->hashes[depth];
+    else
+      hash = ndn_name_hash_extend(hash, prefix + offset, lens[depth]);
+    hashes[depth] = ndn_name_hash_mix(hash);
+    offset += component_len;
+  }
+
+  // All prefixes of an indexed name are indexed, so the lengths found form a range from 0
+  lo = 0;
+  hi = depth;
+  while (lo < hi) {
+    mid = (lo + hi + 1) / 2;
+    found = fib_index_lookup(self, hashes[mid], (uint8_t)mid, prefix + offsets[mid], lens[mid]);
+    if (found != NDN_INVALID_ID) {
+      lo = mid;
+      node = found;
+    }
+    else {
+      hi = mid - 1;
+    }
+  }
+
+  // The longest match is the deepest prefix found or one of its ancestors.
+  // Like the NameTree walk, an entry at the root is not matched.
+  while (node != 0 && self->nametree->nodes[node].fib_id == NDN_INVALID_ID) {
+    node = self->nametree->nodes[node].parent;
   }
-  return &self->slots[entry->fib_id];
+  if (node == 0) return NULL;
+  return &self->slots[self->nametree->nodes[node].fib_id];
+#else
+  (void)name_hash;
+  return ndn_fib_node_entry(self, ndn_nametree_prefix_match(self->nametree, prefix, length, NDN_NAMETREE_FIB_TYPE));
+#endif
 }
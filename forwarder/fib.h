@@ -11,8 +11,9 @@
 #ifndef FORWARDER_FIB_H_
 #define FORWARDER_FIB_H_
 
-#include "../util/bit-operations.h"
+#include "../ndn-enums.h"
 #include "callback-funcs.h"
+#include "face-set.h"
 #include "name-tree.h"
 
 #ifdef __cplusplus
@@ -22,16 +23,27 @@ extern "C" {
 /** @defgroup NDNFwdFIB FIB
  * @brief Fowarding Infomation Base
  * @ingroup NDNFwd
+ *
+ * With #NDN_FIB_HASH_INDEX, every prefix of a FIB entry's name is indexed by
+ * (length, hash), so ndn_fib_prefix_match() binary searches the prefix lengths
+ * of a name with O(log L) hash probes instead of walking the NameTree.
  * @{
  */
 
+/** Longest prefix indexed, in components.
+ * Deeper entries are still matched, by walking the NameTree.
+ */
+#ifndef NDN_FIB_INDEX_MAX_DEPTH
+#define NDN_FIB_INDEX_MAX_DEPTH 32
+#endif
+
 /**
  * FIB entry.
  */
 typedef struct ndn_fib_entry {
-  /** A bitset recording all next hops.
+  /** All next hops.
    */
-  ndn_bitset_t nexthop;
+  ndn_face_set_t nexthop;
 
   /** OnOnterest callback function if registered.
    */
@@ -41,30 +53,128 @@ typedef struct ndn_fib_entry {
    */
   void* userdata;
 
+  /** Forwarding strategy for Interests under this prefix.
+   * #NDN_FWD_STRATEGY_MULTICAST by default.
+   * @sa ndn_forwarder_set_strategy
+   */
+  uint8_t strategy;
+
+  /** Interests forwarded by the strategy, used to schedule probes.
+   */
+  uint8_t strategy_count;
+
+  /** Next hop picked last by round-robin.
+   */
+  ndn_table_id_t strategy_last;
+
   /** NameTree entry's ID.
    * #NDN_INVALID_ID if the entry is empty.
    */
   ndn_table_id_t nametree_id;
+
+  /** Next empty slot if this entry is empty.
+   * Empty slots are linked as a free list starting from @c free_head.
+   */
+  ndn_table_id_t next_free;
 } ndn_fib_entry_t;
 
+/**
+ * FIB counters. Only the owner of the FIB writes them.
+ */
+typedef struct ndn_fib_stats {
+  /** Entries created. */
+  uint64_t insertions;
+  /** Entries removed. */
+  uint64_t removals;
+  /** Insertions failed because the FIB is full. */
+  uint64_t full;
+} ndn_fib_stats_t;
+
+#if NDN_FIB_HASH_INDEX
+/**
+ * A prefix of the name of one or more FIB entries, kept for the NameTree node of the prefix.
+ */
+typedef struct ndn_fib_marker {
+  /** Hash of the prefix. */
+  uint64_t hash;
+  /** FIB entries under this prefix, including one at it. 0 if not indexed. */
+  ndn_table_id_t ref_count;
+  /** Number of components. */
+  uint8_t depth;
+} ndn_fib_marker_t;
+#endif
+
 /**
  * Forwarding Information Base (FIB).
+ *
+ * With #NDN_FIB_HASH_INDEX, markers for all NameTree nodes follow @c slots
+ * in the same memory block, and then an open addressing hash table of node ids.
  */
 typedef struct ndn_fib {
   ndn_nametree_t* nametree;
+  /** Bitmaps for face sets with many faces. */
+  ndn_face_set_pool_t* faces;
   ndn_table_id_t capacity;
+  /** Number of occupied slots. */
+  ndn_table_id_t count;
+  /** First empty slot. #NDN_INVALID_ID if the table is full. */
+  ndn_table_id_t free_head;
+  ndn_fib_stats_t stats;
+#if NDN_FIB_HASH_INDEX
+  /** Number of buckets in the prefix index. */
+  uint32_t bucket_count;
+  /** Entries deeper than #NDN_FIB_INDEX_MAX_DEPTH, which turn the index off. */
+  ndn_table_id_t deep_count;
+  /** Deepest prefix indexed. Every shorter length is populated too. */
+  uint8_t max_depth;
+  /** Prefixes indexed per length. */
+  ndn_table_id_t depth_count[NDN_FIB_INDEX_MAX_DEPTH + 1];
+#endif
   ndn_fib_entry_t slots[];
 } ndn_fib_t;
 
 #define NDN_FIB_RESERVE_SIZE(entry_count) \
   (sizeof(ndn_fib_t) + sizeof(ndn_fib_entry_t) * (entry_count))
 
+#if NDN_FIB_HASH_INDEX
+/** Number of prefix index buckets for a NameTree of @c nametree_size nodes,
+ * keeping load factor under 1/2.
+ */
+#define NDN_FIB_BUCKET_COUNT(nametree_size) (2 * (nametree_size))
+/** The memory reserved for the prefix index, after #NDN_FIB_RESERVE_SIZE.
+ */
+#define NDN_FIB_INDEX_SIZE(nametree_size) \
+  (sizeof(ndn_fib_marker_t) * (nametree_size) + \
+   sizeof(ndn_table_id_t) * NDN_FIB_BUCKET_COUNT(nametree_size))
+#else
+#define NDN_FIB_INDEX_SIZE(nametree_size) 0
+#endif
+
+/** Initialize FIB at specified memory space.
+ * @param[in] memory Memory of #NDN_FIB_RESERVE_SIZE(@c capacity) +
+ *                   #NDN_FIB_INDEX_SIZE(@c nametree->capacity) bytes, aligned to 8 bytes.
+ * @param[in] faces Pool for large next hop sets, needing one bitmap per entry at most.
+ *                  NULL if no entry has more than #NDN_FACE_SET_INLINE_SIZE next hops.
+ */
 void
-ndn_fib_init(void* memory, ndn_table_id_t capacity, ndn_nametree_t* nametree);
+ndn_fib_init(void* memory, ndn_table_id_t capacity, ndn_nametree_t* nametree,
+             ndn_face_set_pool_t* faces);
 
 void
 ndn_fib_unregister_face(ndn_fib_t* self, ndn_table_id_t face_id);
 
+/** Get the FIB entry attached to a NameTree node.
+ * @return NULL if @c node is NULL or has no FIB entry.
+ */
+ndn_fib_entry_t*
+ndn_fib_node_entry(ndn_fib_t* self, nametree_entry_t* node);
+
+/** Get or create the FIB entry attached to a NameTree node.
+ * @return NULL if @c node is NULL or the FIB is full.
+ */
+ndn_fib_entry_t*
+ndn_fib_node_insert(ndn_fib_t* self, nametree_entry_t* node);
+
 ndn_fib_entry_t*
 ndn_fib_find_or_insert(ndn_fib_t* self, uint8_t* prefix, size_t length);
 
@@ -74,9 +184,27 @@ ndn_fib_find(ndn_fib_t* self, uint8_t* prefix, size_t length);
 void
 ndn_fib_remove_entry_if_empty(ndn_fib_t* self, ndn_fib_entry_t* entry);
 
+/** Find the FIB entry of the longest prefix of a name.
+ * @param[in] prefix The encoded name.
+ * @param[in] length The length of @c prefix.
+ * @return NULL if no prefix has a FIB entry.
+ */
 ndn_fib_entry_t*
 ndn_fib_prefix_match(ndn_fib_t* self, uint8_t* prefix, size_t length);
 
+/** Find the FIB entry of the longest prefix of a name, whose prefixes are hashed already.
+ *
+ * Same as ndn_fib_prefix_match(), but the index probes take the hashes of
+ * @c name_hash up to ndn_name_hash#short_depth instead of hashing the name again.
+ * @param[in] prefix The encoded name.
+ * @param[in] length The length of @c prefix.
+ * @param[in] name_hash Hashes of @c prefix from ndn_name_hash_compute(), or NULL.
+ * @return NULL if no prefix has a FIB entry.
+ */
+ndn_fib_entry_t*
+ndn_fib_prefix_match_hashed(ndn_fib_t* self, uint8_t* prefix, size_t length,
+                            const ndn_name_hash_t* name_hash);
+
 /*@}*/
 
 #ifdef __cplusplus
@@ -8,7 +8,7 @@
  * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
  */
 #define ENABLE_NDN_LOG_INFO 0
-#define ENABLE_NDN_LOG_DEBUG 1
+#define ENABLE_NDN_LOG_DEBUG 0
 #define ENABLE_NDN_LOG_ERROR 1
 #include "forwarder.h"
 #include "../ndn-constants.h"
@@ -17,95 +17,433 @@
 #include "../encode/name.h"
 #include "../encode/data.h"
 #include "../util/logger.h"
+#include "../util/scratch.h"
+#include "../encode/packet-view.h"
+#include "../encode/name-hash.h"
+#include <limits.h>
+#include <string.h>
 
-uint8_t encoding_buf[2048];
+// Bytes of scratch memory an Interest is encoded into by ndn_forwarder_express_interest_struct()
+#define FWD_INTEREST_ENCODE_SIZE 2048
 
 static ndn_forwarder_t forwarder;
 
+// Updates replicated to forwarder shards, and packets the application hands to one
+enum fwd_shard_op {
+  FWD_SHARD_REGISTER_FACE,
+  FWD_SHARD_UNREGISTER_FACE,
+  FWD_SHARD_ADD_ROUTE,
+  FWD_SHARD_REMOVE_ROUTE,
+  FWD_SHARD_REMOVE_ALL_ROUTES,
+  FWD_SHARD_REGISTER_PREFIX,
+  FWD_SHARD_UNREGISTER_PREFIX,
+  FWD_SHARD_SET_STRATEGY,
+  FWD_SHARD_EXPRESS_INTEREST,
+  FWD_SHARD_PUT_DATA,
+};
+
+// Platform event loop used by ndn_forwarder_run()
+static ndn_forwarder_wait_func fwd_wait = NULL;
+static void* fwd_wait_userdata = NULL;
+
+// Pool faces receive packets into
+static ndn_pktbuf_pool_t* fwd_packet_pool = NULL;
+
+// Memory used by ndn_forwarder_init()
+static uint64_t forwarder_memory[NDN_FORWARDER_DEFAULT_SIZE / sizeof(uint64_t) + 1];
+
+#if NDN_FORWARDER_SHARDING
+// The forwarder the calling thread acts on:
+// the shard inside ndn_forwarder_shard_process(), the main forwarder otherwise
+static _Thread_local ndn_forwarder_t* fwd = &forwarder;
+
+// Shards are laid out shard_stride bytes apart from shard_memory
+static uint8_t* shard_memory;
+static size_t shard_stride;
+static uint32_t shard_count = 0;
+static uint8_t shard_components;
+
+#define FWD_SHARD(index) ((ndn_forwarder_shard_t*)(shard_memory + (size_t)(index) * shard_stride))
+
+// Faces are shared by the shards but do not lock around sending,
+// so sends to a face are serialized by a lock per face ID
+static atomic_flag* shard_send_locks;
+static ndn_table_id_t shard_send_lock_count;
+
+// The face whose lock the calling thread holds, so a face sending
+// packets back through the forwarder does not wait for itself
+static _Thread_local ndn_table_id_t shard_send_locked = NDN_INVALID_ID;
+#else
+static ndn_forwarder_t* const fwd = &forwarder;
+#endif
+
 // face_id is optional
 static int
-fwd_on_incoming_interest(uint8_t* interest,
-                         size_t length,
-                         interest_options_t* options,
-                         uint8_t* name,
-                         size_t name_len,
+fwd_on_incoming_interest(ndn_packet_index_t* index,
                          ndn_table_id_t face_id);
 
 static int
-fwd_on_outgoing_interest(uint8_t* interest,
-                         size_t length,
-                         uint8_t* name,
-                         size_t name_len,
+fwd_on_outgoing_interest(ndn_interest_view_t* view,
+                         ndn_fib_entry_t* fib_entry,
                          ndn_pit_entry_t* entry,
                          ndn_table_id_t face_id);
 
 static int
-fwd_data_pipeline(uint8_t* data,
-                  size_t length,
-                  uint8_t* name,
-                  size_t name_len,
+fwd_data_pipeline(ndn_packet_index_t* index,
                   ndn_table_id_t face_id);
 
-static ndn_bitset_t
+static uint64_t
 fwd_multicast(uint8_t* packet,
               size_t length,
-              ndn_bitset_t out_faces,
-              ndn_table_id_t in_face);
+              ndn_pktbuf_t* buf,
+              const ndn_face_set_t* out_faces,
+              ndn_table_id_t in_face,
+              ndn_pit_entry_t* entry);
+
+static void
+fwd_send(ndn_table_id_t face_id, uint8_t* packet, size_t length, ndn_pktbuf_t* buf);
+
+static int
+fwd_receive(ndn_table_id_t face_id, uint8_t* packet, size_t length);
+
+static int
+fwd_process_packet(ndn_table_id_t face_id, uint8_t* packet, size_t length);
+
+static int
+fwd_shards_check(size_t prefix_length);
+
+#if NDN_FORWARDER_SHARDING
+static int
+fwd_shards_dispatch(ndn_table_id_t face_id, uint8_t* packet, size_t length);
+
+static int
+fwd_shards_post(uint8_t op, const ndn_packet_index_t* index, const uint8_t* packet, size_t length,
+                ndn_on_data_func on_data, ndn_on_timeout_func on_timeout, void* userdata);
+
+static int
+fwd_shard_try_run(ndn_forwarder_shard_t* shard);
+
+static void
+fwd_shards_add_stats(ndn_forwarder_stats_t* stats);
+
+static void
+fwd_shards_add_face_stats(ndn_table_id_t face_id, ndn_face_stats_t* stats);
+#endif
+
+static void
+fwd_shards_replicate(uint8_t op, ndn_face_intf_t* face, const uint8_t* prefix, size_t length,
+                     ndn_on_interest_func on_interest, void* userdata, uint8_t strategy);
+
+static void
+fwd_shards_sync(void);
 
 /////////////////////////////////////////////////////////////////////////////////
 
-void
-ndn_forwarder_init(void)
+size_t
+ndn_forwarder_reserve_size(const ndn_forwarder_config_t* config)
 {
-  uint8_t* ptr = (uint8_t*)forwarder.memory;
-  ndn_msgqueue_init();
+  // Sizes are computed in 64 bits so overflow of size_t can be detected
+  uint64_t size = NDN_FORWARDER_RESERVE_SIZE((uint64_t)config->nametree_size,
+                                             (uint64_t)config->facetab_size,
+                                             (uint64_t)config->fib_size,
+                                             (uint64_t)config->pit_size,
+                                             (uint64_t)config->cs_size,
+                                             (uint64_t)config->cs_bytes,
+                                             (uint64_t)config->dnl_size,
+                                             (uint64_t)config->faceset_size) + sizeof(uint64_t) - 1;
+  if (size > SIZE_MAX)
+    return 0;
+  return (size_t)size;
+}
 
-  ndn_nametree_init(ptr, NDN_NAMETREE_MAX_SIZE);
-  forwarder.nametree = (ndn_nametree_t*)ptr;
-  ptr += NDN_NAMETREE_RESERVE_SIZE(NDN_NAMETREE_MAX_SIZE);
+static int
+fwd_check_config(const ndn_forwarder_config_t* config)
+{
+  if (config->nametree_size < 2 || config->facetab_size == 0 || config->fib_size == 0 ||
+      config->pit_size == 0 || config->cs_size == 0 || config->cs_bytes < NDN_CS_BLOCK_SIZE)
+    return NDN_INVALID_ARG;
+  if (config->nametree_size >= NDN_INVALID_ID || config->facetab_size >= NDN_INVALID_ID ||
+      config->fib_size >= NDN_INVALID_ID || config->pit_size >= NDN_INVALID_ID ||
+      config->cs_size >= NDN_INVALID_ID || config->cs_bytes / NDN_CS_BLOCK_SIZE >= UINT32_MAX)
+    return NDN_OVERSIZE;
+  // Face set bitmaps are indexed by ndn_table_id_t
+  if (NDN_FORWARDER_FACE_SET_COUNT((uint64_t)config->faceset_size, (uint64_t)config->fib_size,
+                                   (uint64_t)config->pit_size) >= NDN_INVALID_ID)
+    return NDN_OVERSIZE;
+  return NDN_SUCCESS;
+}
 
-  ndn_facetab_init(ptr, NDN_FACE_TABLE_MAX_SIZE);
-  forwarder.facetab = (ndn_face_table_t*)ptr;
-  ptr += NDN_FACE_TABLE_RESERVE_SIZE(NDN_FACE_TABLE_MAX_SIZE);
+// Place the tables of self at ptr, which is aligned to uint64_t
+static void
+fwd_init_tables(ndn_forwarder_t* self, const ndn_forwarder_config_t* config, uint8_t* ptr)
+{
+  ndn_table_id_t faceset_count;
+
+  memset(&self->counters, 0, sizeof(self->counters));
+  self->stats_hook = NULL;
+  self->stats_timer = NULL;
+  self->rx_buf = NULL;
+#if NDN_FORWARDER_TX_BATCH_SIZE > 0
+  self->tx.count = 0;
+  self->tx.used = 0;
+  self->tx.flushing = false;
+#endif
+
+  ndn_nametree_init(ptr, config->nametree_size);
+  self->nametree = (ndn_nametree_t*)ptr;
+  ptr += NDN_FORWARDER_ALIGN_SIZE(NDN_NAMETREE_RESERVE_SIZE(config->nametree_size));
+
+  ndn_facetab_init(ptr, config->facetab_size);
+  self->facetab = (ndn_face_table_t*)ptr;
+  ptr += NDN_FORWARDER_ALIGN_SIZE(NDN_FACE_TABLE_RESERVE_SIZE(config->facetab_size));
+
+  faceset_count = (ndn_table_id_t)NDN_FORWARDER_FACE_SET_COUNT((uint64_t)config->faceset_size,
+                                                               (uint64_t)config->fib_size,
+                                                               (uint64_t)config->pit_size);
+  ndn_faceset_pool_init(ptr, faceset_count, config->facetab_size);
+  self->faces = (ndn_face_set_pool_t*)ptr;
+  ptr += NDN_FORWARDER_ALIGN_SIZE(NDN_FACE_SET_POOL_RESERVE_SIZE(faceset_count, config->facetab_size));
+
+  ndn_fib_init(ptr, config->fib_size, self->nametree, self->faces);
+  self->fib = (ndn_fib_t*)ptr;
+  ptr += NDN_FORWARDER_ALIGN_SIZE(NDN_FIB_RESERVE_SIZE(config->fib_size) +
+                                  NDN_FIB_INDEX_SIZE(config->nametree_size));
+
+  ndn_pit_init(ptr, config->pit_size, self->nametree, self->faces);
+  self->pit = (ndn_pit_t*)ptr;
+  ptr += NDN_FORWARDER_ALIGN_SIZE(NDN_PIT_RESERVE_SIZE(config->pit_size));
+
+  ndn_dnl_init(ptr, (uint32_t)NDN_FORWARDER_DNL_BUCKETS((uint64_t)config->dnl_size));
+  self->dnl = (ndn_dnl_t*)ptr;
+  ptr += NDN_FORWARDER_ALIGN_SIZE(NDN_DNL_RESERVE_SIZE(NDN_FORWARDER_DNL_BUCKETS((uint64_t)config->dnl_size)));
+
+  ndn_cs_init(ptr, config->cs_size, config->cs_bytes, self->nametree);
+  self->cs = (ndn_cs_t*)ptr;
+}
 
-  ndn_fib_init(ptr, NDN_FIB_MAX_SIZE, forwarder.nametree);
-  forwarder.fib = (ndn_fib_t*)ptr;
-  ptr += NDN_FIB_RESERVE_SIZE(NDN_FIB_MAX_SIZE);
+int
+ndn_forwarder_init_ex(const ndn_forwarder_config_t* config, void* memory, size_t len)
+{
+  uint8_t* ptr = (uint8_t*)memory;
+  size_t required;
+  int ret;
 
-  ndn_pit_init(ptr, NDN_PIT_MAX_SIZE, forwarder.nametree);
-  forwarder.pit = (ndn_pit_t*)ptr;
-  ptr += NDN_PIT_RESERVE_SIZE(NDN_PIT_MAX_SIZE);
+  if (config == NULL || memory == NULL)
+    return NDN_INVALID_POINTER;
+  ret = fwd_check_config(config);
+  if (ret != NDN_SUCCESS)
+    return ret;
+  required = ndn_forwarder_reserve_size(config);
+  if (required == 0 || len < required)
+    return NDN_OVERSIZE;
 
-  ndn_cs_init(ptr, NDN_CS_MAX_SIZE, forwarder.nametree);
-  forwarder.cs = (ndn_cs_t*)ptr;
-  ptr += NDN_CS_RESERVE_SIZE(NDN_CS_MAX_SIZE);
+  ptr += (sizeof(uint64_t) - (uintptr_t)ptr % sizeof(uint64_t)) % sizeof(uint64_t);
+  ndn_msgqueue_init();
+#if NDN_FORWARDER_SHARDING
+  shard_count = 0;
+#endif
+  // A seed unknown to senders, so that they cannot pick names colliding in the tables
+  ndn_name_hash_set_seed(ndn_name_hash_mix(ndn_time_now_us() ^ (uintptr_t)memory));
+  fwd_init_tables(&forwarder, config, ptr);
+  return NDN_SUCCESS;
+}
 
-  dll_init();
+int
+ndn_forwarder_init(void)
+{
+  const ndn_forwarder_config_t config = {
+    .nametree_size = NDN_NAMETREE_MAX_SIZE,
+    .facetab_size = NDN_FACE_TABLE_MAX_SIZE,
+    .fib_size = NDN_FIB_MAX_SIZE,
+    .pit_size = NDN_PIT_MAX_SIZE,
+    .cs_size = NDN_CS_MAX_SIZE,
+    .cs_bytes = NDN_CS_MAX_BYTES,
+    .dnl_size = NDN_FORWARDER_DNL_DEFAULT_SIZE,
+    .faceset_size = NDN_FORWARDER_FACE_SET_DEFAULT_COUNT(NDN_FIB_MAX_SIZE, NDN_PIT_MAX_SIZE),
+  };
+  int ret = ndn_forwarder_init_ex(&config, forwarder_memory, sizeof(forwarder_memory));
+  if (ret != NDN_SUCCESS)
+    NDN_LOG_ERROR("[FORWARDER] Default table sizes do not fit, err %d\n", ret);
+  return ret;
 }
 
 const ndn_forwarder_t*
 ndn_forwarder_get(void){
-  return &forwarder;
+  return fwd;
+}
+
+static void
+fwd_fill_stats(const ndn_forwarder_t* self, ndn_forwarder_stats_t* stats)
+{
+  stats->counters = self->counters;
+  stats->pit = self->pit->stats;
+  stats->cs = self->cs->stats;
+  stats->fib = self->fib->stats;
+  stats->dnl = self->dnl->stats;
+  stats->pit_count = self->pit->count;
+  stats->pit_capacity = self->pit->capacity;
+  stats->cs_count = self->cs->count;
+  stats->cs_capacity = self->cs->capacity;
+  stats->fib_count = self->fib->count;
+  stats->fib_capacity = self->fib->capacity;
+  stats->face_count = self->facetab->count;
+  stats->face_capacity = self->facetab->capacity;
+  stats->dnl_count = self->dnl->count;
+  stats->dnl_capacity = self->dnl->bucket_count * NDN_DNL_BUCKET_SIZE;
+  stats->dnl_fp_rate = ndn_dnl_fp_rate(self->dnl);
+  stats->cs_used_bytes = self->cs->used_bytes;
+  stats->cs_arena_bytes = (size_t)self->cs->block_count * NDN_CS_BLOCK_SIZE;
+}
+
+int
+ndn_forwarder_get_stats(ndn_forwarder_stats_t* stats)
+{
+  if(stats == NULL)
+    return NDN_INVALID_POINTER;
+  fwd_fill_stats(fwd, stats);
+#if NDN_FORWARDER_SHARDING
+  if(shard_count > 0 && fwd == &forwarder)
+    fwd_shards_add_stats(stats);
+#endif
+  return NDN_SUCCESS;
+}
+
+int
+ndn_forwarder_get_face_stats(const ndn_face_intf_t* face, ndn_face_stats_t* stats)
+{
+  if(face == NULL || stats == NULL)
+    return NDN_INVALID_POINTER;
+  if(face->face_id >= fwd->facetab->capacity || fwd->facetab->slots[face->face_id] != face)
+    return NDN_FWD_INVALID_FACE;
+  *stats = *ndn_facetab_stats(fwd->facetab, face->face_id);
+#if NDN_FORWARDER_SHARDING
+  if(shard_count > 0 && fwd == &forwarder)
+    fwd_shards_add_face_stats(face->face_id, stats);
+#endif
+  return NDN_SUCCESS;
+}
+
+int
+ndn_forwarder_get_face_measurements(const ndn_face_intf_t* face, ndn_face_measurements_t* measurements)
+{
+  if(face == NULL || measurements == NULL)
+    return NDN_INVALID_POINTER;
+  if(face->face_id >= fwd->facetab->capacity || fwd->facetab->slots[face->face_id] != face)
+    return NDN_FWD_INVALID_FACE;
+  *measurements = *ndn_facetab_measurements(fwd->facetab, face->face_id);
+  return NDN_SUCCESS;
+}
+
+static void
+fwd_stats_dump(void *arg)
+{
+  ndn_forwarder_stats_t stats;
+  (void)arg;
+
+  fwd->stats_timer = ndn_timer_schedule(ndn_time_now_ms() + fwd->stats_interval, fwd_stats_dump, NULL);
+  ndn_forwarder_get_stats(&stats);
+  fwd->stats_hook(&stats, fwd->stats_userdata);
+}
+
+void
+ndn_forwarder_set_stats_hook(ndn_forwarder_stats_hook_func hook, uint32_t interval, void* userdata)
+{
+  fwd->stats_hook = hook;
+  fwd->stats_userdata = userdata;
+  fwd->stats_interval = interval;
+  ndn_timer_cancel(fwd->stats_timer);
+  fwd->stats_timer = NULL;
+  if(hook != NULL){
+    fwd->stats_timer = ndn_timer_schedule(ndn_time_now_ms() + interval, fwd_stats_dump, NULL);
+  }
 }
 
 void
 ndn_forwarder_process(void){
   ndn_msgqueue_process();
+  ndn_pit_process_timeout(fwd->pit, ndn_time_now_ms());
+  ndn_forwarder_flush();
+}
+
+ndn_time_ms_t
+ndn_forwarder_next_deadline(void){
+  ndn_time_ms_t deadline;
+  if(!ndn_msgqueue_empty() || !ndn_msgqueue_mt_empty()){
+    return ndn_time_now_ms();
+  }
+  deadline = ndn_pit_next_deadline(fwd->pit);
+  if(ndn_timer_next_deadline() < deadline){
+    deadline = ndn_timer_next_deadline();
+  }
+  return deadline;
+}
+
+void
+ndn_forwarder_set_wait_func(ndn_forwarder_wait_func wait, void* userdata){
+  fwd_wait = wait;
+  fwd_wait_userdata = userdata;
+}
+
+void
+ndn_forwarder_set_packet_pool(ndn_pktbuf_pool_t* pool){
+  fwd_packet_pool = pool;
+}
+
+ndn_pktbuf_pool_t*
+ndn_forwarder_get_packet_pool(void){
+  return fwd_packet_pool;
+}
+
+int
+ndn_forwarder_run(uint32_t timeout){
+  ndn_time_ms_t now, deadline;
+  int ret = 0;
+
+  ndn_forwarder_process();
+  now = ndn_time_now_ms();
+  deadline = ndn_forwarder_next_deadline();
+  if(deadline > now + timeout){
+    deadline = now + timeout;
+  }
+  if(fwd_wait != NULL){
+    ret = fwd_wait(deadline, fwd_wait_userdata);
+  }
+  else if(deadline > now){
+    ndn_time_delay(deadline - now);
+  }
+  ndn_forwarder_process();
+  return ret;
 }
 
 int
 ndn_forwarder_register_face(ndn_face_intf_t* face)
 {
+  int ret;
+
   if(face == NULL)
     return NDN_INVALID_POINTER;
   if(face->face_id != NDN_INVALID_ID)
     return NDN_FWD_NO_EFFECT;
-  face->face_id = ndn_facetab_register(forwarder.facetab, face);
+  ret = fwd_shards_check(0);
+  if(ret != NDN_SUCCESS)
+    return ret;
+  face->face_id = ndn_facetab_register(fwd->facetab, face);
   if(face->face_id == NDN_INVALID_ID)
     return NDN_FWD_FACE_TABLE_FULL;
+  fwd_shards_replicate(FWD_SHARD_REGISTER_FACE, face, NULL, 0, NULL, NULL, 0);
   return NDN_SUCCESS;
 }
 
+static void
+fwd_unregister_face_id(ndn_table_id_t face_id)
+{
+  // Queued packets must not go to a face registered later with the same ID
+  ndn_forwarder_flush();
+  ndn_fib_unregister_face(fwd->fib, face_id);
+  ndn_pit_unregister_face(fwd->pit, face_id);
+  ndn_facetab_unregister(fwd->facetab, face_id);
+}
+
 int
 ndn_forwarder_unregister_face(ndn_face_intf_t* face)
 {
@@ -113,11 +451,13 @@ ndn_forwarder_unregister_face(ndn_face_intf_t* face)
     return NDN_INVALID_POINTER;
   if(face->face_id == NDN_INVALID_ID)
     return NDN_FWD_NO_EFFECT;
-  if(face->face_id >= forwarder.facetab->capacity)
+  if(face->face_id >= fwd->facetab->capacity)
     return NDN_FWD_INVALID_FACE;
-  ndn_fib_unregister_face(forwarder.fib, face->face_id);
-  ndn_pit_unregister_face(forwarder.pit, face->face_id);
-  ndn_facetab_unregister(forwarder.facetab, face->face_id);
+  fwd_unregister_face_id(face->face_id);
+  // Not checked first: destroying a face cannot fail, and the face may be freed
+  // once this returns, so every shard must have dropped it by then
+  fwd_shards_replicate(FWD_SHARD_UNREGISTER_FACE, face, NULL, 0, NULL, NULL, 0);
+  fwd_shards_sync();
   face->face_id = NDN_INVALID_ID;
   return NDN_SUCCESS;
 }
@@ -129,37 +469,58 @@ ndn_forwarder_add_route(ndn_face_intf_t* face, uint8_t* prefix, size_t length){
 
   if(face == NULL)
     return NDN_INVALID_POINTER;
-  if(face->face_id >= forwarder.facetab->capacity)
+  if(face->face_id >= fwd->facetab->capacity)
     return NDN_FWD_INVALID_FACE;
   ret = tlv_check_type_length(prefix, length, TLV_Name);
+  if(ret != NDN_SUCCESS)
+    return ret;
+  ret = fwd_shards_check(length);
   if(ret != NDN_SUCCESS)
     return ret;
 
-  fib_entry = ndn_fib_find_or_insert(forwarder.fib, prefix, length);
+  fib_entry = ndn_fib_find_or_insert(fwd->fib, prefix, length);
   if (fib_entry == NULL)
     return NDN_FWD_FIB_FULL;
-  fib_entry->nexthop = bitset_set(fib_entry->nexthop, face->face_id);
-  return NDN_SUCCESS;
+  ret = ndn_faceset_add(fwd->faces, &fib_entry->nexthop, face->face_id);
+  if(ret == NDN_SUCCESS)
+    fwd_shards_replicate(FWD_SHARD_ADD_ROUTE, face, prefix, length, NULL, NULL, 0);
+  else
+    ndn_fib_remove_entry_if_empty(fwd->fib, fib_entry);
+  return ret;
 }
 
 int
 ndn_forwarder_add_route_by_str(ndn_face_intf_t* face, const char* prefix, size_t length)
 {
   ndn_name_t name_prefix;
-  ndn_name_from_string(&name_prefix, prefix, length);
-  ndn_encoder_t encoder;
-  encoder_init(&encoder, encoding_buf, sizeof(encoding_buf));
-  ndn_name_tlv_encode(&encoder, &name_prefix);
-  return ndn_forwarder_add_route(face, encoder.output_value, encoder.offset);
+  int ret = ndn_name_from_string(&name_prefix, prefix, length);
+  if(ret != NDN_SUCCESS)
+    return ret;
+  return ndn_forwarder_add_route_by_name(face, &name_prefix);
+}
+
+// Encode a name into scratch memory, released by the caller
+static int
+fwd_encode_name(const ndn_name_t* name, ndn_encoder_t* encoder)
+{
+  uint32_t size = ndn_name_probe_block_size(name);
+  uint8_t* buf = ndn_scratch_alloc(size);
+  if(buf == NULL)
+    return NDN_OVERSIZE;
+  encoder_init_nozero(encoder, buf, size);
+  return ndn_name_tlv_encode(encoder, name);
 }
 
 int
 ndn_forwarder_add_route_by_name(ndn_face_intf_t* face, const ndn_name_t* prefix)
 {
+  ndn_scratch_mark_t mark = ndn_scratch_mark();
   ndn_encoder_t encoder;
-  encoder_init(&encoder, encoding_buf, sizeof(encoding_buf));
-  ndn_name_tlv_encode(&encoder, prefix);
-  return ndn_forwarder_add_route(face, encoder.output_value, encoder.offset);
+  int ret = fwd_encode_name(prefix, &encoder);
+  if(ret == NDN_SUCCESS)
+    ret = ndn_forwarder_add_route(face, encoder.output_value, encoder.offset);
+  ndn_scratch_release(mark);
+  return ret;
 }
 
 int
@@ -169,17 +530,21 @@ ndn_forwarder_remove_route(ndn_face_intf_t* face, uint8_t* prefix, size_t length
 
   if(face == NULL)
     return NDN_INVALID_POINTER;
-  if(face->face_id >= forwarder.facetab->capacity)
+  if(face->face_id >= fwd->facetab->capacity)
     return NDN_FWD_INVALID_FACE;
   ret = tlv_check_type_length(prefix, length, TLV_Name);
+  if(ret != NDN_SUCCESS)
+    return ret;
+  ret = fwd_shards_check(length);
   if(ret != NDN_SUCCESS)
     return ret;
 
-  ndn_fib_entry_t* fib_entry = ndn_fib_find(forwarder.fib, prefix, length);
+  ndn_fib_entry_t* fib_entry = ndn_fib_find(fwd->fib, prefix, length);
   if (fib_entry == NULL)
     return NDN_FWD_NO_EFFECT;
-  fib_entry->nexthop = bitset_unset(fib_entry->nexthop, face->face_id);
-  ndn_fib_remove_entry_if_empty(forwarder.fib, fib_entry);
+  ndn_faceset_remove(fwd->faces, &fib_entry->nexthop, face->face_id);
+  ndn_fib_remove_entry_if_empty(fwd->fib, fib_entry);
+  fwd_shards_replicate(FWD_SHARD_REMOVE_ROUTE, face, prefix, length, NULL, NULL, 0);
   return NDN_SUCCESS;
 }
 
@@ -189,12 +554,41 @@ ndn_forwarder_remove_all_routes(uint8_t* prefix, size_t length)
   int ret = tlv_check_type_length(prefix, length, TLV_Name);
   if(ret != NDN_SUCCESS)
     return ret;
+  ret = fwd_shards_check(length);
+  if(ret != NDN_SUCCESS)
+    return ret;
+
+  ndn_fib_entry_t* fib_entry = ndn_fib_find(fwd->fib, prefix, length);
+  if (fib_entry == NULL)
+    return NDN_FWD_NO_EFFECT;
+  ndn_faceset_clear(fwd->faces, &fib_entry->nexthop);
+  ndn_fib_remove_entry_if_empty(fwd->fib, fib_entry);
+  fwd_shards_replicate(FWD_SHARD_REMOVE_ALL_ROUTES, NULL, prefix, length, NULL, NULL, 0);
+  return NDN_SUCCESS;
+}
+
+int
+ndn_forwarder_set_strategy(uint8_t* prefix, size_t length, uint8_t strategy)
+{
+  ndn_fib_entry_t* fib_entry;
+  int ret;
+
+  if (strategy < NDN_FWD_STRATEGY_MULTICAST || strategy > NDN_FWD_STRATEGY_ADAPTIVE)
+    return NDN_INVALID_ARG;
+  ret = tlv_check_type_length(prefix, length, TLV_Name);
+  if (ret != NDN_SUCCESS)
+    return ret;
+  ret = fwd_shards_check(length);
+  if (ret != NDN_SUCCESS)
+    return ret;
 
-  ndn_fib_entry_t* fib_entry = ndn_fib_find(forwarder.fib, prefix, length);
+  fib_entry = ndn_fib_find(fwd->fib, prefix, length);
   if (fib_entry == NULL)
     return NDN_FWD_NO_EFFECT;
-  fib_entry->nexthop = 0;
-  ndn_fib_remove_entry_if_empty(forwarder.fib, fib_entry);
+  fib_entry->strategy = strategy;
+  fib_entry->strategy_count = 0;
+  fib_entry->strategy_last = NDN_INVALID_ID;
+  fwd_shards_replicate(FWD_SHARD_SET_STRATEGY, NULL, prefix, length, NULL, NULL, strategy);
   return NDN_SUCCESS;
 }
 
@@ -208,12 +602,16 @@ ndn_forwarder_register_prefix(uint8_t* prefix, size_t length,
     return ret;
   if (on_interest == NULL)
     return NDN_INVALID_POINTER;
+  ret = fwd_shards_check(length);
+  if(ret != NDN_SUCCESS)
+    return ret;
 
-  ndn_fib_entry_t* fib_entry = ndn_fib_find_or_insert(forwarder.fib, prefix, length);
+  ndn_fib_entry_t* fib_entry = ndn_fib_find_or_insert(fwd->fib, prefix, length);
   if (fib_entry == NULL)
     return NDN_FWD_FIB_FULL;
   fib_entry->on_interest = on_interest;
   fib_entry->userdata = userdata;
+  fwd_shards_replicate(FWD_SHARD_REGISTER_PREFIX, NULL, prefix, length, on_interest, userdata, 0);
   return NDN_SUCCESS;
 }
 
@@ -222,57 +620,73 @@ ndn_forwarder_register_name_prefix(const ndn_name_t* prefix,
                                    ndn_on_interest_func on_interest,
                                    void* userdata)
 {
+  ndn_scratch_mark_t mark = ndn_scratch_mark();
   ndn_encoder_t encoder;
-  encoder_init(&encoder, encoding_buf, sizeof(encoding_buf));
-  ndn_name_tlv_encode(&encoder, prefix);
-  return ndn_forwarder_register_prefix(encoder.output_value, encoder.offset, on_interest, userdata);
+  int ret = fwd_encode_name(prefix, &encoder);
+  if(ret == NDN_SUCCESS)
+    ret = ndn_forwarder_register_prefix(encoder.output_value, encoder.offset, on_interest, userdata);
+  ndn_scratch_release(mark);
+  return ret;
 }
 
 int
 ndn_forwarder_unregister_prefix(uint8_t* prefix, size_t length)
 {
   int ret = tlv_check_type_length(prefix, length, TLV_Name);
+  if(ret != NDN_SUCCESS)
+    return ret;
+  ret = fwd_shards_check(length);
   if(ret != NDN_SUCCESS)
     return ret;
 
-  ndn_fib_entry_t* fib_entry = ndn_fib_find(forwarder.fib, prefix, length);
+  ndn_fib_entry_t* fib_entry = ndn_fib_find(fwd->fib, prefix, length);
   if (fib_entry == NULL)
     return NDN_FWD_NO_EFFECT;
   fib_entry->on_interest = NULL;
   fib_entry->userdata = NULL;
-  ndn_fib_remove_entry_if_empty(forwarder.fib, fib_entry);
+  ndn_fib_remove_entry_if_empty(fwd->fib, fib_entry);
+  fwd_shards_replicate(FWD_SHARD_UNREGISTER_PREFIX, NULL, prefix, length, NULL, NULL, 0);
   return NDN_SUCCESS;
 }
 
-int
-ndn_forwarder_express_interest(uint8_t* interest, size_t length,
-                               ndn_on_data_func on_data,
-                               ndn_on_timeout_func on_timeout,
-                               void* userdata)
+// Record a (Name, Nonce) pair in the Dead Nonce List.
+// Returns whether it was already there if check is set, false otherwise.
+// Interests without a Nonce are never recorded.
+static bool
+fwd_dnl_seen(const ndn_name_hash_t* name_hash, uint32_t nonce, bool check)
 {
-  int ret;
-  interest_options_t options;
-  uint8_t *name;
-  size_t name_len;
-  ndn_pit_entry_t* pit_entry;
-
-  if(interest == NULL || on_data == NULL)
-    return NDN_INVALID_POINTER;
-
-  ret = tlv_interest_get_header(interest, length, &options, &name, &name_len);
-  if(ret != NDN_SUCCESS)
-    return ret;
+  uint64_t hash;
+
+  if (nonce == 0)
+    return false;
+  hash = ndn_dnl_hash_name(name_hash->full, nonce);
+  ndn_dnl_age(fwd->dnl, ndn_time_now_ms());
+  if (check && ndn_dnl_find(fwd->dnl, hash))
+    return true;
+  ndn_dnl_insert(fwd->dnl, hash);
+  return false;
+}
 
+static int
+fwd_express_interest_matched(ndn_interest_view_t* view,
+                             ndn_nametree_match_t* match,
+                             ndn_on_data_func on_data,
+                             ndn_on_timeout_func on_timeout,
+                             void* userdata)
+{
+  ndn_pit_entry_t* pit_entry;
   ndn_cs_entry_t* cs_entry;
-  cs_entry = ndn_cs_prefix_match(forwarder.cs, name, name_len);
+
+  cs_entry = ndn_cs_node_entry(fwd->cs, match->longest[NDN_NAMETREE_CS_TYPE]);
   if (cs_entry != NULL){
     NDN_LOG_DEBUG("[FORWARDER] (ndn_forwarder_express_interest) Prefix match in content store found\n");
-    if (cs_entry->options.can_be_prefix || ndn_cs_find(forwarder.cs, name, name_len) == cs_entry){
+    if (cs_entry->options.can_be_prefix || match->longest[NDN_NAMETREE_CS_TYPE] == match->exact){
 
       // check if either the CS entry is fresh or must_be_fresh of the entry is false
-      int cs_entry_freshness = dll_check_one_cs_entry_freshness(cs_entry);
-      if ((cs_entry_freshness == 0) || ((cs_entry_freshness == -1) && (cs_entry->options.must_be_fresh == false))){
-        cs_entry->options = options;
+      if (ndn_cs_entry_is_fresh(cs_entry, ndn_time_now_ms()) || !cs_entry->options.must_be_fresh){
+        fwd->counters.cs_hits ++;
+        ndn_cs_touch(fwd->cs, cs_entry);
+        cs_entry->options = view->options;
         cs_entry->on_data = on_data;
         cs_entry->userdata = userdata;
 
@@ -286,22 +700,68 @@ ndn_forwarder_express_interest(uint8_t* interest, size_t length,
       }else{
         NDN_LOG_DEBUG("The found CS entry is not fresh anymore, but must be fresh\n");
 
-        dll_remove_cs_entry(cs_entry);
+        ndn_cs_remove_entry(fwd->cs, cs_entry);
       }
     }
   }
 
-  pit_entry = ndn_pit_find_or_insert(forwarder.pit, name, name_len);
-  if (pit_entry == NULL)
+  fwd->counters.cs_misses ++;
+  pit_entry = ndn_pit_node_insert(fwd->pit, match->exact);
+  if (pit_entry == NULL){
+    fwd->counters.drop_pit_full ++;
     return NDN_FWD_PIT_FULL;
-  pit_entry->options = options;
+  }
+  pit_entry->options = view->options;
   pit_entry->on_data = on_data;
   pit_entry->on_timeout = on_timeout;
   pit_entry->userdata = userdata;
 
   pit_entry->last_time = pit_entry->express_time = ndn_time_now_ms();
+  ndn_pit_update_deadline(fwd->pit, pit_entry);
+
+  return fwd_on_outgoing_interest(view,
+                                  ndn_fib_node_entry(fwd->fib, match->longest[NDN_NAMETREE_FIB_TYPE]),
+                                  pit_entry, NDN_INVALID_ID);
+}
+
+int
+ndn_forwarder_express_interest(uint8_t* interest, size_t length,
+                               ndn_on_data_func on_data,
+                               ndn_on_timeout_func on_timeout,
+                               void* userdata)
+{
+  int ret;
+  ndn_packet_index_t index;
+  ndn_nametree_match_t match;
+
+  if(interest == NULL || on_data == NULL)
+    return NDN_INVALID_POINTER;
+
+  ret = ndn_packet_index_init(&index, interest, length);
+  if(ret == NDN_SUCCESS && index.type != TLV_Interest)
+    ret = NDN_WRONG_TLV_TYPE;
+  if(ret != NDN_SUCCESS)
+    return ret;
+#if NDN_FORWARDER_SHARDING
+  // The Data will come back to the shard owning the name, so the PIT entry must be there
+  if(shard_count > 0){
+    ret = fwd_shards_post(FWD_SHARD_EXPRESS_INTEREST, &index, interest, length,
+                          on_data, on_timeout, userdata);
+    if(ret != NDN_FWD_NO_EFFECT)
+      return ret;
+  }
+#endif
+
+  // So that the Interest is dropped if it comes back
+  fwd_dnl_seen(&index.name_hash, index.interest.options.nonce, false);
 
-  return fwd_on_outgoing_interest(interest, length, name, name_len, pit_entry, NDN_INVALID_ID);
+  // One walk of the NameTree serves the CS, PIT and FIB.
+  // The name stays pinned until the Interest is processed.
+  ndn_nametree_lookup(fwd->nametree, index.interest.name, index.interest.name_size,
+                      &index.name_hash, true, &match);
+  ret = fwd_express_interest_matched(&index.interest, &match, on_data, on_timeout, userdata);
+  ndn_nametree_unpin(fwd->nametree, match.exact);
+  return ret;
 }
 
 int
@@ -310,152 +770,325 @@ ndn_forwarder_express_interest_struct(ndn_interest_t* interest,
                                       ndn_on_timeout_func on_timeout,
                                       void* userdata)
 {
-  ndn_encoder_t encoder;
-  encoder_init(&encoder, encoding_buf, sizeof(encoding_buf));
-  ndn_interest_tlv_encode(&encoder, interest);
-  return ndn_forwarder_express_interest(encoder.output_value, encoder.offset,
-                                 on_data, on_timeout, userdata);
+  ndn_scratch_mark_t mark = ndn_scratch_mark();
+  uint8_t* buf = ndn_scratch_alloc(FWD_INTEREST_ENCODE_SIZE);
+  ndn_prepend_encoder_t encoder;
+  int ret;
+
+  if(buf == NULL)
+    return NDN_OVERSIZE;
+  // Encoded back to front, as only a pointer to the Interest is needed
+  prepend_encoder_init(&encoder, buf, FWD_INTEREST_ENCODE_SIZE);
+  ret = ndn_interest_tlv_prepend(&encoder, interest);
+  // Callbacks run from here may express Interests of their own, above this one
+  if(ret == NDN_SUCCESS)
+    ret = ndn_forwarder_express_interest(prepend_encoder_output(&encoder),
+                                         prepend_encoder_size(&encoder),
+                                         on_data, on_timeout, userdata);
+  ndn_scratch_release(mark);
+  return ret;
 }
 
 int
 ndn_forwarder_put_data(uint8_t* data, size_t length)
 {
   int ret;
-  uint8_t *name;
-  size_t name_len;
+  ndn_packet_index_t index;
 
   if(data == NULL)
     return NDN_INVALID_POINTER;
-  ret = tlv_data_get_name(data, length, &name, &name_len);
+  ret = ndn_packet_index_init(&index, data, length);
+  if(ret == NDN_SUCCESS && index.type != TLV_Data)
+    ret = NDN_WRONG_TLV_TYPE;
   if(ret != NDN_SUCCESS)
     return ret;
+#if NDN_FORWARDER_SHARDING
+  if(shard_count > 0){
+    ret = fwd_shards_post(FWD_SHARD_PUT_DATA, &index, data, length, NULL, NULL, NULL);
+    if(ret != NDN_FWD_NO_EFFECT)
+      return ret;
+  }
+#endif
 
-  return fwd_data_pipeline(data, length, name, name_len, NDN_INVALID_ID);
+  return fwd_data_pipeline(&index, NDN_INVALID_ID);
 }
 
 int
 ndn_forwarder_receive(ndn_face_intf_t* face, uint8_t* packet, size_t length)
 {
-  uint32_t type, val_len;
-  uint8_t* buf;
-  uint8_t *name;
-  size_t name_len;
-  interest_options_t options;
-  int ret;
   ndn_table_id_t face_id = (face ? face->face_id : NDN_INVALID_ID);
 
   if (packet == NULL)
     return NDN_INVALID_POINTER;
+#if NDN_FORWARDER_SHARDING
+  if (shard_count > 0 && fwd == &forwarder)
+    return fwd_shards_dispatch(face_id, packet, length);
+#endif
+  return fwd_receive(face_id, packet, length);
+}
 
-  buf = tlv_get_type_length(packet, length, &type, &val_len);
-  if (val_len != length - (buf - packet))
-    return NDN_WRONG_TLV_LENGTH;
+int
+ndn_forwarder_receive_buf(ndn_face_intf_t* face, ndn_pktbuf_t* buf)
+{
+  ndn_table_id_t face_id = (face ? face->face_id : NDN_INVALID_ID);
+  ndn_pktbuf_t* outer_buf;
+  int ret;
 
-  if (type == TLV_Interest) {
-    ret = tlv_interest_get_header(packet, length, &options, &name, &name_len);
-    if (ret != NDN_SUCCESS)
-      return ret;
-    return fwd_on_incoming_interest(packet, length, &options, name, name_len, face_id);
+  if (buf == NULL)
+    return NDN_INVALID_POINTER;
+#if NDN_FORWARDER_SHARDING
+  if (shard_count > 0 && fwd == &forwarder) {
+    ret = fwd_shards_dispatch(face_id, buf->data, buf->length);
+    ndn_pktbuf_release(buf);
+    return ret;
   }
-  else if(type == TLV_Data) {
-    ret = tlv_data_get_name(packet, length, &name, &name_len);
-    if (ret != NDN_SUCCESS)
-      return ret;
-    return fwd_data_pipeline(packet, length, name, name_len, face_id);
+#endif
+  // A callback may receive another packet meanwhile
+  outer_buf = fwd->rx_buf;
+  fwd->rx_buf = buf;
+  ret = fwd_receive(face_id, buf->data, buf->length);
+  fwd->rx_buf = outer_buf;
+  ndn_pktbuf_release(buf);
+  return ret;
+}
+
+int
+ndn_forwarder_receive_batch(ndn_face_intf_t* face, uint8_t* const packets[],
+                            const size_t lengths[], size_t count)
+{
+  ndn_table_id_t face_id = (face ? face->face_id : NDN_INVALID_ID);
+  ndn_face_stats_t* face_stats = NULL;
+  size_t i;
+
+  if (packets == NULL || lengths == NULL)
+    return NDN_INVALID_POINTER;
+  if (count > INT_MAX)
+    count = INT_MAX;
+#if NDN_FORWARDER_SHARDING
+  if (shard_count > 0 && fwd == &forwarder) {
+    for (i = 0; i < count; i++) {
+      if (fwd_shards_dispatch(face_id, packets[i], lengths[i]) == NDN_FWD_SHARD_QUEUE_FULL)
+        break;
+    }
+    return (int)i;
   }
-  else {
-    return NDN_WRONG_TLV_TYPE;
+#endif
+
+  if (face_id < fwd->facetab->capacity)
+    face_stats = ndn_facetab_stats(fwd->facetab, face_id);
+  for (i = 0; i < count; i++) {
+    if (face_stats != NULL) {
+      face_stats->in_packets ++;
+      face_stats->in_bytes += lengths[i];
+    }
+    fwd_process_packet(face_id, packets[i], lengths[i]);
   }
+  ndn_forwarder_flush();
+  return (int)count;
+}
+
+int
+ndn_forwarder_receive_buf_batch(ndn_face_intf_t* face, ndn_pktbuf_t* const bufs[], size_t count)
+{
+  ndn_table_id_t face_id = (face ? face->face_id : NDN_INVALID_ID);
+  ndn_face_stats_t* face_stats = NULL;
+  ndn_pktbuf_t* outer_buf;
+  size_t i;
+#if NDN_FORWARDER_SHARDING
+  size_t taken;
+#endif
+
+  if (bufs == NULL)
+    return NDN_INVALID_POINTER;
+  if (count > INT_MAX)
+    count = INT_MAX;
+#if NDN_FORWARDER_SHARDING
+  if (shard_count > 0 && fwd == &forwarder) {
+    for (taken = 0; taken < count; taken++) {
+      if (fwd_shards_dispatch(face_id, bufs[taken]->data, bufs[taken]->length) == NDN_FWD_SHARD_QUEUE_FULL)
+        break;
+    }
+    for (i = 0; i < count; i++)
+      ndn_pktbuf_release(bufs[i]);
+    return (int)taken;
+  }
+#endif
+
+  if (face_id < fwd->facetab->capacity)
+    face_stats = ndn_facetab_stats(fwd->facetab, face_id);
+  outer_buf = fwd->rx_buf;
+  for (i = 0; i < count; i++) {
+    if (face_stats != NULL) {
+      face_stats->in_packets ++;
+      face_stats->in_bytes += bufs[i]->length;
+    }
+    fwd->rx_buf = bufs[i];
+    fwd_process_packet(face_id, bufs[i]->data, bufs[i]->length);
+    ndn_pktbuf_release(bufs[i]);
+  }
+  fwd->rx_buf = outer_buf;
+  ndn_forwarder_flush();
+  return (int)count;
 }
 
 static int
-fwd_on_incoming_interest(uint8_t* interest,
-                         size_t length,
-                         interest_options_t* options,
-                         uint8_t* name,
-                         size_t name_len,
-                         ndn_table_id_t face_id)
+fwd_receive(ndn_table_id_t face_id, uint8_t* packet, size_t length)
+{
+  ndn_face_stats_t* face_stats;
+
+  if (face_id < fwd->facetab->capacity) {
+    face_stats = ndn_facetab_stats(fwd->facetab, face_id);
+    face_stats->in_packets ++;
+    face_stats->in_bytes += length;
+  }
+  return fwd_process_packet(face_id, packet, length);
+}
+
+// The buffer of the packet being received if packet is in it, NULL otherwise
+static inline ndn_pktbuf_t*
+fwd_rx_buf(const uint8_t* packet, size_t length)
+{
+  ndn_pktbuf_t* buf = fwd->rx_buf;
+
+  if (buf != NULL && packet == buf->data && length == buf->length)
+    return buf;
+  return NULL;
+}
+
+static int
+fwd_process_packet(ndn_table_id_t face_id, uint8_t* packet, size_t length)
+{
+  ndn_packet_index_t index;
+  int ret;
+
+  // The packet is parsed and its name hashed once here for all stages it goes through
+  ret = ndn_packet_index_init(&index, packet, length);
+  if (index.type == TLV_Interest)
+    fwd->counters.in_interests ++;
+  else if (index.type == TLV_Data)
+    fwd->counters.in_data ++;
+  if (ret != NDN_SUCCESS) {
+    fwd->counters.drop_malformed ++;
+    return ret;
+  }
+
+  if (index.type == TLV_Interest)
+    return fwd_on_incoming_interest(&index, face_id);
+  else
+    return fwd_data_pipeline(&index, face_id);
+}
+
+static int
+fwd_on_incoming_interest_matched(ndn_interest_view_t* view,
+                                 ndn_nametree_match_t* match,
+                                 ndn_table_id_t face_id)
 {
   ndn_cs_entry_t* cs_entry;
 
-  cs_entry = ndn_cs_prefix_match(forwarder.cs, name, name_len);
+  cs_entry = ndn_cs_node_entry(fwd->cs, match->longest[NDN_NAMETREE_CS_TYPE]);
   if (cs_entry == NULL){
     NDN_LOG_DEBUG("[FORWARDER] (fwd_on_incoming_interest) No prefix match in content store found\n");
   }else{
     NDN_LOG_DEBUG("[FORWARDER] (fwd_on_incoming_interest) Prefix match in content store found\n");
-    if (cs_entry->options.can_be_prefix || ndn_cs_find(forwarder.cs, name, name_len) == cs_entry){
+    if (cs_entry->options.can_be_prefix || match->longest[NDN_NAMETREE_CS_TYPE] == match->exact){
 
       // check if either the CS entry is either fresh or must_be_fresh of the entry is false
-      int cs_entry_freshness = dll_check_one_cs_entry_freshness(cs_entry);
-      if ((cs_entry_freshness == 0) || ((cs_entry_freshness == -1) && (cs_entry->options.must_be_fresh == false))){
-        // Randomized dead nonce list
-        if(cs_entry->options.nonce == options->nonce && options->nonce != 0){
-          NDN_LOG_ERROR("[FORWARDER] Drop by dead nonce\n");
-          return NDN_FWD_INTEREST_REJECTED;
-        }
+      if (ndn_cs_entry_is_fresh(cs_entry, ndn_time_now_ms()) || !cs_entry->options.must_be_fresh){
+        fwd->counters.cs_hits ++;
         if(cs_entry->on_data == NULL){
           // Update the options (lifetime) only when it's not expressed by an application, as done with the pit_entry below.
-          cs_entry->options = *options;
+          cs_entry->options = view->options;
         }
         cs_entry->last_time = ndn_time_now_ms();
+        ndn_cs_touch(fwd->cs, cs_entry);
 
-        ndn_bitset_t incoming_faces;
-        incoming_faces = bitset_set(0, face_id);
-
-        fwd_multicast(cs_entry->content, cs_entry->content_len, incoming_faces, NDN_INVALID_ID);
+        if(face_id != NDN_INVALID_ID && fwd->facetab->slots[face_id] != NULL){
+          fwd_send(face_id, cs_entry->content, cs_entry->content_len, cs_entry->buf);
+          fwd->counters.out_data ++;
+        }
 
         return NDN_SUCCESS;
       }else{
         NDN_LOG_DEBUG("The found CS entry is not fresh anymore, but must be fresh\n");
 
-        dll_remove_cs_entry(cs_entry);
+        ndn_cs_remove_entry(fwd->cs, cs_entry);
       }
     }
   }
 
   ndn_pit_entry_t *pit_entry;
 
-  pit_entry = ndn_pit_find_or_insert(forwarder.pit, name, name_len);
+  fwd->counters.cs_misses ++;
+  pit_entry = ndn_pit_node_insert(fwd->pit, match->exact);
   if (pit_entry == NULL){
+    fwd->counters.drop_pit_full ++;
     return NDN_FWD_PIT_FULL;
   }
-
-  // Randomized dead nonce list
-  if(pit_entry->options.nonce == options->nonce && options->nonce != 0){
-    NDN_LOG_ERROR("[FORWARDER] Drop by dead nonce\n");
-    return NDN_FWD_INTEREST_REJECTED;
+  // Only a set of many faces needs a bitmap, so the entry is not new if this fails
+  if(face_id != NDN_INVALID_ID &&
+     ndn_faceset_add(fwd->faces, &pit_entry->incoming_faces, face_id) != NDN_SUCCESS){
+    fwd->counters.drop_face_set_full ++;
+    return NDN_FWD_PIT_FULL;
   }
+
   if(pit_entry->on_data == NULL && pit_entry->on_timeout == NULL){
     // Update the options (lifetime) only when it's not expressed by an application.
     // I'm sorry I don't have a clear idea on this. Maybe we should separate user's lifetime
     // and forwarded Interest's lifetime.
-    pit_entry->options = *options;
+    pit_entry->options = view->options;
   }
   pit_entry->last_time = ndn_time_now_ms();
-  if(face_id != NDN_INVALID_ID){
-    pit_entry->incoming_faces = bitset_set(pit_entry->incoming_faces, face_id);
+  ndn_pit_update_deadline(fwd->pit, pit_entry);
+
+  return fwd_on_outgoing_interest(view,
+                                  ndn_fib_node_entry(fwd->fib, match->longest[NDN_NAMETREE_FIB_TYPE]),
+                                  pit_entry, face_id);
+}
+
+static int
+fwd_on_incoming_interest(ndn_packet_index_t* index,
+                         ndn_table_id_t face_id)
+{
+  ndn_interest_view_t* view = &index->interest;
+  ndn_nametree_match_t match;
+  int ret;
+
+  // A looping Interest is dropped before any table is touched
+  if (fwd_dnl_seen(&index->name_hash, view->options.nonce, true)){
+    NDN_LOG_ERROR("[FORWARDER] Drop by dead nonce\n");
+    fwd->counters.drop_dead_nonce ++;
+    return NDN_FWD_INTEREST_REJECTED;
   }
 
-  return fwd_on_outgoing_interest(interest, length, name, name_len, pit_entry, face_id);
+  // One walk of the NameTree serves the CS, PIT and FIB.
+  // The name stays pinned until the Interest is processed.
+  ndn_nametree_lookup(fwd->nametree, view->name, view->name_size, &index->name_hash, true, &match);
+  ret = fwd_on_incoming_interest_matched(view, &match, face_id);
+  ndn_nametree_unpin(fwd->nametree, match.exact);
+  return ret;
 }
 
 static int
-fwd_data_pipeline(uint8_t* data,
-                  size_t length,
-                  uint8_t* name,
-                  size_t name_len,
-                  ndn_table_id_t face_id)
+fwd_data_pipeline_matched(ndn_data_view_t* view,
+                          ndn_nametree_match_t* match,
+                          ndn_table_id_t face_id)
 {
+  uint8_t* data = view->block;
+  size_t length = view->block_size;
+  // Cached Data shares the packet buffer if it has one
+  ndn_pktbuf_t* buf = fwd_rx_buf(data, length);
   ndn_cs_entry_t* cs_entry;
+  ndn_table_id_t nametree_id;
+  ndn_time_ms_t now;
 
-  cs_entry = ndn_cs_prefix_match(forwarder.cs, name, name_len);
+  cs_entry = ndn_cs_node_entry(fwd->cs, match->longest[NDN_NAMETREE_CS_TYPE]);
   if (cs_entry != NULL){
     NDN_LOG_DEBUG("[FORWARDER] (fwd_data_pipeline) cs entry already found\n");
 
     // update existing CS entry
-    ndn_insert_cs_entry_with_content(cs_entry, data, length);
+    ndn_cs_set_content_view(fwd->cs, cs_entry, view, buf);
 
-    if (cs_entry->options.can_be_prefix || ndn_cs_find(forwarder.cs, name, name_len) == cs_entry){
+    if (cs_entry->options.can_be_prefix || match->longest[NDN_NAMETREE_CS_TYPE] == match->exact){
       if (cs_entry->on_data != NULL){
           cs_entry->on_data(cs_entry->content, cs_entry->content_len, cs_entry->userdata);
           return NDN_SUCCESS;
@@ -464,87 +1097,249 @@ fwd_data_pipeline(uint8_t* data,
   }else{
     NDN_LOG_DEBUG("[FORWARDER] (fwd_data_pipeline) No cs entry found, inserting new one\n");
 
-    // try to insert new CS entry
-    cs_entry = ndn_cs_find_or_insert(forwarder.cs, name, name_len);
+    // try to insert new CS entry, the CS evicts a stale or the least recently used entry if full
+    cs_entry = ndn_cs_node_insert(fwd->cs, match->exact);
     if (cs_entry == NULL){
-      NDN_LOG_DEBUG("[FORWARDER] (fwd_data_pipeline) The CS table is already full\n");
-      // CS table is full, remove all entries that are not fresh or first/oldest entry from CS
-      int deleted = dll_check_all_cs_entry_freshness();
-      if (deleted == 0)
-        dll_remove_first();
-
-      // insert new entry after creating space
-      cs_entry = ndn_cs_find_or_insert(forwarder.cs, name, name_len);
-    }
-
-    if (cs_entry == NULL)
       NDN_LOG_DEBUG("[FORWARDER] (fwd_data_pipeline) Could not create new cs_entry\n");
-
-    // insert the CS entry with the content into the dll
-    ndn_insert_cs_entry_with_content(cs_entry, data, length);
-    dll_insert(cs_entry);
+    }else{
+      ndn_cs_set_content_view(fwd->cs, cs_entry, view, buf);
+    }
   }
 
   ndn_pit_entry_t* pit_entry;
 
-  pit_entry = ndn_pit_prefix_match(forwarder.pit, name, name_len);
+  pit_entry = ndn_pit_node_entry(fwd->pit, match->longest[NDN_NAMETREE_PIT_TYPE]);
   if (pit_entry == NULL) {
+    fwd->counters.drop_unsolicited ++;
     return NDN_FWD_NO_ROUTE;
   }
   if (!pit_entry->options.can_be_prefix) {
-    // Quick and dirty solution
-    if (ndn_pit_find(forwarder.pit, name, name_len) != pit_entry)
+    if (match->longest[NDN_NAMETREE_PIT_TYPE] != match->exact) {
+      fwd->counters.drop_unsolicited ++;
       return NDN_FWD_NO_ROUTE;
+    }
+  }
+
+  // Measure the face from the last time the Interest came in, when it was last forwarded
+  if (face_id < fwd->facetab->capacity &&
+      ndn_faceset_contains(fwd->faces, &pit_entry->outgoing_faces, face_id)) {
+    now = ndn_time_now_ms();
+    ndn_measurements_on_satisfied(ndn_facetab_measurements(fwd->facetab, face_id),
+                                  now > pit_entry->last_time ? now - pit_entry->last_time : 0);
   }
 
+  // Callbacks and faces may satisfy the entry meanwhile, or reuse it for another Interest
+  nametree_id = pit_entry->nametree_id;
   if (pit_entry->on_data != NULL) {
     pit_entry->on_data(data, length, pit_entry->userdata);
   }
 
-  fwd_multicast(data, length, pit_entry->incoming_faces, face_id);
+  fwd->counters.out_data += fwd_multicast(data, length, buf, &pit_entry->incoming_faces, face_id, NULL);
 
-  ndn_pit_remove_entry(forwarder.pit, pit_entry);
+  if (pit_entry->nametree_id == nametree_id) {
+    ndn_pit_remove_entry(fwd->pit, pit_entry);
+  }
 
   return NDN_SUCCESS;
 }
 
-static ndn_bitset_t
+static int
+fwd_data_pipeline(ndn_packet_index_t* index,
+                  ndn_table_id_t face_id)
+{
+  ndn_data_view_t* view = &index->data;
+  ndn_nametree_match_t match;
+  int ret;
+
+  // One walk of the NameTree serves the CS and PIT.
+  // The name stays pinned until the Data is processed.
+  ndn_nametree_lookup(fwd->nametree, view->name, view->name_size, &index->name_hash, true, &match);
+  ret = fwd_data_pipeline_matched(view, &match, face_id);
+  ndn_nametree_unpin(fwd->nametree, match.exact);
+  return ret;
+}
+
+#if NDN_FORWARDER_SHARDING
+// Returns whether the lock was taken, and has to be released by fwd_face_unlock()
+static bool
+fwd_face_lock(ndn_table_id_t face_id)
+{
+  if (shard_count == 0 || face_id >= shard_send_lock_count || face_id == shard_send_locked)
+    return false;
+  while (atomic_flag_test_and_set_explicit(&shard_send_locks[face_id], memory_order_acquire))
+    ;
+  shard_send_locked = face_id;
+  return true;
+}
+
+static void
+fwd_face_unlock(ndn_table_id_t face_id, bool locked)
+{
+  if (!locked)
+    return;
+  shard_send_locked = NDN_INVALID_ID;
+  atomic_flag_clear_explicit(&shard_send_locks[face_id], memory_order_release);
+}
+#else
+#define fwd_face_lock(face_id) false
+#define fwd_face_unlock(face_id, locked) ((void)(locked))
+#endif
+
+// Send a packet, by reference if buf holds it
+static void
+fwd_send(ndn_table_id_t face_id, uint8_t* packet, size_t length, ndn_pktbuf_t* buf)
+{
+  ndn_face_stats_t* face_stats = ndn_facetab_stats(fwd->facetab, face_id);
+  ndn_face_intf_t* face = fwd->facetab->slots[face_id];
+#if NDN_FORWARDER_TX_BATCH_SIZE > 0
+  ndn_forwarder_tx_queue_t* tx = &fwd->tx;
+#endif
+
+  bool locked;
+
+  face_stats->out_packets ++;
+  face_stats->out_bytes += length;
+#if NDN_FORWARDER_TX_BATCH_SIZE > 0
+  if (face->send_batch != NULL && !tx->flushing && length <= NDN_FORWARDER_TX_BUFFER_SIZE) {
+    if (tx->count == NDN_FORWARDER_TX_BATCH_SIZE || tx->used + length > NDN_FORWARDER_TX_BUFFER_SIZE)
+      ndn_forwarder_flush();
+    tx->face_ids[tx->count] = face_id;
+    tx->sizes[tx->count] = (uint32_t)length;
+    if (buf != NULL) {
+      tx->bufs[tx->count] = ndn_pktbuf_retain(buf);
+      tx->offsets[tx->count] = 0;
+    }
+    else {
+      tx->bufs[tx->count] = NULL;
+      tx->offsets[tx->count] = tx->used;
+      memcpy(tx->buf + tx->used, packet, length);
+      tx->used += (uint32_t)length;
+    }
+    tx->count ++;
+    return;
+  }
+#endif
+  locked = fwd_face_lock(face_id);
+  if (buf != NULL && face->send_buf != NULL)
+    ndn_face_send_buf(face, ndn_pktbuf_retain(buf));
+  else
+    ndn_face_send(face, packet, length);
+  fwd_face_unlock(face_id, locked);
+}
+
+void
+ndn_forwarder_flush(void)
+{
+#if NDN_FORWARDER_TX_BATCH_SIZE > 0
+  ndn_forwarder_tx_queue_t* tx = &fwd->tx;
+  const uint8_t* packets[NDN_FORWARDER_TX_BATCH_SIZE];
+  uint32_t sizes[NDN_FORWARDER_TX_BATCH_SIZE];
+  ndn_table_id_t face_id;
+  ndn_face_intf_t* face;
+  uint32_t i, j, n;
+  bool locked;
+
+  if (tx->count == 0 || tx->flushing)
+    return;
+  // A face may hand packets back to the forwarder while sending
+  tx->flushing = true;
+  // Group packets by face, keeping their order
+  for (i = 0; i < tx->count; i++) {
+    face_id = tx->face_ids[i];
+    if (face_id == NDN_INVALID_ID)
+      continue;
+    n = 0;
+    for (j = i; j < tx->count; j++) {
+      if (tx->face_ids[j] == face_id) {
+        packets[n] = (tx->bufs[j] != NULL) ? tx->bufs[j]->data : tx->buf + tx->offsets[j];
+        sizes[n] = tx->sizes[j];
+        n ++;
+        tx->face_ids[j] = NDN_INVALID_ID;
+      }
+    }
+    face = fwd->facetab->slots[face_id];
+    if (face != NULL) {
+      locked = fwd_face_lock(face_id);
+      ndn_face_send_batch(face, packets, sizes, n);
+      fwd_face_unlock(face_id, locked);
+    }
+  }
+  for (i = 0; i < tx->count; i++) {
+    if (tx->bufs[i] != NULL)
+      ndn_pktbuf_release(tx->bufs[i]);
+  }
+  tx->count = 0;
+  tx->used = 0;
+  tx->flushing = false;
+#endif
+}
+
+// Send to all faces in out_faces except in_face. Given the PIT entry of an Interest,
+// skip and record faces in its outgoing_faces. Returns the number of faces sent to.
+// A face may run callbacks which change out_faces or remove the entry while sending,
+// so a snapshot of out_faces is walked and the entry is checked after each send.
+static uint64_t
 fwd_multicast(uint8_t* packet,
               size_t length,
-              ndn_bitset_t out_faces,
-              ndn_table_id_t in_face)
+              ndn_pktbuf_t* buf,
+              const ndn_face_set_t* out_faces,
+              ndn_table_id_t in_face,
+              ndn_pit_entry_t* entry)
 {
+  ndn_scratch_mark_t mark = ndn_scratch_mark();
+  ndn_table_id_t nametree_id = (entry != NULL ? entry->nametree_id : NDN_INVALID_ID);
+  uint64_t* copy = NULL;
+  ndn_face_set_iter_t iter;
   ndn_table_id_t id;
-  ndn_face_intf_t* face;
-  ndn_bitset_t ret = 0;
-
-  while(out_faces != 0){
-    id = bitset_pop_least(&out_faces);
-    face = forwarder.facetab->slots[id];
-    if(id != in_face && face != NULL){
-      ndn_face_send(face, packet, length);
-      ret = bitset_set(ret, id);
+  uint64_t count = 0;
+
+  // A table of more faces than the scratch arena holds bits for is walked in place
+  if(ndn_faceset_is_spilled(out_faces))
+    copy = ndn_scratch_alloc(sizeof(uint64_t) * fwd->faces->words);
+  ndn_faceset_iter_init_copy(&iter, fwd->faces, out_faces, copy);
+  while((id = ndn_faceset_iter_next(&iter)) != NDN_INVALID_ID){
+    if(id == in_face || id >= fwd->facetab->capacity){
+      continue;
+    }
+    if(entry != NULL && ndn_faceset_contains(fwd->faces, &entry->outgoing_faces, id)){
+      continue;
+    }
+    if(fwd->facetab->slots[id] != NULL){
+      // Only Interests record where they went, and are not sent where that cannot be recorded
+      if(entry != NULL){
+        if(ndn_faceset_add(fwd->faces, &entry->outgoing_faces, id) != NDN_SUCCESS){
+          fwd->counters.drop_face_set_full ++;
+          break;
+        }
+        ndn_measurements_on_sent(ndn_facetab_measurements(fwd->facetab, id));
+      }
+      fwd_send(id, packet, length, buf);
+      count ++;
+      // The Interest was satisfied or dropped meanwhile
+      if(entry != NULL && entry->nametree_id != nametree_id){
+        break;
+      }
     }
   }
-  return ret;
+  ndn_scratch_release(mark);
+  return count;
 }
 
 static int
-fwd_on_outgoing_interest(uint8_t* interest,
-                         size_t length,
-                         uint8_t* name,
-                         size_t name_len,
+fwd_on_outgoing_interest(ndn_interest_view_t* view,
+                         ndn_fib_entry_t* fib_entry,
                          ndn_pit_entry_t* entry,
                          ndn_table_id_t face_id)
 {
-  ndn_fib_entry_t* fib_entry;
+  uint8_t* interest = view->block;
+  size_t length = view->block_size;
+  uint8_t* hop_limit = view->hop_limit;
   int strategy;
-  uint8_t *hop_limit;
-  ndn_bitset_t outfaces;
+  ndn_table_id_t out_face;
 
-  fib_entry = ndn_fib_prefix_match(forwarder.fib, name, name_len);
   if(fib_entry == NULL){
     NDN_LOG_ERROR("[FORWARDER] Drop by no route\n");
+    fwd->counters.drop_no_route ++;
     return NDN_FWD_NO_ROUTE;
   }
 
@@ -559,9 +1354,9 @@ fwd_on_outgoing_interest(uint8_t* interest,
     return NDN_SUCCESS;
   }
 
-  hop_limit = tlv_interest_get_hoplimit_ptr(interest, length);
   if(hop_limit != NULL){
     if(*hop_limit <= 0){
+      fwd->counters.drop_hop_limit ++;
       return NDN_FWD_INTEREST_REJECTED;
     }
     // If the Interest is received from another hop
@@ -570,10 +1365,601 @@ fwd_on_outgoing_interest(uint8_t* interest,
     }
   }
 
-  outfaces = (fib_entry->nexthop & (~entry->outgoing_faces));
-  if(strategy == NDN_FWD_STRATEGY_MULTICAST){
-    entry->outgoing_faces |= fwd_multicast(interest, length, outfaces, face_id);
+  if(strategy == NDN_FWD_STRATEGY_SUPPRESS){
+    return NDN_SUCCESS;
+  }
+  if(fib_entry->strategy == NDN_FWD_STRATEGY_MULTICAST){
+    fwd->counters.out_interests +=
+      fwd_multicast(interest, length, fwd_rx_buf(interest, length),
+                    &fib_entry->nexthop, face_id, entry);
+  }
+  else{
+    out_face = ndn_strategy_select(fib_entry, fwd->facetab, fwd->faces, face_id, &entry->outgoing_faces);
+    if(out_face != NDN_INVALID_ID){
+      if(ndn_faceset_add(fwd->faces, &entry->outgoing_faces, out_face) != NDN_SUCCESS){
+        fwd->counters.drop_face_set_full ++;
+        return NDN_FWD_PIT_FULL;
+      }
+      ndn_measurements_on_sent(ndn_facetab_measurements(fwd->facetab, out_face));
+      fwd_send(out_face, interest, length, fwd_rx_buf(interest, length));
+      fwd->counters.out_interests ++;
+    }
+  }
+
+  return NDN_SUCCESS;
+}
+
+#if NDN_FORWARDER_SHARDING
+
+/** A packet handed from a face to a shard.
+ */
+typedef struct fwd_shard_packet {
+  uint32_t length;
+  /** Tail of the control queue when the packet was queued.
+   * Updates before it are applied before the packet, later ones after it. */
+  uint32_t stamp;
+  ndn_table_id_t face_id;
+  uint8_t packet[NDN_FORWARDER_SHARD_PACKET_SIZE];
+} fwd_shard_packet_t;
+
+/** A FaceTable or FIB update replicated to a shard, or a packet of the application.
+ */
+typedef struct fwd_shard_control {
+  uint8_t op;
+  ndn_table_id_t face_id;
+  ndn_face_intf_t* face;
+  ndn_on_interest_func on_interest;
+  ndn_on_data_func on_data;
+  ndn_on_timeout_func on_timeout;
+  void* userdata;
+  uint8_t strategy;
+  /** The name prefix of an update, or the packet. */
+  uint32_t length;
+  uint8_t value[NDN_FORWARDER_SHARD_PACKET_SIZE];
+} fwd_shard_control_t;
+
+#define FWD_CACHE_ALIGN_SIZE(size) \
+  (((size) + NDN_CACHE_LINE_SIZE - 1) / NDN_CACHE_LINE_SIZE * NDN_CACHE_LINE_SIZE)
+
+static void
+fwd_store_words(_Atomic uint64_t* words, const void* value, size_t size)
+{
+  uint64_t word;
+  size_t i;
+
+  for (i = 0; i < size / sizeof(uint64_t); i++) {
+    memcpy(&word, (const uint8_t*)value + i * sizeof(uint64_t), sizeof(uint64_t));
+    atomic_store_explicit(&words[i], word, memory_order_relaxed);
+  }
+}
+
+// Read statistics of a shard, from the word at offset of its snapshot
+static void
+fwd_shard_read(ndn_forwarder_shard_t* shard, size_t offset, void* value, size_t size)
+{
+  uint_fast32_t seq;
+  uint64_t word;
+  size_t i;
+
+  do {
+    while ((seq = atomic_load_explicit(&shard->snapshot_seq, memory_order_acquire)) & 1)
+      ;
+    for (i = 0; i < size / sizeof(uint64_t); i++) {
+      word = atomic_load_explicit(&shard->snapshot[offset + i], memory_order_relaxed);
+      memcpy((uint8_t*)value + i * sizeof(uint64_t), &word, sizeof(uint64_t));
+    }
+    atomic_thread_fence(memory_order_acquire);
+  } while (atomic_load_explicit(&shard->snapshot_seq, memory_order_relaxed) != seq);
+}
+
+// Add counters made of uint64_t only
+static void
+fwd_add_counters(void* sum, const void* value, size_t size)
+{
+  uint64_t* words = (uint64_t*)sum;
+  const uint64_t* added = (const uint64_t*)value;
+  size_t i;
+
+  for (i = 0; i < size / sizeof(uint64_t); i++)
+    words[i] += added[i];
+}
+
+static ndn_table_id_t
+fwd_add_table_size(ndn_table_id_t sum, ndn_table_id_t value)
+{
+  return (value > NDN_INVALID_ID - sum ? NDN_INVALID_ID : sum + value);
+}
+
+static void
+fwd_shards_add_stats(ndn_forwarder_stats_t* stats)
+{
+  ndn_forwarder_stats_t shard_stats;
+  ndn_forwarder_shard_t* shard;
+  uint32_t i;
+
+  // Only shards forward packets, so the tables in use are theirs
+  stats->pit_count = stats->pit_capacity = 0;
+  stats->cs_count = stats->cs_capacity = 0;
+  stats->dnl_count = stats->dnl_capacity = stats->dnl_fp_rate = 0;
+  stats->cs_used_bytes = stats->cs_arena_bytes = 0;
+  for (i = 0; i < shard_count; i++) {
+    shard = FWD_SHARD(i);
+    fwd_shard_read(shard, 0, &shard_stats, sizeof(shard_stats));
+    fwd_add_counters(&stats->counters, &shard_stats.counters, sizeof(shard_stats.counters));
+    fwd_add_counters(&stats->pit, &shard_stats.pit, sizeof(shard_stats.pit));
+    fwd_add_counters(&stats->cs, &shard_stats.cs, sizeof(shard_stats.cs));
+    fwd_add_counters(&stats->dnl, &shard_stats.dnl, sizeof(shard_stats.dnl));
+    stats->counters.drop_queue_full += atomic_load_explicit(&shard->queue_drops, memory_order_relaxed);
+    stats->pit_count = fwd_add_table_size(stats->pit_count, shard_stats.pit_count);
+    stats->pit_capacity = fwd_add_table_size(stats->pit_capacity, shard_stats.pit_capacity);
+    stats->cs_count = fwd_add_table_size(stats->cs_count, shard_stats.cs_count);
+    stats->cs_capacity = fwd_add_table_size(stats->cs_capacity, shard_stats.cs_capacity);
+    stats->dnl_count += shard_stats.dnl_count;
+    stats->dnl_capacity += shard_stats.dnl_capacity;
+    if (shard_stats.dnl_fp_rate > stats->dnl_fp_rate)
+      stats->dnl_fp_rate = shard_stats.dnl_fp_rate;
+    stats->cs_used_bytes += shard_stats.cs_used_bytes;
+    stats->cs_arena_bytes += shard_stats.cs_arena_bytes;
+  }
+}
+
+static void
+fwd_shards_add_face_stats(ndn_table_id_t face_id, ndn_face_stats_t* stats)
+{
+  ndn_face_stats_t shard_stats;
+  ndn_forwarder_shard_t* shard;
+  uint32_t i;
+
+  for (i = 0; i < shard_count; i++) {
+    shard = FWD_SHARD(i);
+    if (face_id >= shard->forwarder.facetab->capacity)
+      continue;
+    fwd_shard_read(shard, (sizeof(ndn_forwarder_stats_t) +
+                           sizeof(ndn_face_stats_t) * face_id) / sizeof(uint64_t),
+                   &shard_stats, sizeof(shard_stats));
+    fwd_add_counters(stats, &shard_stats, sizeof(shard_stats));
+  }
+}
+
+// Bytes of the statistics a shard publishes
+#define FWD_SHARD_SNAPSHOT_SIZE(facetab_size) \
+  (sizeof(ndn_forwarder_stats_t) + sizeof(ndn_face_stats_t) * (facetab_size))
+
+// Publish the statistics of a shard. Only the thread processing it writes them.
+// Readers retry while the sequence number is odd, or has changed when they are done.
+static void
+fwd_shard_publish(ndn_forwarder_shard_t* shard)
+{
+  ndn_face_table_t* facetab = shard->forwarder.facetab;
+  uint_fast32_t seq = atomic_load_explicit(&shard->snapshot_seq, memory_order_relaxed);
+  ndn_forwarder_stats_t stats;
+  size_t offset = sizeof(stats) / sizeof(uint64_t);
+  size_t i;
+
+  fwd_fill_stats(&shard->forwarder, &stats);
+  atomic_store_explicit(&shard->snapshot_seq, seq + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  fwd_store_words(shard->snapshot, &stats, sizeof(stats));
+  for (i = 0; i < facetab->capacity; i++) {
+    fwd_store_words(shard->snapshot + offset, ndn_facetab_stats(facetab, i), sizeof(ndn_face_stats_t));
+    offset += sizeof(ndn_face_stats_t) / sizeof(uint64_t);
+  }
+  atomic_store_explicit(&shard->snapshot_seq, seq + 2, memory_order_release);
+  atomic_store_explicit(&shard->snapshot_control,
+                        atomic_load_explicit(&shard->control->head, memory_order_relaxed),
+                        memory_order_release);
+}
+
+// Bytes of one shard: the header, its tables, its two rings and its statistics,
+// each on their own cache lines
+static uint64_t
+fwd_shard_size(const ndn_forwarder_config_t* config)
+{
+  return FWD_CACHE_ALIGN_SIZE((uint64_t)sizeof(ndn_forwarder_shard_t)) +
+         FWD_CACHE_ALIGN_SIZE(NDN_FORWARDER_RESERVE_SIZE((uint64_t)config->nametree_size,
+                                                         (uint64_t)config->facetab_size,
+                                                         (uint64_t)config->fib_size,
+                                                         (uint64_t)config->pit_size,
+                                                         (uint64_t)config->cs_size,
+                                                         (uint64_t)config->cs_bytes,
+                                                         (uint64_t)config->dnl_size,
+                                                         (uint64_t)config->faceset_size)) +
+         FWD_CACHE_ALIGN_SIZE(NDN_SPSC_RING_RESERVE_SIZE((uint64_t)NDN_FORWARDER_SHARD_QUEUE_SIZE,
+                                                         sizeof(fwd_shard_packet_t))) +
+         FWD_CACHE_ALIGN_SIZE(NDN_SPSC_RING_RESERVE_SIZE((uint64_t)NDN_FORWARDER_SHARD_CONTROL_SIZE,
+                                                         sizeof(fwd_shard_control_t))) +
+         FWD_CACHE_ALIGN_SIZE(FWD_SHARD_SNAPSHOT_SIZE((uint64_t)config->facetab_size));
+}
+
+size_t
+ndn_forwarder_shards_reserve_size(uint32_t count, const ndn_forwarder_config_t* config)
+{
+  uint64_t shard_size = fwd_shard_size(config);
+  uint64_t locks_size = FWD_CACHE_ALIGN_SIZE((uint64_t)config->facetab_size * sizeof(atomic_flag));
+  if (count == 0 || shard_size > (SIZE_MAX - NDN_CACHE_LINE_SIZE - locks_size) / count)
+    return 0;
+  return (size_t)(shard_size * count + locks_size + NDN_CACHE_LINE_SIZE - 1);
+}
+
+int
+ndn_forwarder_shards_init(uint32_t count, uint8_t prefix_components,
+                          const ndn_forwarder_config_t* config,
+                          void* memory, size_t len)
+{
+  uint8_t* ptr = (uint8_t*)memory;
+  ndn_forwarder_shard_t* shard;
+  size_t required;
+  uint32_t i;
+  int ret;
+
+  if (config == NULL || memory == NULL)
+    return NDN_INVALID_POINTER;
+  if (count == 0 || prefix_components == 0 || prefix_components > NDN_NAME_HASH_MAX_DEPTH ||
+      fwd != &forwarder)
+    return NDN_INVALID_ARG;
+  // Shards only learn the faces and routes added from now on
+  if (forwarder.facetab == NULL || forwarder.facetab->count > 0 || forwarder.fib->count > 0)
+    return NDN_INVALID_ARG;
+  ret = fwd_check_config(config);
+  if (ret != NDN_SUCCESS)
+    return ret;
+  required = ndn_forwarder_shards_reserve_size(count, config);
+  if (required == 0 || len < required)
+    return NDN_OVERSIZE;
+
+  ptr += (NDN_CACHE_LINE_SIZE - (uintptr_t)ptr % NDN_CACHE_LINE_SIZE) % NDN_CACHE_LINE_SIZE;
+  shard_memory = ptr;
+  shard_stride = (size_t)fwd_shard_size(config);
+  shard_components = prefix_components;
+  for (i = 0; i < count; i++) {
+    shard = FWD_SHARD(i);
+    ptr = (uint8_t*)shard + FWD_CACHE_ALIGN_SIZE(sizeof(ndn_forwarder_shard_t));
+    fwd_init_tables(&shard->forwarder, config, ptr);
+    ptr += FWD_CACHE_ALIGN_SIZE(ndn_forwarder_reserve_size(config) - (sizeof(uint64_t) - 1));
+
+    ndn_spscring_init(ptr, NDN_FORWARDER_SHARD_QUEUE_SIZE, sizeof(fwd_shard_packet_t));
+    shard->packets = (ndn_spsc_ring_t*)ptr;
+    ptr += FWD_CACHE_ALIGN_SIZE(NDN_SPSC_RING_RESERVE_SIZE(NDN_FORWARDER_SHARD_QUEUE_SIZE,
+                                                           sizeof(fwd_shard_packet_t)));
+
+    ndn_spscring_init(ptr, NDN_FORWARDER_SHARD_CONTROL_SIZE, sizeof(fwd_shard_control_t));
+    shard->control = (ndn_spsc_ring_t*)ptr;
+    ptr += FWD_CACHE_ALIGN_SIZE(NDN_SPSC_RING_RESERVE_SIZE(NDN_FORWARDER_SHARD_CONTROL_SIZE,
+                                                           sizeof(fwd_shard_control_t)));
+
+    shard->snapshot = (_Atomic uint64_t*)ptr;
+    atomic_init(&shard->snapshot_seq, 0);
+    fwd_shard_publish(shard);
+    atomic_flag_clear(&shard->busy);
+    atomic_init(&shard->queue_drops, 0);
+  }
+  // Face IDs agree in all shards, so one lock per ID covers them all
+  shard_send_locks = (atomic_flag*)(shard_memory + (size_t)count * shard_stride);
+  shard_send_lock_count = config->facetab_size;
+  for (i = 0; i < config->facetab_size; i++)
+    atomic_flag_clear(&shard_send_locks[i]);
+  shard_count = count;
+  return NDN_SUCCESS;
+}
+
+uint32_t
+ndn_forwarder_shard_count(void)
+{
+  return shard_count;
+}
+
+const ndn_forwarder_shard_t*
+ndn_forwarder_get_shard(uint32_t index)
+{
+  if (index >= shard_count)
+    return NULL;
+  return FWD_SHARD(index);
+}
+
+// The shard owning a name. Shorter names go by their whole name.
+static ndn_forwarder_shard_t*
+fwd_shard_of(const ndn_name_hash_t* hash)
+{
+  return FWD_SHARD(ndn_name_hash_mix(hash->hashes[hash->depth < shard_components ?
+                                                  hash->depth : shard_components]) % shard_count);
+}
+
+int
+ndn_forwarder_shard_of(uint8_t* packet, size_t length)
+{
+  ndn_packet_index_t index;
+  int ret;
+
+  if (packet == NULL)
+    return NDN_INVALID_POINTER;
+  if (shard_count == 0)
+    return NDN_INVALID_ARG;
+  ret = ndn_packet_index_init(&index, packet, length);
+  if (ret != NDN_SUCCESS)
+    return ret;
+  return (int)(((uint8_t*)fwd_shard_of(&index.name_hash) - shard_memory) / shard_stride);
+}
+
+static int
+fwd_shards_dispatch(ndn_table_id_t face_id, uint8_t* packet, size_t length)
+{
+  ndn_packet_index_t index;
+  int ret;
+  ndn_forwarder_shard_t* shard;
+  fwd_shard_packet_t* slot;
+
+  if (length > NDN_FORWARDER_SHARD_PACKET_SIZE)
+    return NDN_OVERSIZE;
+  // The shard indexes its own copy again, as the views point into this packet
+  ret = ndn_packet_index_init(&index, packet, length);
+  if (ret != NDN_SUCCESS) {
+    fwd->counters.drop_malformed ++;
+    return ret;
+  }
+
+  shard = fwd_shard_of(&index.name_hash);
+  slot = (fwd_shard_packet_t*)ndn_spscring_reserve(shard->packets);
+  if (slot == NULL) {
+    // Counted per shard, as each shard may have its own receiving thread
+    atomic_fetch_add_explicit(&shard->queue_drops, 1, memory_order_relaxed);
+    return NDN_FWD_SHARD_QUEUE_FULL;
+  }
+  slot->length = (uint32_t)length;
+  slot->stamp = (uint32_t)atomic_load_explicit(&shard->control->tail, memory_order_acquire);
+  slot->face_id = face_id;
+  memcpy(slot->packet, packet, length);
+  ndn_spscring_commit(shard->packets);
+  return NDN_SUCCESS;
+}
+
+// Hand a packet of the application to the shard owning its name.
+// Returns NDN_FWD_NO_EFFECT if the calling thread processes it itself.
+static int
+fwd_shards_post(uint8_t op, const ndn_packet_index_t* index, const uint8_t* packet, size_t length,
+                ndn_on_data_func on_data, ndn_on_timeout_func on_timeout, void* userdata)
+{
+  ndn_forwarder_shard_t* shard = fwd_shard_of(&index->name_hash);
+  fwd_shard_control_t* msg;
+
+  if (fwd != &forwarder) {
+    // Data put from a callback answers an Interest of this shard.
+    // Other shards are only reached through the main thread.
+    if (op == FWD_SHARD_EXPRESS_INTEREST && fwd != &shard->forwarder)
+      return NDN_FWD_WRONG_SHARD;
+    return NDN_FWD_NO_EFFECT;
+  }
+  if (length > NDN_FORWARDER_SHARD_PACKET_SIZE)
+    return NDN_OVERSIZE;
+  msg = (fwd_shard_control_t*)ndn_spscring_reserve(shard->control);
+  if (msg == NULL) {
+    fwd->counters.drop_queue_full ++;
+    return NDN_FWD_SHARD_QUEUE_FULL;
+  }
+  msg->op = op;
+  msg->face = NULL;
+  msg->face_id = NDN_INVALID_ID;
+  msg->on_interest = NULL;
+  msg->on_data = on_data;
+  msg->on_timeout = on_timeout;
+  msg->userdata = userdata;
+  msg->strategy = 0;
+  msg->length = (uint32_t)length;
+  memcpy(msg->value, packet, length);
+  ndn_spscring_commit(shard->control);
+  return NDN_SUCCESS;
+}
+
+static int
+fwd_shards_check(size_t prefix_length)
+{
+  uint32_t i;
+
+  if (shard_count == 0 || fwd != &forwarder)
+    return NDN_SUCCESS;
+  if (prefix_length > NDN_NAME_MAX_BLOCK_SIZE)
+    return NDN_OVERSIZE;
+  // Only this thread produces, so a free slot stays free until replicated
+  for (i = 0; i < shard_count; i++) {
+    if (ndn_spscring_reserve(FWD_SHARD(i)->control) == NULL)
+      return NDN_FWD_SHARD_QUEUE_FULL;
+  }
+  return NDN_SUCCESS;
+}
+
+static void
+fwd_shards_replicate(uint8_t op, ndn_face_intf_t* face, const uint8_t* prefix, size_t length,
+                     ndn_on_interest_func on_interest, void* userdata, uint8_t strategy)
+{
+  fwd_shard_control_t* msg;
+  uint32_t i;
+
+  if (shard_count == 0 || fwd != &forwarder)
+    return;
+  for (i = 0; i < shard_count; i++) {
+    // Only updates that cannot fail come here without fwd_shards_check()
+    while ((msg = (fwd_shard_control_t*)ndn_spscring_reserve(FWD_SHARD(i)->control)) == NULL)
+      fwd_shard_try_run(FWD_SHARD(i));
+    msg->op = op;
+    msg->face = face;
+    msg->face_id = (face ? face->face_id : NDN_INVALID_ID);
+    msg->on_interest = on_interest;
+    msg->userdata = userdata;
+    msg->strategy = strategy;
+    msg->length = (uint32_t)length;
+    if (length > 0)
+      memcpy(msg->value, prefix, length);
+    ndn_spscring_commit(FWD_SHARD(i)->control);
+  }
+}
+
+// Apply an update to the current shard.
+// The face ID comes with the update since the face may have been unregistered meanwhile.
+// Calls of the public functions are not replicated again.
+static void
+fwd_shard_apply(fwd_shard_control_t* msg)
+{
+  ndn_fib_entry_t* fib_entry;
+
+  switch (msg->op) {
+  case FWD_SHARD_REGISTER_FACE:
+    // FaceTables change in the same order everywhere, so the IDs agree
+    if (ndn_facetab_register(fwd->facetab, msg->face) != msg->face_id) {
+      NDN_LOG_ERROR("[FORWARDER] Shard face ID mismatch\n");
+    }
+    break;
+  case FWD_SHARD_UNREGISTER_FACE:
+    fwd_unregister_face_id(msg->face_id);
+    break;
+  case FWD_SHARD_ADD_ROUTE:
+    fib_entry = ndn_fib_find_or_insert(fwd->fib, msg->value, msg->length);
+    // PIT entries of the shard may hold face set bitmaps the main forwarder has free
+    if (fib_entry == NULL || ndn_faceset_add(fwd->faces, &fib_entry->nexthop, msg->face_id) != NDN_SUCCESS) {
+      NDN_LOG_ERROR("[FORWARDER] Shard cannot add a route\n");
+      if (fib_entry != NULL)
+        ndn_fib_remove_entry_if_empty(fwd->fib, fib_entry);
+    }
+    break;
+  case FWD_SHARD_REMOVE_ROUTE:
+    fib_entry = ndn_fib_find(fwd->fib, msg->value, msg->length);
+    if (fib_entry != NULL) {
+      ndn_faceset_remove(fwd->faces, &fib_entry->nexthop, msg->face_id);
+      ndn_fib_remove_entry_if_empty(fwd->fib, fib_entry);
+    }
+    break;
+  case FWD_SHARD_REMOVE_ALL_ROUTES:
+    ndn_forwarder_remove_all_routes(msg->value, msg->length);
+    break;
+  case FWD_SHARD_REGISTER_PREFIX:
+    ndn_forwarder_register_prefix(msg->value, msg->length, msg->on_interest, msg->userdata);
+    break;
+  case FWD_SHARD_UNREGISTER_PREFIX:
+    ndn_forwarder_unregister_prefix(msg->value, msg->length);
+    break;
+  case FWD_SHARD_SET_STRATEGY:
+    ndn_forwarder_set_strategy(msg->value, msg->length, msg->strategy);
+    break;
+  case FWD_SHARD_EXPRESS_INTEREST:
+    ndn_forwarder_express_interest(msg->value, msg->length, msg->on_data, msg->on_timeout, msg->userdata);
+    break;
+  case FWD_SHARD_PUT_DATA:
+    ndn_forwarder_put_data(msg->value, msg->length);
+    break;
+  }
+}
+
+// Apply the updates queued before a tail of the control queue
+static void
+fwd_shard_apply_until(ndn_forwarder_shard_t* shard, uint32_t tail)
+{
+  fwd_shard_control_t* msg;
+  uint32_t head;
+
+  for (;;) {
+    head = (uint32_t)atomic_load_explicit(&shard->control->head, memory_order_relaxed);
+    if ((int32_t)(tail - head) <= 0)
+      break;
+    msg = (fwd_shard_control_t*)ndn_spscring_front(shard->control);
+    fwd_shard_apply(msg);
+    ndn_spscring_pop(shard->control);
   }
+}
 
+// Process a shard on the calling thread, which must hold its busy flag
+static int
+fwd_shard_run(ndn_forwarder_shard_t* shard)
+{
+  ndn_forwarder_t* caller = fwd;
+  fwd_shard_packet_t* slot;
+  int count = 0;
+
+  fwd = &shard->forwarder;
+
+  // Bound the batch so the PIT is expired even under full load
+  while (count < NDN_FORWARDER_SHARD_QUEUE_SIZE &&
+         (slot = (fwd_shard_packet_t*)ndn_spscring_front(shard->packets)) != NULL) {
+    // A face unregistered after this packet was queued is still there,
+    // and one registered since with the same ID is not yet
+    fwd_shard_apply_until(shard, slot->stamp);
+    fwd_receive(slot->face_id, slot->packet, slot->length);
+    ndn_spscring_pop(shard->packets);
+    count ++;
+  }
+  fwd_shard_apply_until(shard, (uint32_t)atomic_load_explicit(&shard->control->tail,
+                                                              memory_order_acquire));
+  ndn_pit_process_timeout(fwd->pit, ndn_time_now_ms());
+  ndn_forwarder_flush();
+  fwd_shard_publish(shard);
+
+  fwd = caller;
+  return count;
+}
+
+// Process a shard unless another thread is processing it
+static int
+fwd_shard_try_run(ndn_forwarder_shard_t* shard)
+{
+  int count;
+
+  if (atomic_flag_test_and_set_explicit(&shard->busy, memory_order_acquire))
+    return 0;
+  count = fwd_shard_run(shard);
+  atomic_flag_clear_explicit(&shard->busy, memory_order_release);
+  return count;
+}
+
+int
+ndn_forwarder_shard_process(uint32_t index)
+{
+  if (index >= shard_count)
+    return NDN_INVALID_ARG;
+  return fwd_shard_try_run(FWD_SHARD(index));
+}
+
+// Wait until every shard has applied the updates queued so far and published its
+// statistics, processing the shards no other thread is processing meanwhile
+static void
+fwd_shards_sync(void)
+{
+  ndn_forwarder_shard_t* shard;
+  uint_fast32_t tail;
+  uint32_t i;
+
+  if (shard_count == 0 || fwd != &forwarder)
+    return;
+  for (i = 0; i < shard_count; i++) {
+    shard = FWD_SHARD(i);
+    // Only this thread produces, so the tail stays put meanwhile
+    tail = atomic_load_explicit(&shard->control->tail, memory_order_relaxed);
+    while (atomic_load_explicit(&shard->snapshot_control, memory_order_acquire) != tail)
+      fwd_shard_try_run(shard);
+  }
+}
+
+#else
+
+static int
+fwd_shards_check(size_t prefix_length)
+{
+  (void)prefix_length;
   return NDN_SUCCESS;
 }
+
+static void
+fwd_shards_replicate(uint8_t op, ndn_face_intf_t* face, const uint8_t* prefix, size_t length,
+                     ndn_on_interest_func on_interest, void* userdata, uint8_t strategy)
+{
+  (void)op;
+  (void)face;
+  (void)prefix;
+  (void)length;
+  (void)on_interest;
+  (void)userdata;
+  (void)strategy;
+}
+
+static void
+fwd_shards_sync(void)
+{
+}
+
+#endif // NDN_FORWARDER_SHARDING
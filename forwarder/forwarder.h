@@ -16,32 +16,239 @@
 #include "pit.h"
 #include "cs.h"
 #include "fib.h"
+#include "strategy.h"
 #include "face-table.h"
+#include "face-set.h"
+#include "dead-nonce.h"
 #include "../encode/name.h"
 #include "../encode/interest.h"
 #include "callback-funcs.h"
-#include "../util/dll.h"
 #include "../util/msg-queue.h"
+#if NDN_FORWARDER_SHARDING
+#include "../util/spsc-ring.h"
+#endif
+
+/** Round @c size up so the table placed after it stays aligned.
+ */
+#define NDN_FORWARDER_ALIGN_SIZE(size) \
+  (((size) + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t))
 
-#define NDN_FORWARDER_RESERVE_SIZE(nametree_size, facetab_size, fib_size, pit_size, cs_size) \
-  (NDN_NAMETREE_RESERVE_SIZE(nametree_size) + \
-   NDN_FACE_TABLE_RESERVE_SIZE(facetab_size) + \
-   NDN_FIB_RESERVE_SIZE(fib_size) + \
-   NDN_PIT_RESERVE_SIZE(pit_size) + \
-   NDN_PIT_RESERVE_SIZE(cs_size))
+/** One in how many PIT and FIB entries may have a face set spilled into a bitmap,
+ * unless the number of bitmaps is given.
+ */
+#ifndef NDN_FORWARDER_FACE_SET_RATIO
+#define NDN_FORWARDER_FACE_SET_RATIO 8
+#endif
+
+/** Number of face set bitmaps a forwarder reserves unless given.
+ * Only sets with more than #NDN_FACE_SET_INLINE_SIZE faces take one.
+ */
+#define NDN_FORWARDER_FACE_SET_DEFAULT_COUNT(fib_size, pit_size) \
+  (((pit_size) + (fib_size)) / NDN_FORWARDER_FACE_SET_RATIO + 1)
+
+/** Number of face set bitmaps a forwarder reserves for @c faceset_size of them.
+ * 0 stands for #NDN_FORWARDER_FACE_SET_DEFAULT_COUNT.
+ */
+#define NDN_FORWARDER_FACE_SET_COUNT(faceset_size, fib_size, pit_size) \
+  ((faceset_size) ? (faceset_size) : NDN_FORWARDER_FACE_SET_DEFAULT_COUNT(fib_size, pit_size))
+
+/** Interests per second the Dead Nonce List is sized for, unless its size is given.
+ */
+#ifndef NDN_FORWARDER_DNL_RATE
+#define NDN_FORWARDER_DNL_RATE 100
+#endif
+
+/** Number of (Name, Nonce) pairs the Dead Nonce List is sized for, unless given:
+ * #NDN_FORWARDER_DNL_RATE Interests per second over the longest time a pair is kept,
+ * #NDN_DNL_LIFETIME and one more generation.
+ */
+#define NDN_FORWARDER_DNL_DEFAULT_SIZE \
+  (NDN_FORWARDER_DNL_RATE * (NDN_DNL_LIFETIME + NDN_DNL_LIFETIME / NDN_DNL_GENERATIONS) / 1000)
+
+/** Number of Dead Nonce List buckets a forwarder reserves for @c dnl_size pairs.
+ * 0 stands for #NDN_FORWARDER_DNL_DEFAULT_SIZE. The filter is kept at most half full,
+ * so it seldom evicts, and a lookup matches a fingerprint by chance at most 1 in 16384 times.
+ */
+#define NDN_FORWARDER_DNL_BUCKETS(dnl_size) \
+  ((2 * ((dnl_size) ? (dnl_size) : NDN_FORWARDER_DNL_DEFAULT_SIZE) + NDN_DNL_BUCKET_SIZE - 1) / \
+   NDN_DNL_BUCKET_SIZE)
+
+/** The memory reserved for all tables of a forwarder.
+ * @note The memory passed to ndn_forwarder_init_ex() may need up to
+ *       <tt>sizeof(uint64_t) - 1</tt> more bytes for alignment.
+ */
+#define NDN_FORWARDER_RESERVE_SIZE(nametree_size, facetab_size, fib_size, pit_size, cs_size, cs_bytes, \
+                                   dnl_size, faceset_size) \
+  (NDN_FORWARDER_ALIGN_SIZE(NDN_NAMETREE_RESERVE_SIZE(nametree_size)) + \
+   NDN_FORWARDER_ALIGN_SIZE(NDN_FACE_TABLE_RESERVE_SIZE(facetab_size)) + \
+   NDN_FORWARDER_ALIGN_SIZE(NDN_FACE_SET_POOL_RESERVE_SIZE( \
+     NDN_FORWARDER_FACE_SET_COUNT(faceset_size, fib_size, pit_size), facetab_size)) + \
+   NDN_FORWARDER_ALIGN_SIZE(NDN_FIB_RESERVE_SIZE(fib_size) + NDN_FIB_INDEX_SIZE(nametree_size)) + \
+   NDN_FORWARDER_ALIGN_SIZE(NDN_PIT_RESERVE_SIZE(pit_size)) + \
+   NDN_FORWARDER_ALIGN_SIZE(NDN_DNL_RESERVE_SIZE(NDN_FORWARDER_DNL_BUCKETS(dnl_size))) + \
+   NDN_FORWARDER_ALIGN_SIZE(NDN_CS_RESERVE_SIZE(cs_size, cs_bytes)))
 
 #define NDN_FORWARDER_DEFAULT_SIZE \
   NDN_FORWARDER_RESERVE_SIZE(NDN_NAMETREE_MAX_SIZE, \
                              NDN_FACE_TABLE_MAX_SIZE, \
                              NDN_FIB_MAX_SIZE, \
                              NDN_PIT_MAX_SIZE, \
-                             NDN_CS_MAX_SIZE)
+                             NDN_CS_MAX_SIZE, \
+                             NDN_CS_MAX_BYTES, \
+                             NDN_FORWARDER_DNL_DEFAULT_SIZE, \
+                             NDN_FORWARDER_FACE_SET_DEFAULT_COUNT(NDN_FIB_MAX_SIZE, NDN_PIT_MAX_SIZE))
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-// TODO: Add support of content store and make it a modular component: can be realized with RAM, ROM, etc. the size is configurable.
+/** Table sizes of a forwarder.
+ *
+ * Used by ndn_forwarder_init_ex() to size the tables at runtime.
+ */
+typedef struct ndn_forwarder_config {
+  /** Maximum number of NameTree nodes, including the root.
+   */
+  ndn_table_id_t nametree_size;
+
+  /** Maximum number of faces.
+   */
+  ndn_table_id_t facetab_size;
+
+  /** Maximum number of FIB entries.
+   */
+  ndn_table_id_t fib_size;
+
+  /** Maximum number of PIT entries.
+   */
+  ndn_table_id_t pit_size;
+
+  /** Maximum number of CS entries.
+   */
+  ndn_table_id_t cs_size;
+
+  /** Maximum bytes of Data kept by the CS.
+   * At least #NDN_CS_BLOCK_SIZE.
+   */
+  size_t cs_bytes;
+
+  /** Number of (Name, Nonce) pairs the Dead Nonce List is sized for.
+   * It should cover the Interests received within #NDN_DNL_LIFETIME and one more
+   * generation, or the list forgets pairs and drops more valid Interests by chance.
+   * 0 sizes it by #NDN_FORWARDER_DNL_RATE.
+   */
+  uint32_t dnl_size;
+
+  /** Number of bitmaps for face sets of PIT and FIB entries with more than
+   * #NDN_FACE_SET_INLINE_SIZE faces. When they run out, Interests which need one
+   * are dropped and routes which need one are refused.
+   * 0 sizes it by #NDN_FORWARDER_FACE_SET_RATIO.
+   */
+  ndn_table_id_t faceset_size;
+} ndn_forwarder_config_t;
+
+/** Packet counters of the forwarding pipelines.
+ */
+typedef struct ndn_forwarder_counters {
+  /** Interests received from faces. */
+  uint64_t in_interests;
+  /** Data received from faces. */
+  uint64_t in_data;
+  /** Interests sent to faces. */
+  uint64_t out_interests;
+  /** Data sent to faces. */
+  uint64_t out_data;
+  /** Interests satisfied by the CS. */
+  uint64_t cs_hits;
+  /** Interests not satisfied by the CS. */
+  uint64_t cs_misses;
+  /** Interests dropped because the Dead Nonce List holds their Name and Nonce. */
+  uint64_t drop_dead_nonce;
+  /** Interests dropped for lack of a FIB entry. */
+  uint64_t drop_no_route;
+  /** Interests dropped because the PIT is full. */
+  uint64_t drop_pit_full;
+  /** Interests dropped, or not sent to all next hops, because no face set bitmap
+   * is free to record their faces. */
+  uint64_t drop_face_set_full;
+  /** Interests dropped because the HopLimit is 0. */
+  uint64_t drop_hop_limit;
+  /** Data dropped for lack of a matching PIT entry. */
+  uint64_t drop_unsolicited;
+  /** Packets dropped for a TLV error. */
+  uint64_t drop_malformed;
+  /** Packets dropped because the queue of their shard is full. */
+  uint64_t drop_queue_full;
+} ndn_forwarder_counters_t;
+
+/** A snapshot of all forwarder counters and table occupancy.
+ */
+typedef struct ndn_forwarder_stats {
+  ndn_forwarder_counters_t counters;
+  ndn_pit_stats_t pit;
+  ndn_cs_stats_t cs;
+  ndn_fib_stats_t fib;
+  ndn_dnl_stats_t dnl;
+
+  /** Entries in use and capacity of each table. */
+  ndn_table_id_t pit_count;
+  ndn_table_id_t pit_capacity;
+  ndn_table_id_t cs_count;
+  ndn_table_id_t cs_capacity;
+  ndn_table_id_t fib_count;
+  ndn_table_id_t fib_capacity;
+  ndn_table_id_t face_count;
+  ndn_table_id_t face_capacity;
+
+  /** (Name, Nonce) pairs held by the Dead Nonce List and its capacity. */
+  uint32_t dnl_count;
+  uint32_t dnl_capacity;
+  /** Estimated false-positive rate of the Dead Nonce List, in parts per million. */
+  uint32_t dnl_fp_rate;
+
+  /** Bytes of Data held by the CS, and its arena size. */
+  size_t cs_used_bytes;
+  size_t cs_arena_bytes;
+} ndn_forwarder_stats_t;
+
+/** The callback function to dump forwarder statistics.
+ * @param[in] stats A snapshot taken right before the call.
+ * @param[in] userdata User-defined data given to ndn_forwarder_set_stats_hook().
+ */
+typedef void (*ndn_forwarder_stats_hook_func)(const ndn_forwarder_stats_t* stats, void* userdata);
+
+#if NDN_FORWARDER_TX_BATCH_SIZE > 0
+
+/** Bytes buffered for queued outgoing packets.
+ * Larger packets are sent on their own.
+ */
+#ifndef NDN_FORWARDER_TX_BUFFER_SIZE
+#define NDN_FORWARDER_TX_BUFFER_SIZE 16384
+#endif
+
+/** Outgoing packets queued for faces with a batch send function.
+ *
+ * Packets are copied, since the buffers they are built in are reused
+ * by the next packet, except packets in a packet buffer, of which a
+ * reference is queued instead. The queue is flushed by ndn_forwarder_flush(),
+ * or earlier when it is full.
+ */
+typedef struct ndn_forwarder_tx_queue {
+  uint32_t count;
+  uint32_t used;
+  /** Set while flushing. Packets sent meanwhile bypass the queue.
+   */
+  bool flushing;
+  ndn_table_id_t face_ids[NDN_FORWARDER_TX_BATCH_SIZE];
+  uint32_t offsets[NDN_FORWARDER_TX_BATCH_SIZE];
+  uint32_t sizes[NDN_FORWARDER_TX_BATCH_SIZE];
+  /** Packet buffers referenced instead of copied. NULL for copied packets.
+   */
+  ndn_pktbuf_t* bufs[NDN_FORWARDER_TX_BATCH_SIZE];
+  uint8_t buf[NDN_FORWARDER_TX_BUFFER_SIZE];
+} ndn_forwarder_tx_queue_t;
+
+#endif // NDN_FORWARDER_TX_BATCH_SIZE > 0
 
 /**
  * NDN-Lite forwarder.
@@ -52,6 +259,11 @@ typedef struct ndn_forwarder {
   ndn_nametree_t* nametree;
   ndn_face_table_t* facetab;
 
+  /**
+   * Bitmaps for PIT and FIB face sets with many faces.
+   */
+  ndn_face_set_pool_t* faces;
+
   /**
    * The forwarding information base (FIB).
    */
@@ -64,10 +276,97 @@ typedef struct ndn_forwarder {
    * The content store (CS).
    */
   ndn_cs_t* cs;
+  /**
+   * The Dead Nonce List (DNL).
+   */
+  ndn_dnl_t* dnl;
+
+  /**
+   * Packet counters.
+   * They are written for every packet, so they start a new cache line
+   * apart from the table pointers above, which are read for every packet.
+   */
+  NDN_CACHE_ALIGNED ndn_forwarder_counters_t counters;
 
-  uint8_t memory[NDN_FORWARDER_DEFAULT_SIZE];
+  /**
+   * Periodic statistics dump. No dump if @c stats_hook is NULL.
+   */
+  NDN_CACHE_ALIGNED ndn_forwarder_stats_hook_func stats_hook;
+  void* stats_userdata;
+  uint32_t stats_interval;
+  struct ndn_timer* stats_timer;
+
+  /**
+   * Packet buffer of the packet being received, if any.
+   * Outgoing copies of it are sent by reference.
+   */
+  ndn_pktbuf_t* rx_buf;
+
+#if NDN_FORWARDER_TX_BATCH_SIZE > 0
+  /**
+   * Outgoing packets not flushed yet.
+   */
+  NDN_CACHE_ALIGNED ndn_forwarder_tx_queue_t tx;
+#endif
 } ndn_forwarder_t;
 
+#if NDN_FORWARDER_SHARDING
+
+/** Bytes of the largest packet a face can hand to a shard.
+ */
+#define NDN_FORWARDER_SHARD_PACKET_SIZE 2048
+
+/** Number of packets queued from faces to each shard. A power of 2.
+ */
+#define NDN_FORWARDER_SHARD_QUEUE_SIZE 256
+
+/** Number of FaceTable and FIB updates and application packets queued to each shard.
+ * A power of 2.
+ */
+#define NDN_FORWARDER_SHARD_CONTROL_SIZE 32
+
+/** A forwarder shard.
+ *
+ * Each shard owns a full set of tables. Names are assigned to shards by a hash
+ * of their first components, so the Interests and Data of a name meet in one shard.
+ */
+typedef struct ndn_forwarder_shard {
+  ndn_forwarder_t forwarder;
+
+  /** Packets from faces. The thread calling ndn_forwarder_receive() produces.
+   */
+  ndn_spsc_ring_t* packets;
+
+  /** FaceTable and FIB updates, replicated to every shard,
+   * and Interests and Data of the application. The main thread produces.
+   */
+  ndn_spsc_ring_t* control;
+
+  /** Set while a thread processes the shard.
+   */
+  atomic_flag busy;
+
+  /** Packets from faces dropped because @c packets was full.
+   * Written by the thread receiving packets for this shard.
+   */
+  _Atomic uint64_t queue_drops;
+
+  /** Incremented before and after the shard writes @c snapshot, so it is odd meanwhile.
+   */
+  NDN_CACHE_ALIGNED atomic_uint_fast32_t snapshot_seq;
+
+  /** Head of @c control when @c snapshot was written.
+   */
+  atomic_uint_fast32_t snapshot_control;
+
+  /** Statistics of the shard as of the end of its last processing:
+   * an ndn_forwarder_stats_t, then an ndn_face_stats_t per face ID, word by word.
+   */
+  _Atomic uint64_t* snapshot;
+} ndn_forwarder_shard_t;
+
+#endif // NDN_FORWARDER_SHARDING
+
 /**@defgroup NDNFwd Forwarder
  * @brief A lite forwarder.
  */
@@ -79,22 +378,168 @@ typedef struct ndn_forwarder {
  */
 
 /** Initialize all components of the forwarder.
+ *
+ * Table sizes are #NDN_NAMETREE_MAX_SIZE, #NDN_FACE_TABLE_MAX_SIZE, #NDN_FIB_MAX_SIZE,
+ * #NDN_PIT_MAX_SIZE, #NDN_CS_MAX_SIZE, #NDN_CS_MAX_BYTES and #NDN_FORWARDER_DNL_DEFAULT_SIZE.
+ * @return #NDN_SUCCESS if the call succeeded. The error code of ndn_forwarder_init_ex()
+ *         otherwise, in which case the forwarder must not be used.
  */
-void
+int
 ndn_forwarder_init(void);
 
+/** Initialize all components of the forwarder with table sizes given at runtime.
+ *
+ * @param[in] config Table sizes.
+ * @param[in, out] memory Memory to place the tables. It must outlive the forwarder.
+ * @param[in] len The length of @c memory.
+ * @return #NDN_SUCCESS if the call succeeded. The error code otherwise.
+ * @retval #NDN_INVALID_ARG A table size is 0, or the NameTree has no room besides the root.
+ * @retval #NDN_OVERSIZE A table size is not less than #NDN_INVALID_ID, so is the number of
+ *                       face set bitmaps, or @c len is less than ndn_forwarder_reserve_size().
+ */
+int
+ndn_forwarder_init_ex(const ndn_forwarder_config_t* config, void* memory, size_t len);
+
+/** Get the memory needed by ndn_forwarder_init_ex().
+ *
+ * @param[in] config Table sizes.
+ * @return The size in bytes, including alignment slack. 0 if it does not fit in @c size_t.
+ */
+size_t
+ndn_forwarder_reserve_size(const ndn_forwarder_config_t* config);
+
 /** Returns the forwarder as a pointer
+ *
+ * Inside ndn_forwarder_shard_process() this is the shard being processed.
  */
 const ndn_forwarder_t*
 ndn_forwarder_get(void);
 
-/** Process event messages.
+/** Process event messages, run due timers and expire due PIT entries.
  *
- * This should be called at a fixed interval.
+ * This should be called at a fixed interval,
+ * or whenever ndn_forwarder_next_deadline() is reached.
  */
 void
 ndn_forwarder_process(void);
 
+/** Get the time at which ndn_forwarder_process() next has work to do.
+ *
+ * An event loop may sleep until this time if no packet arrives meanwhile.
+ * @return The current time if there are pending messages, the earliest
+ *         PIT deadline or statistics dump otherwise.
+ *         #NDN_PIT_NO_DEADLINE if there is nothing to wait for.
+ */
+ndn_time_ms_t
+ndn_forwarder_next_deadline(void);
+
+/** Send out the packets queued for faces with a batch send function.
+ *
+ * Called at the end of ndn_forwarder_process() and ndn_forwarder_receive_batch().
+ * Call it after ndn_forwarder_receive() if packets must leave before the next round.
+ */
+void
+ndn_forwarder_flush(void);
+
+/** Wait for face I/O until a deadline.
+ *
+ * Provided by the platform event loop. It handles ready faces,
+ * usually by calling ndn_forwarder_receive(), and returns once
+ * anything was handled or @c deadline is reached.
+ * @param[in] deadline The time to return by. #NDN_PIT_NO_DEADLINE to wait for I/O only.
+ * @param[in] userdata User-defined data given to ndn_forwarder_set_wait_func().
+ * @return The number of events handled. A negative error code if waiting failed.
+ */
+typedef int (*ndn_forwarder_wait_func)(ndn_time_ms_t deadline, void* userdata);
+
+/** Set the function ndn_forwarder_run() blocks in.
+ *
+ * @param[in] wait The wait function. NULL to sleep without watching faces.
+ * @param[in] userdata Passed to @c wait.
+ */
+void
+ndn_forwarder_set_wait_func(ndn_forwarder_wait_func wait, void* userdata);
+
+/** Set the pool faces receive packets into.
+ *
+ * Faces that support it take a buffer from the pool for every packet and hand
+ * it over with ndn_forwarder_receive_buf(), so the packet is never copied on its
+ * way to the CS or out of other faces. Only the thread running the forwarder
+ * may use the pool, so a sharded forwarder copies the packets into its shard
+ * queues and gains no zero-copy.
+ * @param[in] pool The pool. NULL to let faces receive into their own buffers.
+ */
+void
+ndn_forwarder_set_packet_pool(ndn_pktbuf_pool_t* pool);
+
+/** Get the pool set by ndn_forwarder_set_packet_pool().
+ * @return The pool. NULL if none is set.
+ */
+ndn_pktbuf_pool_t*
+ndn_forwarder_get_packet_pool(void);
+
+/** Run one round of the forwarder event loop.
+ *
+ * Process pending work, block until a face is ready, ndn_forwarder_next_deadline()
+ * or @c timeout is reached, then process again.
+ * Faces polled through the message queue keep the deadline at the current time,
+ * so this never blocks while such faces are up.
+ * @param[in] timeout Milliseconds to block at most. 0 to not block.
+ * @return The number of events handled by the wait function.
+ *         The error code of the wait function otherwise.
+ */
+int
+ndn_forwarder_run(uint32_t timeout);
+
+/** Take a snapshot of the forwarder counters and table occupancy.
+ *
+ * If the forwarder is sharded, the main thread gets the sum of the forwarder and of
+ * every shard as of the end of its last ndn_forwarder_shard_process(). PIT, CS and
+ * Dead Nonce List occupancy and capacity are those of the shards, saturated at
+ * #NDN_INVALID_ID for table IDs, with the false-positive rate of the worst shard.
+ * FIB and face table sizes are those of the main forwarder, as the shards replicate it.
+ * A shard thread gets the statistics of its own shard.
+ * @param[out] stats The snapshot.
+ * @return #NDN_SUCCESS if the call succeeded. The error code otherwise.
+ * @retval #NDN_INVALID_POINTER @c stats is NULL.
+ */
+int
+ndn_forwarder_get_stats(ndn_forwarder_stats_t* stats);
+
+/** Get the counters of a face.
+ *
+ * Counters are reset when the face is registered. If the forwarder is sharded,
+ * the main thread gets the sum over the shards, as ndn_forwarder_get_stats().
+ * @param[in] face The face.
+ * @param[out] stats The counters.
+ * @return #NDN_SUCCESS if the call succeeded. The error code otherwise.
+ * @retval #NDN_FWD_INVALID_FACE @c face is not registered.
+ */
+int
+ndn_forwarder_get_face_stats(const ndn_face_intf_t* face, ndn_face_stats_t* stats);
+
+/** Get the measurements of a face.
+ *
+ * Measurements are reset when the face is registered.
+ * @param[in] face The face.
+ * @param[out] measurements The measurements.
+ * @return #NDN_SUCCESS if the call succeeded. The error code otherwise.
+ * @retval #NDN_FWD_INVALID_FACE @c face is not registered.
+ */
+int
+ndn_forwarder_get_face_measurements(const ndn_face_intf_t* face, ndn_face_measurements_t* measurements);
+
+/** Dump statistics periodically.
+ *
+ * The hook is called with a snapshot from a message queue timer,
+ * every @c interval milliseconds, when ndn_forwarder_process() runs.
+ * @param[in] hook The callback function. NULL to stop dumping.
+ * @param[in] interval The interval in milliseconds.
+ * @param[in] userdata [Optional] User-defined data, copied to @c hook.
+ */
+void
+ndn_forwarder_set_stats_hook(ndn_forwarder_stats_hook_func hook, uint32_t interval, void* userdata);
+
 /** Register a new face.
  *
  * The face should call this to get a face id during creation.
@@ -117,6 +562,8 @@ ndn_forwarder_register_face(ndn_face_intf_t* face);
  * @return #NDN_SUCCESS if the call succeeded. The error code otherwise.
  * @retval #NDN_FWD_NO_EFFECT @c face is not in FaceTable now.
  * @note The application doesn't need to unregister faces manually.
+ * @note If the forwarder is sharded, this returns only after every shard has dropped
+ *       @c face, so it may be freed right away. See ndn_forwarder_shards_init().
  * @post <tt>face->face_id == #NDN_INVALID_ID</tt>
  */
 int
@@ -130,13 +577,25 @@ ndn_forwarder_unregister_face(ndn_face_intf_t* face);
  * @return #NDN_SUCCESS if the call succeeded. The error code otherwise.
  * @retval #NDN_FWD_FIB_FULL FIB or NameTree is full. See also #NDN_FIB_MAX_SIZE,
  *                          #NDN_NAMETREE_MAX_SIZE.
+ * @retval #NDN_OVERSIZE The route needs a face set bitmap and none is free.
+ *                       See also ndn_forwarder_config#faceset_size.
  */
 int
 ndn_forwarder_add_route(ndn_face_intf_t* face, uint8_t* prefix, size_t length);
 
+/** Add a route into FIB, with the prefix given as a string.
+ *
+ * This and the other functions taking a name or an Interest structure encode it
+ * into the scratch memory of the calling thread, so they may be called from
+ * callbacks and from several threads. See @ref NDNUtilScratch.
+ * @retval #NDN_OVERSIZE Not enough scratch memory is left, see #NDN_SCRATCH_SIZE.
+ */
 int
 ndn_forwarder_add_route_by_str(ndn_face_intf_t* face, const char* prefix, size_t length);
 
+/** Add a route into FIB, with the prefix given as a Name structure.
+ * @sa ndn_forwarder_add_route_by_str
+ */
 int
 ndn_forwarder_add_route_by_name(ndn_face_intf_t* face, const ndn_name_t* prefix);
 
@@ -163,12 +622,79 @@ ndn_forwarder_remove_route(ndn_face_intf_t* face, uint8_t* prefix, size_t length
 int
 ndn_forwarder_remove_all_routes(uint8_t* prefix, size_t length);
 
+/** Set the forwarding strategy of a prefix.
+ *
+ * Interests use the strategy of the longest prefix with a FIB entry.
+ * The strategy is kept until the FIB entry is removed with its last route.
+ * @param[in] prefix The prefix, which needs a route or a registered prefix.
+ * @param[in] length The length of @c prefix.
+ * @param[in] strategy #NDN_FWD_STRATEGY_MULTICAST, #NDN_FWD_STRATEGY_BEST_ROUTE,
+ *                     #NDN_FWD_STRATEGY_ROUND_ROBIN or #NDN_FWD_STRATEGY_ADAPTIVE.
+ * @return #NDN_SUCCESS if the call succeeded. The error code otherwise.
+ * @retval #NDN_INVALID_ARG @c strategy is unknown.
+ * @retval #NDN_FWD_NO_EFFECT Currently @c prefix has no FIB entry.
+ * @sa NDNFwdStrategy
+ */
+int
+ndn_forwarder_set_strategy(uint8_t* prefix, size_t length, uint8_t strategy);
+
 /** Receive a packet from a face.
  *
+ * If the forwarder is sharded, the packet is copied to the queue of its shard.
+ * @return #NDN_SUCCESS if the call succeeded. The error code otherwise.
+ * @retval #NDN_FWD_SHARD_QUEUE_FULL The queue of the shard is full.
  */
 int
 ndn_forwarder_receive(ndn_face_intf_t* face, uint8_t* packet, size_t length);
 
+/** Receive a packet held in a packet buffer from a face.
+ *
+ * Like ndn_forwarder_receive(), but the CS and outgoing faces keep references
+ * of @c buf instead of copying the packet. Only the unsharded forwarder does so:
+ * if the forwarder is sharded, the packet is copied to the queue of its shard
+ * and @c buf is released right away, as the pool belongs to the receiving thread.
+ * @param[in] face The incoming face.
+ * @param[in] buf The packet. The call takes over one reference of it in all cases.
+ * @return Same as ndn_forwarder_receive().
+ * @retval #NDN_INVALID_POINTER @c buf is NULL.
+ */
+int
+ndn_forwarder_receive_buf(ndn_face_intf_t* face, ndn_pktbuf_t* buf);
+
+/** Receive a burst of packets from a face.
+ *
+ * The face is looked up once for the burst, and queued outgoing packets
+ * are flushed at the end. Each packet still goes through the PIT, CS and FIB
+ * on its own. Per-packet errors are only counted in the forwarder
+ * statistics, so a bad packet does not stop the burst.
+ * @param[in] face The incoming face.
+ * @param[in] packets The packets. They may be modified in place.
+ * @param[in] lengths The length of each packet.
+ * @param[in] count The number of packets.
+ * @return The number of packets taken, from the front of @c packets.
+ *         Less than @c count only if a shard queue filled up.
+ *         The error code if the arguments are invalid.
+ * @retval #NDN_INVALID_POINTER @c packets or @c lengths is NULL.
+ */
+int
+ndn_forwarder_receive_batch(ndn_face_intf_t* face, uint8_t* const packets[],
+                            const size_t lengths[], size_t count);
+
+/** Receive a burst of packets held in packet buffers from a face.
+ *
+ * ndn_forwarder_receive_batch() for packet buffers: the packets are kept by
+ * reference as by ndn_forwarder_receive_buf().
+ * @param[in] face The incoming face.
+ * @param[in] bufs The packets. The call takes over one reference of each in all cases.
+ * @param[in] count The number of packets.
+ * @return The number of packets taken, from the front of @c bufs.
+ *         Less than @c count only if a shard queue filled up, and the rest are dropped.
+ *         The error code if the arguments are invalid.
+ * @retval #NDN_INVALID_POINTER @c bufs is NULL.
+ */
+int
+ndn_forwarder_receive_buf_batch(ndn_face_intf_t* face, ndn_pktbuf_t* const bufs[], size_t count);
+
 /** Register a prefix.
  *
  * A latter registration cancels the former one.
@@ -185,6 +711,9 @@ ndn_forwarder_register_prefix(uint8_t* prefix, size_t length,
                               ndn_on_interest_func on_interest,
                               void* userdata);
 
+/** Register a prefix given as a Name structure.
+ * @sa ndn_forwarder_add_route_by_str
+ */
 int
 ndn_forwarder_register_name_prefix(const ndn_name_t* prefix,
                                    ndn_on_interest_func on_interest,
@@ -212,6 +741,12 @@ ndn_forwarder_unregister_prefix(uint8_t* prefix, size_t length);
  * @return #NDN_SUCCESS if the call succeeded. The error code otherwise.
  * @retval #NDN_FWD_PIT_FULL PIT or NameTree is full. See also #NDN_PIT_MAX_SIZE,
  *                          #NDN_NAMETREE_MAX_SIZE.
+ * @retval #NDN_FWD_SHARD_QUEUE_FULL The forwarder is sharded and the control queue
+ *                                   of the shard owning the name is full.
+ * @retval #NDN_FWD_WRONG_SHARD Called from a shard thread, and another shard owns the name.
+ * @note If the forwarder is sharded, an Interest expressed from the main thread is
+ *       handed to the shard owning its name, and expressed when that shard is processed.
+ *       Errors of that expression are not reported, and the callbacks run in that shard.
  */
 int
 ndn_forwarder_express_interest(uint8_t* interest, size_t length,
@@ -219,17 +754,112 @@ ndn_forwarder_express_interest(uint8_t* interest, size_t length,
                                ndn_on_timeout_func on_timeout,
                                void* userdata);
 
+/** Express an Interest given as a structure.
+ * @sa ndn_forwarder_add_route_by_str
+ */
 int
 ndn_forwarder_express_interest_struct(ndn_interest_t* interest,
                                       ndn_on_data_func on_data,
                                       ndn_on_timeout_func on_timeout,
                                       void* userdata);
 
+#if NDN_FORWARDER_SHARDING
+
+/** Get the memory needed by ndn_forwarder_shards_init().
+ *
+ * @param[in] count Number of shards.
+ * @param[in] config Table sizes of each shard.
+ * @return The size in bytes, including alignment slack. 0 if it does not fit in @c size_t.
+ */
+size_t
+ndn_forwarder_shards_reserve_size(uint32_t count, const ndn_forwarder_config_t* config);
+
+/** Split forwarding into shards.
+ *
+ * After this call ndn_forwarder_receive() hands packets to the shard selected by
+ * a hash of the first @c prefix_components components of their names.
+ * FaceTable and FIB updates are applied to the forwarder and replicated to every shard.
+ * Each shard is then driven by its own thread calling ndn_forwarder_shard_process().
+ * All other functions must be called from one thread, the main thread, which faces
+ * also use to call ndn_forwarder_receive(). Alternatively, each shard may have its
+ * own thread calling ndn_forwarder_receive(), with only the packets
+ * ndn_forwarder_shard_of() assigns to that shard.
+ *
+ * Only the forwarder state is per shard. The message queue, timers, packet buffer pool
+ * and ndn_forwarder_set_stats_hook() remain for the main thread. Callbacks running in
+ * shards reach it with ndn_msgqueue_post_mt(). Sends of the shards to a face are
+ * serialized by the forwarder, so faces need not be thread-safe, but a face must
+ * not be sent to outside of the forwarder meanwhile.
+ * Other FaceTable and FIB updates fail with #NDN_FWD_SHARD_QUEUE_FULL while the control
+ * queue of a shard is full. Unregistering a face never fails: it waits for queue space,
+ * then until every shard has applied it, processing shards not busy in another thread
+ * meanwhile. Callbacks running in shards must therefore not wait for the main thread.
+ * An Interest with CanBePrefix is only matched by Data in its own shard,
+ * so its name should have at least @c prefix_components components.
+ * @param[in] count Number of shards.
+ * @param[in] prefix_components Number of name components selecting a shard.
+ * @param[in] config Table sizes of each shard.
+ * @param[in, out] memory Memory to place the shards. It must outlive the forwarder.
+ * @param[in] len The length of @c memory.
+ * @return #NDN_SUCCESS if the call succeeded. The error code otherwise.
+ * @retval #NDN_INVALID_ARG @c count or @c prefix_components is 0, @c prefix_components is
+ *                          more than #NDN_NAME_HASH_MAX_DEPTH, a table size is invalid,
+ *                          or faces or routes have been added.
+ * @retval #NDN_OVERSIZE @c len is less than ndn_forwarder_shards_reserve_size().
+ * @pre ndn_forwarder_init() or ndn_forwarder_init_ex() has been called.
+ */
+int
+ndn_forwarder_shards_init(uint32_t count, uint8_t prefix_components,
+                          const ndn_forwarder_config_t* config,
+                          void* memory, size_t len);
+
+/** Get the shard owning the name of a packet.
+ *
+ * Faces may use it to steer packets to one receiving thread per shard.
+ * @param[in] packet The Interest or Data.
+ * @param[in] length The length of @c packet.
+ * @return The index of the shard. The error code if @c packet is malformed.
+ * @retval #NDN_INVALID_ARG The forwarder is not sharded.
+ */
+int
+ndn_forwarder_shard_of(uint8_t* packet, size_t length);
+
+/** Get the number of shards. 0 if the forwarder is not sharded.
+ */
+uint32_t
+ndn_forwarder_shard_count(void);
+
+/** Get a shard.
+ *
+ * Counters read from another thread than the one of the shard are approximate.
+ * @return The shard. NULL if @c index is out of range.
+ */
+const ndn_forwarder_shard_t*
+ndn_forwarder_get_shard(uint32_t index);
+
+/** Process queued updates and packets of a shard, and expire its due PIT entries.
+ *
+ * A shard is processed by one thread at a time. The call returns 0 at once if another
+ * thread processes the shard, which includes ndn_forwarder_unregister_face() helping it.
+ * Callbacks of the applications run in the processing thread, and act on this shard.
+ * They must not use the message queue or timers except through ndn_msgqueue_post_mt().
+ * @param[in] index The shard.
+ * @return The number of packets processed. #NDN_INVALID_ARG if @c index is out of range.
+ */
+int
+ndn_forwarder_shard_process(uint32_t index);
+
+#endif // NDN_FORWARDER_SHARDING
+
 /** Produce a data packet.
  *
  * @param[in] data The data to produce.
  * @param[in] length The length of @c data.
  * @return #NDN_SUCCESS if the call succeeded. The error code otherwise.
+ * @retval #NDN_FWD_SHARD_QUEUE_FULL The forwarder is sharded and the control queue
+ *                                   of the shard owning the name is full.
+ * @note If the forwarder is sharded, Data put from the main thread is handed to the
+ *       shard owning its name. Data put from a shard thread is processed by that shard.
  */
 int
 ndn_forwarder_put_data(uint8_t* data, size_t length);
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include "measurements.h"
+
+void
+ndn_measurements_reset(ndn_face_measurements_t* self)
+{
+  self->srtt = 0;
+  self->rttvar = 0;
+  self->sent = 0;
+  self->satisfied = 0;
+  self->has_rtt = false;
+}
+
+void
+ndn_measurements_on_sent(ndn_face_measurements_t* self)
+{
+  if (self->sent >= NDN_MEASUREMENTS_WINDOW) {
+    self->sent /= 2;
+    self->satisfied /= 2;
+  }
+  self->sent ++;
+}
+
+void
+ndn_measurements_on_satisfied(ndn_face_measurements_t* self, ndn_time_ms_t rtt)
+{
+  uint32_t sample = (rtt < UINT32_MAX) ? (uint32_t)rtt : UINT32_MAX;
+  uint32_t delta;
+
+  // Data of an Interest counted before halving may come back afterwards
+  if (self->satisfied < self->sent)
+    self->satisfied ++;
+
+  // RFC 6298 smoothing
+  if (!self->has_rtt) {
+    self->srtt = sample;
+    self->rttvar = sample / 2;
+    self->has_rtt = true;
+    return;
+  }
+  delta = (self->srtt > sample) ? self->srtt - sample : sample - self->srtt;
+  self->rttvar = (uint32_t)(((uint64_t)self->rttvar * 3 + delta) / 4);
+  self->srtt = (uint32_t)(((uint64_t)self->srtt * 7 + sample) / 8);
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef FORWARDER_MEASUREMENTS_H_
+#define FORWARDER_MEASUREMENTS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../util/uniform-time.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdMeasurements Measurements
+ * @brief Per-face round-trip time and satisfaction ratio, read by forwarding strategies.
+ * @ingroup NDNFwd
+ * @{
+ */
+
+/** Interests counted per face before the counts are halved,
+ * so the satisfaction ratio follows recent behavior.
+ */
+#define NDN_MEASUREMENTS_WINDOW 256
+
+/** Satisfaction ratio of a face whose every Interest was satisfied.
+ */
+#define NDN_MEASUREMENTS_RATIO_ONE 1024
+
+/** Measurements of a face.
+ */
+typedef struct ndn_face_measurements {
+  /** Smoothed RTT in milliseconds. Valid if @c has_rtt is set.
+   */
+  uint32_t srtt;
+
+  /** RTT variation in milliseconds.
+   */
+  uint32_t rttvar;
+
+  /** Interests forwarded to the face.
+   */
+  uint16_t sent;
+
+  /** Interests forwarded to the face and satisfied by Data from it.
+   */
+  uint16_t satisfied;
+
+  /** Whether an RTT has been measured.
+   */
+  bool has_rtt;
+} ndn_face_measurements_t;
+
+/** Clear the measurements of a face.
+ */
+void
+ndn_measurements_reset(ndn_face_measurements_t* self);
+
+/** Count an Interest forwarded to the face.
+ */
+void
+ndn_measurements_on_sent(ndn_face_measurements_t* self);
+
+/** Count an Interest satisfied by the face and take an RTT sample.
+ * @param[in, out] self The measurements of the face.
+ * @param[in] rtt Time from forwarding the Interest to receiving the Data.
+ */
+void
+ndn_measurements_on_satisfied(ndn_face_measurements_t* self, ndn_time_ms_t rtt);
+
+/** Get the ratio of satisfied Interests.
+ * @return From 0 to #NDN_MEASUREMENTS_RATIO_ONE.
+ *         #NDN_MEASUREMENTS_RATIO_ONE if no Interest was forwarded yet.
+ */
+static inline uint32_t
+ndn_measurements_ratio(const ndn_face_measurements_t* self)
+{
+  if (self->sent == 0)
+    return NDN_MEASUREMENTS_RATIO_ONE;
+  return (uint32_t)self->satisfied * NDN_MEASUREMENTS_RATIO_ONE / self->sent;
+}
+
+/** Get the retransmission timeout of a face, @c srtt + 4 * @c rttvar.
+ * @return The timeout in milliseconds. UINT32_MAX if no RTT has been measured.
+ */
+static inline uint32_t
+ndn_measurements_rto(const ndn_face_measurements_t* self)
+{
+  uint64_t rto;
+
+  if (!self->has_rtt)
+    return UINT32_MAX;
+  rto = (uint64_t)self->srtt + 4 * (uint64_t)self->rttvar;
+  return (rto < UINT32_MAX) ? (uint32_t)rto : UINT32_MAX;
+}
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_MEASUREMENTS_H_
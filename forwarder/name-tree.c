@@ -13,145 +13,341 @@
 
 #define minof2(a, b) ((a) < (b) ? (a) : (b))
 
+#if NDN_NAMETREE_HASH_INDEX
+
+static inline ndn_table_id_t*
+nametree_buckets(ndn_nametree_t *nametree)
+{
+  return (ndn_table_id_t*)&nametree->nodes[nametree->capacity];
+}
+
+// The key of a node in the child index, from the hash of its prefix
+static inline uint32_t
+nametree_key(uint64_t prefix_hash)
+{
+  return (uint32_t)ndn_name_hash_mix(prefix_hash);
+}
+
+static ndn_table_id_t
+nametree_index_lookup(ndn_nametree_t *nametree, ndn_table_id_t father,
+                      uint32_t hash, const uint8_t* component, size_t len)
+{
+  ndn_table_id_t* buckets = nametree_buckets(nametree);
+  uint32_t i = hash % nametree->bucket_count;
+  ndn_table_id_t id;
+  while ((id = buckets[i]) != NDN_INVALID_ID) {
+    if (nametree->nodes[id].hash == hash && nametree->nodes[id].parent == father &&
+        memcmp(nametree->nodes[id].val, component, len) == 0) {
+      return id;
+    }
+    if (++i == nametree->bucket_count) i = 0;
+  }
+  return NDN_INVALID_ID;
+}
+
 static void
-nametree_refresh(ndn_nametree_t *nametree, int num)
+nametree_index_insert(ndn_nametree_t *nametree, ndn_table_id_t id)
 {
-  (*nametree)[num].left_child = NDN_INVALID_ID;
-  (*nametree)[num].pit_id = NDN_INVALID_ID;
-  (*nametree)[num].cs_id = NDN_INVALID_ID;
-  (*nametree)[num].fib_id = NDN_INVALID_ID;
+  ndn_table_id_t* buckets = nametree_buckets(nametree);
+  uint32_t i = nametree->nodes[id].hash % nametree->bucket_count;
+  // The load factor is below 1/2, so an empty bucket always exists
+  while (buckets[i] != NDN_INVALID_ID) {
+    if (++i == nametree->bucket_count) i = 0;
+  }
+  buckets[i] = id;
+}
 
-  (*nametree)[num].right_bro = (*nametree)[0].right_bro;
-  (*nametree)[0].right_bro = num;
+static void
+nametree_index_remove(ndn_nametree_t *nametree, ndn_table_id_t id)
+{
+  ndn_table_id_t* buckets = nametree_buckets(nametree);
+  uint32_t n = nametree->bucket_count;
+  uint32_t i = nametree->nodes[id].hash % n, j, home;
+  while (buckets[i] != id) {
+    if (buckets[i] == NDN_INVALID_ID) return;
+    if (++i == n) i = 0;
+  }
+  // Backward shift deletion: no tombstones, so probe lengths never degrade
+  j = i;
+  for (;;) {
+    if (++j == n) j = 0;
+    if (buckets[j] == NDN_INVALID_ID) break;
+    home = nametree->nodes[buckets[j]].hash % n;
+    // Keep buckets[j] if its home lies cyclically in (i, j]
+    if (i <= j ? (i < home && home <= j) : (i < home || home <= j)) continue;
+    buckets[i] = buckets[j];
+    i = j;
+  }
+  buckets[i] = NDN_INVALID_ID;
+}
+
+#endif // NDN_NAMETREE_HASH_INDEX
+
+/** Get the hash of the prefix of @c depth components ending with @c component.
+ * It is taken from @c hashes when it covers the prefix, and extended from the
+ * hash of the parent prefix otherwise.
+ */
+static inline uint64_t
+nametree_prefix_hash(const ndn_name_hash_t* hashes, size_t depth, uint64_t parent,
+                     const uint8_t* component, size_t len)
+{
+#if NDN_NAMETREE_HASH_INDEX
+  if (hashes != NULL && depth <= hashes->short_depth)
+    return hashes->hashes[depth];
+  return ndn_name_hash_extend(parent, component, len);
+#else
+  (void)hashes;
+  (void)depth;
+  (void)component;
+  (void)len;
+  return parent;
+#endif
+}
+
+static inline bool
+nametree_node_unused(ndn_nametree_t *nametree, ndn_table_id_t num)
+{
+  return nametree->nodes[num].ref_count == 0 &&
+         nametree->nodes[num].fib_id == NDN_INVALID_ID &&
+         nametree->nodes[num].pit_id == NDN_INVALID_ID &&
+         nametree->nodes[num].cs_id == NDN_INVALID_ID;
 }
 
-static int
-nametree_clean(ndn_nametree_t *nametree, int num)
+/** Unlink a leaf from its parent and put it back to the free list.
+ * @return The parent of the node.
+ */
+static ndn_table_id_t
+nametree_free_node(ndn_nametree_t *nametree, ndn_table_id_t num)
 {
-  int ret = 0;
-  if (num == NDN_INVALID_ID) {
-    return NDN_INVALID_ID;
+  ndn_table_id_t father = nametree->nodes[num].parent;
+  ndn_table_id_t now_node = nametree->nodes[father].left_child;
+
+  if (now_node == num) {
+    nametree->nodes[father].left_child = nametree->nodes[num].right_bro;
   }
   else {
-    (*nametree)[num].left_child = nametree_clean(nametree, (*nametree)[num].left_child);
-    (*nametree)[num].right_bro = nametree_clean(nametree, (*nametree)[num].right_bro);
-    if ((*nametree)[num].fib_id == NDN_INVALID_ID &&
-        (*nametree)[num].pit_id == NDN_INVALID_ID &&
-        (*nametree)[num].cs_id == NDN_INVALID_ID &&
-        (*nametree)[num].left_child == NDN_INVALID_ID) {
-      ret = (*nametree)[num].right_bro;
-      nametree_refresh(nametree, num);
-      return ret;
-    }
-    else {
-      return num;
+    while (nametree->nodes[now_node].right_bro != num) {
+      now_node = nametree->nodes[now_node].right_bro;
     }
+    nametree->nodes[now_node].right_bro = nametree->nodes[num].right_bro;
   }
+  nametree->nodes[father].ref_count--;
+
+#if NDN_NAMETREE_HASH_INDEX
+  nametree_index_remove(nametree, num);
+#endif
+  nametree->nodes[num].parent = NDN_INVALID_ID;
+  nametree->nodes[num].right_bro = nametree->nodes[0].right_bro;
+  nametree->nodes[0].right_bro = num;
+  return father;
 }
 
-static void
-nametree_cleanup(ndn_nametree_t *nametree)
+void
+ndn_nametree_release(ndn_nametree_t *nametree, nametree_entry_t* node)
+{
+  ndn_table_id_t num;
+  if (node == NULL) return;
+  num = ndn_nametree_getid(nametree, node);
+  // The root is never released
+  while (num != 0 && nametree_node_unused(nametree, num)) {
+    num = nametree_free_node(nametree, num);
+  }
+}
+
+void
+ndn_nametree_unpin(ndn_nametree_t *nametree, nametree_entry_t* node)
 {
-  (*nametree)[0].left_child = nametree_clean(nametree, (*nametree)[0].left_child);
+  if (node == NULL) return;
+  node->ref_count--;
+  ndn_nametree_release(nametree, node);
 }
 
 void
 ndn_nametree_init(void* memory, ndn_table_id_t capacity)
 {
   ndn_nametree_t *nametree = (ndn_nametree_t*)memory;
-  //all free entries are linked as right_bro of (*nametree)[0], the root of the tree.
-  for (int i = 0; i < capacity; ++i) {
-    (*nametree)[i].left_child = (*nametree)[i].pit_id = (*nametree)[i].cs_id = (*nametree)[i].fib_id = NDN_INVALID_ID;
-    (*nametree)[i].right_bro = i + 1;
+  nametree->capacity = capacity;
+  //all free entries are linked as right_bro of nodes[0], the root of the tree.
+  for (ndn_table_id_t i = 0; i < capacity; ++i) {
+    nametree->nodes[i].left_child = nametree->nodes[i].pit_id = NDN_INVALID_ID;
+    nametree->nodes[i].cs_id = nametree->nodes[i].fib_id = NDN_INVALID_ID;
+    nametree->nodes[i].right_bro = i + 1;
+    nametree->nodes[i].parent = NDN_INVALID_ID;
+    nametree->nodes[i].ref_count = 0;
+#if NDN_NAMETREE_HASH_INDEX
+    nametree->nodes[i].hash = 0;
+#endif
   }
-  (*nametree)[capacity - 1].right_bro = NDN_INVALID_ID;
+  nametree->nodes[capacity - 1].right_bro = NDN_INVALID_ID;
+#if NDN_NAMETREE_HASH_INDEX
+  nametree->bucket_count = NDN_NAMETREE_BUCKET_COUNT(capacity);
+  memset(nametree_buckets(nametree), 0xFF, NDN_NAMETREE_INDEX_SIZE(capacity));
+#endif
 }
 
-static int
+static ndn_table_id_t
 nametree_create_node(ndn_nametree_t *nametree, uint8_t name[], size_t len)
 {
-  int output = (*nametree)[0].right_bro;
+  ndn_table_id_t output = nametree->nodes[0].right_bro;
   if (output == NDN_INVALID_ID) return NDN_INVALID_ID;
-  (*nametree)[0].right_bro = (*nametree)[output].right_bro;
-  (*nametree)[output].left_child  = (*nametree)[output].right_bro = NDN_INVALID_ID;
-  (*nametree)[output].pit_id = (*nametree)[output].cs_id = (*nametree)[output].fib_id = NDN_INVALID_ID;
-  memcpy((*nametree)[output].val, name, len);
+  nametree->nodes[0].right_bro = nametree->nodes[output].right_bro;
+  nametree->nodes[output].left_child  = nametree->nodes[output].right_bro = NDN_INVALID_ID;
+  nametree->nodes[output].pit_id = nametree->nodes[output].cs_id = nametree->nodes[output].fib_id = NDN_INVALID_ID;
+  nametree->nodes[output].ref_count = 0;
+  memcpy(nametree->nodes[output].val, name, len);
   return output;
 }
 
+/** Find the child of @c father whose component is @c name[0, len).
+ * @c hash is the hash of the prefix ending with it.
+ * @return The id of the child. #NDN_INVALID_ID if not found.
+ */
+static ndn_table_id_t
+nametree_find_child(ndn_nametree_t *nametree, ndn_table_id_t father, uint64_t hash,
+                    uint8_t name[], size_t len)
+{
+#if NDN_NAMETREE_HASH_INDEX
+  return nametree_index_lookup(nametree, father, nametree_key(hash), name, len);
+#else
+  ndn_table_id_t now_node = nametree->nodes[father].left_child;
+  int tmp;
+  (void)hash;
+  while (now_node != NDN_INVALID_ID) {
+    tmp = memcmp(name, nametree->nodes[now_node].val, len);
+    if (tmp == 0) return now_node;
+    if (tmp < 0) break;
+    now_node = nametree->nodes[now_node].right_bro;
+  }
+  return NDN_INVALID_ID;
+#endif
+}
+
+/** Create a child of @c father with component @c name[0, len).
+ * @c hash is the hash of the prefix ending with it.
+ * @return The id of the new child. #NDN_INVALID_ID if the tree is full.
+ * @pre The child does not exist.
+ */
+static ndn_table_id_t
+nametree_insert_child(ndn_nametree_t *nametree, ndn_table_id_t father, uint64_t hash,
+                      uint8_t name[], size_t len)
+{
+  ndn_table_id_t new_node_number = nametree_create_node(nametree, name, len);
+  if (new_node_number == NDN_INVALID_ID) return NDN_INVALID_ID;
+  nametree->nodes[new_node_number].parent = father;
+  nametree->nodes[father].ref_count++;
+#if NDN_NAMETREE_HASH_INDEX
+  // Lookups go through the index, so siblings need not be sorted
+  nametree->nodes[new_node_number].hash = nametree_key(hash);
+  nametree_index_insert(nametree, new_node_number);
+  nametree->nodes[new_node_number].right_bro = nametree->nodes[father].left_child;
+  nametree->nodes[father].left_child = new_node_number;
+#else
+  ndn_table_id_t now_node = nametree->nodes[father].left_child, last_node = NDN_INVALID_ID;
+  (void)hash;
+  while (now_node != NDN_INVALID_ID) {
+    if (memcmp(name, nametree->nodes[now_node].val, len) <= 0) break;
+    last_node = now_node;
+    now_node = nametree->nodes[now_node].right_bro;
+  }
+  if(last_node == NDN_INVALID_ID){
+    nametree->nodes[father].left_child = new_node_number;
+  }else{
+    nametree->nodes[last_node].right_bro = new_node_number;
+  }
+  nametree->nodes[new_node_number].right_bro = now_node;
+#endif
+  return new_node_number;
+}
+
 nametree_entry_t*
 ndn_nametree_find(ndn_nametree_t *nametree, uint8_t name[], size_t len)
 {
-  int now_node, father = 0 , tmp;
-  size_t component_len, eqiv_component_len, offset = 0;
+  ndn_table_id_t now_node, father = 0;
+  size_t component_len, eqiv_component_len, offset = 0, depth = 0;
+  uint64_t hash = ndn_name_hash_seed();
   // TODO: Put it into decoder
   if (len < 2) return NULL;
   if (name[1] < 253) offset = 2; else offset = 4;
   while (offset < len) {
     component_len = name[offset + 1] + 2;
     eqiv_component_len = minof2(component_len, NDN_NAME_COMPONENT_BUFFER_SIZE);
-    now_node = (*nametree)[father].left_child;
-    tmp = -2;
-    while (now_node != NDN_INVALID_ID) {
-      tmp = memcmp(name+offset, (*nametree)[now_node].val , eqiv_component_len);
-      if (tmp <= 0) break;
-      now_node = (*nametree)[now_node].right_bro;
-    }
-    if (tmp != 0) {
+    hash = nametree_prefix_hash(NULL, ++depth, hash, name + offset, eqiv_component_len);
+    now_node = nametree_find_child(nametree, father, hash, name + offset, eqiv_component_len);
+    if (now_node == NDN_INVALID_ID) {
       return NULL;
     }
     offset += component_len;
     father = now_node;
   }
-  return &(*nametree)[father];
+  return &nametree->nodes[father];
 }
 
-static nametree_entry_t*
-nametree_find_or_insert_try(ndn_nametree_t *nametree, uint8_t name[], size_t len)
+nametree_entry_t*
+ndn_nametree_find_or_insert(ndn_nametree_t *nametree, uint8_t name[], size_t len)
 {
-  int now_node, last_node, father = 0 , tmp , new_node_number;
-  size_t component_len, eqiv_component_len, offset = 0;
+  ndn_table_id_t now_node, father = 0;
+  size_t component_len, eqiv_component_len, offset = 0, depth = 0;
+  uint64_t hash = ndn_name_hash_seed();
   // TODO: Put it into decoder
   if (len < 2) return NULL;
   if (name[1] < 253) offset = 2; else offset = 4;
   while (offset < len) {
     component_len = name[offset + 1] + 2;
     eqiv_component_len = minof2(component_len, NDN_NAME_COMPONENT_BUFFER_SIZE);
-    now_node = (*nametree)[father].left_child;
-    last_node = NDN_INVALID_ID;
-    tmp = -2;
-    while (now_node != NDN_INVALID_ID) {
-      tmp = memcmp(name+offset, (*nametree)[now_node].val , eqiv_component_len);
-      if (tmp <= 0) break;
-      last_node = now_node;
-      now_node = (*nametree)[now_node].right_bro;
-    }
-    if (tmp != 0) {
-      new_node_number = nametree_create_node(nametree, name + offset , eqiv_component_len);
-      if (new_node_number == NDN_INVALID_ID) return NULL;
-      if(last_node == NDN_INVALID_ID){
-        (*nametree)[father].left_child = new_node_number;
-      }else{
-        (*nametree)[last_node].right_bro = new_node_number;
+    hash = nametree_prefix_hash(NULL, ++depth, hash, name + offset, eqiv_component_len);
+    now_node = nametree_find_child(nametree, father, hash, name + offset, eqiv_component_len);
+    if (now_node == NDN_INVALID_ID) {
+      now_node = nametree_insert_child(nametree, father, hash, name + offset, eqiv_component_len);
+      if (now_node == NDN_INVALID_ID) {
+        // Drop the part of the path inserted so far
+        ndn_nametree_release(nametree, &nametree->nodes[father]);
+        return NULL;
       }
-      (*nametree)[new_node_number].right_bro = now_node;
-      now_node = new_node_number;
     }
     offset += component_len;
     father = now_node;
   }
-  return &(*nametree)[father];
+  return &nametree->nodes[father];
 }
 
-nametree_entry_t*
-ndn_nametree_find_or_insert(ndn_nametree_t *nametree, uint8_t name[], size_t len)
+void
+ndn_nametree_lookup(ndn_nametree_t *nametree, uint8_t name[], size_t len,
+                    const ndn_name_hash_t* hashes, bool insert, ndn_nametree_match_t* match)
 {
-  nametree_entry_t* p = nametree_find_or_insert_try(nametree, name , len);
-  if (p == NULL) {
-    nametree_cleanup(nametree);
-    p = nametree_find_or_insert_try(nametree, name , len);
+  ndn_table_id_t now_node, father = 0;
+  size_t component_len, eqiv_component_len, offset = 0, depth = 0;
+  uint64_t hash = ndn_name_hash_seed();
+  nametree_entry_t* node;
+  int i;
+
+  match->exact = NULL;
+  for (i = 0; i < NDN_NAMETREE_ENTRY_TYPE_CNT; i++) {
+    match->longest[i] = NULL;
+  }
+  if (len < 2) return;
+  if (name[1] < 253) offset = 2; else offset = 4;
+  while (offset < len) {
+    component_len = name[offset + 1] + 2;
+    eqiv_component_len = minof2(component_len, NDN_NAME_COMPONENT_BUFFER_SIZE);
+    hash = nametree_prefix_hash(hashes, ++depth, hash, name + offset, eqiv_component_len);
+    now_node = nametree_find_child(nametree, father, hash, name + offset, eqiv_component_len);
+    if (now_node == NDN_INVALID_ID) {
+      if (!insert) return;
+      now_node = nametree_insert_child(nametree, father, hash, name + offset, eqiv_component_len);
+      if (now_node == NDN_INVALID_ID) {
+        ndn_nametree_release(nametree, &nametree->nodes[father]);
+        return;
+      }
+    }
+    node = &nametree->nodes[now_node];
+    if (node->fib_id != NDN_INVALID_ID) match->longest[NDN_NAMETREE_FIB_TYPE] = node;
+    if (node->pit_id != NDN_INVALID_ID) match->longest[NDN_NAMETREE_PIT_TYPE] = node;
+    if (node->cs_id != NDN_INVALID_ID) match->longest[NDN_NAMETREE_CS_TYPE] = node;
+    offset += component_len;
+    father = now_node;
   }
-  return p;
+  match->exact = &nametree->nodes[father];
+  match->exact->ref_count++;
 }
 
 nametree_entry_t*
@@ -161,37 +357,32 @@ ndn_nametree_prefix_match(
                           size_t len,
                           enum NDN_NAMETREE_ENTRY_TYPE type)
 {
-  int now_node, last_node = NDN_INVALID_ID , father = 0 , tmp;
-  size_t component_len, eqiv_component_len, offset = 0;
+  ndn_table_id_t now_node, last_node = NDN_INVALID_ID , father = 0;
+  size_t component_len, eqiv_component_len, offset = 0, depth = 0;
+  uint64_t hash = ndn_name_hash_seed();
   if (len < 2) return NULL;
   if (name[1] < 253) offset = 2; else offset = 4;
   while (offset < len) {
     component_len = name[offset + 1] + 2;
     eqiv_component_len = minof2(component_len, NDN_NAME_COMPONENT_BUFFER_SIZE);
-    now_node = (*nametree)[father].left_child;
-    tmp = -2;
-    while (now_node != NDN_INVALID_ID) {
-      tmp = memcmp(name+offset,(*nametree)[now_node].val , eqiv_component_len);
-      if (tmp <= 0) break;
-      now_node = (*nametree)[now_node].right_bro;
-    }
-    if (tmp == 0) {
-      if ((*nametree)[now_node].fib_id != NDN_INVALID_ID && type == NDN_NAMETREE_FIB_TYPE) last_node = now_node;
-      if ((*nametree)[now_node].pit_id != NDN_INVALID_ID && type == NDN_NAMETREE_PIT_TYPE) last_node = now_node;
-      if ((*nametree)[now_node].cs_id != NDN_INVALID_ID && type == NDN_NAMETREE_CS_TYPE) last_node = now_node;
-    } else break;
+    hash = nametree_prefix_hash(NULL, ++depth, hash, name + offset, eqiv_component_len);
+    now_node = nametree_find_child(nametree, father, hash, name + offset, eqiv_component_len);
+    if (now_node == NDN_INVALID_ID) break;
+    if (nametree->nodes[now_node].fib_id != NDN_INVALID_ID && type == NDN_NAMETREE_FIB_TYPE) last_node = now_node;
+    if (nametree->nodes[now_node].pit_id != NDN_INVALID_ID && type == NDN_NAMETREE_PIT_TYPE) last_node = now_node;
+    if (nametree->nodes[now_node].cs_id != NDN_INVALID_ID && type == NDN_NAMETREE_CS_TYPE) last_node = now_node;
     offset += component_len;
     father = now_node;
   }
-  if (last_node == NDN_INVALID_ID) return NULL; else return &(*nametree)[last_node];
+  if (last_node == NDN_INVALID_ID) return NULL; else return &nametree->nodes[last_node];
 }
 
 nametree_entry_t*
 ndn_nametree_at(ndn_nametree_t *self, ndn_table_id_t id){
-  return &(*self)[id];
+  return &self->nodes[id];
 }
 
 ndn_table_id_t
 ndn_nametree_getid(ndn_nametree_t *self, nametree_entry_t* entry){
-  return entry - &(*self)[0];
+  return entry - &self->nodes[0];
 }
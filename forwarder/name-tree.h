@@ -12,8 +12,10 @@
 #define FORWARDER_NAME_TREE_H
 
 #include "../ndn-constants.h"
+#include "../encode/name-hash.h"
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 /** @defgroup NDNFwdNameTree Name Tree
  * @brief Name Tree
@@ -69,15 +71,95 @@ typedef struct nametree_entry{
    * #NDN_INVALID_ID if none.
    */
   ndn_table_id_t fib_id;
+
+  /**
+   * Parent of this node.
+   * #NDN_INVALID_ID for the root and free nodes.
+   */
+  ndn_table_id_t parent;
+
+  /**
+   * Number of children plus pins held by in-flight lookups.
+   * A node with no reference and no PIT, CS or FIB entry is released
+   * together with its ancestors that become empty.
+   */
+  ndn_table_id_t ref_count;
+
+#if NDN_NAMETREE_HASH_INDEX
+  /**
+   * Mixed hash of the prefix ending at this node, the key of this node in the child index.
+   */
+  uint32_t hash;
+#endif
 } nametree_entry_t;
 
-typedef nametree_entry_t ndn_nametree_t[];
+/**
+ * NameTree.
+ *
+ * With #NDN_NAMETREE_HASH_INDEX, an open addressing hash table of node ids follows
+ * @c nodes in the same memory block. It maps (parent, component) to the child node,
+ * so children are found in O(1) instead of walking the sibling list. Nodes are keyed by
+ * the hash of their prefix as ndn_name_hash_compute() gives it, with each component
+ * truncated to #NDN_NAME_COMPONENT_BUFFER_SIZE bytes.
+ */
+typedef struct ndn_nametree {
+  ndn_table_id_t capacity;
+
+#if NDN_NAMETREE_HASH_INDEX
+  /**
+   * Number of buckets in the child index.
+   */
+  uint32_t bucket_count;
+#endif
+
+  /**
+   * All nodes. The root is @c nodes[0].
+   */
+  nametree_entry_t nodes[];
+} ndn_nametree_t;
 
-#define NDN_NAMETREE_RESERVE_SIZE(entry_count) (sizeof(nametree_entry_t) * (entry_count))
+#if NDN_NAMETREE_HASH_INDEX
+/** Number of child index buckets for @c entry_count nodes, keeping load factor under 1/2.
+ */
+#define NDN_NAMETREE_BUCKET_COUNT(entry_count) (2 * (entry_count))
+#define NDN_NAMETREE_INDEX_SIZE(entry_count) \
+  (sizeof(ndn_table_id_t) * NDN_NAMETREE_BUCKET_COUNT(entry_count))
+#else
+#define NDN_NAMETREE_INDEX_SIZE(entry_count) 0
+#endif
+
+/**
+ * Result of ndn_nametree_lookup().
+ */
+typedef struct ndn_nametree_match {
+  /**
+   * Node of the whole name.
+   * NULL if it does not exist, or could not be inserted.
+   */
+  nametree_entry_t* exact;
+
+  /**
+   * Deepest node along the name holding an entry of each type,
+   * indexed by #NDN_NAMETREE_ENTRY_TYPE. NULL if none.
+   * The entry at @c exact is an exact match iff it equals @c exact.
+   */
+  nametree_entry_t* longest[NDN_NAMETREE_ENTRY_TYPE_CNT];
+} ndn_nametree_match_t;
+
+/** The memory reserved for NameTree.
+ * @param[in] entry_count Maximum number of nodes, including the root.
+ */
+#define NDN_NAMETREE_RESERVE_SIZE(entry_count) \
+  (sizeof(ndn_nametree_t) + sizeof(nametree_entry_t) * (entry_count) + \
+   NDN_NAMETREE_INDEX_SIZE(entry_count))
 
 void
 ndn_nametree_init(void* memory, ndn_table_id_t capacity);
 
+/** Find the node of a name, inserting missing nodes.
+ * A new node is not pinned: the caller attaches an entry to it, or calls ndn_nametree_release().
+ * @return NULL if the NameTree is full.
+ */
 nametree_entry_t*
 ndn_nametree_find_or_insert(ndn_nametree_t* nametree, uint8_t name[], size_t len);
 
@@ -91,6 +173,36 @@ ndn_nametree_prefix_match(
 nametree_entry_t*
 ndn_nametree_find(ndn_nametree_t *nametree, uint8_t name[], size_t len);
 
+/** Walk a name once and collect the exact and longest prefix matches of all tables.
+ * If @c match->exact is set, it is pinned so that removing table entries cannot
+ * release it or its ancestors. The caller must call ndn_nametree_unpin() on it when done.
+ * @param[in, out] nametree The NameTree.
+ * @param[in] name The encoded name.
+ * @param[in] len The length of @c name.
+ * @param[in] hashes [Optional] The hashes of @c name, so that the prefixes they
+ *                   cover are not hashed again. NULL to hash all of them here.
+ * @param[in] insert Whether to insert missing nodes, so that @c match->exact is set.
+ * @param[out] match The matched nodes.
+ */
+void
+ndn_nametree_lookup(ndn_nametree_t *nametree, uint8_t name[], size_t len,
+                    const ndn_name_hash_t* hashes, bool insert, ndn_nametree_match_t* match);
+
+/** Drop a pin taken by ndn_nametree_lookup(), releasing the node if it became empty.
+ * @param[in, out] nametree The NameTree.
+ * @param[in] node The pinned node. Ignored if NULL.
+ */
+void
+ndn_nametree_unpin(ndn_nametree_t *nametree, nametree_entry_t* node);
+
+/** Release @c node and its ancestors as long as they have no reference and no entry.
+ * Tables call this after detaching an entry from a node.
+ * @param[in, out] nametree The NameTree.
+ * @param[in] node The node. Ignored if NULL or still in use.
+ */
+void
+ndn_nametree_release(ndn_nametree_t *nametree, nametree_entry_t* node);
+
 nametree_entry_t*
 ndn_nametree_at(ndn_nametree_t *self, ndn_table_id_t id);
 
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include "packet-buffer.h"
+
+#define NDN_PKTBUF_AT(pool, index) \
+  ((ndn_pktbuf_t*)((uint8_t*)(pool)->bufs + (size_t)(index) * (pool)->stride))
+
+void
+ndn_pktbuf_pool_init(void* memory, ndn_table_id_t buf_count, uint32_t buf_size)
+{
+  ndn_pktbuf_pool_t* pool = (ndn_pktbuf_pool_t*)memory;
+  ndn_pktbuf_t* buf;
+  ndn_table_id_t i;
+
+  pool->buf_size = buf_size;
+  pool->stride = (uint32_t)NDN_PKTBUF_STRIDE(buf_size);
+  pool->capacity = buf_count;
+  pool->free_count = buf_count;
+  pool->reserve = buf_count / 2;
+  pool->free_head = (buf_count > 0) ? 0 : NDN_INVALID_ID;
+  for (i = 0; i < buf_count; i++) {
+    buf = NDN_PKTBUF_AT(pool, i);
+    buf->pool = pool;
+    buf->refcount = 0;
+    buf->length = 0;
+    buf->next_free = (i + 1 < buf_count) ? i + 1 : NDN_INVALID_ID;
+  }
+}
+
+ndn_pktbuf_t*
+ndn_pktbuf_alloc(ndn_pktbuf_pool_t* pool)
+{
+  ndn_pktbuf_t* buf;
+
+  if (pool->free_head == NDN_INVALID_ID)
+    return NULL;
+  buf = NDN_PKTBUF_AT(pool, pool->free_head);
+  pool->free_head = buf->next_free;
+  pool->free_count --;
+  buf->refcount = 1;
+  buf->length = 0;
+  buf->next_free = NDN_INVALID_ID;
+  return buf;
+}
+
+void
+ndn_pktbuf_release(ndn_pktbuf_t* buf)
+{
+  ndn_pktbuf_pool_t* pool = buf->pool;
+
+  if (--buf->refcount > 0)
+    return;
+  buf->next_free = pool->free_head;
+  pool->free_head = (ndn_table_id_t)(((uint8_t*)buf - (uint8_t*)pool->bufs) / pool->stride);
+  pool->free_count ++;
+}
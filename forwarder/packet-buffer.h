@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef FORWARDER_PACKET_BUFFER_H_
+#define FORWARDER_PACKET_BUFFER_H_
+
+#include "../ndn-constants.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdPktBuf Packet Buffer
+ * @brief Reference-counted packet buffers shared by faces, the CS and the forwarder.
+ * @ingroup NDNFwd
+ *
+ * A face receives into a buffer taken from a pool and hands its reference to the
+ * forwarder. The CS and outgoing faces keep their own references instead of copying
+ * the packet, and the buffer returns to the pool when the last one is released.
+ * A pool is not thread-safe; all its buffers must be used by one thread.
+ * @{
+ */
+
+struct ndn_pktbuf_pool;
+
+/** A packet buffer.
+ */
+typedef struct ndn_pktbuf {
+  /** The pool to return to.
+   */
+  struct ndn_pktbuf_pool* pool;
+
+  /** Number of references. The buffer is free when it drops to 0.
+   */
+  uint32_t refcount;
+
+  /** Bytes of @c data in use.
+   */
+  uint32_t length;
+
+  /** Next free buffer if this one is free.
+   */
+  ndn_table_id_t next_free;
+
+  /** The packet. It has the @c buf_size of the pool.
+   */
+  uint8_t data[];
+} ndn_pktbuf_t;
+
+/** A pool of packet buffers of the same size.
+ */
+typedef struct ndn_pktbuf_pool {
+  /** Bytes of @c data of each buffer.
+   */
+  uint32_t buf_size;
+
+  /** Bytes from one buffer to the next.
+   */
+  uint32_t stride;
+
+  /** Number of buffers.
+   */
+  ndn_table_id_t capacity;
+
+  /** Number of free buffers.
+   */
+  ndn_table_id_t free_count;
+
+  /** Free buffers kept for receiving. The CS only keeps a reference while
+   * more buffers than this are free, and copies the packet otherwise.
+   */
+  ndn_table_id_t reserve;
+
+  /** First free buffer. #NDN_INVALID_ID if all are in use.
+   */
+  ndn_table_id_t free_head;
+
+  uint64_t bufs[];
+} ndn_pktbuf_pool_t;
+
+/** Bytes from one buffer to the next, keeping every buffer aligned to @c uint64_t.
+ */
+#define NDN_PKTBUF_STRIDE(buf_size) \
+  ((sizeof(ndn_pktbuf_t) + (buf_size) + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t))
+
+/** The memory reserved for a pool.
+ * @param[in] buf_count Number of buffers.
+ * @param[in] buf_size Bytes of each buffer.
+ */
+#define NDN_PKTBUF_POOL_RESERVE_SIZE(buf_count, buf_size) \
+  (sizeof(ndn_pktbuf_pool_t) + NDN_PKTBUF_STRIDE(buf_size) * (buf_count))
+
+/** Initialize a pool at specified memory space.
+ *
+ * Half of the buffers are kept as the receive reserve.
+ * @param[in, out] memory Memory reserved for the pool, aligned to @c uint64_t.
+ * @param[in] buf_count Number of buffers.
+ * @param[in] buf_size Bytes of each buffer.
+ */
+void
+ndn_pktbuf_pool_init(void* memory, ndn_table_id_t buf_count, uint32_t buf_size);
+
+/** Take a buffer from a pool.
+ * @return A buffer holding one reference and no data. NULL if the pool is empty.
+ */
+ndn_pktbuf_t*
+ndn_pktbuf_alloc(ndn_pktbuf_pool_t* pool);
+
+/** Add a reference to a buffer.
+ * @return @c buf.
+ */
+static inline ndn_pktbuf_t*
+ndn_pktbuf_retain(ndn_pktbuf_t* buf)
+{
+  buf->refcount ++;
+  return buf;
+}
+
+/** Drop a reference to a buffer, returning it to its pool after the last one.
+ */
+void
+ndn_pktbuf_release(ndn_pktbuf_t* buf);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_PACKET_BUFFER_H_
@@ -11,81 +11,212 @@
 #define ENABLE_NDN_LOG_DEBUG 0
 #define ENABLE_NDN_LOG_ERROR 1
 #include "pit.h"
-#include "../util/msg-queue.h"
 #include "../util/logger.h"
+#include <string.h>
+
+#define NDN_PIT_HEAP(self) ((ndn_table_id_t*)&(self)->slots[(self)->capacity])
 
 static inline void
 ndn_pit_entry_reset(ndn_pit_entry_t* self){
   self->nametree_id = NDN_INVALID_ID;
+  self->heap_index = NDN_INVALID_ID;
+  self->deadline = 0;
   self->last_time = 0;
   self->express_time = 0;
-  self->incoming_faces = 0;
-  self->outgoing_faces = 0;
+  ndn_faceset_init(&self->incoming_faces);
+  ndn_faceset_init(&self->outgoing_faces);
   self->on_data = NULL;
   self->on_timeout = NULL;
   self->userdata = NULL;
   // Don't reset options.nonce here
 }
 
-static void ndn_pit_timeout(void *selfptr, size_t param_len, void *param){
-  (void) param_len, (void) param;
-  ndn_pit_t* self = (ndn_pit_t*)selfptr;
-  ndn_table_id_t i;
-  ndn_time_ms_t now = ndn_time_now_ms();
+/** The first time point at which @c now - @c time > @c lifetime holds.
+ */
+static inline ndn_time_ms_t
+ndn_pit_expiry(ndn_time_ms_t time, uint64_t lifetime){
+  if(lifetime >= NDN_PIT_NO_DEADLINE - time){
+    return NDN_PIT_NO_DEADLINE;
+  }
+  return time + lifetime + 1;
+}
+
+static inline ndn_time_ms_t
+ndn_pit_entry_deadline(const ndn_pit_entry_t* entry){
+  ndn_time_ms_t ret = ndn_pit_expiry(entry->last_time, entry->options.lifetime);
+  ndn_time_ms_t user_deadline;
+  if(entry->on_data != NULL){
+    user_deadline = ndn_pit_expiry(entry->express_time, entry->options.lifetime);
+    if(user_deadline < ret){
+      ret = user_deadline;
+    }
+  }
+  return ret;
+}
+
+static inline ndn_time_ms_t
+ndn_pit_heap_key(ndn_pit_t* self, size_t pos){
+  return self->slots[NDN_PIT_HEAP(self)[pos]].deadline;
+}
+
+static void
+ndn_pit_heap_swap(ndn_pit_t* self, size_t a, size_t b){
+  ndn_table_id_t* heap = NDN_PIT_HEAP(self);
+  ndn_table_id_t tmp = heap[a];
+  heap[a] = heap[b];
+  heap[b] = tmp;
+  self->slots[heap[a]].heap_index = (ndn_table_id_t)a;
+  self->slots[heap[b]].heap_index = (ndn_table_id_t)b;
+}
+
+static void
+ndn_pit_heap_sift(ndn_pit_t* self, size_t pos){
+  size_t parent, child;
+
+  while(pos > 0){
+    parent = (pos - 1) / 2;
+    if(ndn_pit_heap_key(self, parent) <= ndn_pit_heap_key(self, pos)){
+      break;
+    }
+    ndn_pit_heap_swap(self, parent, pos);
+    pos = parent;
+  }
+  for(;;){
+    child = pos * 2 + 1;
+    if(child >= self->heap_size){
+      break;
+    }
+    if(child + 1 < self->heap_size &&
+       ndn_pit_heap_key(self, child + 1) < ndn_pit_heap_key(self, child)){
+      child ++;
+    }
+    if(ndn_pit_heap_key(self, pos) <= ndn_pit_heap_key(self, child)){
+      break;
+    }
+    ndn_pit_heap_swap(self, pos, child);
+    pos = child;
+  }
+}
+
+static void
+ndn_pit_heap_push(ndn_pit_t* self, ndn_table_id_t id){
+  NDN_PIT_HEAP(self)[self->heap_size] = id;
+  self->slots[id].heap_index = self->heap_size;
+  self->slots[id].deadline = ndn_pit_entry_deadline(&self->slots[id]);
+  self->heap_size ++;
+  ndn_pit_heap_sift(self, self->heap_size - 1);
+}
+
+static void
+ndn_pit_heap_remove(ndn_pit_t* self, ndn_pit_entry_t* entry){
+  size_t pos = entry->heap_index;
+  if(entry->heap_index == NDN_INVALID_ID){
+    return;
+  }
+  self->heap_size --;
+  if(pos != self->heap_size){
+    ndn_pit_heap_swap(self, pos, self->heap_size);
+    ndn_pit_heap_sift(self, pos);
+  }
+  entry->heap_index = NDN_INVALID_ID;
+}
+
+void
+ndn_pit_update_deadline(ndn_pit_t* self, ndn_pit_entry_t* entry){
+  if(entry->heap_index == NDN_INVALID_ID){
+    return;
+  }
+  entry->deadline = ndn_pit_entry_deadline(entry);
+  ndn_pit_heap_sift(self, entry->heap_index);
+}
+
+ndn_time_ms_t
+ndn_pit_next_deadline(const ndn_pit_t* self){
+  if(self->heap_size == 0){
+    return NDN_PIT_NO_DEADLINE;
+  }
+  return self->slots[NDN_PIT_HEAP(self)[0]].deadline;
+}
+
+void
+ndn_pit_process_timeout(ndn_pit_t* self, ndn_time_ms_t now){
+  ndn_pit_entry_t* entry;
   ndn_on_timeout_func on_timeout = NULL;
   void* userdata = NULL;
 
-  for(i = 0; i < self->capacity; i ++){
-    if(self->slots[i].nametree_id == NDN_INVALID_ID){
-      continue;
+  while(self->heap_size > 0){
+    entry = &self->slots[NDN_PIT_HEAP(self)[0]];
+    if(entry->deadline > now){
+      break;
     }
 
     // User timeout
-    if(self->slots[i].on_data != NULL){
-      if(now - self->slots[i].express_time > self->slots[i].options.lifetime){
-        on_timeout = self->slots[i].on_timeout;
-        userdata = self->slots[i].userdata;
-        
-        self->slots[i].on_timeout = NULL;
-        self->slots[i].on_data = NULL;
-        self->slots[i].userdata = NULL;
-        self->slots[i].express_time = 0;
-        self->slots[i].outgoing_faces = 0;
-
-        if(on_timeout){
-          on_timeout(userdata);
-        }
+    if(entry->on_data != NULL &&
+       ndn_pit_expiry(entry->express_time, entry->options.lifetime) <= now)
+    {
+      on_timeout = entry->on_timeout;
+      userdata = entry->userdata;
+
+      entry->on_timeout = NULL;
+      entry->on_data = NULL;
+      entry->userdata = NULL;
+      entry->express_time = 0;
+      ndn_faceset_clear(self->faces, &entry->outgoing_faces);
+
+      if(on_timeout){
+        self->stats.app_timeouts ++;
+        on_timeout(userdata);
+      }
+      // The callback may have expressed an Interest and reused this slot
+      if(entry->nametree_id == NDN_INVALID_ID){
+        continue;
       }
     }
     // PIT timeout
-    if((now > self->slots[i].last_time) &&
-       (now - self->slots[i].last_time > self->slots[i].options.lifetime))
-    {
-      ndn_pit_remove_entry(self, &self->slots[i]);
+    if(ndn_pit_expiry(entry->last_time, entry->options.lifetime) <= now){
+      self->stats.expirations ++;
+      ndn_pit_remove_entry(self, entry);
+    }else{
+      ndn_pit_update_deadline(self, entry);
     }
   }
-
-  ndn_msgqueue_post(self, ndn_pit_timeout, 0, NULL);
 }
 
 void
-ndn_pit_init(void* memory, ndn_table_id_t capacity, ndn_nametree_t* nametree){
+ndn_pit_init(void* memory, ndn_table_id_t capacity, ndn_nametree_t* nametree,
+             ndn_face_set_pool_t* faces){
   ndn_table_id_t i;
   ndn_pit_t* self = (ndn_pit_t*)memory;
   self->capacity = capacity;
   self->nametree = nametree;
+  self->faces = faces;
+  self->heap_size = 0;
+  self->count = 0;
+  memset(&self->stats, 0, sizeof(self->stats));
+  self->free_head = (capacity > 0) ? 0 : NDN_INVALID_ID;
   for(i = 0; i < capacity; i ++){
     ndn_pit_entry_reset(&self->slots[i]);
     self->slots[i].options.nonce = 0;
+    self->slots[i].next_free = (i + 1 < capacity) ? i + 1 : NDN_INVALID_ID;
   }
-
-  ndn_msgqueue_post(self, ndn_pit_timeout, 0, NULL);
 }
 
 void
 ndn_pit_remove_entry(ndn_pit_t* self, ndn_pit_entry_t* entry){
-  ndn_nametree_at(self->nametree, entry->nametree_id)->pit_id = NDN_INVALID_ID;
+  if(entry->nametree_id == NDN_INVALID_ID){
+    return;
+  }
+  nametree_entry_t* node = ndn_nametree_at(self->nametree, entry->nametree_id);
+  node->pit_id = NDN_INVALID_ID;
+  ndn_nametree_release(self->nametree, node);
+  ndn_pit_heap_remove(self, entry);
+  ndn_faceset_clear(self->faces, &entry->incoming_faces);
+  ndn_faceset_clear(self->faces, &entry->outgoing_faces);
   ndn_pit_entry_reset(entry);
+  entry->next_free = self->free_head;
+  self->free_head = (ndn_table_id_t)(entry - self->slots);
+  self->count --;
+  self->stats.removals ++;
 }
 
 static inline void
@@ -93,7 +224,7 @@ ndn_pit_remove_entry_if_empty(ndn_pit_t* self, ndn_pit_entry_t* entry){
   if(entry->nametree_id == NDN_INVALID_ID){
     return;
   }
-  if(entry->incoming_faces == 0 &&
+  if(ndn_faceset_is_empty(&entry->incoming_faces) &&
      entry->on_data == NULL &&
      entry->on_timeout == NULL)
   {
@@ -104,56 +235,66 @@ ndn_pit_remove_entry_if_empty(ndn_pit_t* self, ndn_pit_entry_t* entry){
 void
 ndn_pit_unregister_face(ndn_pit_t* self, ndn_table_id_t face_id){
   for (ndn_table_id_t i = 0; i < self->capacity; ++i){
-    self->slots[i].incoming_faces = bitset_unset(self->slots[i].incoming_faces, face_id);
+    ndn_faceset_remove(self->faces, &self->slots[i].incoming_faces, face_id);
+    ndn_faceset_remove(self->faces, &self->slots[i].outgoing_faces, face_id);
     ndn_pit_remove_entry_if_empty(self, &self->slots[i]);
   }
 }
 
 static ndn_table_id_t
-ndn_pit_add_new_entry(ndn_pit_t* pit , int nametree_id){
-  ndn_table_id_t i;
-  for (i = 0; i < pit->capacity; ++i) {
-    if (pit->slots[i].nametree_id == NDN_INVALID_ID) {
-      ndn_pit_entry_reset(&pit->slots[i]);
-      pit->slots[i].nametree_id = nametree_id;
-      return i;
-    }
+ndn_pit_add_new_entry(ndn_pit_t* pit , ndn_table_id_t nametree_id){
+  ndn_table_id_t i = pit->free_head;
+  if (i == NDN_INVALID_ID) {
+    pit->stats.full ++;
+    return NDN_INVALID_ID;
   }
-  return NDN_INVALID_ID;
+  pit->free_head = pit->slots[i].next_free;
+  pit->count ++;
+  pit->stats.insertions ++;
+  ndn_pit_entry_reset(&pit->slots[i]);
+  pit->slots[i].nametree_id = nametree_id;
+  pit->slots[i].next_free = NDN_INVALID_ID;
+  ndn_pit_heap_push(pit, i);
+  return i;
 }
 
 ndn_pit_entry_t*
-ndn_pit_find_or_insert(ndn_pit_t* self, uint8_t* name, size_t length){
-  nametree_entry_t* entry = ndn_nametree_find_or_insert(self->nametree, name, length);
-  if(entry == NULL){
+ndn_pit_node_entry(ndn_pit_t* self, nametree_entry_t* node){
+  if(node == NULL || node->pit_id == NDN_INVALID_ID){
+    return NULL;
+  }
+  return &self->slots[node->pit_id];
+}
+
+ndn_pit_entry_t*
+ndn_pit_node_insert(ndn_pit_t* self, nametree_entry_t* node){
+  if(node == NULL){
     return NULL;
   }
-  if(entry->pit_id == NDN_INVALID_ID){
-    entry->pit_id = ndn_pit_add_new_entry(self, ndn_nametree_getid(self->nametree, entry));
+  if(node->pit_id == NDN_INVALID_ID){
+    node->pit_id = ndn_pit_add_new_entry(self, ndn_nametree_getid(self->nametree, node));
     NDN_LOG_DEBUG("[PIT] Add a new PIT entry\n");
-    if(entry->pit_id == NDN_INVALID_ID){
+    if(node->pit_id == NDN_INVALID_ID){
+      ndn_nametree_release(self->nametree, node);
       return NULL;
     }
   }
-  return &self->slots[entry->pit_id];
+  return &self->slots[node->pit_id];
+}
+
+ndn_pit_entry_t*
+ndn_pit_find_or_insert(ndn_pit_t* self, uint8_t* name, size_t length){
+  return ndn_pit_node_insert(self, ndn_nametree_find_or_insert(self->nametree, name, length));
 }
 
 ndn_pit_entry_t*
 ndn_pit_find(ndn_pit_t* self, uint8_t* prefix, size_t length)
 {
-  nametree_entry_t* entry = ndn_nametree_find(self->nametree, prefix, length);
-  if (entry == NULL || entry->pit_id == NDN_INVALID_ID) {
-    return NULL;
-  }
-  return &self->slots[entry->pit_id];
+  return ndn_pit_node_entry(self, ndn_nametree_find(self->nametree, prefix, length));
 }
 
 ndn_pit_entry_t*
 ndn_pit_prefix_match(ndn_pit_t* self, uint8_t* prefix, size_t length)
 {
-  nametree_entry_t* entry = ndn_nametree_prefix_match(self->nametree, prefix, length, NDN_NAMETREE_PIT_TYPE);
-  if (entry == NULL || entry->pit_id == NDN_INVALID_ID) {
-    return NULL;
-  }
-  return &self->slots[entry->pit_id];
+  return ndn_pit_node_entry(self, ndn_nametree_prefix_match(self->nametree, prefix, length, NDN_NAMETREE_PIT_TYPE));
 }
@@ -11,8 +11,8 @@
 #ifndef FORWARDER_PIT_H_
 #define FORWARDER_PIT_H_
 #include "../encode/forwarder-helper.h"
-#include "../util/bit-operations.h"
 #include "face.h"
+#include "face-set.h"
 #include "name-tree.h"
 #include "callback-funcs.h"
 #include "../util/uniform-time.h"
@@ -38,12 +38,12 @@ typedef struct ndn_pit_entry {
   /** Faces received this Interest.
    * Used to forward corresponding Data.
    */
-  uint64_t incoming_faces;
+  ndn_face_set_t incoming_faces;
 
   /** Faces sent out this Interest.
    * Used to suppress Interest forwarding.
    */
-  uint64_t outgoing_faces;
+  ndn_face_set_t outgoing_faces;
 
   /** Timestamp for last time the forwarder received this Interest.
    */
@@ -66,30 +66,92 @@ typedef struct ndn_pit_entry {
    */
   void* userdata;
 
+  /** Earliest time at which this entry needs attention,
+   * i.e. the application timeout or the expiry of the forwarding state.
+   */
+  ndn_time_ms_t deadline;
+
   /** NameTree entry's ID.
    * #NDN_INVALID_ID if the entry is empty.
    */
   ndn_table_id_t nametree_id;
+
+  /** Next empty slot if this entry is empty.
+   * Empty slots are linked as a free list starting from @c free_head.
+   */
+  ndn_table_id_t next_free;
+
+  /** Position of this entry in the deadline heap.
+   * #NDN_INVALID_ID if the entry is empty.
+   */
+  ndn_table_id_t heap_index;
 } ndn_pit_entry_t;
 
 /**
-* Forwarding Information Base (FIB).
-*/
+ * PIT counters. Only the owner of the PIT writes them.
+ */
+typedef struct ndn_pit_stats {
+  /** Entries created. */
+  uint64_t insertions;
+  /** Entries removed for any reason. */
+  uint64_t removals;
+  /** Entries removed because the forwarding state expired. */
+  uint64_t expirations;
+  /** OnTimeout callbacks of expressed Interests. */
+  uint64_t app_timeouts;
+  /** Insertions failed because the PIT is full. */
+  uint64_t full;
+} ndn_pit_stats_t;
+
+/**
+ * Pending Interest Table (PIT).
+ * Occupied slots are kept in a binary min-heap ordered by @c deadline,
+ * stored right after @c slots, so that expiry only touches due entries.
+ */
 typedef struct ndn_pit{
   ndn_nametree_t* nametree;
+  /** Bitmaps for face sets with many faces. */
+  ndn_face_set_pool_t* faces;
   ndn_table_id_t capacity;
+  /** Number of occupied slots. */
+  ndn_table_id_t count;
+  /** First empty slot. #NDN_INVALID_ID if the table is full. */
+  ndn_table_id_t free_head;
+  ndn_table_id_t heap_size;
+  ndn_pit_stats_t stats;
   ndn_pit_entry_t slots[];
 }ndn_pit_t;
 
 #define NDN_PIT_RESERVE_SIZE(entry_count) \
-  (sizeof(ndn_pit_t) + sizeof(ndn_pit_entry_t) * (entry_count))
+  (sizeof(ndn_pit_t) + (sizeof(ndn_pit_entry_t) + sizeof(ndn_table_id_t)) * (entry_count))
 
+/** Returned by ndn_pit_next_deadline() when no entry is pending.
+ */
+#define NDN_PIT_NO_DEADLINE ((ndn_time_ms_t)UINT64_MAX)
+
+/** Initialize PIT at specified memory space.
+ * @param[in] faces Pool for large face sets, needing two bitmaps per entry at most.
+ *                  NULL if no face set grows beyond #NDN_FACE_SET_INLINE_SIZE.
+ */
 void
-ndn_pit_init(void* memory, ndn_table_id_t capacity, ndn_nametree_t* nametree);
+ndn_pit_init(void* memory, ndn_table_id_t capacity, ndn_nametree_t* nametree,
+             ndn_face_set_pool_t* faces);
 
 void
 ndn_pit_unregister_face(ndn_pit_t* self, ndn_table_id_t face_id);
 
+/** Get the PIT entry attached to a NameTree node.
+ * @return NULL if @c node is NULL or has no PIT entry.
+ */
+ndn_pit_entry_t*
+ndn_pit_node_entry(ndn_pit_t* self, nametree_entry_t* node);
+
+/** Get or create the PIT entry attached to a NameTree node.
+ * @return NULL if @c node is NULL or the PIT is full.
+ */
+ndn_pit_entry_t*
+ndn_pit_node_insert(ndn_pit_t* self, nametree_entry_t* node);
+
 ndn_pit_entry_t*
 ndn_pit_find_or_insert(ndn_pit_t* self, uint8_t* name, size_t length);
 
@@ -102,6 +164,29 @@ ndn_pit_prefix_match(ndn_pit_t* self, uint8_t* prefix, size_t length);
 void
 ndn_pit_remove_entry(ndn_pit_t* self, ndn_pit_entry_t* entry);
 
+/** Reschedule an entry after its timestamps, lifetime or callbacks are changed.
+ * @param[in, out] self The PIT.
+ * @param[in, out] entry The entry whose @c last_time, @c express_time,
+ *                       @c options.lifetime or @c on_data was modified.
+ */
+void
+ndn_pit_update_deadline(ndn_pit_t* self, ndn_pit_entry_t* entry);
+
+/** Get the earliest deadline of all entries.
+ * @param[in] self The PIT.
+ * @return The earliest deadline. #NDN_PIT_NO_DEADLINE if the PIT is empty.
+ */
+ndn_time_ms_t
+ndn_pit_next_deadline(const ndn_pit_t* self);
+
+/** Fire application timeouts and remove expired entries.
+ * Only entries whose deadline is not later than @c now are visited.
+ * @param[in, out] self The PIT.
+ * @param[in] now Current time.
+ */
+void
+ndn_pit_process_timeout(ndn_pit_t* self, ndn_time_ms_t now);
+
 /*@}*/
 
 #ifdef __cplusplus
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include "strategy.h"
+
+// The cost of a next hop, lower is better
+static uint64_t
+ndn_strategy_cost(uint8_t strategy, const ndn_face_measurements_t* meas)
+{
+  uint32_t ratio;
+
+  if (strategy == NDN_FWD_STRATEGY_BEST_ROUTE)
+    return meas->has_rtt ? meas->srtt : (uint64_t)UINT32_MAX + 1;
+  // Adaptive: explore faces never tried
+  if (meas->sent == 0)
+    return 0;
+  ratio = ndn_measurements_ratio(meas);
+  return (uint64_t)ndn_measurements_rto(meas) * NDN_MEASUREMENTS_RATIO_ONE / (ratio > 0 ? ratio : 1);
+}
+
+ndn_table_id_t
+ndn_strategy_select(ndn_fib_entry_t* entry, ndn_face_table_t* facetab,
+                    const ndn_face_set_pool_t* faces, ndn_table_id_t in_face,
+                    const ndn_face_set_t* tried)
+{
+  ndn_face_set_iter_t iter;
+  ndn_table_id_t id;
+  ndn_table_id_t best = NDN_INVALID_ID, second = NDN_INVALID_ID;
+  uint64_t cost, best_cost = UINT64_MAX, second_cost = UINT64_MAX;
+
+  ndn_faceset_iter_init(&iter, faces, &entry->nexthop);
+  while ((id = ndn_faceset_iter_next(&iter)) != NDN_INVALID_ID) {
+    if (id == in_face || id >= facetab->capacity || facetab->slots[id] == NULL)
+      continue;
+    if (tried != NULL && ndn_faceset_contains(faces, tried, id))
+      continue;
+    if (entry->strategy == NDN_FWD_STRATEGY_ROUND_ROBIN) {
+      // Order by ID, the ones after the last pick first
+      cost = ((entry->strategy_last == NDN_INVALID_ID || id > entry->strategy_last) ? 0 : NDN_INVALID_ID);
+      cost += id;
+    }
+    else {
+      cost = ndn_strategy_cost(entry->strategy, ndn_facetab_measurements(facetab, id));
+    }
+    // Ties go to the lower ID, since face sets are not ordered
+    if (cost < best_cost || (cost == best_cost && id < best)) {
+      second = best;
+      second_cost = best_cost;
+      best = id;
+      best_cost = cost;
+    }
+    else if (cost < second_cost || (cost == second_cost && id < second)) {
+      second = id;
+      second_cost = cost;
+    }
+  }
+
+  if (entry->strategy == NDN_FWD_STRATEGY_ADAPTIVE) {
+    entry->strategy_count ++;
+    if (entry->strategy_count % NDN_STRATEGY_PROBE_INTERVAL == 0 && second != NDN_INVALID_ID)
+      best = second;
+  }
+  if (best != NDN_INVALID_ID)
+    entry->strategy_last = best;
+  return best;
+}
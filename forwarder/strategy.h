@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef FORWARDER_STRATEGY_H_
+#define FORWARDER_STRATEGY_H_
+
+#include "fib.h"
+#include "face-table.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdStrategy Strategy
+ * @brief Forwarding strategies sending an Interest to one next hop.
+ * @ingroup NDNFwd
+ *
+ * #NDN_FWD_STRATEGY_MULTICAST sends to all next hops and needs no choice.
+ * The others pick one next hop the Interest has not been sent to yet,
+ * so a retransmission tries the next candidate:
+ * - #NDN_FWD_STRATEGY_BEST_ROUTE: the lowest smoothed RTT. Unmeasured faces come last.
+ * - #NDN_FWD_STRATEGY_ROUND_ROBIN: the next hops in turn, by face ID.
+ * - #NDN_FWD_STRATEGY_ADAPTIVE: the lowest RTO divided by satisfaction ratio.
+ *   Unmeasured faces come first, and every #NDN_STRATEGY_PROBE_INTERVAL-th
+ *   Interest goes to the runner-up to keep its measurements current.
+ * @{
+ */
+
+/** Interests per probe of the adaptive strategy.
+ */
+#define NDN_STRATEGY_PROBE_INTERVAL 16
+
+/** Pick the next hop of an Interest.
+ * @param[in, out] entry The FIB entry. Its strategy state is updated.
+ * @param[in] facetab The faces and their measurements.
+ * @param[in] faces The pool of the face sets.
+ * @param[in] in_face The incoming face, never picked.
+ * @param[in] tried Faces the Interest was sent to, never picked. NULL if none.
+ * @return The face ID. #NDN_INVALID_ID if no next hop is left.
+ * @pre <tt>entry->strategy</tt> is not #NDN_FWD_STRATEGY_MULTICAST.
+ */
+ndn_table_id_t
+ndn_strategy_select(ndn_fib_entry_t* entry, ndn_face_table_t* facetab,
+                    const ndn_face_set_pool_t* faces, ndn_table_id_t in_face,
+                    const ndn_face_set_t* tried);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_STRATEGY_H_
@@ -20,6 +20,10 @@
 #define NDN_NAME_MAX_BLOCK_SIZE 384
 #define NDN_FWD_INVALID_NAME_SIZE ((uint8_t)(-1))
 #define NDN_FWD_INVALID_NAME_COMPONENT_SIZE ((uint8_t)(-1))
+// Prefixes of a name hashed once per packet, up to 255. Tables hash deeper ones themselves.
+#ifndef NDN_NAME_HASH_MAX_DEPTH
+#define NDN_NAME_HASH_MAX_DEPTH 16
+#endif
 
 // tlv
 #define NDN_TLV_LENGTH_FIELD_MAX_SIZE 9
@@ -38,15 +42,60 @@
 #define NDN_SIGNATURE_BUFFER_SIZE 128
 
 // forwarder
+// Use 32-bit table ids so tables can hold more than 65534 entries.
+#ifndef NDN_TABLE_ID_32BIT
+#define NDN_TABLE_ID_32BIT 0
+#endif
+#if NDN_TABLE_ID_32BIT
+typedef uint32_t ndn_table_id_t;
+#define NDN_INVALID_ID 0xFFFFFFFF
+#else
 typedef uint16_t ndn_table_id_t;
-
 #define NDN_INVALID_ID 0xFFFF
+#endif
 #define NDN_NAMETREE_MAX_SIZE 64
+// Index name tree children by hash. Set to 0 on tiny MCUs to fall back to sorted sibling lists.
+#ifndef NDN_NAMETREE_HASH_INDEX
+#define NDN_NAMETREE_HASH_INDEX 1
+#endif
 #define NDN_FIB_MAX_SIZE 20
+// Index FIB prefixes by hash for longest prefix match in O(log L) probes. Costs memory per NameTree node.
+#ifndef NDN_FIB_HASH_INDEX
+#define NDN_FIB_HASH_INDEX 0
+#endif
 #define NDN_PIT_MAX_SIZE 32
 #define NDN_CS_MAX_SIZE 10
+// Bytes of Data the content store may keep
+#define NDN_CS_MAX_BYTES 8192
 #define NDN_FACE_TABLE_MAX_SIZE 10
 #define NDN_FACE_DEFAULT_COST 1
+// Counters written per packet are aligned to this to avoid false sharing
+#ifndef NDN_CACHE_LINE_SIZE
+#define NDN_CACHE_LINE_SIZE 64
+#endif
+#ifdef __cplusplus
+#define NDN_CACHE_ALIGNED alignas(NDN_CACHE_LINE_SIZE)
+#else
+#define NDN_CACHE_ALIGNED _Alignas(NDN_CACHE_LINE_SIZE)
+#endif
+// Storage of per-thread state. Define it empty on targets without thread-local storage.
+#ifndef NDN_THREAD_LOCAL
+#ifdef __cplusplus
+#define NDN_THREAD_LOCAL thread_local
+#else
+#define NDN_THREAD_LOCAL _Thread_local
+#endif
+#endif
+// Run the forwarder as several shards, each driven by its own thread.
+// Needs C11 atomics and thread-local storage, so it is off by default.
+#ifndef NDN_FORWARDER_SHARDING
+#define NDN_FORWARDER_SHARDING 0
+#endif
+// Packets queued for faces with a batch send function before they are flushed.
+// 0 disables the queue and its buffer, and every packet is sent on its own.
+#ifndef NDN_FORWARDER_TX_BATCH_SIZE
+#define NDN_FORWARDER_TX_BATCH_SIZE 0
+#endif
 #define NDN_AES_BLOCK_SIZE 16
 #define NDN_MAX_FACE_PER_PIT_ENTRY 3
 
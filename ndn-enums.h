@@ -29,6 +29,9 @@ enum {
 enum {
   NDN_FWD_STRATEGY_SUPPRESS = 0,
   NDN_FWD_STRATEGY_MULTICAST = 1,
+  NDN_FWD_STRATEGY_BEST_ROUTE = 2,
+  NDN_FWD_STRATEGY_ROUND_ROBIN = 3,
+  NDN_FWD_STRATEGY_ADAPTIVE = 4,
 };
 
 // content type values
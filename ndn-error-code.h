@@ -126,7 +126,7 @@
  */
 #define NDN_FWD_FACE_TABLE_FULL -51
 
-/** The PIT is full.
+/** The PIT, or the pool of face set bitmaps its entries take, is full.
  */
 #define NDN_FWD_PIT_FULL -52
 
@@ -160,6 +160,14 @@
 /** The CS is full.
  */
 #define NDN_FWD_CS_FULL -58
+
+/** The queue from faces or the control queue of a forwarder shard is full.
+ */
+#define NDN_FWD_SHARD_QUEUE_FULL -59
+
+/** The name belongs to another forwarder shard than the one of the calling thread.
+ */
+#define NDN_FWD_WRONG_SHARD -63
 /* @} */
 
 /** @defgroup NDNErrorCodeFace Face Errors
@@ -0,0 +1,28 @@
+set(DIR_BENCHMARKS "${PROJECT_SOURCE_DIR}/benchmarks")
+find_package(Threads REQUIRED)
+
+if(FORWARDER_SHARDING)
+  add_executable(forwarder-shards-benchmark
+    "${DIR_BENCHMARKS}/forwarder-shards-benchmark.c"
+  )
+  target_link_libraries(forwarder-shards-benchmark ndn-lite Threads::Threads)
+endif()
+
+# 100k routes take more NameTree nodes than 16-bit table IDs address,
+# so the FIB benchmark links a copy of the library built with 32-bit IDs,
+# and with the FIB index whatever FORWARDER_FIB_INDEX is
+get_target_property(NDN_LITE_SOURCES ndn-lite SOURCES)
+add_library(ndn-lite-id32 STATIC ${NDN_LITE_SOURCES})
+target_compile_definitions(ndn-lite-id32 PUBLIC NDN_TABLE_ID_32BIT=1 NDN_FIB_HASH_INDEX=1)
+add_executable(fib-lpm-benchmark
+  "${DIR_BENCHMARKS}/fib-lpm-benchmark.c"
+)
+target_link_libraries(fib-lpm-benchmark ndn-lite-id32)
+unset(NDN_LITE_SOURCES)
+
+add_executable(encode-benchmark
+  "${DIR_BENCHMARKS}/encode-benchmark.c"
+)
+target_link_libraries(encode-benchmark ndn-lite)
+
+unset(DIR_BENCHMARKS)
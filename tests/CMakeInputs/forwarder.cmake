@@ -2,19 +2,29 @@ set(DIR_FORWARDER "${DIR_NDN_LITE}/forwarder")
 target_sources(ndn-lite PUBLIC
   ${DIR_FORWARDER}/callback-funcs.h
   ${DIR_FORWARDER}/cs.h
+  ${DIR_FORWARDER}/dead-nonce.h
+  ${DIR_FORWARDER}/face-set.h
   ${DIR_FORWARDER}/face-table.h
   ${DIR_FORWARDER}/face.h
   ${DIR_FORWARDER}/fib.h
   ${DIR_FORWARDER}/forwarder.h
+  ${DIR_FORWARDER}/measurements.h
   ${DIR_FORWARDER}/name-tree.h
+  ${DIR_FORWARDER}/packet-buffer.h
   ${DIR_FORWARDER}/pit.h
+  ${DIR_FORWARDER}/strategy.h
 )
 target_sources(ndn-lite PRIVATE
   ${DIR_FORWARDER}/cs.c
+  ${DIR_FORWARDER}/dead-nonce.c
+  ${DIR_FORWARDER}/face-set.c
   ${DIR_FORWARDER}/face-table.c
   ${DIR_FORWARDER}/fib.c
   ${DIR_FORWARDER}/forwarder.c
+  ${DIR_FORWARDER}/measurements.c
   ${DIR_FORWARDER}/name-tree.c
+  ${DIR_FORWARDER}/packet-buffer.c
   ${DIR_FORWARDER}/pit.c
+  ${DIR_FORWARDER}/strategy.c
 )
 unset(DIR_FORWARDER)
@@ -106,6 +106,20 @@ unset(LIST_TESTS)
 target_sources(unittest PRIVATE
   "${DIR_UNITTESTS}/fib/fib-tests.h"
   "${DIR_UNITTESTS}/fib/fib-tests.c"
+  "${DIR_UNITTESTS}/name-tree/name-tree-tests.h"
+  "${DIR_UNITTESTS}/name-tree/name-tree-tests.c"
+  "${DIR_UNITTESTS}/forwarder/many-faces.h"
+  "${DIR_UNITTESTS}/forwarder/many-faces.c"
+  "${DIR_UNITTESTS}/face-set/face-set-tests.h"
+  "${DIR_UNITTESTS}/face-set/face-set-tests.c"
+  "${DIR_UNITTESTS}/dead-nonce/dead-nonce-tests.h"
+  "${DIR_UNITTESTS}/dead-nonce/dead-nonce-tests.c"
+  "${DIR_UNITTESTS}/strategy/strategy-tests.h"
+  "${DIR_UNITTESTS}/strategy/strategy-tests.c"
+  "${DIR_UNITTESTS}/packet-buffer/packet-buffer-tests.h"
+  "${DIR_UNITTESTS}/packet-buffer/packet-buffer-tests.c"
+  "${DIR_UNITTESTS}/shards/shards-tests.h"
+  "${DIR_UNITTESTS}/shards/shards-tests.c"
 )
 
 target_sources(unittest PRIVATE
@@ -6,12 +6,16 @@ target_sources(ndn-lite PUBLIC
   ${DIR_UTIL}/bit-operations.h
   ${DIR_UTIL}/re.h
   ${DIR_UTIL}/logger.h
-  ${DIR_UTIL}/dll.h
+  ${DIR_UTIL}/spsc-ring.h
+  ${DIR_UTIL}/mpsc-queue.h
+  ${DIR_UTIL}/scratch.h
 )
 target_sources(ndn-lite PRIVATE
   ${DIR_UTIL}/memory-pool.c
   ${DIR_UTIL}/msg-queue.c
   ${DIR_UTIL}/re.c
-  ${DIR_UTIL}/dll.c
+  ${DIR_UTIL}/spsc-ring.c
+  ${DIR_UTIL}/mpsc-queue.c
+  ${DIR_UTIL}/scratch.c
 )
 unset(DIR_UTIL)
@@ -10,6 +10,7 @@
 
 #define NDN_UDP_FACE_SOCKET_ERROR 1
 #define NDN_UNIX_FACE_SOCKET_ERROR 2
+#define NDN_EVENT_LOOP_ERROR 3
 
 #define NDN_NFD_DEFAULT_ADDR "/var/run/nfd.sock"
 
@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include "event-loop.h"
+#include "ndn-lite/ndn-error-code.h"
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+static int epoll_fd = -1;
+static int timer_fd = -1;
+static int wake_fd = -1;
+
+// Wakes epoll_wait() at the forwarder deadline
+static ndn_event_loop_watch_t timer_watch;
+// Wakes epoll_wait() when another thread posts a message
+static ndn_event_loop_watch_t wake_watch;
+
+static int
+ndn_event_loop_wait(ndn_time_ms_t deadline, void* userdata);
+
+static void
+ndn_event_loop_wake(void* userdata){
+  uint64_t one = 1;
+  ssize_t written;
+  (void)userdata;
+
+  // EAGAIN means the counter is full, so the loop is woken up anyway
+  written = write(wake_fd, &one, sizeof(one));
+  (void)written;
+}
+
+int
+ndn_event_loop_init(void){
+  if(epoll_fd != -1){
+    return NDN_SUCCESS;
+  }
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if(epoll_fd == -1){
+    return NDN_EVENT_LOOP_ERROR;
+  }
+  // ndn_time_now_ms() reads CLOCK_REALTIME, so deadlines are on that clock
+  timer_fd = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+  if(timer_fd == -1 ||
+     ndn_event_loop_watch(&timer_watch, timer_fd, NULL, NULL) != NDN_SUCCESS){
+    ndn_event_loop_close();
+    return NDN_EVENT_LOOP_ERROR;
+  }
+  wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if(wake_fd == -1 ||
+     ndn_event_loop_watch(&wake_watch, wake_fd, NULL, NULL) != NDN_SUCCESS){
+    ndn_event_loop_close();
+    return NDN_EVENT_LOOP_ERROR;
+  }
+  ndn_msgqueue_set_wakeup(ndn_event_loop_wake, NULL);
+  ndn_forwarder_set_wait_func(ndn_event_loop_wait, NULL);
+  return NDN_SUCCESS;
+}
+
+void
+ndn_event_loop_close(void){
+  ndn_forwarder_set_wait_func(NULL, NULL);
+  ndn_msgqueue_set_wakeup(NULL, NULL);
+  if(wake_fd != -1){
+    close(wake_fd);
+    wake_fd = -1;
+  }
+  if(timer_fd != -1){
+    close(timer_fd);
+    timer_fd = -1;
+  }
+  if(epoll_fd != -1){
+    close(epoll_fd);
+    epoll_fd = -1;
+  }
+}
+
+bool
+ndn_event_loop_active(void){
+  return epoll_fd != -1;
+}
+
+int
+ndn_event_loop_watch(ndn_event_loop_watch_t* watch, int fd,
+                     ndn_event_loop_callback on_readable, void* obj){
+  struct epoll_event event;
+
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.ptr = watch;
+  watch->on_readable = on_readable;
+  watch->obj = obj;
+  watch->fd = -1;
+  if(epoll_fd == -1 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1){
+    return NDN_EVENT_LOOP_ERROR;
+  }
+  watch->fd = fd;
+  return NDN_SUCCESS;
+}
+
+void
+ndn_event_loop_unwatch(ndn_event_loop_watch_t* watch){
+  if(watch->fd != -1 && epoll_fd != -1){
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, watch->fd, NULL);
+  }
+  watch->fd = -1;
+}
+
+static int
+ndn_event_loop_wait(ndn_time_ms_t deadline, void* userdata){
+  struct epoll_event events[NDN_EVENT_LOOP_BATCH_SIZE];
+  struct itimerspec spec;
+  ndn_event_loop_watch_t* watch;
+  uint64_t expirations;
+  ssize_t expired;
+  int count = 0;
+  int ready, i;
+  (void)userdata;
+
+  // A zero it_value disarms the timer, which is what no deadline means.
+  // Past deadlines fire at once, so keep them nonzero.
+  memset(&spec, 0, sizeof(spec));
+  if(deadline != NDN_PIT_NO_DEADLINE){
+    spec.it_value.tv_sec = deadline / 1000;
+    spec.it_value.tv_nsec = (deadline % 1000) * 1000000;
+    if(deadline == 0){
+      spec.it_value.tv_nsec = 1;
+    }
+  }
+  // Errors are negated so they cannot be read as an event count
+  if(timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) == -1){
+    return -NDN_EVENT_LOOP_ERROR;
+  }
+
+  do{
+    ready = epoll_wait(epoll_fd, events, NDN_EVENT_LOOP_BATCH_SIZE, -1);
+  }while(ready == -1 && errno == EINTR);
+  if(ready == -1){
+    return -NDN_EVENT_LOOP_ERROR;
+  }
+
+  for(i = 0; i < ready; i++){
+    watch = (ndn_event_loop_watch_t*)events[i].data.ptr;
+    if(watch == &timer_watch){
+      // Clear the expiration. EAGAIN only means it was cleared already.
+      expired = read(timer_fd, &expirations, sizeof(expirations));
+      (void)expired;
+      continue;
+    }
+    if(watch == &wake_watch){
+      // Reset the counter. The messages are dispatched by ndn_forwarder_process().
+      expired = read(wake_fd, &expirations, sizeof(expirations));
+      (void)expired;
+      continue;
+    }
+    // A callback may only unwatch its own descriptor, since the rest of the batch is still pending
+    if(watch->fd != -1){
+      watch->on_readable(watch->obj);
+      count++;
+    }
+  }
+  return count;
+}
+
+#else
+
+int
+ndn_event_loop_init(void){
+  return NDN_EVENT_LOOP_ERROR;
+}
+
+void
+ndn_event_loop_close(void){
+}
+
+bool
+ndn_event_loop_active(void){
+  return false;
+}
+
+int
+ndn_event_loop_watch(ndn_event_loop_watch_t* watch, int fd,
+                     ndn_event_loop_callback on_readable, void* obj){
+  (void)fd;
+  watch->on_readable = on_readable;
+  watch->obj = obj;
+  watch->fd = -1;
+  return NDN_EVENT_LOOP_ERROR;
+}
+
+void
+ndn_event_loop_unwatch(ndn_event_loop_watch_t* watch){
+  watch->fd = -1;
+}
+
+#endif
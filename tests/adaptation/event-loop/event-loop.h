@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef NDN_EVENT_LOOP_H_
+#define NDN_EVENT_LOOP_H_
+
+#include <stdbool.h>
+#include "ndn-lite/forwarder/forwarder.h"
+#include "../adapt-consts.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Readiness-driven event loop (epoll + timerfd, Linux only).
+//
+// Once ndn_event_loop_init() succeeds, faces brought up afterwards register
+// their sockets here instead of re-posting themselves to the message queue,
+// and ndn_forwarder_run() sleeps until a socket is readable or the next
+// forwarder deadline. Faces brought up earlier keep polling.
+
+// Maximum number of ready sockets handled per wait
+#define NDN_EVENT_LOOP_BATCH_SIZE 32
+
+/**
+ * Called when the watched descriptor is readable.
+ */
+typedef void (*ndn_event_loop_callback)(void* obj);
+
+/**
+ * A descriptor watched by the event loop.
+ * Embed it in the face and keep it alive while watched.
+ */
+typedef struct ndn_event_loop_watch {
+  ndn_event_loop_callback on_readable;
+  void* obj;
+  int fd;
+} ndn_event_loop_watch_t;
+
+/**
+ * Create the event loop and install it as the forwarder wait function.
+ * @return NDN_SUCCESS, or NDN_EVENT_LOOP_ERROR if the platform lacks epoll or timerfd.
+ */
+int
+ndn_event_loop_init(void);
+
+/**
+ * Close the event loop. Watched faces stop receiving until brought up again.
+ */
+void
+ndn_event_loop_close(void);
+
+/**
+ * Whether ndn_event_loop_init() succeeded.
+ */
+bool
+ndn_event_loop_active(void);
+
+/**
+ * Start watching a descriptor for reading.
+ * @return NDN_SUCCESS, or NDN_EVENT_LOOP_ERROR if it cannot be added.
+ */
+int
+ndn_event_loop_watch(ndn_event_loop_watch_t* watch, int fd,
+                     ndn_event_loop_callback on_readable, void* obj);
+
+/**
+ * Stop watching. Does nothing if @c watch is not watched.
+ * Call it before closing the descriptor.
+ */
+void
+ndn_event_loop_unwatch(ndn_event_loop_watch_t* watch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NDN_EVENT_LOOP_H_
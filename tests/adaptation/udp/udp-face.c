@@ -7,6 +7,7 @@
  */
 
 #include <sys/ioctl.h>
+#include <sys/socket.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -28,6 +29,10 @@ ndn_udp_face_destroy(ndn_face_intf_t* self);
 static int
 ndn_udp_face_send(ndn_face_intf_t* self, const uint8_t* packet, uint32_t size);
 
+static int
+ndn_udp_face_send_batch(ndn_face_intf_t* self, const uint8_t* const packets[],
+                        const uint32_t sizes[], size_t count);
+
 static ndn_udp_face_t*
 ndn_udp_face_construct(
   in_addr_t local_addr,
@@ -39,6 +44,9 @@ ndn_udp_face_construct(
 static void
 ndn_udp_face_recv(void *self, size_t param_len, void *param);
 
+static void
+ndn_udp_face_on_readable(void *self);
+
 /////////////////////////// /////////////////////////// ///////////////////////////
 
 static int
@@ -83,10 +91,17 @@ ndn_udp_face_up(struct ndn_face_intf* self){
     }
   }
 
-  ptr->process_event = ndn_msgqueue_post(ptr, ndn_udp_face_recv, 0, NULL);
-  if(ptr->process_event == NULL){
-    ndn_face_down(self);
-    return NDN_FWD_MSGQUEUE_FULL;
+  if(ndn_event_loop_active()){
+    if(ndn_event_loop_watch(&ptr->watch, ptr->sock, ndn_udp_face_on_readable, ptr) != NDN_SUCCESS){
+      ndn_face_down(self);
+      return NDN_UDP_FACE_SOCKET_ERROR;
+    }
+  }else{
+    ptr->process_event = ndn_msgqueue_post(ptr, ndn_udp_face_recv, 0, NULL);
+    if(ptr->process_event == NULL){
+      ndn_face_down(self);
+      return NDN_FWD_MSGQUEUE_FULL;
+    }
   }
 
   self->state = NDN_FACE_STATE_UP;
@@ -98,6 +113,7 @@ ndn_udp_face_down(struct ndn_face_intf* self){
   ndn_udp_face_t* ptr = (ndn_udp_face_t*)self;
   self->state = NDN_FACE_STATE_DOWN;
 
+  ndn_event_loop_unwatch(&ptr->watch);
   if(ptr->sock != -1){
     close(ptr->sock);
     ptr->sock = -1;
@@ -131,6 +147,58 @@ ndn_udp_face_send(ndn_face_intf_t* self, const uint8_t* packet, uint32_t size){
   }
 }
 
+// Send up to NDN_UDP_BATCH_SIZE packets. Return the number sent, or -1 with errno set.
+static int
+ndn_udp_face_sendmmsg(ndn_udp_face_t* ptr, const uint8_t* const packets[],
+                      const uint32_t sizes[], size_t count){
+#ifdef __linux__
+  struct mmsghdr msgs[NDN_UDP_BATCH_SIZE];
+  struct iovec iovs[NDN_UDP_BATCH_SIZE];
+  size_t i;
+
+  memset(msgs, 0, sizeof(struct mmsghdr) * count);
+  for(i = 0; i < count; i++){
+    iovs[i].iov_base = (void*)packets[i];
+    iovs[i].iov_len = sizes[i];
+    msgs[i].msg_hdr.msg_name = &ptr->remote_addr;
+    msgs[i].msg_hdr.msg_namelen = sizeof(ptr->remote_addr);
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  return sendmmsg(ptr->sock, msgs, count, 0);
+#else
+  size_t i;
+  for(i = 0; i < count; i++){
+    if(sendto(ptr->sock, packets[i], sizes[i], 0,
+              (struct sockaddr*)&ptr->remote_addr, sizeof(ptr->remote_addr)) == -1){
+      return i > 0 ? (int)i : -1;
+    }
+  }
+  return (int)count;
+#endif
+}
+
+static int
+ndn_udp_face_send_batch(ndn_face_intf_t* self, const uint8_t* const packets[],
+                        const uint32_t sizes[], size_t count){
+  ndn_udp_face_t* ptr = (ndn_udp_face_t*)self;
+  size_t sent = 0, n;
+  int ret;
+
+  while(sent < count){
+    n = count - sent;
+    if(n > NDN_UDP_BATCH_SIZE){
+      n = NDN_UDP_BATCH_SIZE;
+    }
+    ret = ndn_udp_face_sendmmsg(ptr, packets + sent, sizes + sent, n);
+    if(ret <= 0){
+      return NDN_UDP_FACE_SOCKET_ERROR;
+    }
+    sent += ret;
+  }
+  return NDN_SUCCESS;
+}
+
 static ndn_udp_face_t*
 ndn_udp_face_construct(
   in_addr_t local_addr,
@@ -159,6 +227,8 @@ ndn_udp_face_construct(
   ret->intf.up = ndn_udp_face_up;
   ret->intf.down = ndn_udp_face_down;
   ret->intf.send = ndn_udp_face_send;
+  ret->intf.send_batch = ndn_udp_face_send_batch;
+  ret->intf.send_buf = NULL;
   ret->intf.destroy = ndn_udp_face_destroy;
 
   ret->local_addr.sin_family = AF_INET;
@@ -174,6 +244,7 @@ ndn_udp_face_construct(
   ret->sock = -1;
   ret->multicast = multicast;
   ret->process_event = NULL;
+  ret->watch.fd = -1;
   ndn_face_up(&ret->intf);
 
   return ret;
@@ -198,28 +269,111 @@ ndn_udp_multicast_face_construct(
   return ndn_udp_face_construct(local_addr, port, group_addr, port, true);
 }
 
-static void
-ndn_udp_face_recv(void *self, size_t param_len, void *param){
-  struct sockaddr_in client_addr;
-  socklen_t addr_len;
+// Fill up to NDN_UDP_BATCH_SIZE buffers of buf_size bytes.
+// Return the number of datagrams, or -1 with errno set.
+static int
+ndn_udp_face_recvmmsg(ndn_udp_face_t* ptr, uint8_t* const packets[], size_t buf_size,
+                      int n, size_t lengths[]){
+#ifdef __linux__
+  struct mmsghdr msgs[NDN_UDP_BATCH_SIZE];
+  struct iovec iovs[NDN_UDP_BATCH_SIZE];
+  int count, i;
+
+  memset(msgs, 0, sizeof(struct mmsghdr) * n);
+  for(i = 0; i < n; i++){
+    iovs[i].iov_base = packets[i];
+    iovs[i].iov_len = buf_size;
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  count = recvmmsg(ptr->sock, msgs, n, MSG_DONTWAIT, NULL);
+  for(i = 0; i < count; i++){
+    lengths[i] = msgs[i].msg_len;
+  }
+  return count;
+#else
   ssize_t size;
-  ndn_udp_face_t* ptr = (ndn_udp_face_t*)self;
+  int count;
+  for(count = 0; count < n; count++){
+    size = recvfrom(ptr->sock, packets[count], buf_size, MSG_DONTWAIT, NULL, NULL);
+    if(size == -1){
+      return count > 0 ? count : -1;
+    }
+    lengths[count] = size;
+  }
+  return count;
+#endif
+}
+
+// Receive until the socket is drained. Return false if the face went down.
+static bool
+ndn_udp_face_drain(ndn_udp_face_t* ptr){
+  ndn_pktbuf_pool_t* pool = ndn_forwarder_get_packet_pool();
+  ndn_pktbuf_t* bufs[NDN_UDP_BATCH_SIZE];
+  uint8_t* packets[NDN_UDP_BATCH_SIZE];
+  size_t lengths[NDN_UDP_BATCH_SIZE];
+  size_t buf_size;
+  int pooled, n, count, i;
 
   while(true){
-    size = recvfrom(ptr->sock, ptr->buf, sizeof(ptr->buf), 0,
-                    (struct sockaddr*)&client_addr, &addr_len);
-    if(size >= 0){
-      // A packet recved
-      // @TODO check return status
-      ndn_forwarder_receive(&ptr->intf, ptr->buf, size);
-    }else if(size == -1 && (errno == EWOULDBLOCK || errno == EAGAIN)){
+    // Receive into packet buffers of the forwarder pool while it has some to spare
+    for(pooled = 0; pool != NULL && pooled < NDN_UDP_BATCH_SIZE; pooled++){
+      bufs[pooled] = ndn_pktbuf_alloc(pool);
+      if(bufs[pooled] == NULL){
+        break;
+      }
+      packets[pooled] = bufs[pooled]->data;
+    }
+    if(pooled > 0){
+      n = pooled;
+      buf_size = pool->buf_size;
+    }else{
+      n = NDN_UDP_BATCH_SIZE;
+      buf_size = NDN_UDP_BUFFER_SIZE;
+      for(i = 0; i < n; i++){
+        packets[i] = ptr->buf[i];
+      }
+    }
+
+    count = ndn_udp_face_recvmmsg(ptr, packets, buf_size, n, lengths);
+    for(i = (count > 0 ? count : 0); i < pooled; i++){
+      ndn_pktbuf_release(bufs[i]);
+    }
+    if(count > 0){
+      // Datagrams a full shard queue does not take are dropped, as the network would
+      if(pooled > 0){
+        for(i = 0; i < count; i++){
+          bufs[i]->length = (uint32_t)lengths[i];
+        }
+        ndn_forwarder_receive_buf_batch(&ptr->intf, bufs, count);
+      }else{
+        ndn_forwarder_receive_batch(&ptr->intf, packets, lengths, count);
+      }
+      if(count < n){
+        break;
+      }
+    }else if(count == 0 || errno == EWOULDBLOCK || errno == EAGAIN){
       // No more packet
       break;
     }else{
       ndn_face_down(&ptr->intf);
-      return;
+      return false;
     }
   }
+  return true;
+}
+
+static void
+ndn_udp_face_recv(void *self, size_t param_len, void *param){
+  ndn_udp_face_t* ptr = (ndn_udp_face_t*)self;
+
+  ptr->process_event = NULL;
+  if(ndn_udp_face_drain(ptr)){
+    ptr->process_event = ndn_msgqueue_post(self, ndn_udp_face_recv, param_len, param);
+  }
+}
 
-  ptr->process_event = ndn_msgqueue_post(self, ndn_udp_face_recv, param_len, param);
+static void
+ndn_udp_face_on_readable(void *self){
+  ndn_udp_face_drain((ndn_udp_face_t*)self);
 }
\ No newline at end of file
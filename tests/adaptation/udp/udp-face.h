@@ -13,6 +13,7 @@
 #include "ndn-lite/forwarder/forwarder.h"
 #include "ndn-lite/util/msg-queue.h"
 #include "../adapt-consts.h"
+#include "../event-loop/event-loop.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -24,6 +25,9 @@ extern "C" {
 // Given that we don't cache
 #define NDN_UDP_BUFFER_SIZE 4096
 
+// Datagrams received or sent per system call
+#define NDN_UDP_BATCH_SIZE 16
+
 /**
  * Udp face
  */
@@ -36,9 +40,13 @@ typedef struct ndn_udp_face {
   struct sockaddr_in local_addr;
   struct sockaddr_in remote_addr;
   struct ndn_msg* process_event;
+  ndn_event_loop_watch_t watch;
   int sock;
   bool multicast;
-  uint8_t buf[NDN_UDP_BUFFER_SIZE];
+  // Receive buffers, filled by one system call and handed to the forwarder as a burst.
+  // Used while the forwarder packet pool is unset or exhausted; datagrams longer
+  // than its buffers are truncated and dropped.
+  uint8_t buf[NDN_UDP_BATCH_SIZE][NDN_UDP_BUFFER_SIZE];
 } ndn_udp_face_t;
 
 ndn_udp_face_t*
@@ -45,11 +45,33 @@ ndn_unix_face_recv(void *self, size_t param_len, void *param);
 static void
 ndn_unix_face_accept(void *self, size_t param_len, void *param);
 
+static void
+ndn_unix_face_on_readable(void *self);
+
+static void
+ndn_unix_face_on_acceptable(void *self);
+
 static ndn_unix_face_t*
 ndn_unix_slave_face_construct(int sock);
 
 /////////////////////////// /////////////////////////// ///////////////////////////
 
+// Wait for the socket through the event loop if it is active, by polling it otherwise
+static int
+ndn_unix_face_watch(ndn_unix_face_t* ptr, ndn_msg_callback poll, ndn_event_loop_callback on_ready){
+  if(ndn_event_loop_active()){
+    if(ndn_event_loop_watch(&ptr->watch, ptr->sock, on_ready, ptr) != NDN_SUCCESS){
+      return NDN_UNIX_FACE_SOCKET_ERROR;
+    }
+    return NDN_SUCCESS;
+  }
+  ptr->process_event = ndn_msgqueue_post(ptr, poll, 0, NULL);
+  if(ptr->process_event == NULL){
+    return NDN_FWD_MSGQUEUE_FULL;
+  }
+  return NDN_SUCCESS;
+}
+
 static int
 ndn_unix_face_up(struct ndn_face_intf* self){
   ndn_unix_face_t* ptr = container_of(self, ndn_unix_face_t, intf);
@@ -91,10 +113,10 @@ ndn_unix_client_face_up(struct ndn_face_intf* self){
     return NDN_UNIX_FACE_SOCKET_ERROR;
   }
 
-  ptr->process_event = ndn_msgqueue_post(ptr, ndn_unix_face_recv, 0, NULL);
-  if(ptr->process_event == NULL){
+  ret = ndn_unix_face_watch(ptr, ndn_unix_face_recv, ndn_unix_face_on_readable);
+  if(ret != NDN_SUCCESS){
     ndn_face_down(self);
-    return NDN_FWD_MSGQUEUE_FULL;
+    return ret;
   }
 
   self->state = NDN_FACE_STATE_UP;
@@ -129,10 +151,10 @@ ndn_unix_server_face_up(struct ndn_face_intf* self){
 
   chmod(ptr->addr.sun_path, 0666);
 
-  ptr->process_event = ndn_msgqueue_post(ptr, ndn_unix_face_accept, 0, NULL);
-  if(ptr->process_event == NULL){
+  ret = ndn_unix_face_watch(ptr, ndn_unix_face_accept, ndn_unix_face_on_acceptable);
+  if(ret != NDN_SUCCESS){
     ndn_face_down(self);
-    return NDN_FWD_MSGQUEUE_FULL;
+    return ret;
   }
 
   self->state = NDN_FACE_STATE_UP;
@@ -144,6 +166,7 @@ ndn_unix_face_down(struct ndn_face_intf* self){
   ndn_unix_face_t* ptr = (ndn_unix_face_t*)self;
   self->state = NDN_FACE_STATE_DOWN;
 
+  ndn_event_loop_unwatch(&ptr->watch);
   if(ptr->sock != -1){
     close(ptr->sock);
     ptr->sock = -1;
@@ -203,6 +226,8 @@ ndn_unix_face_construct(const char* addr, bool client){
   }
   ret->intf.down = ndn_unix_face_down;
   ret->intf.send = ndn_unix_face_send;
+  ret->intf.send_batch = NULL;
+  ret->intf.send_buf = NULL;
   ret->intf.destroy = ndn_unix_face_destroy;
 
   ret->addr.sun_family = AF_UNIX;
@@ -218,6 +243,7 @@ ndn_unix_face_construct(const char* addr, bool client){
   ret->sock = -1;
   ret->offset = 0;
   ret->process_event = NULL;
+  ret->watch.fd = -1;
   ndn_face_up(&ret->intf);
 
   return ret;
@@ -246,13 +272,16 @@ ndn_unix_slave_face_construct(int sock){
   ret->intf.up = NULL;
   ret->intf.down = ndn_unix_slave_face_down;
   ret->intf.send = ndn_unix_face_send;
+  ret->intf.send_batch = NULL;
+  ret->intf.send_buf = NULL;
   ret->intf.destroy = NULL;
 
   ret->client = false;
   ret->sock = sock;
   ret->offset = 0;
-  ret->process_event = ndn_msgqueue_post(ret, ndn_unix_face_recv, 0, NULL);
-  if(ret->process_event == NULL){
+  ret->process_event = NULL;
+  ret->watch.fd = -1;
+  if(ndn_unix_face_watch(ret, ndn_unix_face_recv, ndn_unix_face_on_readable) != NDN_SUCCESS){
     ndn_face_down(&ret->intf);
     return NULL;
   }
@@ -269,17 +298,13 @@ ndn_unix_slave_face_down(struct ndn_face_intf* self){
   return NDN_SUCCESS;
 }
 
-static void
-ndn_unix_face_recv(void *self, size_t param_len, void *param){
-  ndn_unix_face_t* ptr = (ndn_unix_face_t*)self;
+// Receive what is available. Return false if the face went down.
+static bool
+ndn_unix_face_read(ndn_unix_face_t* ptr){
   ssize_t size;
   uint8_t *buf, *valptr;
   uint32_t cur_type, cur_size;
 
-  // It works without this line but I think adding is better, following the logic.
-  // So ndn_face_down won't cancel a not existing event.
-  ptr->process_event = NULL;
-
   size = recv(ptr->sock,
               ptr->buf + ptr->offset,
               sizeof(ptr->buf) - ptr->offset,
@@ -310,19 +335,34 @@ ndn_unix_face_recv(void *self, size_t param_len, void *param){
   }else{
     // size == 0 means a shutdown
     ndn_face_down(&ptr->intf);
-    return;
+    return false;
   }
-
-  ptr->process_event = ndn_msgqueue_post(self, ndn_unix_face_recv, param_len, param);
+  return true;
 }
 
 static void
-ndn_unix_face_accept(void *self, size_t param_len, void *param){
+ndn_unix_face_recv(void *self, size_t param_len, void *param){
   ndn_unix_face_t* ptr = (ndn_unix_face_t*)self;
-  int ret = 0;
 
+  // It works without this line but I think adding is better, following the logic.
+  // So ndn_face_down won't cancel a not existing event.
   ptr->process_event = NULL;
 
+  if(ndn_unix_face_read(ptr)){
+    ptr->process_event = ndn_msgqueue_post(self, ndn_unix_face_recv, param_len, param);
+  }
+}
+
+static void
+ndn_unix_face_on_readable(void *self){
+  ndn_unix_face_read((ndn_unix_face_t*)self);
+}
+
+// Accept one connection. Return false if the face went down.
+static bool
+ndn_unix_face_accept_one(ndn_unix_face_t* ptr){
+  int ret = 0;
+
   ret = accept(ptr->sock, NULL, NULL);
   if(ret >= 0){
     //printf("New face created %d\n", ret);
@@ -333,8 +373,23 @@ ndn_unix_face_accept(void *self, size_t param_len, void *param){
     //No more connections
   }else{
     ndn_face_down(&ptr->intf);
-    return;
+    return false;
   }
+  return true;
+}
+
+static void
+ndn_unix_face_accept(void *self, size_t param_len, void *param){
+  ndn_unix_face_t* ptr = (ndn_unix_face_t*)self;
 
-  ptr->process_event = ndn_msgqueue_post(self, ndn_unix_face_accept, param_len, param);
+  ptr->process_event = NULL;
+
+  if(ndn_unix_face_accept_one(ptr)){
+    ptr->process_event = ndn_msgqueue_post(self, ndn_unix_face_accept, param_len, param);
+  }
+}
+
+static void
+ndn_unix_face_on_acceptable(void *self){
+  ndn_unix_face_accept_one((ndn_unix_face_t*)self);
 }
@@ -14,6 +14,7 @@
 #include "ndn-lite/forwarder/forwarder.h"
 #include "ndn-lite/util/msg-queue.h"
 #include "../adapt-consts.h"
+#include "../event-loop/event-loop.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,6 +35,7 @@ typedef struct ndn_unix_face {
 
   struct sockaddr_un addr;
   struct ndn_msg* process_event;
+  ndn_event_loop_watch_t watch;
   int sock;
 
   uint8_t buf[NDN_UNIX_BUFFER_SIZE];
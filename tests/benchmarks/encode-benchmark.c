@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+// Packet encoding: the forward encoders, which probe the size of every element
+// before writing it, against the back-to-front prepend encoders.
+// Usage: encode-benchmark [milliseconds per run]
+//
+// Both columns encode into a buffer which is not cleared first. Signed packets
+// use DigestSha256, as the other signers log each packet.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ndn-lite.h"
+#include "ndn-lite/encode/data.h"
+#include "ndn-lite/encode/interest.h"
+
+#define BENCH_BUFFER_SIZE 2048
+#define BENCH_BATCH 1024
+
+typedef int (*bench_encode_func)(uint8_t* buf, uint32_t size, uint8_t** output, uint32_t* output_size);
+
+static ndn_interest_t short_interest, long_interest;
+static ndn_data_t small_data, large_data;
+static uint8_t content[1000];
+
+static double
+bench_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#define BENCH_FORWARD(func_name, call) \
+  static int \
+  func_name(uint8_t* buf, uint32_t size, uint8_t** output, uint32_t* output_size) \
+  { \
+    ndn_encoder_t encoder; \
+    int ret; \
+    encoder_init_nozero(&encoder, buf, size); \
+    ret = call; \
+    *output = buf; \
+    *output_size = encoder.offset; \
+    return ret; \
+  }
+
+#define BENCH_PREPEND(func_name, call) \
+  static int \
+  func_name(uint8_t* buf, uint32_t size, uint8_t** output, uint32_t* output_size) \
+  { \
+    ndn_prepend_encoder_t encoder; \
+    int ret; \
+    prepend_encoder_init(&encoder, buf, size); \
+    ret = call; \
+    *output = prepend_encoder_output(&encoder); \
+    *output_size = prepend_encoder_size(&encoder); \
+    return ret; \
+  }
+
+BENCH_FORWARD(forward_short_interest, ndn_interest_tlv_encode(&encoder, &short_interest))
+BENCH_PREPEND(prepend_short_interest, ndn_interest_tlv_prepend(&encoder, &short_interest))
+BENCH_FORWARD(forward_long_interest, ndn_interest_tlv_encode(&encoder, &long_interest))
+BENCH_PREPEND(prepend_long_interest, ndn_interest_tlv_prepend(&encoder, &long_interest))
+BENCH_FORWARD(forward_small_data, ndn_data_tlv_encode(&encoder, &small_data))
+BENCH_PREPEND(prepend_small_data, ndn_data_tlv_prepend(&encoder, &small_data))
+BENCH_FORWARD(forward_large_data, ndn_data_tlv_encode(&encoder, &large_data))
+BENCH_PREPEND(prepend_large_data, ndn_data_tlv_prepend(&encoder, &large_data))
+BENCH_FORWARD(forward_signed_data, ndn_data_tlv_encode_digest_sign(&encoder, &small_data))
+BENCH_PREPEND(prepend_signed_data, ndn_data_tlv_prepend_digest_sign(&encoder, &small_data))
+
+typedef struct bench_case {
+  const char* name;
+  bench_encode_func forward;
+  bench_encode_func prepend;
+} bench_case_t;
+
+static const bench_case_t bench_cases[] = {
+  {"Interest, 3 components", forward_short_interest, prepend_short_interest},
+  {"Interest, 8 components", forward_long_interest, prepend_long_interest},
+  {"Data, 64B content", forward_small_data, prepend_small_data},
+  {"Data, 1000B content", forward_large_data, prepend_large_data},
+  {"Data, 64B digest-signed", forward_signed_data, prepend_signed_data},
+};
+
+static void
+bench_setup(void)
+{
+  const char short_uri[] = "/home/room1/light";
+  const char long_uri[] = "/home/building2/floor3/room14/sensor/temperature/latest/v1";
+
+  for (size_t i = 0; i < sizeof(content); i++)
+    content[i] = (uint8_t)i;
+
+  ndn_interest_init(&short_interest);
+  ndn_name_from_string(&short_interest.name, short_uri, strlen(short_uri));
+  ndn_interest_init(&long_interest);
+  ndn_name_from_string(&long_interest.name, long_uri, strlen(long_uri));
+  ndn_interest_set_CanBePrefix(&long_interest, true);
+  ndn_interest_set_MustBeFresh(&long_interest, true);
+  ndn_interest_set_HopLimit(&long_interest, 32);
+
+  ndn_data_init(&small_data);
+  ndn_name_from_string(&small_data.name, long_uri, strlen(long_uri));
+  ndn_metainfo_set_freshness_period(&small_data.metainfo, 10000);
+  ndn_data_set_content(&small_data, content, 64);
+  ndn_signature_init(&small_data.signature, false);
+  ndn_signature_set_signature_type(&small_data.signature, NDN_SIG_TYPE_DIGEST_SHA256);
+  large_data = small_data;
+  ndn_data_set_content(&large_data, content, sizeof(content));
+}
+
+static double
+bench_time(bench_encode_func func, double duration, uint64_t* packets)
+{
+  static uint8_t buf[BENCH_BUFFER_SIZE];
+  double start = bench_now(), elapsed;
+  uint8_t* output;
+  uint32_t output_size;
+  uint64_t sink = 0;
+  int i;
+
+  *packets = 0;
+  do {
+    for (i = 0; i < BENCH_BATCH; i++) {
+      func(buf, sizeof(buf), &output, &output_size);
+      sink += output[output_size - 1];
+    }
+    *packets += BENCH_BATCH;
+    elapsed = bench_now() - start;
+  } while (elapsed < duration);
+  // Keep the encoding from being optimized out
+  if (sink == 1)
+    printf(" ");
+  return elapsed;
+}
+
+static int
+bench_run(const bench_case_t* bench, double duration)
+{
+  static uint8_t forward_buf[BENCH_BUFFER_SIZE], prepend_buf[BENCH_BUFFER_SIZE];
+  uint8_t *forward_output, *prepend_output;
+  uint32_t forward_size, prepend_size;
+  uint64_t forward_packets, prepend_packets;
+  double forward_time, prepend_time;
+  bool same;
+
+  if (bench->forward(forward_buf, sizeof(forward_buf), &forward_output, &forward_size) != NDN_SUCCESS ||
+      bench->prepend(prepend_buf, sizeof(prepend_buf), &prepend_output, &prepend_size) != NDN_SUCCESS)
+    return -1;
+  same = forward_size == prepend_size && memcmp(forward_output, prepend_output, forward_size) == 0;
+
+  forward_time = bench_time(bench->forward, duration, &forward_packets);
+  prepend_time = bench_time(bench->prepend, duration, &prepend_packets);
+  printf("%-26s %6u %14.1f %14.1f%s\n", bench->name, forward_size,
+         forward_time * 1e9 / forward_packets, prepend_time * 1e9 / prepend_packets,
+         same ? "" : "   MISMATCH");
+  return same ? 0 : -1;
+}
+
+int
+main(int argc, char* argv[])
+{
+  double duration = (argc > 1) ? atoi(argv[1]) / 1000.0 : 1.0;
+  size_t i;
+
+  ndn_lite_startup();
+  bench_setup();
+  printf("%-26s %6s %14s %14s\n", "packet", "bytes", "forward ns/op", "prepend ns/op");
+  for (i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++) {
+    if (bench_run(&bench_cases[i], duration) != 0) {
+      fprintf(stderr, "Failed at %s\n", bench_cases[i].name);
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+// FIB longest prefix match: the NameTree walk against the prefix hash index,
+// at 100, 10k and 100k routes.
+// Usage: fib-lpm-benchmark [milliseconds per run]
+//
+// Routes are /home/room<r>/dev<d>/svc<s>. Names looked up are 2 components
+// deeper, and 1 in 8 is under a room without routes. Their hashes are computed
+// beforehand, as the forwarder does once per packet.
+// 100k routes need NDN_TABLE_ID_32BIT, and the index NDN_FIB_HASH_INDEX,
+// which the build sets for this program.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ndn-lite.h"
+#include "ndn-lite/encode/name.h"
+#include "ndn-lite/forwarder/fib.h"
+#include "ndn-lite/forwarder/name-tree.h"
+
+#define BENCH_LOOKUPS 4096
+#define BENCH_NAME_SIZE 96
+
+static const uint32_t bench_route_counts[] = {100, 10000, 100000};
+
+static uint8_t names[BENCH_LOOKUPS][BENCH_NAME_SIZE];
+static size_t name_lens[BENCH_LOOKUPS];
+static ndn_name_hash_t name_hashes[BENCH_LOOKUPS];
+
+static double
+bench_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static size_t
+bench_encode(const char* uri, uint8_t* buf, size_t size)
+{
+  ndn_name_t name;
+  ndn_encoder_t encoder;
+
+  ndn_name_from_string(&name, uri, strlen(uri));
+  encoder_init(&encoder, buf, size);
+  ndn_name_tlv_encode(&encoder, &name);
+  return encoder.offset;
+}
+
+static void
+bench_route_uri(uint32_t i, char* str, size_t size)
+{
+  snprintf(str, size, "/home/room%u/dev%u/svc%u", i / 1000, i / 10 % 100, i % 10);
+}
+
+static ndn_fib_entry_t*
+bench_tree_match(ndn_fib_t* fib, uint8_t* name, size_t len)
+{
+  return ndn_fib_node_entry(fib, ndn_nametree_prefix_match(fib->nametree, name, len,
+                                                           NDN_NAMETREE_FIB_TYPE));
+}
+
+static double
+bench_time(ndn_fib_t* fib, bool index, double duration, uint64_t* lookups)
+{
+  double start = bench_now(), elapsed;
+  uintptr_t sink = 0;
+  int i;
+
+  *lookups = 0;
+  do {
+    for (i = 0; i < BENCH_LOOKUPS; i++) {
+      if (index)
+        sink += (uintptr_t)ndn_fib_prefix_match_hashed(fib, names[i], name_lens[i], &name_hashes[i]);
+      else
+        sink += (uintptr_t)bench_tree_match(fib, names[i], name_lens[i]);
+    }
+    *lookups += BENCH_LOOKUPS;
+    elapsed = bench_now() - start;
+  } while (elapsed < duration);
+  // Keep the lookups from being optimized out
+  if (sink == 1)
+    printf(" ");
+  return elapsed;
+}
+
+static int
+bench_run(uint32_t route_count, double duration)
+{
+  // Nodes: the root, /home, the rooms, the devices and the services
+  uint64_t nametree_size = 2 * (uint64_t)route_count + 16;
+  size_t nametree_len = (NDN_NAMETREE_RESERVE_SIZE(nametree_size) + 7) / 8 * 8;
+  size_t fib_len = NDN_FIB_RESERVE_SIZE(route_count) + NDN_FIB_INDEX_SIZE(nametree_size);
+  uint8_t* memory;
+  ndn_nametree_t* nametree;
+  ndn_fib_t* fib;
+  uint64_t tree_lookups, index_lookups;
+  double tree_time, index_time;
+  uint32_t i, route, mismatches = 0;
+  uint8_t buf[BENCH_NAME_SIZE];
+  char str[80];
+
+  if (nametree_size >= NDN_INVALID_ID) {
+    printf("%8u %14s %14s   needs NDN_TABLE_ID_32BIT\n", route_count, "-", "-");
+    return 0;
+  }
+  memory = malloc(nametree_len + fib_len);
+  if (memory == NULL)
+    return -1;
+  nametree = (ndn_nametree_t*)memory;
+  fib = (ndn_fib_t*)(memory + nametree_len);
+  ndn_nametree_init(nametree, (ndn_table_id_t)nametree_size);
+  ndn_fib_init(fib, (ndn_table_id_t)route_count, nametree, NULL);
+  for (i = 0; i < route_count; i++) {
+    bench_route_uri(i, str, sizeof(str));
+    if (ndn_fib_find_or_insert(fib, buf, bench_encode(str, buf, sizeof(buf))) == NULL) {
+      free(memory);
+      return -1;
+    }
+  }
+
+  srand(route_count);
+  for (i = 0; i < BENCH_LOOKUPS; i++) {
+    route = (uint32_t)rand() % route_count;
+    if (i % 8 == 7) {
+      snprintf(str, sizeof(str), "/home/room%u/dev%u/svc%u/data/%u",
+               route_count / 1000 + 1, route / 10 % 100, route % 10, i);
+    }
+    else {
+      bench_route_uri(route, str, sizeof(str));
+      snprintf(str + strlen(str), sizeof(str) - strlen(str), "/data/%u", i);
+    }
+    name_lens[i] = bench_encode(str, names[i], BENCH_NAME_SIZE);
+    ndn_name_hash_compute(&name_hashes[i], names[i], name_lens[i]);
+    if (ndn_fib_prefix_match_hashed(fib, names[i], name_lens[i], &name_hashes[i]) !=
+        bench_tree_match(fib, names[i], name_lens[i]))
+      mismatches ++;
+  }
+
+  tree_time = bench_time(fib, false, duration, &tree_lookups);
+  index_time = bench_time(fib, true, duration, &index_lookups);
+  printf("%8u %14.1f %14.1f%s\n", route_count,
+         tree_time * 1e9 / tree_lookups, index_time * 1e9 / index_lookups,
+         mismatches > 0 ? "   MISMATCH" : "");
+  free(memory);
+  return mismatches > 0 ? -1 : 0;
+}
+
+int
+main(int argc, char* argv[])
+{
+  double duration = (argc > 1) ? atoi(argv[1]) / 1000.0 : 1.0;
+  size_t i;
+
+  ndn_lite_startup();
+  printf("%8s %14s %14s\n", "routes", "walk ns/op", "index ns/op");
+  for (i = 0; i < sizeof(bench_route_counts) / sizeof(bench_route_counts[0]); i++) {
+    if (bench_run(bench_route_counts[i], duration) != 0) {
+      fprintf(stderr, "Failed at %u routes\n", bench_route_counts[i]);
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,325 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+// Packets per second of the sharded forwarder at 1, 2, 4 and 8 shards.
+// Usage: forwarder-shards-benchmark [milliseconds per run]
+//
+// Each shard has its own pair of faces and its own feeder thread, which
+// receives the Interests and Data whose names the shard owns: a consumer
+// face sends Interests under the prefixes routed to the producer face,
+// which answers each with Data. Feeder and shard threads are pinned to
+// cores round-robin. With fewer cores than threads they share cores, and
+// the numbers show the cost of sharding rather than how it scales.
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ndn-lite.h"
+#include "ndn-lite/ndn-error-code.h"
+#include "ndn-lite/encode/data.h"
+#include "ndn-lite/encode/interest.h"
+#include "ndn-lite/forwarder/forwarder.h"
+
+#define BENCH_PREFIXES 64
+#define BENCH_NAMES 4096
+#define BENCH_PACKET_SIZE 128
+#define BENCH_MAX_SHARDS 8
+// Interests all shards receive within the Dead Nonce List lifetime and a generation,
+// enough for about 250k packets/s
+#define BENCH_DNL_SIZE (1 << 21)
+
+static const uint32_t bench_shard_counts[] = {1, 2, 4, BENCH_MAX_SHARDS};
+
+static uint8_t interests[BENCH_NAMES][BENCH_PACKET_SIZE];
+static size_t interest_lens[BENCH_NAMES];
+static uint8_t* interest_nonces[BENCH_NAMES];
+static uint8_t datas[BENCH_NAMES][BENCH_PACKET_SIZE];
+static size_t data_lens[BENCH_NAMES];
+
+// Names of each shard, as indexes into interests and datas
+static uint32_t shard_names[BENCH_MAX_SHARDS][BENCH_NAMES];
+static uint32_t shard_name_counts[BENCH_MAX_SHARDS];
+
+static ndn_face_intf_t consumers[BENCH_MAX_SHARDS], producers[BENCH_MAX_SHARDS];
+static atomic_ulong sent_packets;
+static atomic_bool running, feeding;
+static long cpu_count;
+
+static int
+bench_face_send(struct ndn_face_intf* self, const uint8_t* packet, uint32_t size)
+{
+  (void)self;
+  (void)packet;
+  (void)size;
+  atomic_fetch_add_explicit(&sent_packets, 1, memory_order_relaxed);
+  return NDN_SUCCESS;
+}
+
+static void
+bench_face_init(ndn_face_intf_t* face)
+{
+  memset(face, 0, sizeof(ndn_face_intf_t));
+  face->send = bench_face_send;
+  face->state = NDN_FACE_STATE_UP;
+  face->face_id = NDN_INVALID_ID;
+}
+
+static double
+bench_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void
+bench_pin(pthread_t thread, uint32_t slot)
+{
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(slot % cpu_count, &cpus);
+  pthread_setaffinity_np(thread, sizeof(cpus), &cpus);
+}
+
+// Locate the Nonce value so each round can send fresh nonces
+static uint8_t*
+bench_find_nonce(uint8_t* interest, size_t length, uint32_t nonce)
+{
+  size_t i;
+  for (i = 0; i + 6 <= length; i++) {
+    if (interest[i] == TLV_Nonce && interest[i + 1] == 4 &&
+        interest[i + 2] == (uint8_t)(nonce >> 24) && interest[i + 3] == (uint8_t)(nonce >> 16) &&
+        interest[i + 4] == (uint8_t)(nonce >> 8) && interest[i + 5] == (uint8_t)nonce) {
+      return &interest[i + 2];
+    }
+  }
+  return NULL;
+}
+
+static void
+bench_set_nonce(uint8_t* value, uint32_t nonce)
+{
+  if (value != NULL) {
+    value[0] = (uint8_t)(nonce >> 24);
+    value[1] = (uint8_t)(nonce >> 16);
+    value[2] = (uint8_t)(nonce >> 8);
+    value[3] = (uint8_t)nonce;
+  }
+}
+
+static void
+bench_encode_packets(void)
+{
+  ndn_interest_t interest;
+  ndn_data_t data;
+  ndn_encoder_t encoder;
+  char str[64];
+  int i;
+
+  for (i = 0; i < BENCH_NAMES; i++) {
+    snprintf(str, sizeof(str), "/p%d/item/%d", i % BENCH_PREFIXES, i);
+
+    ndn_interest_init(&interest);
+    ndn_name_from_string(&interest.name, str, strlen(str));
+    interest.nonce = i + 1;
+    encoder_init(&encoder, interests[i], BENCH_PACKET_SIZE);
+    ndn_interest_tlv_encode(&encoder, &interest);
+    interest_lens[i] = encoder.offset;
+    interest_nonces[i] = bench_find_nonce(interests[i], interest_lens[i], interest.nonce);
+
+    ndn_data_init(&data);
+    ndn_name_from_string(&data.name, str, strlen(str));
+    ndn_data_set_content(&data, (uint8_t*)"payload", 7);
+    encoder_init(&encoder, datas[i], BENCH_PACKET_SIZE);
+    ndn_data_tlv_encode_digest_sign(&encoder, &data);
+    data_lens[i] = encoder.offset;
+  }
+}
+
+// Split the names by shard. Names under a prefix share its shard.
+static int
+bench_assign_names(uint32_t shard_count)
+{
+  int shard;
+  uint32_t i;
+
+  memset(shard_name_counts, 0, sizeof(shard_name_counts));
+  for (i = 0; i < BENCH_NAMES; i++) {
+    shard = ndn_forwarder_shard_of(interests[i], interest_lens[i]);
+    if (shard < 0 || (uint32_t)shard >= shard_count)
+      return -1;
+    shard_names[shard][shard_name_counts[shard]++] = i;
+  }
+  return 0;
+}
+
+static void*
+bench_shard_thread(void* arg)
+{
+  uint32_t index = (uint32_t)(uintptr_t)arg;
+  unsigned long* processed = malloc(sizeof(unsigned long));
+  int ret;
+
+  *processed = 0;
+  while (atomic_load_explicit(&running, memory_order_relaxed)) {
+    ret = ndn_forwarder_shard_process(index);
+    if (ret > 0)
+      *processed += ret;
+  }
+  return processed;
+}
+
+// Hand a packet to its shard, waiting while the queue is full
+static void
+bench_receive(ndn_face_intf_t* face, uint8_t* packet, size_t length)
+{
+  while (ndn_forwarder_receive(face, packet, length) == NDN_FWD_SHARD_QUEUE_FULL) {
+    sched_yield();
+  }
+}
+
+// Feed the Interests and Data of one shard until stopped.
+// Rounds start at 1, so nonces differ from the encoded ones.
+static void*
+bench_feeder_thread(void* arg)
+{
+  uint32_t index = (uint32_t)(uintptr_t)arg;
+  uint32_t round = 0, i, name;
+
+  while (atomic_load_explicit(&feeding, memory_order_relaxed)) {
+    round ++;
+    for (i = 0; i < shard_name_counts[index]; i++) {
+      name = shard_names[index][i];
+      bench_set_nonce(interest_nonces[name], round * BENCH_NAMES + name + 1);
+      bench_receive(&consumers[index], interests[name], interest_lens[name]);
+      bench_receive(&producers[index], datas[name], data_lens[name]);
+    }
+  }
+  return NULL;
+}
+
+static int
+bench_run(uint32_t shard_count, double duration)
+{
+  const ndn_forwarder_config_t config = {
+    .nametree_size = 2048,
+    .facetab_size = 2 * BENCH_MAX_SHARDS,
+    .fib_size = BENCH_PREFIXES + 1,
+    .pit_size = 512,
+    .cs_size = 256,
+    .cs_bytes = 32768,
+    // Each shard gets its share of the Interests kept within the DNL lifetime
+    .dnl_size = BENCH_DNL_SIZE / shard_count,
+  };
+  size_t main_len = ndn_forwarder_reserve_size(&config);
+  size_t shards_len = ndn_forwarder_shards_reserve_size(shard_count, &config);
+  void* main_memory = malloc(main_len);
+  void* shards_memory = malloc(shards_len);
+  pthread_t threads[BENCH_MAX_SHARDS], feeders[BENCH_MAX_SHARDS];
+  unsigned long processed = 0, *thread_processed;
+  double start, elapsed;
+  char prefix[16];
+  uint32_t i, shard;
+  int ret = -1;
+
+  if (main_memory == NULL || shards_memory == NULL)
+    goto out;
+  if (ndn_forwarder_init_ex(&config, main_memory, main_len) != NDN_SUCCESS)
+    goto out;
+  if (ndn_forwarder_shards_init(shard_count, 1, &config, shards_memory, shards_len) != NDN_SUCCESS)
+    goto out;
+  if (bench_assign_names(shard_count) != 0)
+    goto out;
+  atomic_store(&sent_packets, 0);
+  atomic_store(&running, true);
+  for (i = 0; i < shard_count; i++) {
+    pthread_create(&threads[i], NULL, bench_shard_thread, (void*)(uintptr_t)i);
+    bench_pin(threads[i], 2 * i + 1);
+  }
+
+  // Updates are queued to the shards, so wait while their queues are full
+  for (i = 0; i < shard_count; i++) {
+    bench_face_init(&consumers[i]);
+    bench_face_init(&producers[i]);
+    while (ndn_forwarder_register_face(&consumers[i]) == NDN_FWD_SHARD_QUEUE_FULL)
+      sched_yield();
+    while (ndn_forwarder_register_face(&producers[i]) == NDN_FWD_SHARD_QUEUE_FULL)
+      sched_yield();
+  }
+  // Name i is under prefix i % BENCH_PREFIXES, routed to the producer of its shard
+  for (i = 0; i < BENCH_PREFIXES; i++) {
+    shard = (uint32_t)ndn_forwarder_shard_of(interests[i], interest_lens[i]);
+    snprintf(prefix, sizeof(prefix), "/p%u", i);
+    while (ndn_forwarder_add_route_by_str(&producers[shard], prefix, strlen(prefix)) == NDN_FWD_SHARD_QUEUE_FULL)
+      sched_yield();
+  }
+
+  start = bench_now();
+  atomic_store(&feeding, true);
+  for (i = 0; i < shard_count; i++) {
+    pthread_create(&feeders[i], NULL, bench_feeder_thread, (void*)(uintptr_t)i);
+    bench_pin(feeders[i], 2 * i);
+  }
+  while (bench_now() - start < duration)
+    usleep(1000);
+  // Shards keep running until the feeders waiting on their queues are done
+  atomic_store(&feeding, false);
+  for (i = 0; i < shard_count; i++)
+    pthread_join(feeders[i], NULL);
+  atomic_store(&running, false);
+  for (i = 0; i < shard_count; i++) {
+    pthread_join(threads[i], (void**)&thread_processed);
+    processed += *thread_processed;
+    free(thread_processed);
+  }
+  elapsed = bench_now() - start;
+
+  printf("%6u %8u %14.0f %14lu\n", shard_count, 2 * shard_count, processed / elapsed,
+         atomic_load(&sent_packets));
+  ret = 0;
+
+out:
+  free(main_memory);
+  free(shards_memory);
+  return ret;
+}
+
+int
+main(int argc, char* argv[])
+{
+  double duration = (argc > 1) ? atoi(argv[1]) / 1000.0 : 1.0;
+  size_t i;
+
+  cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+  if (cpu_count < 1)
+    cpu_count = 1;
+  ndn_lite_startup();
+  bench_encode_packets();
+  printf("%ld cores online\n", cpu_count);
+  printf("%6s %8s %14s %14s\n", "shards", "threads", "packets/s", "packets sent");
+  for (i = 0; i < sizeof(bench_shard_counts) / sizeof(bench_shard_counts[0]); i++) {
+    if (bench_run(bench_shard_counts[i], duration) != 0) {
+      fprintf(stderr, "Failed to set up %u shards\n", bench_shard_counts[i]);
+      return 1;
+    }
+  }
+  if (cpu_count < 2 * BENCH_MAX_SHARDS)
+    printf("Runs with more threads than cores share cores, and do not show scaling.\n");
+  return 0;
+}
@@ -18,6 +18,7 @@
 #include "adaptation/adapt-consts.h"
 #include "adaptation/udp/udp-face.h"
 #include "adaptation/unix-socket/unix-face.h"
+#include "adaptation/event-loop/event-loop.h"
 
 #ifdef __cplusplus
 extern "C" {
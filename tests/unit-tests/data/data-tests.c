@@ -14,6 +14,7 @@
 #include "../test-helpers.h"
 #include "ndn-lite/encode/data.h"
 #include "ndn-lite/encode/key-storage.h"
+#include "ndn-lite/encode/packet-view.h"
 
 static const char *_current_test_name;
 static bool _all_function_calls_succeeded = true;
@@ -303,6 +304,79 @@ void _run_data_test(data_test_t *test) {
   }
 }
 
+void run_data_view_test(void)
+{
+  uint8_t block_value[512];
+  uint8_t name_block[128];
+  uint8_t content[] = {1, 2, 3, 4};
+  uint8_t key_raw[32] = {0x11, 0x22, 0x33, 0x44};
+  char name_string[] = "/view/data/0";
+  char identity_string[] = "/view/producer";
+  ndn_data_t data, check;
+  ndn_name_t identity;
+  ndn_hmac_key_t hmac_key;
+  ndn_encoder_t encoder;
+  ndn_data_view_t view;
+  ndn_signature_view_t signature;
+  data_metainfo_options_t metainfo;
+  uint8_t* ptr;
+  size_t size, data_size;
+
+  ndn_data_init(&data);
+  ndn_name_from_string(&data.name, name_string, strlen(name_string));
+  ndn_name_from_string(&identity, identity_string, strlen(identity_string));
+  ndn_metainfo_set_freshness_period(&data.metainfo, 1000);
+  ndn_data_set_content(&data, content, sizeof(content));
+  ndn_hmac_key_init(&hmac_key, key_raw, sizeof(key_raw), 5678);
+  encoder_init(&encoder, block_value, sizeof(block_value));
+  CU_ASSERT_EQUAL_FATAL(ndn_data_tlv_encode_hmac_sign(&encoder, &data, &identity, &hmac_key), NDN_SUCCESS);
+  data_size = encoder.offset;
+  CU_ASSERT_EQUAL_FATAL(ndn_data_tlv_decode_no_verify(&check, block_value, data_size, NULL, NULL),
+                        NDN_SUCCESS);
+
+  // Only the Name is found at first
+  CU_ASSERT_EQUAL_FATAL(ndn_data_view_init(&view, block_value, data_size), NDN_SUCCESS);
+  CU_ASSERT_FALSE(view.scanned);
+  CU_ASSERT_EQUAL(view.name_size, ndn_name_probe_block_size(&data.name));
+  CU_ASSERT_EQUAL(ndn_name_view_is_prefix_of(view.name, view.name_size, &data.name), 0);
+  CU_ASSERT_EQUAL(ndn_name_view_is_prefix_of(view.name, view.name_size, &identity), 1);
+  CU_ASSERT_EQUAL(ndn_name_view_component(view.name, view.name_size, -1, &ptr, &size), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(size, 3);
+  CU_ASSERT_EQUAL(ptr[2], '0');
+  CU_ASSERT_EQUAL(ndn_name_view_component(view.name, view.name_size, 0, &ptr, &size), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(memcmp(ptr + 2, "view", 4), 0);
+  CU_ASSERT_EQUAL(ndn_name_view_component(view.name, view.name_size, 3, &ptr, &size), NDN_INVALID_ARG);
+  CU_ASSERT_EQUAL(ndn_name_view_component(view.name, view.name_size, -4, &ptr, &size), NDN_INVALID_ARG);
+
+  CU_ASSERT_EQUAL(ndn_data_view_content(&view, &ptr, &size), NDN_SUCCESS);
+  CU_ASSERT_TRUE(view.scanned);
+  CU_ASSERT_EQUAL_FATAL(size, sizeof(content));
+  CU_ASSERT_EQUAL(memcmp(ptr, content, size), 0);
+  CU_ASSERT_TRUE(ptr > block_value && ptr < block_value + data_size);
+  CU_ASSERT_EQUAL(ndn_data_view_metainfo(&view, &metainfo), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(metainfo.freshness_period, 1000);
+  CU_ASSERT_EQUAL(metainfo.content_type, NDN_CONTENT_TYPE_BLOB);
+
+  // The signature verifies over the signed portion in place
+  CU_ASSERT_EQUAL_FATAL(ndn_data_view_signature(&view, &signature), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(signature.sig_type, NDN_SIG_TYPE_HMAC_SHA256);
+  CU_ASSERT_EQUAL_FATAL(signature.sig_size, check.signature.sig_size);
+  CU_ASSERT_EQUAL(memcmp(signature.sig_value, check.signature.sig_value, signature.sig_size), 0);
+  CU_ASSERT_PTR_EQUAL(signature.signed_portion, view.name);
+  CU_ASSERT_EQUAL(ndn_hmac_verify(signature.signed_portion, signature.signed_size,
+                                  signature.sig_value, signature.sig_size, &hmac_key), NDN_SUCCESS);
+  encoder_init(&encoder, name_block, sizeof(name_block));
+  ndn_name_tlv_encode(&encoder, &check.signature.key_locator_name);
+  CU_ASSERT_EQUAL_FATAL(signature.key_locator_name_size, encoder.offset);
+  CU_ASSERT_EQUAL(memcmp(signature.key_locator_name, name_block, encoder.offset), 0);
+
+  // Malformed packets
+  CU_ASSERT_NOT_EQUAL(ndn_data_view_init(&view, block_value, data_size - 1), NDN_SUCCESS);
+  block_value[0] = TLV_Interest;
+  CU_ASSERT_EQUAL(ndn_data_view_init(&view, block_value, data_size), NDN_WRONG_TLV_TYPE);
+  CU_ASSERT_EQUAL(ndn_data_view_init(&view, block_value, 0), NDN_OVERSIZE_VAR);
+}
+
 void add_data_test_suite()
 {
   CU_pSuite pSuite = NULL;
@@ -321,4 +395,9 @@ void add_data_test_suite()
     // return CU_get_error();
     return;
   }
+  if (NULL == CU_add_test(pSuite, "data_view_test", run_data_view_test))
+  {
+    CU_cleanup_registry();
+    return;
+  }
 }
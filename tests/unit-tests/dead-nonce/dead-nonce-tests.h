@@ -0,0 +1,18 @@
+/*
+ * Copyright (C) 2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef DEAD_NONCE_TESTS_H
+#define DEAD_NONCE_TESTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// add Dead Nonce List test suite to CUnit registry
+void add_dead_nonce_test_suite(void);
+
+#endif // DEAD_NONCE_TESTS_H
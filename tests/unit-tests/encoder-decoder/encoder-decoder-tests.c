@@ -14,6 +14,10 @@
 #include "../test-helpers.h"
 #include "ndn-lite/encode/encoder.h"
 #include "ndn-lite/encode/decoder.h"
+#include "ndn-lite/encode/data.h"
+#include "ndn-lite/encode/interest.h"
+#include "ndn-lite/encode/signed-interest.h"
+#include "ndn-lite/security/ndn-lite-sec-config.h"
 
 static const char *_current_test_name;
 static bool _all_function_calls_succeeded = true;
@@ -120,6 +124,105 @@ void _run_encoder_decoder_test(encoder_decoder_test_t *test)
   }
 }
 
+void run_prepend_encoder_test(void)
+{
+  uint8_t forward_block[1536];
+  uint8_t prepend_block[1536];
+  uint8_t content[300];
+  uint8_t params[] = {5, 6, 7};
+  uint8_t key_raw[32] = {0x12, 0x34};
+  char name_string[] = "/prepend/encoder/test";
+  char identity_string[] = "/prepend/producer";
+  ndn_name_t identity;
+  ndn_hmac_key_t hmac_key;
+  ndn_data_t data;
+  ndn_interest_t interest, copy;
+  ndn_encoder_t encoder;
+  ndn_prepend_encoder_t prepender;
+
+  ndn_security_init();
+
+  // Variable-length numbers
+  prepend_encoder_init(&prepender, prepend_block, sizeof(prepend_block));
+  CU_ASSERT_EQUAL(encoder_prepend_var(&prepender, 0x10000), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(encoder_prepend_var(&prepender, 300), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(encoder_prepend_var(&prepender, 7), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(encoder_prepend_uint_value(&prepender, 0x1234), NDN_SUCCESS);
+  encoder_init(&encoder, forward_block, sizeof(forward_block));
+  encoder_append_uint_value(&encoder, 0x1234);
+  encoder_append_var(&encoder, 7);
+  encoder_append_var(&encoder, 300);
+  encoder_append_var(&encoder, 0x10000);
+  CU_ASSERT_EQUAL_FATAL(prepend_encoder_size(&prepender), encoder.offset);
+  CU_ASSERT_EQUAL(memcmp(prepend_encoder_output(&prepender), forward_block, encoder.offset), 0);
+
+  ndn_name_from_string(&identity, identity_string, strlen(identity_string));
+  ndn_hmac_key_init(&hmac_key, key_raw, sizeof(key_raw), 4321);
+  for (size_t i = 0; i < sizeof(content); i++)
+    content[i] = (uint8_t)i;
+
+  // Data, with Content longer than a one-byte length
+  ndn_data_init(&data);
+  ndn_name_from_string(&data.name, name_string, strlen(name_string));
+  ndn_metainfo_set_content_type(&data.metainfo, NDN_CONTENT_TYPE_KEY);
+  ndn_metainfo_set_freshness_period(&data.metainfo, 70000);
+  ndn_metainfo_set_final_block_id(&data.metainfo, &data.name.components[2]);
+  ndn_data_set_content(&data, content, sizeof(content));
+  encoder_init(&encoder, forward_block, sizeof(forward_block));
+  CU_ASSERT_EQUAL_FATAL(ndn_data_tlv_encode_hmac_sign(&encoder, &data, &identity, &hmac_key), NDN_SUCCESS);
+  prepend_encoder_init(&prepender, prepend_block, sizeof(prepend_block));
+  CU_ASSERT_EQUAL_FATAL(ndn_data_tlv_prepend_hmac_sign(&prepender, &data, &identity, &hmac_key),
+                        NDN_SUCCESS);
+  CU_ASSERT_EQUAL_FATAL(prepend_encoder_size(&prepender), encoder.offset);
+  CU_ASSERT_EQUAL(memcmp(prepend_encoder_output(&prepender), forward_block, encoder.offset), 0);
+  prepend_encoder_init(&prepender, prepend_block, sizeof(prepend_block));
+  CU_ASSERT_EQUAL_FATAL(ndn_data_tlv_prepend(&prepender, &data), NDN_SUCCESS);
+  CU_ASSERT_EQUAL_FATAL(prepend_encoder_size(&prepender), encoder.offset);
+  CU_ASSERT_EQUAL(memcmp(prepend_encoder_output(&prepender), forward_block, encoder.offset), 0);
+
+  encoder_init(&encoder, forward_block, sizeof(forward_block));
+  CU_ASSERT_EQUAL_FATAL(ndn_data_tlv_encode_digest_sign(&encoder, &data), NDN_SUCCESS);
+  prepend_encoder_init(&prepender, prepend_block, sizeof(prepend_block));
+  CU_ASSERT_EQUAL_FATAL(ndn_data_tlv_prepend_digest_sign(&prepender, &data), NDN_SUCCESS);
+  CU_ASSERT_EQUAL_FATAL(prepend_encoder_size(&prepender), encoder.offset);
+  CU_ASSERT_EQUAL(memcmp(prepend_encoder_output(&prepender), forward_block, encoder.offset), 0);
+  CU_ASSERT_EQUAL(ndn_data_tlv_decode_digest_verify(&data, prepend_encoder_output(&prepender),
+                                                    prepend_encoder_size(&prepender)), NDN_SUCCESS);
+
+  // Too small a buffer
+  prepend_encoder_init(&prepender, prepend_block, 200);
+  CU_ASSERT_EQUAL(ndn_data_tlv_prepend_digest_sign(&prepender, &data), NDN_OVERSIZE);
+
+  // Interests, unsigned with parameters and signed
+  ndn_interest_init(&interest);
+  ndn_name_from_string(&interest.name, name_string, strlen(name_string));
+  ndn_interest_set_CanBePrefix(&interest, true);
+  ndn_interest_set_MustBeFresh(&interest, true);
+  ndn_interest_set_HopLimit(&interest, 9);
+  ndn_interest_set_Parameters(&interest, params, sizeof(params));
+  interest.nonce = 0x01020304;
+  interest.lifetime = 300;
+  copy = interest;
+  encoder_init(&encoder, forward_block, sizeof(forward_block));
+  CU_ASSERT_EQUAL_FATAL(ndn_interest_tlv_encode(&encoder, &interest), NDN_SUCCESS);
+  prepend_encoder_init(&prepender, prepend_block, sizeof(prepend_block));
+  CU_ASSERT_EQUAL_FATAL(ndn_interest_tlv_prepend(&prepender, &copy), NDN_SUCCESS);
+  CU_ASSERT_EQUAL_FATAL(prepend_encoder_size(&prepender), encoder.offset);
+  CU_ASSERT_EQUAL(memcmp(prepend_encoder_output(&prepender), forward_block, encoder.offset), 0);
+
+  ndn_interest_init(&interest);
+  ndn_name_from_string(&interest.name, name_string, strlen(name_string));
+  ndn_interest_set_Parameters(&interest, params, sizeof(params));
+  CU_ASSERT_EQUAL_FATAL(ndn_signed_interest_hmac_sign(&interest, &identity, &hmac_key), NDN_SUCCESS);
+  interest.nonce = 0x05060708;
+  encoder_init(&encoder, forward_block, sizeof(forward_block));
+  CU_ASSERT_EQUAL_FATAL(ndn_interest_tlv_encode(&encoder, &interest), NDN_SUCCESS);
+  prepend_encoder_init(&prepender, prepend_block, sizeof(prepend_block));
+  CU_ASSERT_EQUAL_FATAL(ndn_interest_tlv_prepend(&prepender, &interest), NDN_SUCCESS);
+  CU_ASSERT_EQUAL_FATAL(prepend_encoder_size(&prepender), encoder.offset);
+  CU_ASSERT_EQUAL(memcmp(prepend_encoder_output(&prepender), forward_block, encoder.offset), 0);
+}
+
 void add_encoder_decoder_test_suite(void){
   CU_pSuite pSuite = NULL;
 
@@ -137,4 +240,9 @@ void add_encoder_decoder_test_suite(void){
     // return CU_get_error();
     return;
   }
+  if (NULL == CU_add_test(pSuite, "prepend_encoder_test", run_prepend_encoder_test))
+  {
+    CU_cleanup_registry();
+    return;
+  }
 }
\ No newline at end of file
@@ -0,0 +1,18 @@
+/*
+ * Copyright (C) 2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef FACE_SET_TESTS_H
+#define FACE_SET_TESTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// add face set test suite to CUnit registry
+void add_face_set_test_suite(void);
+
+#endif // FACE_SET_TESTS_H
@@ -23,7 +23,10 @@
 #include "ndn-lite/face/dummy-face.h"
 
 void run_fib_test_1(void) {
-  uint8_t memory[6264];
+  uint8_t memory[NDN_NAMETREE_RESERVE_SIZE(NDN_NAMETREE_MAX_SIZE) +
+                 NDN_FACE_TABLE_RESERVE_SIZE(NDN_FACE_TABLE_MAX_SIZE) +
+                 NDN_FIB_RESERVE_SIZE(NDN_FIB_MAX_SIZE) +
+                 NDN_FIB_INDEX_SIZE(NDN_NAMETREE_MAX_SIZE)];
   uint8_t *ptr = (uint8_t *)memory;
   ndn_nametree_init(ptr, NDN_NAMETREE_MAX_SIZE);
   ndn_nametree_t * nametree = (ndn_nametree_t *)ptr;
@@ -31,7 +34,7 @@ void run_fib_test_1(void) {
   ndn_facetab_init(ptr, NDN_FACE_TABLE_MAX_SIZE);
   // ndn_face_table_t *facetab = (ndn_face_table_t *)ptr;
   ptr += NDN_FACE_TABLE_RESERVE_SIZE(NDN_FACE_TABLE_MAX_SIZE);
-  ndn_fib_init(ptr, NDN_FIB_MAX_SIZE, nametree);
+  ndn_fib_init(ptr, NDN_FIB_MAX_SIZE, nametree, NULL);
   ndn_fib_t *fib = (ndn_fib_t *)ptr;
 
   // ndn_dummy_face_t *dummy_face;
@@ -62,6 +65,75 @@ void run_fib_test_1(void) {
   CU_ASSERT_PTR_NOT_NULL(ret_entry);
 }
 
+static size_t
+fib_test_encode(const char* uri, uint8_t* buf, size_t size)
+{
+  ndn_name_t name;
+  ndn_encoder_t encoder;
+  ndn_name_from_string(&name, uri, strlen(uri));
+  encoder_init(&encoder, buf, size);
+  ndn_name_tlv_encode(&encoder, &name);
+  return encoder.offset;
+}
+
+static ndn_fib_entry_t*
+fib_test_match(ndn_fib_t* fib, const char* uri)
+{
+  uint8_t buf[256];
+  size_t len = fib_test_encode(uri, buf, sizeof(buf));
+  ndn_fib_entry_t* entry = ndn_fib_prefix_match(fib, buf, len);
+  ndn_name_hash_t hash;
+  // The index must agree with the NameTree walk, with or without the hashes of the name
+  CU_ASSERT_PTR_EQUAL(entry, ndn_fib_node_entry(fib,
+    ndn_nametree_prefix_match(fib->nametree, buf, len, NDN_NAMETREE_FIB_TYPE)));
+  CU_ASSERT_EQUAL_FATAL(ndn_name_hash_compute(&hash, buf, len), NDN_SUCCESS);
+  CU_ASSERT_PTR_EQUAL(entry, ndn_fib_prefix_match_hashed(fib, buf, len, &hash));
+  return entry;
+}
+
+static ndn_fib_entry_t*
+fib_test_insert(ndn_fib_t* fib, const char* uri)
+{
+  uint8_t buf[256];
+  size_t len = fib_test_encode(uri, buf, sizeof(buf));
+  return ndn_fib_find_or_insert(fib, buf, len);
+}
+
+void run_fib_prefix_match_test(void) {
+  static uint64_t memory[(NDN_NAMETREE_RESERVE_SIZE(NDN_NAMETREE_MAX_SIZE) + 7) / 8 +
+                         (NDN_FIB_RESERVE_SIZE(NDN_FIB_MAX_SIZE) +
+                          NDN_FIB_INDEX_SIZE(NDN_NAMETREE_MAX_SIZE) + 7) / 8];
+  ndn_nametree_t *nametree = (ndn_nametree_t *)memory;
+  ndn_fib_t *fib = (ndn_fib_t *)&memory[(NDN_NAMETREE_RESERVE_SIZE(NDN_NAMETREE_MAX_SIZE) + 7) / 8];
+  ndn_fib_entry_t *a, *abc, *de;
+
+  ndn_nametree_init(nametree, NDN_NAMETREE_MAX_SIZE);
+  ndn_fib_init(fib, NDN_FIB_MAX_SIZE, nametree, NULL);
+  CU_ASSERT_PTR_NULL(fib_test_match(fib, "/a/b"));
+
+  a = fib_test_insert(fib, "/a");
+  abc = fib_test_insert(fib, "/a/b/c");
+  de = fib_test_insert(fib, "/d/e");
+  CU_ASSERT_PTR_NOT_NULL(fib_test_insert(fib, "/x/y/z/w"));
+  CU_ASSERT_PTR_EQUAL(fib_test_match(fib, "/a"), a);
+  CU_ASSERT_PTR_EQUAL(fib_test_match(fib, "/a/b"), a);
+  CU_ASSERT_PTR_EQUAL(fib_test_match(fib, "/a/b/c"), abc);
+  CU_ASSERT_PTR_EQUAL(fib_test_match(fib, "/a/b/c/d/e/f"), abc);
+  CU_ASSERT_PTR_EQUAL(fib_test_match(fib, "/a/b/x"), a);
+  CU_ASSERT_PTR_EQUAL(fib_test_match(fib, "/d/e/f"), de);
+  CU_ASSERT_PTR_NULL(fib_test_match(fib, "/d"));
+  CU_ASSERT_PTR_NULL(fib_test_match(fib, "/x/y/z"));
+  CU_ASSERT_PTR_NULL(fib_test_match(fib, "/q"));
+
+  // Removing an entry keeps the markers still used by others
+  ndn_fib_remove_entry_if_empty(fib, a);
+  CU_ASSERT_PTR_NULL(fib_test_match(fib, "/a/b"));
+  CU_ASSERT_PTR_EQUAL(fib_test_match(fib, "/a/b/c/d"), abc);
+  ndn_fib_remove_entry_if_empty(fib, abc);
+  CU_ASSERT_PTR_NULL(fib_test_match(fib, "/a/b/c/d"));
+  CU_ASSERT_PTR_EQUAL(fib_test_match(fib, "/d/e/f"), de);
+}
+
 void add_fib_test_suite()
 {
   CU_pSuite pSuite = NULL;
@@ -74,7 +146,8 @@ void add_fib_test_suite()
     // return CU_get_error();
     return;
   }
-  if (NULL == CU_add_test(pSuite, "fib_test_1", run_fib_test_1)) {
+  if (NULL == CU_add_test(pSuite, "fib_test_1", run_fib_test_1) ||
+      NULL == CU_add_test(pSuite, "fib_prefix_match_test", run_fib_prefix_match_test)) {
     CU_cleanup_registry();
     // return CU_get_error();
     return;
@@ -15,6 +15,7 @@
 #include "../CUnit/CUnit.h"
 
 #include "forwarder-tests-def.h"
+#include "many-faces.h"
 #include "../test-helpers.h"
 #include "../print-helpers.h"
 
@@ -24,6 +25,10 @@
 #include "ndn-lite/forwarder/fib.h"
 #include "ndn-lite/forwarder/forwarder.h"
 #include "ndn-lite/face/dummy-face.h"
+#include "adaptation/udp/udp-face.h"
+#include "adaptation/event-loop/event-loop.h"
+#include <arpa/inet.h>
+#include <unistd.h>
 
 // five seconds
 #define FORWARDER_TEST_WAIT_TIME_U_SEC 5000000
@@ -34,7 +39,7 @@ forwarder_test_t *_current_forwarder_test = NULL;
 static uint8_t _forwarder_test_raw_pub_key_arr[NDN_SEC_ECC_MAX_PUBLIC_KEY_SIZE];
 static uint32_t _forwarder_test_raw_pub_key_arr_len = 0;
 
-const char *_current_test_name;
+static const char *_current_test_name;
 static bool _current_forwarder_test_app_received_interest = false;
 static bool _current_forwarder_test_app_received_data = false;
 static bool _current_forwarder_test_all_calls_succeeded = false;
@@ -164,7 +169,7 @@ void _run_forwarder_test(forwarder_test_t *test)
   _forwarder_test_raw_pub_key_arr_len = test->pub_key_raw_len;
 
   // tests start
-  ndn_forwarder_init();
+  CU_ASSERT_EQUAL(ndn_forwarder_init(), NDN_SUCCESS);
 
   ndn_dummy_face_t *dummy_face;
   dummy_face = ndn_dummy_face_construct();
@@ -399,7 +404,7 @@ void on_data_callback2(const uint8_t *data, uint32_t data_size, void *userdata)
    */
 void forwarder_put_data_test()
 {
-  ndn_forwarder_init();
+  CU_ASSERT_EQUAL(ndn_forwarder_init(), NDN_SUCCESS);
   
   // prepare dummy face
   ndn_dummy_face_t *dummy_face;
@@ -479,7 +484,7 @@ int test_sign_data(const char* id, uint32_t id_len, ndn_encoder_t* encoder, ndn_
 
 void forwarder_pointer_test()
 {
-  ndn_forwarder_init();
+  CU_ASSERT_EQUAL(ndn_forwarder_init(), NDN_SUCCESS);
 
   const ndn_forwarder_t* forwarder;
   forwarder = ndn_forwarder_get();
@@ -631,7 +636,7 @@ void run_forwarder_cs_tests()
   memcpy(_forwarder_test_raw_pub_key_arr, forwarder_tests[0].pub_key_raw_val, forwarder_tests[0].pub_key_raw_len);
   _forwarder_test_raw_pub_key_arr_len = forwarder_tests[0].pub_key_raw_len;
 
-  ndn_forwarder_init();
+  CU_ASSERT_EQUAL(ndn_forwarder_init(), NDN_SUCCESS);
 
   const ndn_forwarder_t* forwarder;
   forwarder = ndn_forwarder_get();
@@ -792,7 +797,9 @@ void run_forwarder_cs_tests()
   create_and_express_interest(dummy_face, "/cs3/sample3", 3000);
   create_and_express_interest(dummy_face, "/test4/content1",3000);
 
-  dll_remove_all_entries();
+  ndn_cs_remove_all_entries(forwarder->cs);
+  CU_ASSERT_EQUAL(forwarder->cs->count, 0);
+  CU_ASSERT_EQUAL(forwarder->cs->used_bytes, 0);
 
   // test remove route /test4
   encoder_init(&tmp_name_encoder, tmp_name_buf, 256);
@@ -812,6 +819,623 @@ void run_forwarder_cs_tests()
   return;
 }
 
+static uint8_t forwarder_init_ex_memory[NDN_FORWARDER_RESERVE_SIZE(600, 4, 4, 256, 4, 1024, 0, 0) + sizeof(uint64_t)];
+
+void forwarder_init_ex_test()
+{
+  ndn_forwarder_config_t config = {
+    .nametree_size = 600,
+    .facetab_size = 4,
+    .fib_size = 4,
+    .pit_size = 256,
+    .cs_size = 4,
+    .cs_bytes = 1024,
+  };
+  int ret_val;
+  char name_string[32];
+
+  CU_ASSERT(ndn_forwarder_reserve_size(&config) <= sizeof(forwarder_init_ex_memory));
+  ret_val = ndn_forwarder_init_ex(&config, forwarder_init_ex_memory, ndn_forwarder_reserve_size(&config) - 1);
+  CU_ASSERT_EQUAL(ret_val, NDN_OVERSIZE);
+  config.pit_size = 0;
+  ret_val = ndn_forwarder_init_ex(&config, forwarder_init_ex_memory, sizeof(forwarder_init_ex_memory));
+  CU_ASSERT_EQUAL(ret_val, NDN_INVALID_ARG);
+  config.pit_size = 256;
+  ret_val = ndn_forwarder_init_ex(&config, forwarder_init_ex_memory, sizeof(forwarder_init_ex_memory));
+  CU_ASSERT_EQUAL(ret_val, NDN_SUCCESS);
+
+  const ndn_forwarder_t* forwarder = ndn_forwarder_get();
+  CU_ASSERT_EQUAL(forwarder->pit->capacity, 256);
+
+  ndn_dummy_face_t *dummy_face = ndn_dummy_face_construct();
+  CU_ASSERT_PTR_NOT_NULL_FATAL(dummy_face);
+  ret_val = ndn_forwarder_add_route_by_str(&dummy_face->intf, "/many", strlen("/many"));
+  CU_ASSERT_EQUAL(ret_val, 0);
+
+  // More outstanding Interests than the default PIT could hold
+  for (int i = 0; i < 4 * NDN_PIT_MAX_SIZE; i++) {
+    ndn_interest_t interest;
+    uint8_t interest_block[256];
+    ndn_encoder_t encoder;
+    ndn_interest_init(&interest);
+    sprintf(name_string, "/many/%d", i);
+    ret_val = ndn_name_from_string(&interest.name, name_string, strlen(name_string));
+    CU_ASSERT_EQUAL(ret_val, 0);
+    encoder_init(&encoder, interest_block, sizeof(interest_block));
+    ret_val = ndn_interest_tlv_encode(&encoder, &interest);
+    CU_ASSERT_EQUAL(ret_val, 0);
+    ret_val = ndn_forwarder_express_interest(interest_block, encoder.offset,
+                                             on_data_callback2, NULL, NULL);
+    CU_ASSERT_EQUAL(ret_val, 0);
+  }
+
+  ndn_forwarder_unregister_face(&dummy_face->intf);
+  free(dummy_face);
+}
+
+static int pit_timeout_count = 0;
+
+static void
+pit_timeout_callback(void *userdata)
+{
+  (void)userdata;
+  pit_timeout_count++;
+}
+
+static ndn_pit_entry_t*
+pit_insert_by_str(ndn_pit_t* pit, const char* string)
+{
+  ndn_name_t name;
+  ndn_encoder_t encoder;
+  uint8_t name_block[64];
+  CU_ASSERT_EQUAL(ndn_name_from_string(&name, string, strlen(string)), 0);
+  encoder_init(&encoder, name_block, sizeof(name_block));
+  CU_ASSERT_EQUAL(ndn_name_tlv_encode(&encoder, &name), 0);
+  return ndn_pit_find_or_insert(pit, name_block, encoder.offset);
+}
+
+static uint64_t pit_test_nametree_memory[NDN_NAMETREE_RESERVE_SIZE(16) / sizeof(uint64_t) + 1];
+static uint64_t pit_test_pit_memory[NDN_PIT_RESERVE_SIZE(8) / sizeof(uint64_t) + 1];
+
+void forwarder_pit_timeout_test()
+{
+  ndn_nametree_t* nametree = (ndn_nametree_t*)pit_test_nametree_memory;
+  ndn_pit_t* pit = (ndn_pit_t*)pit_test_pit_memory;
+  ndn_pit_entry_t *forwarded, *expressed;
+
+  ndn_nametree_init(pit_test_nametree_memory, 16);
+  ndn_pit_init(pit_test_pit_memory, 8, nametree, NULL);
+  CU_ASSERT_EQUAL(ndn_pit_next_deadline(pit), NDN_PIT_NO_DEADLINE);
+
+  forwarded = pit_insert_by_str(pit, "/forwarded");
+  CU_ASSERT_PTR_NOT_NULL_FATAL(forwarded);
+  forwarded->options.lifetime = 100;
+  forwarded->last_time = 1000;
+  ndn_pit_update_deadline(pit, forwarded);
+
+  expressed = pit_insert_by_str(pit, "/expressed");
+  CU_ASSERT_PTR_NOT_NULL_FATAL(expressed);
+  expressed->options.lifetime = 50;
+  expressed->on_data = on_data_callback2;
+  expressed->on_timeout = pit_timeout_callback;
+  expressed->last_time = expressed->express_time = 1000;
+  ndn_pit_update_deadline(pit, expressed);
+  CU_ASSERT_EQUAL(ndn_pit_next_deadline(pit), 1051);
+
+  pit_timeout_count = 0;
+  ndn_pit_process_timeout(pit, 1050);
+  CU_ASSERT_EQUAL(pit_timeout_count, 0);
+  CU_ASSERT_NOT_EQUAL(expressed->nametree_id, NDN_INVALID_ID);
+
+  // Application timeout and forwarding state expire together
+  ndn_pit_process_timeout(pit, 1051);
+  CU_ASSERT_EQUAL(pit_timeout_count, 1);
+  CU_ASSERT_EQUAL(expressed->nametree_id, NDN_INVALID_ID);
+  CU_ASSERT_EQUAL(ndn_pit_next_deadline(pit), 1101);
+
+  // A refreshed entry is postponed
+  forwarded->last_time = 1080;
+  ndn_pit_update_deadline(pit, forwarded);
+  CU_ASSERT_EQUAL(ndn_pit_next_deadline(pit), 1181);
+  ndn_pit_process_timeout(pit, 1101);
+  CU_ASSERT_NOT_EQUAL(forwarded->nametree_id, NDN_INVALID_ID);
+  ndn_pit_process_timeout(pit, 1181);
+  CU_ASSERT_EQUAL(forwarded->nametree_id, NDN_INVALID_ID);
+  CU_ASSERT_EQUAL(ndn_pit_next_deadline(pit), NDN_PIT_NO_DEADLINE);
+  CU_ASSERT_EQUAL(pit_timeout_count, 1);
+  CU_ASSERT_EQUAL(pit->count, 0);
+  // Expired names are released from the NameTree
+  CU_ASSERT_EQUAL(nametree->nodes[0].left_child, NDN_INVALID_ID);
+}
+
+void forwarder_pit_free_list_test()
+{
+  ndn_nametree_t* nametree = (ndn_nametree_t*)pit_test_nametree_memory;
+  ndn_pit_t* pit = (ndn_pit_t*)pit_test_pit_memory;
+  ndn_pit_entry_t *entry, *removed = NULL;
+  char name_string[32];
+  int i;
+
+  ndn_nametree_init(pit_test_nametree_memory, 16);
+  ndn_pit_init(pit_test_pit_memory, 8, nametree, NULL);
+
+  for (i = 0; i < 8; i++) {
+    sprintf(name_string, "/slot/%d", i);
+    entry = pit_insert_by_str(pit, name_string);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(entry);
+    if (i == 5) {
+      removed = entry;
+    }
+  }
+  CU_ASSERT_EQUAL(pit->count, 8);
+  CU_ASSERT_EQUAL(pit->free_head, NDN_INVALID_ID);
+  CU_ASSERT_PTR_NULL(pit_insert_by_str(pit, "/slot/full"));
+
+  // The released slot is reused
+  ndn_pit_remove_entry(pit, removed);
+  ndn_pit_remove_entry(pit, removed);
+  CU_ASSERT_EQUAL(pit->count, 7);
+  CU_ASSERT_PTR_EQUAL(pit_insert_by_str(pit, "/slot/full"), removed);
+  CU_ASSERT_EQUAL(pit->count, 8);
+}
+
+static uint64_t cs_test_nametree_memory[NDN_NAMETREE_RESERVE_SIZE(32) / sizeof(uint64_t) + 1];
+static uint64_t cs_test_cs_memory[NDN_CS_RESERVE_SIZE(8, 1024) / sizeof(uint64_t) + 1];
+
+static ndn_cs_entry_t*
+cs_put_by_str(ndn_cs_t* cs, const char* string, uint32_t content_size, uint64_t freshness_period, int* ret_val)
+{
+  static uint8_t content[NDN_CONTENT_BUFFER_SIZE];
+  uint8_t data_block[NDN_CONTENT_BUFFER_SIZE + 256];
+  uint8_t name_block[64];
+  ndn_encoder_t encoder;
+  ndn_data_t data;
+  ndn_cs_entry_t* entry;
+
+  ndn_data_init(&data);
+  CU_ASSERT_EQUAL(ndn_name_from_string(&data.name, string, strlen(string)), 0);
+  CU_ASSERT_EQUAL(ndn_data_set_content(&data, content, content_size), 0);
+  ndn_metainfo_set_freshness_period(&data.metainfo, freshness_period);
+  encoder_init(&encoder, data_block, sizeof(data_block));
+  CU_ASSERT_EQUAL(ndn_data_tlv_encode_digest_sign(&encoder, &data), 0);
+  size_t data_len = encoder.offset;
+
+  encoder_init(&encoder, name_block, sizeof(name_block));
+  CU_ASSERT_EQUAL(ndn_name_tlv_encode(&encoder, &data.name), 0);
+  entry = ndn_cs_find_or_insert(cs, name_block, encoder.offset);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(entry);
+  *ret_val = ndn_cs_set_content(cs, entry, data_block, data_len);
+  return entry;
+}
+
+static ndn_cs_entry_t*
+cs_find_by_str(ndn_cs_t* cs, const char* string)
+{
+  ndn_name_t name;
+  ndn_encoder_t encoder;
+  uint8_t name_block[64];
+  CU_ASSERT_EQUAL(ndn_name_from_string(&name, string, strlen(string)), 0);
+  encoder_init(&encoder, name_block, sizeof(name_block));
+  CU_ASSERT_EQUAL(ndn_name_tlv_encode(&encoder, &name), 0);
+  return ndn_cs_find(cs, name_block, encoder.offset);
+}
+
+void forwarder_cs_eviction_test()
+{
+  ndn_nametree_t* nametree = (ndn_nametree_t*)cs_test_nametree_memory;
+  ndn_cs_t* cs = (ndn_cs_t*)cs_test_cs_memory;
+  ndn_cs_entry_t* entry;
+  int ret_val;
+
+  ndn_nametree_init(cs_test_nametree_memory, 32);
+  ndn_cs_init(cs_test_cs_memory, 8, 1024, nametree);
+  CU_ASSERT_EQUAL(cs->block_count, 1024 / NDN_CS_BLOCK_SIZE);
+
+  // Each Data takes a 256-byte block, so four of them fill the CS
+  cs_put_by_str(cs, "/lru/a", 150, 100000, &ret_val);
+  CU_ASSERT_EQUAL(ret_val, NDN_SUCCESS);
+  cs_put_by_str(cs, "/lru/b", 150, 100000, &ret_val);
+  CU_ASSERT_EQUAL(ret_val, NDN_SUCCESS);
+  cs_put_by_str(cs, "/lru/c", 150, 0, &ret_val);
+  CU_ASSERT_EQUAL(ret_val, NDN_SUCCESS);
+  cs_put_by_str(cs, "/lru/d", 150, 100000, &ret_val);
+  CU_ASSERT_EQUAL(ret_val, NDN_SUCCESS);
+  CU_ASSERT_EQUAL(cs->used_bytes, 1024);
+  ndn_cs_touch(cs, cs_find_by_str(cs, "/lru/a"));
+
+  // The stale entry goes first, then the least recently used one
+  cs_put_by_str(cs, "/lru/e", 150, 100000, &ret_val);
+  CU_ASSERT_EQUAL(ret_val, NDN_SUCCESS);
+  CU_ASSERT_PTR_NULL(cs_find_by_str(cs, "/lru/c"));
+  CU_ASSERT_PTR_NOT_NULL(cs_find_by_str(cs, "/lru/b"));
+  cs_put_by_str(cs, "/lru/f", 150, 100000, &ret_val);
+  CU_ASSERT_EQUAL(ret_val, NDN_SUCCESS);
+  CU_ASSERT_PTR_NULL(cs_find_by_str(cs, "/lru/b"));
+  CU_ASSERT_PTR_NOT_NULL(cs_find_by_str(cs, "/lru/a"));
+  CU_ASSERT_EQUAL(cs->count, 4);
+
+  // A larger Data evicts as many entries as needed
+  entry = cs_put_by_str(cs, "/lru/big", 600, 100000, &ret_val);
+  CU_ASSERT_EQUAL(ret_val, NDN_SUCCESS);
+  CU_ASSERT_EQUAL(entry->content_len > 512, true);
+  CU_ASSERT_EQUAL(cs->used_bytes, 1024);
+  CU_ASSERT_EQUAL(cs->count, 1);
+
+  // Data larger than the CS is not cached
+  cs_put_by_str(cs, "/lru/huge", 1000, 100000, &ret_val);
+  CU_ASSERT_EQUAL(ret_val, NDN_OVERSIZE);
+  CU_ASSERT_PTR_NULL(cs_find_by_str(cs, "/lru/huge"));
+
+  ndn_cs_remove_all_entries(cs);
+  CU_ASSERT_EQUAL(cs->count, 0);
+  CU_ASSERT_EQUAL(cs->used_bytes, 0);
+  CU_ASSERT_EQUAL(cs->free_blocks[4], 0);
+}
+
+static uint8_t forwarder_many_faces_memory[NDN_FORWARDER_RESERVE_SIZE(64, 300, 4, 8, 4, 1024, 0, 0) + sizeof(uint64_t)];
+
+static int stats_hook_count = 0;
+static ndn_forwarder_stats_t stats_hook_last;
+
+static void
+stats_hook(const ndn_forwarder_stats_t* stats, void* userdata)
+{
+  CU_ASSERT_PTR_EQUAL(userdata, &stats_hook_count);
+  stats_hook_count++;
+  stats_hook_last = *stats;
+}
+
+void forwarder_stats_test()
+{
+  ndn_forwarder_config_t config = {
+    .nametree_size = 64,
+    .facetab_size = 300,
+    .fib_size = 4,
+    .pit_size = 8,
+    .cs_size = 4,
+    .cs_bytes = 1024,
+    .dnl_size = 16,
+  };
+  ndn_forwarder_stats_t stats;
+  ndn_face_stats_t face_stats;
+  uint8_t buf[256];
+  uint8_t garbage[] = {0x99, 0x01, 0x00};
+  size_t len, data_len;
+  int i, ret_val;
+
+  ret_val = ndn_forwarder_init_ex(&config, forwarder_many_faces_memory, sizeof(forwarder_many_faces_memory));
+  CU_ASSERT_EQUAL_FATAL(ret_val, NDN_SUCCESS);
+  many_faces_register(3);
+  CU_ASSERT_EQUAL(ndn_forwarder_add_route_by_str(&many_faces[1], "/wide", strlen("/wide")), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_add_route_by_str(&many_faces[2], "/wide", strlen("/wide")), NDN_SUCCESS);
+
+  // Forwarded Interest, duplicate nonce and missing route
+  len = many_faces_encode_interest("/wide/a", 1, buf, sizeof(buf));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[0], buf, len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[0], buf, len), NDN_FWD_INTEREST_REJECTED);
+  len = many_faces_encode_interest("/none/a", 2, buf, sizeof(buf));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[0], buf, len), NDN_FWD_NO_ROUTE);
+
+  // Satisfying and unsolicited Data
+  data_len = many_faces_encode_data("/wide/a", buf, sizeof(buf));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[1], buf, data_len), NDN_SUCCESS);
+  len = many_faces_encode_data("/other", buf, sizeof(buf));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[1], buf, len), NDN_FWD_NO_ROUTE);
+
+  // CS hit and a malformed packet
+  len = many_faces_encode_interest("/wide/a", 3, buf, sizeof(buf));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[2], buf, len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[2], garbage, sizeof(garbage)), NDN_WRONG_TLV_TYPE);
+
+  CU_ASSERT_EQUAL(ndn_forwarder_get_stats(NULL), NDN_INVALID_POINTER);
+  CU_ASSERT_EQUAL_FATAL(ndn_forwarder_get_stats(&stats), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(stats.counters.in_interests, 4);
+  CU_ASSERT_EQUAL(stats.counters.in_data, 2);
+  CU_ASSERT_EQUAL(stats.counters.out_interests, 2);
+  CU_ASSERT_EQUAL(stats.counters.out_data, 2);
+  CU_ASSERT_EQUAL(stats.counters.cs_hits, 1);
+  CU_ASSERT_EQUAL(stats.counters.cs_misses, 2);
+  CU_ASSERT_EQUAL(stats.counters.drop_dead_nonce, 1);
+  CU_ASSERT_EQUAL(stats.counters.drop_no_route, 1);
+  CU_ASSERT_EQUAL(stats.counters.drop_unsolicited, 1);
+  CU_ASSERT_EQUAL(stats.counters.drop_malformed, 1);
+  CU_ASSERT_EQUAL(stats.counters.drop_pit_full, 0);
+  CU_ASSERT_EQUAL(stats.pit.insertions, 2);
+  CU_ASSERT_EQUAL(stats.pit.removals, 1);
+  CU_ASSERT_EQUAL(stats.pit_count, 1);
+  CU_ASSERT_EQUAL(stats.cs.stores, 2);
+  CU_ASSERT_EQUAL(stats.cs_count, 2);
+  CU_ASSERT(stats.cs_used_bytes > 0 && stats.cs_used_bytes <= stats.cs_arena_bytes);
+  CU_ASSERT_EQUAL(stats.fib.insertions, 1);
+  CU_ASSERT_EQUAL(stats.fib_count, 1);
+  CU_ASSERT_EQUAL(stats.dnl.lookups, 4);
+  CU_ASSERT_EQUAL(stats.dnl.hits, 1);
+  CU_ASSERT_EQUAL(stats.dnl.insertions, 3);
+  CU_ASSERT_EQUAL(stats.dnl_count, 3);
+  CU_ASSERT_EQUAL(stats.dnl_capacity, NDN_FORWARDER_DNL_BUCKETS(16) * NDN_DNL_BUCKET_SIZE);
+  CU_ASSERT(stats.dnl_fp_rate > 0 && stats.dnl_fp_rate < 100);
+  CU_ASSERT_EQUAL(stats.face_count, 3);
+  CU_ASSERT_EQUAL(stats.face_capacity, 300);
+
+  CU_ASSERT_EQUAL_FATAL(ndn_forwarder_get_face_stats(&many_faces[0], &face_stats), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(face_stats.in_packets, 3);
+  CU_ASSERT_EQUAL(face_stats.out_packets, 1);
+  CU_ASSERT_EQUAL(face_stats.out_bytes, data_len);
+  CU_ASSERT_EQUAL_FATAL(ndn_forwarder_get_face_stats(&many_faces[2], &face_stats), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(face_stats.in_packets, 2);
+  CU_ASSERT_EQUAL(face_stats.out_packets, 2);
+  CU_ASSERT_EQUAL(many_faces_sent[2], 2);
+
+  // The hook is run from the message queue once the interval elapses
+  ndn_forwarder_set_stats_hook(stats_hook, 0, &stats_hook_count);
+  CU_ASSERT(ndn_forwarder_next_deadline() <= ndn_time_now_ms());
+  ndn_forwarder_process();
+  CU_ASSERT_EQUAL(stats_hook_count, 1);
+  CU_ASSERT_EQUAL(stats_hook_last.counters.in_interests, 4);
+  ndn_forwarder_set_stats_hook(stats_hook, 60000, &stats_hook_count);
+  ndn_forwarder_process();
+  CU_ASSERT_EQUAL(stats_hook_count, 1);
+  CU_ASSERT(ndn_forwarder_next_deadline() <= ndn_time_now_ms() + 60000);
+  ndn_forwarder_set_stats_hook(NULL, 0, NULL);
+
+  for (i = 0; i < 3; i++) {
+    CU_ASSERT_EQUAL(ndn_forwarder_unregister_face(&many_faces[i]), NDN_SUCCESS);
+  }
+  CU_ASSERT_EQUAL(ndn_forwarder_get_face_stats(&many_faces[0], &face_stats), NDN_FWD_INVALID_FACE);
+}
+
+#ifdef __linux__
+// The port a socket is bound to, in network byte order
+static in_port_t
+udp_bound_port(int sock)
+{
+  struct sockaddr_in addr;
+  socklen_t len = sizeof(addr);
+
+  CU_ASSERT_EQUAL(getsockname(sock, (struct sockaddr*)&addr, &len), 0);
+  return addr.sin_port;
+}
+#endif
+
+static ndn_time_ms_t run_wait_deadline;
+static int run_wait_result;
+
+static int
+run_wait(ndn_time_ms_t deadline, void* userdata)
+{
+  CU_ASSERT_PTR_EQUAL(userdata, &run_wait_deadline);
+  run_wait_deadline = deadline;
+  return run_wait_result;
+}
+
+void forwarder_run_test()
+{
+  ndn_forwarder_config_t config = {
+    .nametree_size = 64,
+    .facetab_size = 4,
+    .fib_size = 4,
+    .pit_size = 8,
+    .cs_size = 4,
+    .cs_bytes = 1024,
+  };
+  ndn_forwarder_stats_t stats;
+  ndn_time_ms_t now;
+  int ret_val;
+
+  ret_val = ndn_forwarder_init_ex(&config, forwarder_many_faces_memory, sizeof(forwarder_many_faces_memory));
+  CU_ASSERT_EQUAL_FATAL(ret_val, NDN_SUCCESS);
+
+  // The wait ends at the timeout or the next deadline, whichever is first
+  ndn_forwarder_set_wait_func(run_wait, &run_wait_deadline);
+  run_wait_result = 2;
+  now = ndn_time_now_ms();
+  CU_ASSERT_EQUAL(ndn_forwarder_run(50), 2);
+  CU_ASSERT(run_wait_deadline >= now + 50 && run_wait_deadline <= ndn_time_now_ms() + 50);
+  ndn_forwarder_set_stats_hook(stats_hook, 10, &stats_hook_count);
+  now = ndn_time_now_ms();
+  CU_ASSERT_EQUAL(ndn_forwarder_run(60000), 2);
+  CU_ASSERT(run_wait_deadline <= now + 10);
+  ndn_forwarder_set_stats_hook(NULL, 0, NULL);
+  run_wait_result = -1;
+  CU_ASSERT_EQUAL(ndn_forwarder_run(0), -1);
+  ndn_forwarder_set_wait_func(NULL, NULL);
+
+#ifdef __linux__
+  {
+    const in_addr_t loopback = htonl(INADDR_LOOPBACK);
+    struct sockaddr_in addr;
+    ndn_udp_face_t* face;
+    uint8_t buf[256];
+    size_t len;
+    int sock;
+
+    // A face brought up after the event loop starts is woken by epoll
+    CU_ASSERT_EQUAL_FATAL(ndn_event_loop_init(), NDN_SUCCESS);
+    // Bound to a free port, as the face never sends
+    face = ndn_udp_unicast_face_construct(loopback, 0, loopback, htons(9));
+    CU_ASSERT_PTR_NOT_NULL_FATAL(face);
+    CU_ASSERT_EQUAL(face->intf.state, NDN_FACE_STATE_UP);
+    CU_ASSERT_PTR_NULL(face->process_event);
+
+    // Nothing to do: sleeps until the timeout
+    now = ndn_time_now_ms();
+    CU_ASSERT_EQUAL(ndn_forwarder_run(20), 0);
+    CU_ASSERT(ndn_time_now_ms() >= now + 19);
+
+    sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    CU_ASSERT_FATAL(sock != -1);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = udp_bound_port(face->sock);
+    addr.sin_addr.s_addr = loopback;
+    len = many_faces_encode_interest("/run/a", 1, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(sendto(sock, buf, len, 0, (struct sockaddr*)&addr, sizeof(addr)), (ssize_t)len);
+    CU_ASSERT_EQUAL(ndn_forwarder_run(5000), 1);
+    CU_ASSERT_EQUAL(ndn_forwarder_get_stats(&stats), NDN_SUCCESS);
+    CU_ASSERT_EQUAL(stats.counters.in_interests, 1);
+    CU_ASSERT_EQUAL(stats.counters.drop_no_route, 1);
+    close(sock);
+
+    face->intf.destroy(&face->intf);
+    ndn_event_loop_close();
+  }
+#endif
+}
+
+#if NDN_FORWARDER_TX_BATCH_SIZE > 0
+
+static uint8_t forwarder_batch_memory[NDN_FORWARDER_RESERVE_SIZE(256, 4, 4, 64, 4, 1024, 0, 0) + sizeof(uint64_t)];
+static uint64_t forwarder_batch_pool_memory[NDN_PKTBUF_POOL_RESERVE_SIZE(8, 256) / sizeof(uint64_t) + 1];
+static int batch_calls = 0;
+static int batch_packets = 0;
+static uint32_t batch_last_size = 0;
+
+static int
+batch_face_send(struct ndn_face_intf* self, const uint8_t* const packets[],
+                const uint32_t sizes[], size_t count)
+{
+  size_t i;
+  (void)self;
+  batch_calls++;
+  batch_packets += count;
+  for (i = 0; i < count; i++) {
+    // Packets keep their order and were copied out of the sender's buffer
+    CU_ASSERT(sizes[i] >= batch_last_size);
+    CU_ASSERT_EQUAL(packets[i][0], TLV_Interest);
+    batch_last_size = sizes[i];
+  }
+  return NDN_SUCCESS;
+}
+
+void forwarder_batch_test()
+{
+  ndn_forwarder_config_t config = {
+    .nametree_size = 256,
+    .facetab_size = 4,
+    .fib_size = 4,
+    .pit_size = 64,
+    .cs_size = 4,
+    .cs_bytes = 1024,
+  };
+  ndn_forwarder_stats_t stats;
+  uint8_t bufs[40][64];
+  uint8_t* packets[40];
+  size_t lengths[40];
+  uint8_t garbage[] = {0x42, 0x01, 0x00};
+  char str[32];
+  int i;
+
+  CU_ASSERT_EQUAL_FATAL(ndn_forwarder_init_ex(&config, forwarder_batch_memory,
+                                              sizeof(forwarder_batch_memory)), NDN_SUCCESS);
+  many_faces_register(2);
+  many_faces[1].send_batch = batch_face_send;
+  CU_ASSERT_EQUAL(ndn_forwarder_add_route_by_str(&many_faces[1], "/batch", strlen("/batch")), NDN_SUCCESS);
+  // Names grow longer so the order can be checked by size
+  for (i = 0; i < 40; i++) {
+    sprintf(str, "/batch/%d", i);
+    lengths[i] = many_faces_encode_interest(str, i + 1, bufs[i], sizeof(bufs[i]));
+    packets[i] = bufs[i];
+  }
+
+  CU_ASSERT_EQUAL(ndn_forwarder_receive_batch(&many_faces[0], NULL, lengths, 1), NDN_INVALID_POINTER);
+
+  // A burst goes out in one call, and a bad packet does not stop it
+  packets[2] = garbage;
+  lengths[2] = sizeof(garbage);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive_batch(&many_faces[0], packets, lengths, 10), 10);
+  CU_ASSERT_EQUAL(batch_calls, 1);
+  CU_ASSERT_EQUAL(batch_packets, 9);
+  CU_ASSERT_EQUAL(many_faces_sent[1], 0);
+  CU_ASSERT_EQUAL(ndn_forwarder_get_stats(&stats), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(stats.counters.in_interests, 9);
+  CU_ASSERT_EQUAL(stats.counters.drop_malformed, 1);
+  CU_ASSERT_EQUAL(stats.counters.out_interests, 9);
+  packets[2] = bufs[2];
+  lengths[2] = many_faces_encode_interest("/batch/2", 3, bufs[2], sizeof(bufs[2]));
+
+  // Single packets wait for a flush, or for the queue to fill up
+  for (i = 10; i < 10 + NDN_FORWARDER_TX_BATCH_SIZE; i++) {
+    if (i >= 40) break;
+    CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[0], packets[i], lengths[i]), NDN_SUCCESS);
+  }
+  CU_ASSERT_EQUAL(batch_packets, 9);
+  ndn_forwarder_flush();
+  CU_ASSERT_EQUAL(batch_calls, 2);
+  CU_ASSERT_EQUAL(batch_packets, 39);
+  ndn_forwarder_flush();
+  CU_ASSERT_EQUAL(batch_calls, 2);
+
+  // Unregistering the face sends what is queued for it first
+  batch_last_size = 0;
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[0], packets[2], lengths[2]), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_unregister_face(&many_faces[1]), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(batch_calls, 3);
+  CU_ASSERT_EQUAL(batch_packets, 40);
+  CU_ASSERT_EQUAL(ndn_forwarder_unregister_face(&many_faces[0]), NDN_SUCCESS);
+  batch_last_size = 0;
+
+#ifdef __linux__
+  {
+    // Face A receives from sock into pool buffers, and face B forwards them to peer
+    ndn_pktbuf_pool_t* pool = (ndn_pktbuf_pool_t*)forwarder_batch_pool_memory;
+    const in_addr_t loopback = htonl(INADDR_LOOPBACK);
+    struct sockaddr_in addr;
+    struct timeval timeout = {.tv_sec = 5, .tv_usec = 0};
+    ndn_udp_face_t *face_a, *face_b;
+    uint8_t buf[256];
+    int sock, peer;
+
+    CU_ASSERT_EQUAL_FATAL(ndn_forwarder_init_ex(&config, forwarder_batch_memory,
+                                                sizeof(forwarder_batch_memory)), NDN_SUCCESS);
+    CU_ASSERT_EQUAL_FATAL(ndn_event_loop_init(), NDN_SUCCESS);
+    ndn_pktbuf_pool_init(pool, 8, 256);
+    ndn_forwarder_set_packet_pool(pool);
+    // All sockets are bound to free ports
+    peer = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    CU_ASSERT_FATAL(peer != -1);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = 0;
+    addr.sin_addr.s_addr = loopback;
+    CU_ASSERT_EQUAL_FATAL(bind(peer, (struct sockaddr*)&addr, sizeof(addr)), 0);
+    setsockopt(peer, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    face_a = ndn_udp_unicast_face_construct(loopback, 0, loopback, htons(9));
+    face_b = ndn_udp_unicast_face_construct(loopback, 0, loopback, udp_bound_port(peer));
+    CU_ASSERT_PTR_NOT_NULL_FATAL(face_a);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(face_b);
+    CU_ASSERT_EQUAL(ndn_forwarder_add_route_by_str(&face_b->intf, "/batch", strlen("/batch")), NDN_SUCCESS);
+
+    sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    CU_ASSERT_FATAL(sock != -1);
+    addr.sin_port = udp_bound_port(face_a->sock);
+    for (i = 20; i < 40; i++) {
+      CU_ASSERT_EQUAL(sendto(sock, packets[i], lengths[i], 0, (struct sockaddr*)&addr, sizeof(addr)),
+                      (ssize_t)lengths[i]);
+    }
+    // All 20 datagrams arrive in bursts of one readiness event, bounded by the pool
+    CU_ASSERT_EQUAL(ndn_forwarder_run(5000), 1);
+    CU_ASSERT_EQUAL(pool->free_count, 8);
+    CU_ASSERT_EQUAL(ndn_forwarder_get_stats(&stats), NDN_SUCCESS);
+    CU_ASSERT_EQUAL(stats.counters.in_interests, 20);
+    CU_ASSERT_EQUAL(stats.counters.out_interests, 20);
+    for (i = 20; i < 40; i++) {
+      CU_ASSERT_EQUAL(recv(peer, buf, sizeof(buf), 0), (ssize_t)lengths[i]);
+      CU_ASSERT_EQUAL(memcmp(buf, packets[i], lengths[i]), 0);
+    }
+    close(sock);
+    close(peer);
+
+    face_a->intf.destroy(&face_a->intf);
+    face_b->intf.destroy(&face_b->intf);
+    ndn_event_loop_close();
+    ndn_forwarder_set_packet_pool(NULL);
+  }
+#endif
+}
+
+#endif // NDN_FORWARDER_TX_BATCH_SIZE > 0
+
 void add_forwarder_test_suite()
 {
   CU_pSuite pSuite = NULL;
@@ -827,7 +1451,17 @@ void add_forwarder_test_suite()
   if (NULL == CU_add_test(pSuite, "forwarder_tests", (void (*)(void))run_forwarder_tests) ||
       NULL == CU_add_test(pSuite, "forwarder_put_data_test", forwarder_put_data_test) ||
       NULL == CU_add_test(pSuite, "forwarder_pointer_test", forwarder_pointer_test) ||
-      NULL == CU_add_test(pSuite, "forwarder_cs_tests", run_forwarder_cs_tests))
+      NULL == CU_add_test(pSuite, "forwarder_cs_tests", run_forwarder_cs_tests) ||
+      NULL == CU_add_test(pSuite, "forwarder_init_ex_test", forwarder_init_ex_test) ||
+      NULL == CU_add_test(pSuite, "forwarder_pit_timeout_test", forwarder_pit_timeout_test) ||
+      NULL == CU_add_test(pSuite, "forwarder_pit_free_list_test", forwarder_pit_free_list_test) ||
+      NULL == CU_add_test(pSuite, "forwarder_cs_eviction_test", forwarder_cs_eviction_test) ||
+      NULL == CU_add_test(pSuite, "forwarder_stats_test", forwarder_stats_test) ||
+      NULL == CU_add_test(pSuite, "forwarder_run_test", forwarder_run_test) ||
+#if NDN_FORWARDER_TX_BATCH_SIZE > 0
+      NULL == CU_add_test(pSuite, "forwarder_batch_test", forwarder_batch_test) ||
+#endif
+      false)
   {
     CU_cleanup_registry();
     // return CU_get_error();
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+#include "many-faces.h"
+
+#include <string.h>
+#include "../CUnit/CUnit.h"
+
+#include "ndn-lite/encode/interest.h"
+#include "ndn-lite/encode/data.h"
+
+int many_faces_sent[MANY_FACES_COUNT];
+ndn_face_intf_t many_faces[MANY_FACES_COUNT];
+
+static int
+many_faces_send(struct ndn_face_intf* self, const uint8_t* packet, uint32_t size)
+{
+  (void)packet;
+  (void)size;
+  many_faces_sent[self - many_faces]++;
+  return NDN_SUCCESS;
+}
+
+int
+many_faces_total_sent(void)
+{
+  int i, ret = 0;
+  for (i = 0; i < MANY_FACES_COUNT; i++) {
+    ret += many_faces_sent[i];
+  }
+  return ret;
+}
+
+void
+many_faces_register(int count)
+{
+  int i;
+  memset(many_faces_sent, 0, sizeof(many_faces_sent));
+  for (i = 0; i < count; i++) {
+    memset(&many_faces[i], 0, sizeof(ndn_face_intf_t));
+    many_faces[i].send = many_faces_send;
+    many_faces[i].state = NDN_FACE_STATE_UP;
+    many_faces[i].face_id = NDN_INVALID_ID;
+    CU_ASSERT_EQUAL(ndn_forwarder_register_face(&many_faces[i]), NDN_SUCCESS);
+  }
+}
+
+size_t
+many_faces_encode_interest(const char* string, uint32_t nonce, uint8_t* buf, size_t bufsize)
+{
+  ndn_interest_t interest;
+  ndn_encoder_t encoder;
+  ndn_interest_init(&interest);
+  interest.nonce = nonce;
+  CU_ASSERT_EQUAL(ndn_name_from_string(&interest.name, string, strlen(string)), 0);
+  encoder_init(&encoder, buf, bufsize);
+  CU_ASSERT_EQUAL(ndn_interest_tlv_encode(&encoder, &interest), 0);
+  return encoder.offset;
+}
+
+size_t
+many_faces_encode_data(const char* string, uint8_t* buf, size_t bufsize)
+{
+  ndn_data_t data;
+  ndn_encoder_t encoder;
+  ndn_data_init(&data);
+  CU_ASSERT_EQUAL(ndn_name_from_string(&data.name, string, strlen(string)), 0);
+  CU_ASSERT_EQUAL(ndn_data_set_content(&data, (uint8_t*)"x", 1), 0);
+  encoder_init(&encoder, buf, bufsize);
+  CU_ASSERT_EQUAL(ndn_data_tlv_encode_digest_sign(&encoder, &data), 0);
+  return encoder.offset;
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/***********************************************************
+ **  Faces that count the packets sent to them,
+ **  shared by the tests of the forwarding pipelines
+ ************************************************************/
+
+#ifndef MANY_FACES_H
+#define MANY_FACES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ndn-lite/forwarder/forwarder.h"
+
+#define MANY_FACES_COUNT 100
+
+// Packets sent to each face
+extern int many_faces_sent[MANY_FACES_COUNT];
+extern ndn_face_intf_t many_faces[MANY_FACES_COUNT];
+
+// Packets sent to all faces
+int many_faces_total_sent(void);
+
+// Register the first count faces, up and counting what they send from 0
+void many_faces_register(int count);
+
+// Encode an Interest or a Data packet of a name into buf. Returns the length.
+size_t many_faces_encode_interest(const char* string, uint32_t nonce, uint8_t* buf, size_t bufsize);
+size_t many_faces_encode_data(const char* string, uint8_t* buf, size_t bufsize);
+
+#endif // MANY_FACES_H
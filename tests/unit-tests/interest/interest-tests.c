@@ -14,6 +14,8 @@
 #include "../print-helpers.h"
 #include "../test-helpers.h"
 #include "ndn-lite/encode/signed-interest.h"
+#include "ndn-lite/encode/packet-view.h"
+#include "ndn-lite/encode/data.h"
 
 static const char *_current_test_name;
 static bool _all_function_calls_succeeded = true;
@@ -376,6 +378,122 @@ void _test_digest_signed_interest(ndn_name_t *name)
   }
 }
 
+void run_interest_view_test(void)
+{
+  uint8_t block_value[512];
+  uint8_t params[] = {9, 8, 7};
+  uint8_t key_raw[32] = {0x55, 0x66, 0x77, 0x88};
+  char name_string[] = "/view/interest";
+  char identity_string[] = "/view/consumer";
+  ndn_interest_t interest, check;
+  ndn_name_t identity;
+  ndn_hmac_key_t hmac_key;
+  ndn_encoder_t encoder;
+  ndn_interest_view_t view;
+  ndn_signature_view_t signature;
+  uint8_t* ptr;
+  size_t size;
+
+  ndn_name_from_string(&identity, identity_string, strlen(identity_string));
+  ndn_interest_init(&interest);
+  ndn_name_from_string(&interest.name, name_string, strlen(name_string));
+  ndn_interest_set_CanBePrefix(&interest, true);
+  ndn_interest_set_HopLimit(&interest, 5);
+  interest.lifetime = 2000;
+
+  // Unsigned
+  encoder_init(&encoder, block_value, sizeof(block_value));
+  CU_ASSERT_EQUAL_FATAL(ndn_interest_tlv_encode(&encoder, &interest), NDN_SUCCESS);
+  CU_ASSERT_EQUAL_FATAL(ndn_interest_view_init(&view, block_value, encoder.offset), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(view.name_size, ndn_name_probe_block_size(&interest.name));
+  CU_ASSERT_EQUAL(ndn_name_view_is_prefix_of(view.name, view.name_size, &interest.name), 0);
+  CU_ASSERT_TRUE(view.options.can_be_prefix);
+  CU_ASSERT_FALSE(view.options.must_be_fresh);
+  CU_ASSERT_EQUAL(view.options.lifetime, 2000);
+  CU_ASSERT_EQUAL(view.options.hop_limit, 5);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(view.hop_limit);
+  CU_ASSERT_EQUAL(*view.hop_limit, 5);
+  CU_ASSERT_PTR_NULL(view.parameters);
+  CU_ASSERT_EQUAL(ndn_interest_view_signature(&view, &signature), NDN_UNSUPPORTED_FORMAT);
+
+  // Signed, with parameters
+  ndn_interest_set_Parameters(&interest, params, sizeof(params));
+  ndn_hmac_key_init(&hmac_key, key_raw, sizeof(key_raw), 1234);
+  CU_ASSERT_EQUAL_FATAL(ndn_signed_interest_hmac_sign(&interest, &identity, &hmac_key), NDN_SUCCESS);
+  encoder_init(&encoder, block_value, sizeof(block_value));
+  CU_ASSERT_EQUAL_FATAL(ndn_interest_tlv_encode(&encoder, &interest), NDN_SUCCESS);
+  CU_ASSERT_EQUAL_FATAL(ndn_interest_from_block(&check, block_value, encoder.offset), NDN_SUCCESS);
+  CU_ASSERT_EQUAL_FATAL(ndn_interest_view_init(&view, block_value, encoder.offset), NDN_SUCCESS);
+  CU_ASSERT_EQUAL_FATAL(view.parameters_size, sizeof(params));
+  CU_ASSERT_EQUAL(memcmp(view.parameters, params, sizeof(params)), 0);
+  CU_ASSERT_EQUAL(ndn_name_view_component(view.name, view.name_size, -1, &ptr, &size), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ptr[0], TLV_ParametersSha256DigestComponent);
+  CU_ASSERT_EQUAL_FATAL(ndn_interest_view_signature(&view, &signature), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(signature.sig_type, NDN_SIG_TYPE_HMAC_SHA256);
+  CU_ASSERT_EQUAL(signature.nonce, check.signature.signature_nonce);
+  CU_ASSERT_EQUAL(signature.timestamp, check.signature.timestamp);
+  CU_ASSERT_PTR_NULL(signature.signed_portion);
+  CU_ASSERT_PTR_NOT_NULL(signature.key_locator_name);
+  CU_ASSERT_EQUAL_FATAL(signature.sig_size, check.signature.sig_size);
+  CU_ASSERT_EQUAL(memcmp(signature.sig_value, check.signature.sig_value, signature.sig_size), 0);
+
+  // Truncated
+  CU_ASSERT_NOT_EQUAL(ndn_interest_view_init(&view, block_value, encoder.offset - 1), NDN_SUCCESS);
+}
+
+void run_packet_index_test(void)
+{
+  uint8_t block_value[512];
+  uint8_t content[] = {1, 2, 3, 4};
+  char name_string[] = "/index/packet/1";
+  ndn_interest_t interest;
+  ndn_data_t data;
+  ndn_encoder_t encoder;
+  ndn_packet_index_t index;
+  ndn_name_hash_t hash;
+  data_metainfo_options_t metainfo;
+
+  // Interest
+  ndn_interest_init(&interest);
+  ndn_name_from_string(&interest.name, name_string, strlen(name_string));
+  ndn_interest_set_MustBeFresh(&interest, true);
+  ndn_interest_set_HopLimit(&interest, 3);
+  encoder_init(&encoder, block_value, sizeof(block_value));
+  CU_ASSERT_EQUAL_FATAL(ndn_interest_tlv_encode(&encoder, &interest), NDN_SUCCESS);
+  CU_ASSERT_EQUAL_FATAL(ndn_packet_index_init(&index, block_value, encoder.offset), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(index.type, TLV_Interest);
+  CU_ASSERT_TRUE(index.interest.options.must_be_fresh);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(index.interest.hop_limit);
+  CU_ASSERT_EQUAL(*index.interest.hop_limit, 3);
+  CU_ASSERT_EQUAL_FATAL(ndn_name_hash_compute(&hash, index.interest.name, index.interest.name_size),
+                        NDN_SUCCESS);
+  CU_ASSERT_EQUAL(index.name_hash.components_size, 3);
+  CU_ASSERT_EQUAL(index.name_hash.full, hash.full);
+
+  // Data, whose elements after the Name are found once and kept
+  ndn_data_init(&data);
+  ndn_name_from_string(&data.name, name_string, strlen(name_string));
+  ndn_metainfo_set_freshness_period(&data.metainfo, 500);
+  ndn_data_set_content(&data, content, sizeof(content));
+  encoder_init(&encoder, block_value, sizeof(block_value));
+  CU_ASSERT_EQUAL_FATAL(ndn_data_tlv_encode_digest_sign(&encoder, &data), NDN_SUCCESS);
+  CU_ASSERT_EQUAL_FATAL(ndn_packet_index_init(&index, block_value, encoder.offset), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(index.type, TLV_Data);
+  CU_ASSERT_EQUAL(index.name_hash.full, hash.full);
+  CU_ASSERT_EQUAL_FATAL(ndn_data_view_metainfo(&index.data, &metainfo), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(metainfo.freshness_period, 500);
+  CU_ASSERT_TRUE(index.data.scanned);
+  CU_ASSERT_EQUAL_FATAL(index.data.content_size, sizeof(content));
+  CU_ASSERT_EQUAL(memcmp(index.data.content, content, sizeof(content)), 0);
+
+  // Malformed
+  CU_ASSERT_NOT_EQUAL(ndn_packet_index_init(&index, block_value, encoder.offset - 1), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(index.type, 0);
+  block_value[0] = TLV_Name;
+  CU_ASSERT_EQUAL(ndn_packet_index_init(&index, block_value, encoder.offset), NDN_WRONG_TLV_TYPE);
+  CU_ASSERT_EQUAL(index.type, 0);
+}
+
 void add_interest_test_suite(void)
 {
   CU_pSuite pSuite = NULL;
@@ -394,4 +512,14 @@ void add_interest_test_suite(void)
     // return CU_get_error();
     return;
   }
+  if (NULL == CU_add_test(pSuite, "interest_view_test", run_interest_view_test))
+  {
+    CU_cleanup_registry();
+    return;
+  }
+  if (NULL == CU_add_test(pSuite, "packet_index_test", run_packet_index_test))
+  {
+    CU_cleanup_registry();
+    return;
+  }
 }
\ No newline at end of file
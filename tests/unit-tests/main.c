@@ -15,6 +15,11 @@
 #include "aes/aes-tests.h"
 #include "data/data-tests.h"
 #include "encoder-decoder/encoder-decoder-tests.h"
+#include "face-set/face-set-tests.h"
+#include "dead-nonce/dead-nonce-tests.h"
+#include "strategy/strategy-tests.h"
+#include "packet-buffer/packet-buffer-tests.h"
+#include "shards/shards-tests.h"
 #include "forwarder/forwarder-tests.h"
 #include "fib/fib-tests.h"
 #include "fragmentation-support/fragmentation-support-tests.h"
@@ -22,6 +27,7 @@
 #include "interest/interest-tests.h"
 #include "hmac/hmac-tests.h"
 #include "metainfo/metainfo-tests.h"
+#include "name-tree/name-tree-tests.h"
 #include "name-encode-decode/name-encode-decode-tests.h"
 #include "random/random-tests.h"
 #include "schematized-trust/trust-schema-tests.h"
@@ -38,6 +44,11 @@ int main() {
     add_aes_test_suite();
     add_data_test_suite();
     add_encoder_decoder_test_suite();
+    add_face_set_test_suite();
+    add_dead_nonce_test_suite();
+    add_strategy_test_suite();
+    add_packet_buffer_test_suite();
+    add_shards_test_suite();
     add_fib_test_suite();
     add_forwarder_test_suite();
     add_fragmentation_support_test_suite();
@@ -45,6 +56,7 @@ int main() {
     add_interest_test_suite();
     add_hmac_test_suite();
     add_metainfo_test_suite();
+    add_name_tree_test_suite();
     add_name_encode_decode_test_suite();
     add_random_test_suite();
     add_sign_verify_test_suite();
@@ -14,6 +14,8 @@
 #include "../test-helpers.h"
 #include "ndn-lite/encode/metainfo.h"
 #include "ndn-lite/encode/name.h"
+#include "ndn-lite/encode/data.h"
+#include "ndn-lite/encode/forwarder-helper.h"
 
 static const char *_current_test_name;
 static bool _all_function_calls_succeeded = true;
@@ -102,6 +104,54 @@ void _run_metainfo_test(metainfo_test_t *test) {
   }
 }
 
+void run_metainfo_scan_test(void)
+{
+  uint8_t block_value[256];
+  uint8_t content[] = {1, 2, 3};
+  char name_string[] = "/scan/data/0";
+  char comp_string[] = "9";
+  name_component_t component;
+  data_metainfo_options_t options;
+  ndn_encoder_t encoder;
+  ndn_data_t data;
+  int ret_val;
+
+  ndn_data_init(&data);
+  ret_val = ndn_name_from_string(&data.name, name_string, strlen(name_string));
+  CU_ASSERT_EQUAL(ret_val, 0);
+  ndn_data_set_content(&data, content, sizeof(content));
+  encoder_init(&encoder, block_value, sizeof(block_value));
+  ret_val = ndn_data_tlv_encode_digest_sign(&encoder, &data);
+  CU_ASSERT_EQUAL(ret_val, 0);
+
+  // No MetaInfo
+  ret_val = tlv_data_get_metainfo(block_value, encoder.offset, &options);
+  CU_ASSERT_EQUAL(ret_val, NDN_SUCCESS);
+  CU_ASSERT_EQUAL(options.content_type, NDN_CONTENT_TYPE_BLOB);
+  CU_ASSERT_EQUAL(options.freshness_period, 0);
+  CU_ASSERT_PTR_NULL(options.final_block_id);
+
+  name_component_from_string(&component, comp_string, strlen(comp_string));
+  ndn_metainfo_set_content_type(&data.metainfo, NDN_CONTENT_TYPE_KEY);
+  ndn_metainfo_set_freshness_period(&data.metainfo, 3600000);
+  ndn_metainfo_set_final_block_id(&data.metainfo, &component);
+  encoder_init(&encoder, block_value, sizeof(block_value));
+  ret_val = ndn_data_tlv_encode_digest_sign(&encoder, &data);
+  CU_ASSERT_EQUAL(ret_val, 0);
+
+  ret_val = tlv_data_get_metainfo(block_value, encoder.offset, &options);
+  CU_ASSERT_EQUAL(ret_val, NDN_SUCCESS);
+  CU_ASSERT_EQUAL(options.content_type, NDN_CONTENT_TYPE_KEY);
+  CU_ASSERT_EQUAL(options.freshness_period, 3600000);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(options.final_block_id);
+  CU_ASSERT_EQUAL(options.final_block_id_len, name_component_probe_block_size(&component));
+  CU_ASSERT_EQUAL(options.final_block_id[options.final_block_id_len - 1], '9');
+
+  // Truncated packet
+  ret_val = tlv_data_get_metainfo(block_value, encoder.offset - 1, &options);
+  CU_ASSERT_NOT_EQUAL(ret_val, NDN_SUCCESS);
+}
+
 void add_metainfo_test_suite(void)
 {
   CU_pSuite pSuite = NULL;
@@ -114,7 +164,8 @@ void add_metainfo_test_suite(void)
     // return CU_get_error();
     return;
   }
-  if (NULL == CU_add_test(pSuite, "metainfo_tests", (void (*)(void))run_metainfo_tests))
+  if (NULL == CU_add_test(pSuite, "metainfo_tests", (void (*)(void))run_metainfo_tests) ||
+      NULL == CU_add_test(pSuite, "metainfo_scan_test", run_metainfo_scan_test))
   {
     CU_cleanup_registry();
     // return CU_get_error();
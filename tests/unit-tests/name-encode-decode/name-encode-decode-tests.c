@@ -14,6 +14,8 @@
 #include "../print-helpers.h"
 #include "../test-helpers.h"
 #include "ndn-lite/encode/name.h"
+#include "ndn-lite/encode/compact-name.h"
+#include "ndn-lite/ndn-error-code.h"
 
 static const char *_current_test_name;
 static bool _all_function_calls_succeeded = true;
@@ -169,6 +171,83 @@ void _run_name_encode_decode_test(name_encode_decode_test_t *test) {
   }
 }
 
+void run_compact_name_test(void)
+{
+  uint8_t block[512], other_block[128];
+  uint32_t offsets[NDN_COMPACT_NAME_OFFSETS_SIZE(16)];
+  uint32_t other_offsets[NDN_COMPACT_NAME_OFFSETS_SIZE(NDN_NAME_COMPONENTS_SIZE)];
+  uint8_t long_value[100];
+  char prefix_string[] = "/compact/name";
+  ndn_compact_name_t name, other;
+  ndn_name_t prefix, check;
+  ndn_encoder_t encoder;
+  uint8_t* ptr;
+  size_t size, value_size = 0;
+
+  // 12 components, one of them 100 bytes: too large for ndn_name_t
+  memset(long_value, 0xAB, sizeof(long_value));
+  encoder_init(&encoder, block, sizeof(block));
+  for (int i = 0; i < 11; i++)
+    value_size += encoder_probe_block_size(TLV_GenericNameComponent, 1);
+  value_size += encoder_probe_block_size(TLV_GenericNameComponent, sizeof(long_value));
+  encoder_append_type(&encoder, TLV_Name);
+  encoder_append_length(&encoder, value_size);
+  for (uint8_t i = 0; i < 11; i++) {
+    encoder_append_type(&encoder, TLV_GenericNameComponent);
+    encoder_append_length(&encoder, 1);
+    encoder_append_byte_value(&encoder, 'a' + i);
+  }
+  encoder_append_type(&encoder, TLV_GenericNameComponent);
+  encoder_append_length(&encoder, sizeof(long_value));
+  encoder_append_raw_buffer_value(&encoder, long_value, sizeof(long_value));
+
+  CU_ASSERT_EQUAL_FATAL(ndn_compact_name_from_block(&name, block, encoder.offset, offsets, 16),
+                        NDN_SUCCESS);
+  CU_ASSERT_EQUAL(name.components_size, 12);
+  ptr = ndn_compact_name_component(&name, 4, &size);
+  CU_ASSERT_EQUAL(size, 3);
+  CU_ASSERT_EQUAL(ptr[2], 'e');
+  ptr = ndn_compact_name_component(&name, 11, &size);
+  CU_ASSERT_EQUAL(size, 2 + sizeof(long_value));
+  CU_ASSERT_EQUAL(memcmp(ptr + 2, long_value, sizeof(long_value)), 0);
+  CU_ASSERT_PTR_EQUAL(ptr + size, block + encoder.offset);
+  CU_ASSERT_EQUAL(ndn_compact_name_to_name(&name, &check), NDN_OVERSIZE);
+  CU_ASSERT_EQUAL(ndn_compact_name_from_block(&name, block, encoder.offset, offsets, 11),
+                  NDN_OVERSIZE);
+  CU_ASSERT_EQUAL(ndn_compact_name_from_block(&name, block, encoder.offset - 1, offsets, 16),
+                  NDN_WRONG_TLV_LENGTH);
+
+  // Prefix and compare against a name of the first 11 components
+  CU_ASSERT_EQUAL_FATAL(ndn_compact_name_from_block(&name, block, encoder.offset, offsets, 16),
+                        NDN_SUCCESS);
+  ndn_name_init(&check);
+  for (uint8_t i = 0; i < NDN_NAME_COMPONENTS_SIZE; i++) {
+    uint8_t c = 'a' + i;
+    ndn_name_append_bytes_component(&check, &c, 1);
+  }
+  CU_ASSERT_EQUAL_FATAL(ndn_compact_name_from_name(&other, &check, other_block, sizeof(other_block),
+                                                   other_offsets), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(other.components_size, NDN_NAME_COMPONENTS_SIZE);
+  CU_ASSERT_EQUAL(ndn_compact_name_is_prefix_of(&other, &name), 0);
+  CU_ASSERT_EQUAL(ndn_compact_name_is_prefix_of(&name, &other), 1);
+  CU_ASSERT_EQUAL(ndn_compact_name_is_prefix_of(&other, &other), 0);
+  CU_ASSERT_EQUAL(ndn_compact_name_compare(&other, &name), -2);
+  CU_ASSERT_EQUAL(ndn_compact_name_compare(&name, &other), 2);
+  CU_ASSERT_EQUAL(ndn_compact_name_compare(&other, &other), 0);
+
+  // Round trip through ndn_name_t
+  ndn_name_from_string(&prefix, prefix_string, strlen(prefix_string));
+  CU_ASSERT_EQUAL_FATAL(ndn_compact_name_from_name(&other, &prefix, other_block, sizeof(other_block),
+                                                   other_offsets), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(other.block_size, ndn_name_probe_block_size(&prefix));
+  CU_ASSERT_EQUAL(ndn_compact_name_to_name(&other, &check), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_name_compare(&check, &prefix), 0);
+  CU_ASSERT_EQUAL(ndn_compact_name_is_prefix_of(&other, &name), 1);
+  CU_ASSERT_EQUAL(ndn_compact_name_compare(&other, &name), 1);
+  CU_ASSERT_EQUAL(ndn_compact_name_from_name(&other, &prefix, other_block, 4, other_offsets),
+                  NDN_OVERSIZE);
+}
+
 void add_name_encode_decode_test_suite(void)
 {
   CU_pSuite pSuite = NULL;
@@ -187,4 +266,9 @@ void add_name_encode_decode_test_suite(void)
     // return CU_get_error();
     return;
   }
+  if (NULL == CU_add_test(pSuite, "compact_name_test", run_compact_name_test))
+  {
+    CU_cleanup_registry();
+    return;
+  }
 }
\ No newline at end of file
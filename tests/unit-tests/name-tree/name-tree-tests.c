@@ -0,0 +1,300 @@
+/*
+ * Copyright (C) 2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+#include "name-tree-tests.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "../CUnit/CUnit.h"
+
+#include "ndn-lite/ndn-constants.h"
+#include "ndn-lite/encode/name.h"
+#include "ndn-lite/forwarder/name-tree.h"
+#include "ndn-lite/encode/name-hash.h"
+#include "ndn-lite/ndn-error-code.h"
+
+#define NAME_TREE_TEST_SIZE 300
+#define NAME_TREE_TEST_CHILDREN 256
+
+static uint8_t nametree_memory[NDN_NAMETREE_RESERVE_SIZE(NAME_TREE_TEST_SIZE)];
+
+static size_t
+encode_name(const char* str, uint8_t* buf, size_t bufsize)
+{
+  ndn_name_t name;
+  ndn_encoder_t encoder;
+  int ret_val = ndn_name_from_string(&name, str, strlen(str));
+  CU_ASSERT_EQUAL(ret_val, 0);
+  encoder_init(&encoder, buf, bufsize);
+  ret_val = ndn_name_tlv_encode(&encoder, &name);
+  CU_ASSERT_EQUAL(ret_val, 0);
+  return encoder.offset;
+}
+
+void run_name_tree_many_children_test(void)
+{
+  ndn_nametree_t *nametree = (ndn_nametree_t*)nametree_memory;
+  nametree_entry_t *entry, *parent;
+  uint8_t buf[128];
+  char str[64];
+  size_t len;
+  int i;
+
+  ndn_nametree_init(nametree_memory, NAME_TREE_TEST_SIZE);
+
+  len = encode_name("/home/sensor", buf, sizeof(buf));
+  parent = ndn_nametree_find_or_insert(nametree, buf, len);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(parent);
+  parent->fib_id = 0;
+
+  for (i = 0; i < NAME_TREE_TEST_CHILDREN; i++) {
+    sprintf(str, "/home/sensor/%d", i);
+    len = encode_name(str, buf, sizeof(buf));
+    entry = ndn_nametree_find_or_insert(nametree, buf, len);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(entry);
+    entry->pit_id = i;
+  }
+
+  for (i = 0; i < NAME_TREE_TEST_CHILDREN; i++) {
+    sprintf(str, "/home/sensor/%d", i);
+    len = encode_name(str, buf, sizeof(buf));
+    entry = ndn_nametree_find(nametree, buf, len);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(entry);
+    CU_ASSERT_EQUAL(entry->pit_id, i);
+    CU_ASSERT_PTR_EQUAL(ndn_nametree_find_or_insert(nametree, buf, len), entry);
+  }
+
+  len = encode_name("/home/sensor/1000", buf, sizeof(buf));
+  CU_ASSERT_PTR_NULL(ndn_nametree_find(nametree, buf, len));
+
+  // Longest prefix match stops at the deepest node holding a FIB entry
+  len = encode_name("/home/sensor/17/temperature", buf, sizeof(buf));
+  CU_ASSERT_PTR_EQUAL(ndn_nametree_prefix_match(nametree, buf, len, NDN_NAMETREE_FIB_TYPE), parent);
+  entry = ndn_nametree_prefix_match(nametree, buf, len, NDN_NAMETREE_PIT_TYPE);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(entry);
+  CU_ASSERT_EQUAL(entry->pit_id, 17);
+  CU_ASSERT_PTR_NULL(ndn_nametree_prefix_match(nametree, buf, len, NDN_NAMETREE_CS_TYPE));
+}
+
+void run_name_tree_cleanup_test(void)
+{
+  ndn_nametree_t *nametree = (ndn_nametree_t*)nametree_memory;
+  nametree_entry_t *entry;
+  uint8_t buf[128];
+  char str[64];
+  size_t len;
+  int i;
+
+  ndn_nametree_init(nametree_memory, NAME_TREE_TEST_SIZE);
+
+  len = encode_name("/keep/me", buf, sizeof(buf));
+  entry = ndn_nametree_find_or_insert(nametree, buf, len);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(entry);
+  entry->cs_id = 1;
+
+  // Nodes are reclaimed as soon as their last entry goes away
+  for (i = 0; i < 3 * NAME_TREE_TEST_SIZE; i++) {
+    sprintf(str, "/tmp/%d/data", i);
+    len = encode_name(str, buf, sizeof(buf));
+    entry = ndn_nametree_find_or_insert(nametree, buf, len);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(entry);
+    entry->pit_id = 0;
+    entry->pit_id = NDN_INVALID_ID;
+    ndn_nametree_release(nametree, entry);
+    CU_ASSERT_PTR_NULL(ndn_nametree_find(nametree, buf, len));
+  }
+  len = encode_name("/tmp", buf, sizeof(buf));
+  CU_ASSERT_PTR_NULL(ndn_nametree_find(nametree, buf, len));
+
+  len = encode_name("/keep/me", buf, sizeof(buf));
+  entry = ndn_nametree_find(nametree, buf, len);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(entry);
+  CU_ASSERT_EQUAL(entry->cs_id, 1);
+
+  // A failed insertion does not leave a partial path behind
+  for (i = 0; i < NAME_TREE_TEST_SIZE; i++) {
+    sprintf(str, "/fill/%d", i);
+    len = encode_name(str, buf, sizeof(buf));
+    entry = ndn_nametree_find_or_insert(nametree, buf, len);
+    if (entry == NULL) break;
+    entry->fib_id = 0;
+  }
+  CU_ASSERT_PTR_NULL(entry);
+  len = encode_name("/fill/0", buf, sizeof(buf));
+  entry = ndn_nametree_find(nametree, buf, len);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(entry);
+  entry->fib_id = NDN_INVALID_ID;
+  ndn_nametree_release(nametree, entry);
+
+  len = encode_name("/new/a/b", buf, sizeof(buf));
+  CU_ASSERT_PTR_NULL(ndn_nametree_find_or_insert(nametree, buf, len));
+  len = encode_name("/new", buf, sizeof(buf));
+  CU_ASSERT_PTR_NULL(ndn_nametree_find(nametree, buf, len));
+  len = encode_name("/fill/0", buf, sizeof(buf));
+  CU_ASSERT_PTR_NOT_NULL(ndn_nametree_find_or_insert(nametree, buf, len));
+}
+
+void run_name_tree_pin_test(void)
+{
+  ndn_nametree_t *nametree = (ndn_nametree_t*)nametree_memory;
+  nametree_entry_t *entry;
+  ndn_nametree_match_t match;
+  uint8_t buf[128];
+  size_t len;
+
+  ndn_nametree_init(nametree_memory, NAME_TREE_TEST_SIZE);
+
+  len = encode_name("/a/b/c", buf, sizeof(buf));
+  ndn_nametree_lookup(nametree, buf, len, NULL, true, &match);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(match.exact);
+
+  // Removing an entry on the matched path keeps the pinned node alive
+  match.exact->cs_id = 0;
+  match.exact->cs_id = NDN_INVALID_ID;
+  ndn_nametree_release(nametree, match.exact);
+  CU_ASSERT_PTR_EQUAL(ndn_nametree_find(nametree, buf, len), match.exact);
+
+  // The last unpin releases the whole unused path
+  ndn_nametree_unpin(nametree, match.exact);
+  CU_ASSERT_PTR_NULL(ndn_nametree_find(nametree, buf, len));
+  len = encode_name("/a", buf, sizeof(buf));
+  CU_ASSERT_PTR_NULL(ndn_nametree_find(nametree, buf, len));
+
+  // An entry keeps the node after unpinning
+  len = encode_name("/a/b/c", buf, sizeof(buf));
+  ndn_nametree_lookup(nametree, buf, len, NULL, true, &match);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(match.exact);
+  match.exact->pit_id = 0;
+  entry = match.exact;
+  ndn_nametree_unpin(nametree, match.exact);
+  CU_ASSERT_PTR_EQUAL(ndn_nametree_find(nametree, buf, len), entry);
+}
+
+void run_name_tree_lookup_test(void)
+{
+  ndn_nametree_t *nametree = (ndn_nametree_t*)nametree_memory;
+  nametree_entry_t *fib_node, *pit_node;
+  ndn_nametree_match_t match;
+  uint8_t buf[128];
+  size_t len;
+
+  ndn_nametree_init(nametree_memory, NAME_TREE_TEST_SIZE);
+
+  len = encode_name("/home", buf, sizeof(buf));
+  fib_node = ndn_nametree_find_or_insert(nametree, buf, len);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(fib_node);
+  fib_node->fib_id = 0;
+  len = encode_name("/home/sensor", buf, sizeof(buf));
+  pit_node = ndn_nametree_find_or_insert(nametree, buf, len);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(pit_node);
+  pit_node->pit_id = 0;
+
+  // Without insertion a missing name has no exact node
+  len = encode_name("/home/sensor/temp", buf, sizeof(buf));
+  ndn_nametree_lookup(nametree, buf, len, NULL, false, &match);
+  CU_ASSERT_PTR_NULL(match.exact);
+  CU_ASSERT_PTR_EQUAL(match.longest[NDN_NAMETREE_FIB_TYPE], fib_node);
+  CU_ASSERT_PTR_EQUAL(match.longest[NDN_NAMETREE_PIT_TYPE], pit_node);
+  CU_ASSERT_PTR_NULL(match.longest[NDN_NAMETREE_CS_TYPE]);
+
+  // With insertion the result agrees with the single-table functions
+  ndn_nametree_lookup(nametree, buf, len, NULL, true, &match);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(match.exact);
+  CU_ASSERT_PTR_EQUAL(match.exact, ndn_nametree_find(nametree, buf, len));
+  CU_ASSERT_PTR_EQUAL(match.longest[NDN_NAMETREE_FIB_TYPE],
+                      ndn_nametree_prefix_match(nametree, buf, len, NDN_NAMETREE_FIB_TYPE));
+  CU_ASSERT_PTR_EQUAL(match.longest[NDN_NAMETREE_PIT_TYPE], pit_node);
+  ndn_nametree_unpin(nametree, match.exact);
+  CU_ASSERT_PTR_NULL(ndn_nametree_find(nametree, buf, len));
+
+  len = encode_name("/home/sensor", buf, sizeof(buf));
+  ndn_nametree_lookup(nametree, buf, len, NULL, false, &match);
+  CU_ASSERT_PTR_EQUAL(match.exact, pit_node);
+  CU_ASSERT_PTR_EQUAL(match.longest[NDN_NAMETREE_PIT_TYPE], match.exact);
+  ndn_nametree_unpin(nametree, match.exact);
+}
+
+void run_name_tree_hash_test(void)
+{
+  ndn_nametree_t *nametree = (ndn_nametree_t*)nametree_memory;
+  ndn_nametree_match_t match;
+  ndn_name_hash_t hash, prefix_hash;
+  uint8_t buf[128], long_value[40];
+  ndn_encoder_t encoder;
+  size_t len;
+
+  ndn_nametree_init(nametree_memory, NAME_TREE_TEST_SIZE);
+
+  // /a/<40 bytes>/b: the NameTree keeps the second component truncated
+  memset(long_value, 0x5A, sizeof(long_value));
+  encoder_init(&encoder, buf, sizeof(buf));
+  encoder_append_type(&encoder, TLV_Name);
+  encoder_append_length(&encoder, 3 + 2 + sizeof(long_value) + 3);
+  encoder_append_type(&encoder, TLV_GenericNameComponent);
+  encoder_append_length(&encoder, 1);
+  encoder_append_byte_value(&encoder, 'a');
+  encoder_append_type(&encoder, TLV_GenericNameComponent);
+  encoder_append_length(&encoder, sizeof(long_value));
+  encoder_append_raw_buffer_value(&encoder, long_value, sizeof(long_value));
+  encoder_append_type(&encoder, TLV_GenericNameComponent);
+  encoder_append_length(&encoder, 1);
+  encoder_append_byte_value(&encoder, 'b');
+  len = encoder.offset;
+
+  CU_ASSERT_EQUAL_FATAL(ndn_name_hash_compute(&hash, buf, len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(hash.components_size, 3);
+  CU_ASSERT_EQUAL(hash.depth, 3);
+  CU_ASSERT_EQUAL(hash.short_depth, 1);
+  CU_ASSERT_EQUAL(hash.hashes[0], ndn_name_hash_seed());
+  CU_ASSERT_EQUAL(hash.hashes[1], ndn_name_hash_extend(ndn_name_hash_seed(), buf + 2, 3));
+  CU_ASSERT_EQUAL(hash.full, hash.hashes[3]);
+  CU_ASSERT_EQUAL(ndn_name_hash_compute(&prefix_hash, buf, len - 1), NDN_OVERSIZE_VAR);
+
+  // The same nodes are found with and without the hashes of the packet
+  ndn_nametree_lookup(nametree, buf, len, &hash, true, &match);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(match.exact);
+  CU_ASSERT_PTR_EQUAL(ndn_nametree_find(nametree, buf, len), match.exact);
+  ndn_nametree_unpin(nametree, match.exact);
+  CU_ASSERT_PTR_NULL(ndn_nametree_find(nametree, buf, len));
+
+  len = encode_name("/home/sensor/temp", buf, sizeof(buf));
+  CU_ASSERT_PTR_NOT_NULL_FATAL(ndn_nametree_find_or_insert(nametree, buf, len));
+  CU_ASSERT_EQUAL_FATAL(ndn_name_hash_compute(&hash, buf, len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(hash.short_depth, 3);
+  ndn_nametree_lookup(nametree, buf, len, &hash, false, &match);
+  CU_ASSERT_PTR_EQUAL(match.exact, ndn_nametree_find(nametree, buf, len));
+  ndn_nametree_unpin(nametree, match.exact);
+
+  // A prefix has the hashes of the longer name
+  len = encode_name("/home/sensor", buf, sizeof(buf));
+  CU_ASSERT_EQUAL_FATAL(ndn_name_hash_compute(&prefix_hash, buf, len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(prefix_hash.full, hash.hashes[2]);
+  CU_ASSERT_NOT_EQUAL(prefix_hash.full, hash.full);
+}
+
+void add_name_tree_test_suite()
+{
+  CU_pSuite pSuite = NULL;
+
+  /* add a suite to the registry */
+  pSuite = CU_add_suite("Name Tree Test", NULL, NULL);
+  if (NULL == pSuite)
+  {
+    CU_cleanup_registry();
+    // return CU_get_error();
+    return;
+  }
+  if (NULL == CU_add_test(pSuite, "name_tree_many_children_test", run_name_tree_many_children_test) ||
+      NULL == CU_add_test(pSuite, "name_tree_cleanup_test", run_name_tree_cleanup_test) ||
+      NULL == CU_add_test(pSuite, "name_tree_lookup_test", run_name_tree_lookup_test) ||
+      NULL == CU_add_test(pSuite, "name_tree_pin_test", run_name_tree_pin_test) ||
+      NULL == CU_add_test(pSuite, "name_tree_hash_test", run_name_tree_hash_test)) {
+    CU_cleanup_registry();
+    // return CU_get_error();
+    return;
+  }
+}
@@ -0,0 +1,18 @@
+/*
+ * Copyright (C) 2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef NAME_TREE_TESTS_H
+#define NAME_TREE_TESTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// add name tree test suite to CUnit registry
+void add_name_tree_test_suite(void);
+
+#endif // NAME_TREE_TESTS_H
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+#include "packet-buffer-tests.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "../CUnit/CUnit.h"
+#include "../forwarder/many-faces.h"
+
+#include "ndn-lite/ndn-constants.h"
+#include "ndn-lite/ndn-error-code.h"
+#include "ndn-lite/forwarder/packet-buffer.h"
+#include "ndn-lite/forwarder/forwarder.h"
+
+static uint8_t pktbuf_forwarder_memory[NDN_FORWARDER_RESERVE_SIZE(64, 300, 4, 8, 4, 1024, 0, 0) + sizeof(uint64_t)];
+
+#define PKTBUF_TEST_COUNT 4
+
+static uint64_t forwarder_pktbuf_pool_memory[NDN_PKTBUF_POOL_RESERVE_SIZE(PKTBUF_TEST_COUNT, 256) / sizeof(uint64_t) + 1];
+static ndn_pktbuf_t* pktbuf_sent[4];
+static int pktbuf_sent_count = 0;
+
+static int
+pktbuf_face_send_buf(struct ndn_face_intf* self, ndn_pktbuf_t* buf)
+{
+  (void)self;
+  // Hold the reference until the test drops it
+  pktbuf_sent[pktbuf_sent_count++] = buf;
+  return NDN_SUCCESS;
+}
+
+static void
+pktbuf_release_sent(void)
+{
+  int i;
+  for (i = 0; i < pktbuf_sent_count; i++) {
+    ndn_pktbuf_release(pktbuf_sent[i]);
+  }
+  pktbuf_sent_count = 0;
+}
+
+#if NDN_FORWARDER_TX_BATCH_SIZE > 0
+static const uint8_t* pktbuf_batch_packet = NULL;
+
+static int
+pktbuf_face_send_batch(struct ndn_face_intf* self, const uint8_t* const packets[],
+                       const uint32_t sizes[], size_t count)
+{
+  (void)self;
+  (void)sizes;
+  CU_ASSERT_EQUAL(count, 1);
+  pktbuf_batch_packet = packets[0];
+  return NDN_SUCCESS;
+}
+#endif
+
+void forwarder_pktbuf_test()
+{
+  ndn_forwarder_config_t config = {
+    .nametree_size = 64,
+    .facetab_size = 300,
+    .fib_size = 4,
+    .pit_size = 8,
+    .cs_size = 4,
+    .cs_bytes = 1024,
+  };
+  ndn_pktbuf_pool_t* pool = (ndn_pktbuf_pool_t*)forwarder_pktbuf_pool_memory;
+  ndn_pktbuf_t* bufs[PKTBUF_TEST_COUNT];
+  ndn_pktbuf_t* buf;
+  uint8_t packet[256];
+  size_t len;
+  int i, sent;
+
+  // Buffers are handed out once and come back after the last release
+  ndn_pktbuf_pool_init(pool, PKTBUF_TEST_COUNT, 256);
+  CU_ASSERT_EQUAL(pool->reserve, PKTBUF_TEST_COUNT / 2);
+  for (i = 0; i < PKTBUF_TEST_COUNT; i++) {
+    bufs[i] = ndn_pktbuf_alloc(pool);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(bufs[i]);
+    CU_ASSERT_EQUAL(bufs[i]->refcount, 1);
+    CU_ASSERT_EQUAL(bufs[i]->length, 0);
+  }
+  CU_ASSERT_PTR_NOT_EQUAL(bufs[0], bufs[1]);
+  CU_ASSERT_PTR_NULL(ndn_pktbuf_alloc(pool));
+  CU_ASSERT_EQUAL(pool->free_count, 0);
+  ndn_pktbuf_release(ndn_pktbuf_retain(bufs[2]));
+  CU_ASSERT_EQUAL(pool->free_count, 0);
+  ndn_pktbuf_release(bufs[2]);
+  CU_ASSERT_EQUAL(pool->free_count, 1);
+  CU_ASSERT_PTR_EQUAL(ndn_pktbuf_alloc(pool), bufs[2]);
+  for (i = 0; i < PKTBUF_TEST_COUNT; i++) {
+    ndn_pktbuf_release(bufs[i]);
+  }
+  CU_ASSERT_EQUAL(pool->free_count, PKTBUF_TEST_COUNT);
+
+  ndn_forwarder_set_packet_pool(pool);
+  CU_ASSERT_PTR_EQUAL(ndn_forwarder_get_packet_pool(), pool);
+  ndn_forwarder_set_packet_pool(NULL);
+
+  CU_ASSERT_EQUAL_FATAL(ndn_forwarder_init_ex(&config, pktbuf_forwarder_memory,
+                                              sizeof(pktbuf_forwarder_memory)), NDN_SUCCESS);
+  many_faces_register(3);
+  many_faces[1].send_buf = pktbuf_face_send_buf;
+#if NDN_FORWARDER_TX_BATCH_SIZE > 0
+  many_faces[2].send_batch = pktbuf_face_send_batch;
+#endif
+  CU_ASSERT_EQUAL(ndn_forwarder_add_route_by_str(&many_faces[0], "/zc", strlen("/zc")), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive_buf(&many_faces[0], NULL), NDN_INVALID_POINTER);
+
+  // Faces without send_buf get the bytes of a buffer
+  buf = ndn_pktbuf_alloc(pool);
+  buf->length = many_faces_encode_interest("/zc/a", 1, buf->data, pool->buf_size);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive_buf(&many_faces[1], buf), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(many_faces_sent[0], 1);
+  CU_ASSERT_EQUAL(pool->free_count, PKTBUF_TEST_COUNT);
+  len = many_faces_encode_interest("/zc/a", 2, packet, sizeof(packet));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[2], packet, len), NDN_SUCCESS);
+
+  // Data goes to both faces and into the CS without a copy
+  buf = ndn_pktbuf_alloc(pool);
+  buf->length = many_faces_encode_data("/zc/a", buf->data, pool->buf_size);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive_buf(&many_faces[0], buf), NDN_SUCCESS);
+  CU_ASSERT_EQUAL_FATAL(pktbuf_sent_count, 1);
+  CU_ASSERT_PTR_EQUAL(pktbuf_sent[0], buf);
+#if NDN_FORWARDER_TX_BATCH_SIZE > 0
+  CU_ASSERT_EQUAL(buf->refcount, 3);
+  ndn_forwarder_flush();
+  CU_ASSERT_PTR_EQUAL(pktbuf_batch_packet, buf->data);
+#else
+  CU_ASSERT_EQUAL(many_faces_sent[2], 1);
+#endif
+  CU_ASSERT_EQUAL(buf->refcount, 2);
+  pktbuf_release_sent();
+  CU_ASSERT_EQUAL(buf->refcount, 1);
+  CU_ASSERT_EQUAL(pool->free_count, PKTBUF_TEST_COUNT - 1);
+
+  // A CS hit sends the cached buffer
+  len = many_faces_encode_interest("/zc/a", 3, packet, sizeof(packet));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[1], packet, len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL_FATAL(pktbuf_sent_count, 1);
+  CU_ASSERT_PTR_EQUAL(pktbuf_sent[0], buf);
+  pktbuf_release_sent();
+
+  // The CS copies rather than dip into the receive reserve
+  len = many_faces_encode_interest("/zc/b", 4, packet, sizeof(packet));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[1], packet, len), NDN_SUCCESS);
+  buf = ndn_pktbuf_alloc(pool);
+  buf->length = many_faces_encode_data("/zc/b", buf->data, pool->buf_size);
+  CU_ASSERT_EQUAL(pool->free_count, pool->reserve);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive_buf(&many_faces[0], buf), NDN_SUCCESS);
+  ndn_forwarder_flush();
+  pktbuf_release_sent();
+  CU_ASSERT_EQUAL(pool->free_count, PKTBUF_TEST_COUNT - 1);
+
+  // Removing the CS entry drops the last reference
+  ndn_cs_remove_all_entries(ndn_forwarder_get()->cs);
+  CU_ASSERT_EQUAL(pool->free_count, PKTBUF_TEST_COUNT);
+
+  // A burst of buffers is taken whole and released after it is forwarded
+  sent = many_faces_sent[0];
+  for (i = 0; i < 2; i++) {
+    bufs[i] = ndn_pktbuf_alloc(pool);
+    sprintf((char*)packet, "/zc/burst%d", i);
+    bufs[i]->length = many_faces_encode_interest((char*)packet, 10 + i, bufs[i]->data, pool->buf_size);
+  }
+  CU_ASSERT_EQUAL(ndn_forwarder_receive_buf_batch(&many_faces[1], NULL, 2), NDN_INVALID_POINTER);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive_buf_batch(&many_faces[1], bufs, 2), 2);
+  CU_ASSERT_EQUAL(many_faces_sent[0], sent + 2);
+  CU_ASSERT_EQUAL(pool->free_count, PKTBUF_TEST_COUNT);
+
+  for (i = 0; i < 3; i++) {
+    CU_ASSERT_EQUAL(ndn_forwarder_unregister_face(&many_faces[i]), NDN_SUCCESS);
+  }
+}
+
+void add_packet_buffer_test_suite()
+{
+  CU_pSuite pSuite = NULL;
+
+  /* add a suite to the registry */
+  pSuite = CU_add_suite("Packet Buffer Test", NULL, NULL);
+  if (NULL == pSuite)
+  {
+    CU_cleanup_registry();
+    // return CU_get_error();
+    return;
+  }
+  if (NULL == CU_add_test(pSuite, "forwarder_pktbuf_test", forwarder_pktbuf_test)) {
+    CU_cleanup_registry();
+    // return CU_get_error();
+    return;
+  }
+}
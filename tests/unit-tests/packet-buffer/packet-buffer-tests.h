@@ -0,0 +1,18 @@
+/*
+ * Copyright (C) 2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef PACKET_BUFFER_TESTS_H
+#define PACKET_BUFFER_TESTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// add packet buffer test suite to CUnit registry
+void add_packet_buffer_test_suite(void);
+
+#endif // PACKET_BUFFER_TESTS_H
@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+#include "shards-tests.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "../CUnit/CUnit.h"
+#include "../forwarder/many-faces.h"
+
+#include "ndn-lite/ndn-constants.h"
+#include "ndn-lite/ndn-error-code.h"
+#include "ndn-lite/forwarder/forwarder.h"
+#include "ndn-lite/util/spsc-ring.h"
+
+#if NDN_FORWARDER_SHARDING
+
+static uint8_t shards_forwarder_memory[NDN_FORWARDER_RESERVE_SIZE(64, 300, 4, 8, 4, 1024, 0, 0) + sizeof(uint64_t)];
+
+static uint8_t forwarder_shards_memory[2 * sizeof(ndn_forwarder_shard_t) +
+                                       2 * NDN_FORWARDER_RESERVE_SIZE(64, 4, 4, 8, 4, 1024, 0, 0) +
+                                       2 * NDN_SPSC_RING_RESERVE_SIZE(NDN_FORWARDER_SHARD_QUEUE_SIZE,
+                                                                      NDN_FORWARDER_SHARD_PACKET_SIZE + 16) +
+                                       2 * NDN_SPSC_RING_RESERVE_SIZE(NDN_FORWARDER_SHARD_CONTROL_SIZE,
+                                                                      NDN_FORWARDER_SHARD_PACKET_SIZE + 64) +
+                                       16 * NDN_CACHE_LINE_SIZE];
+
+static int
+forwarder_shards_process_all(void)
+{
+  uint32_t i;
+  int ret = 0;
+  for (i = 0; i < ndn_forwarder_shard_count(); i++) {
+    ret += ndn_forwarder_shard_process(i);
+  }
+  return ret;
+}
+
+static int shards_on_data_count = 0;
+
+static void
+shards_on_data(const uint8_t* data, uint32_t data_size, void* userdata)
+{
+  (void)data;
+  (void)data_size;
+  (void)userdata;
+  shards_on_data_count ++;
+}
+
+void forwarder_shards_test()
+{
+  ndn_forwarder_config_t config = {
+    .nametree_size = 64,
+    .facetab_size = 4,
+    .fib_size = 4,
+    .pit_size = 8,
+    .cs_size = 4,
+    .cs_bytes = 1024,
+  };
+  ndn_forwarder_stats_t stats;
+  ndn_face_stats_t face_stats;
+  uint8_t buf[256];
+  size_t len;
+  uint64_t in_interests = 0;
+  uint32_t i;
+  int ret_val;
+
+  CU_ASSERT_FATAL(ndn_forwarder_shards_reserve_size(2, &config) <= sizeof(forwarder_shards_memory));
+  ret_val = ndn_forwarder_init_ex(&config, shards_forwarder_memory, sizeof(shards_forwarder_memory));
+  CU_ASSERT_EQUAL_FATAL(ret_val, NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_shard_count(), 0);
+  len = many_faces_encode_interest("/wide/a", 1, buf, sizeof(buf));
+  CU_ASSERT_EQUAL(ndn_forwarder_shard_of(buf, len), NDN_INVALID_ARG);
+  CU_ASSERT_EQUAL(ndn_forwarder_shards_init(0, 1, &config, forwarder_shards_memory,
+                                            sizeof(forwarder_shards_memory)), NDN_INVALID_ARG);
+  CU_ASSERT_EQUAL(ndn_forwarder_shards_init(2, 1, &config, forwarder_shards_memory, 64), NDN_OVERSIZE);
+  ret_val = ndn_forwarder_shards_init(2, 1, &config, forwarder_shards_memory, sizeof(forwarder_shards_memory));
+  CU_ASSERT_EQUAL_FATAL(ret_val, NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_shard_count(), 2);
+  CU_ASSERT_PTR_NULL(ndn_forwarder_get_shard(2));
+
+  // Faces and routes reach every shard
+  many_faces_register(2);
+  CU_ASSERT_EQUAL(ndn_forwarder_add_route_by_str(&many_faces[1], "/wide", strlen("/wide")), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_shards_process_all(), 0);
+  for (i = 0; i < 2; i++) {
+    CU_ASSERT_EQUAL(ndn_forwarder_get_shard(i)->forwarder.facetab->count, 2);
+    CU_ASSERT_EQUAL(ndn_forwarder_get_shard(i)->forwarder.fib->count, 1);
+  }
+  // Shards only see faces and routes added after they are created
+  CU_ASSERT_EQUAL(ndn_forwarder_shards_init(2, 1, &config, forwarder_shards_memory,
+                                            sizeof(forwarder_shards_memory)), NDN_INVALID_ARG);
+
+  // Packets wait in the queue until their shard is processed
+  len = many_faces_encode_interest("/wide/a", 1, buf, sizeof(buf));
+  ret_val = ndn_forwarder_shard_of(buf, len);
+  CU_ASSERT(ret_val >= 0 && ret_val < 2);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[0], buf, len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(many_faces_sent[1], 0);
+  CU_ASSERT_EQUAL(forwarder_shards_process_all(), 1);
+  CU_ASSERT_EQUAL(many_faces_sent[1], 1);
+
+  // Data goes to the shard holding the PIT entry of its name
+  len = many_faces_encode_data("/wide/a", buf, sizeof(buf));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[1], buf, len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_shards_process_all(), 1);
+  CU_ASSERT_EQUAL(many_faces_sent[0], 1);
+  for (i = 0; i < 2; i++) {
+    in_interests += ndn_forwarder_get_shard(i)->forwarder.counters.in_interests;
+    CU_ASSERT_EQUAL(ndn_forwarder_get_shard(i)->forwarder.pit->count, 0);
+  }
+  CU_ASSERT_EQUAL(in_interests, 1);
+
+  // The main thread sees the sum of the shards
+  CU_ASSERT_EQUAL(ndn_forwarder_get_stats(&stats), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(stats.counters.in_interests, 1);
+  CU_ASSERT_EQUAL(stats.counters.out_interests, 1);
+  CU_ASSERT_EQUAL(stats.counters.in_data, 1);
+  CU_ASSERT_EQUAL(stats.counters.out_data, 1);
+  CU_ASSERT_EQUAL(stats.pit.insertions, 1);
+  CU_ASSERT_EQUAL(stats.pit_count, 0);
+  CU_ASSERT_EQUAL(stats.pit_capacity, 2 * config.pit_size);
+  CU_ASSERT_EQUAL(stats.fib_count, 1);
+  CU_ASSERT_EQUAL(stats.face_count, 2);
+  for (i = 0; i < 2; i++) {
+    CU_ASSERT_EQUAL(ndn_forwarder_get_face_stats(&many_faces[i], &face_stats), NDN_SUCCESS);
+    CU_ASSERT_EQUAL(face_stats.in_packets, 1);
+    CU_ASSERT_EQUAL(face_stats.out_packets, 1);
+    CU_ASSERT(face_stats.in_bytes > 0);
+  }
+
+  // Interests and Data of the application go to the shard owning their names
+  CU_ASSERT_EQUAL(ndn_forwarder_add_route_by_str(&many_faces[1], "/narrow", strlen("/narrow")), NDN_SUCCESS);
+  shards_on_data_count = 0;
+  len = many_faces_encode_interest("/wide/c", 3, buf, sizeof(buf));
+  CU_ASSERT_EQUAL(ndn_forwarder_express_interest(buf, len, shards_on_data, NULL, NULL), NDN_SUCCESS);
+  len = many_faces_encode_interest("/narrow/c", 4, buf, sizeof(buf));
+  CU_ASSERT_EQUAL(ndn_forwarder_express_interest(buf, len, shards_on_data, NULL, NULL), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_shards_process_all(), 0);
+  CU_ASSERT_EQUAL(many_faces_sent[1], 3);
+  len = many_faces_encode_data("/wide/c", buf, sizeof(buf));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[1], buf, len), NDN_SUCCESS);
+  len = many_faces_encode_data("/narrow/c", buf, sizeof(buf));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[1], buf, len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_shards_process_all(), 2);
+  CU_ASSERT_EQUAL(shards_on_data_count, 2);
+  len = many_faces_encode_interest("/narrow/d", 5, buf, sizeof(buf));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[0], buf, len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_shards_process_all(), 1);
+  len = many_faces_encode_data("/narrow/d", buf, sizeof(buf));
+  CU_ASSERT_EQUAL(ndn_forwarder_put_data(buf, len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_shards_process_all(), 0);
+  CU_ASSERT_EQUAL(many_faces_sent[0], 2);
+  for (i = 0; i < 2; i++) {
+    CU_ASSERT_EQUAL(ndn_forwarder_get_shard(i)->forwarder.counters.drop_unsolicited, 0);
+    CU_ASSERT_EQUAL(ndn_forwarder_get_shard(i)->forwarder.pit->count, 0);
+  }
+
+  // A full queue drops packets
+  len = many_faces_encode_interest("/wide/b", 2, buf, sizeof(buf));
+  for (i = 0; i < NDN_FORWARDER_SHARD_QUEUE_SIZE; i++) {
+    CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[0], buf, len), NDN_SUCCESS);
+  }
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[0], buf, len), NDN_FWD_SHARD_QUEUE_FULL);
+  CU_ASSERT_EQUAL(ndn_forwarder_get_stats(&stats), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(stats.counters.drop_queue_full, 1);
+  CU_ASSERT_EQUAL(forwarder_shards_process_all(), NDN_FORWARDER_SHARD_QUEUE_SIZE);
+
+  // Updates are refused, not lost, while a control queue is full
+  for (i = 0; i < NDN_FORWARDER_SHARD_CONTROL_SIZE; i++) {
+    ret_val = ndn_forwarder_add_route_by_str(&many_faces[1], "/wide", strlen("/wide"));
+    CU_ASSERT_EQUAL(ret_val, NDN_SUCCESS);
+  }
+  CU_ASSERT_EQUAL(ndn_forwarder_add_route_by_str(&many_faces[1], "/wide", strlen("/wide")),
+                  NDN_FWD_SHARD_QUEUE_FULL);
+
+  // Unregistering does not fail on a full queue, and every shard has applied it on return
+  for (i = 0; i < 2; i++) {
+    CU_ASSERT_EQUAL(ndn_forwarder_unregister_face(&many_faces[i]), NDN_SUCCESS);
+  }
+  for (i = 0; i < 2; i++) {
+    CU_ASSERT_EQUAL(ndn_spscring_front(ndn_forwarder_get_shard(i)->control), NULL);
+    CU_ASSERT_EQUAL(ndn_forwarder_get_shard(i)->forwarder.facetab->count, 0);
+    CU_ASSERT_EQUAL(ndn_forwarder_get_shard(i)->forwarder.fib->count, 0);
+  }
+}
+
+void forwarder_shards_order_test()
+{
+  ndn_forwarder_config_t config = {
+    .nametree_size = 64,
+    .facetab_size = 4,
+    .fib_size = 4,
+    .pit_size = 8,
+    .cs_size = 4,
+    .cs_bytes = 1024,
+  };
+  uint8_t buf[256];
+  size_t len;
+  ndn_table_id_t face_id;
+  uint32_t i;
+
+  CU_ASSERT_EQUAL_FATAL(ndn_forwarder_init_ex(&config, shards_forwarder_memory,
+                                              sizeof(shards_forwarder_memory)), NDN_SUCCESS);
+  CU_ASSERT_EQUAL_FATAL(ndn_forwarder_shards_init(1, 1, &config, forwarder_shards_memory,
+                                                  sizeof(forwarder_shards_memory)), NDN_SUCCESS);
+  many_faces_register(3);
+
+  // A packet is forwarded with the routes of the time it was queued
+  len = many_faces_encode_interest("/order/a", 1, buf, sizeof(buf));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[0], buf, len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_add_route_by_str(&many_faces[1], "/order", strlen("/order")), NDN_SUCCESS);
+  len = many_faces_encode_interest("/order/b", 2, buf, sizeof(buf));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[0], buf, len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_shards_process_all(), 2);
+  CU_ASSERT_EQUAL(many_faces_sent[1], 1);
+  CU_ASSERT_EQUAL(ndn_forwarder_get_shard(0)->forwarder.counters.drop_no_route, 1);
+
+  // A packet queued before its face is unregistered still comes from that face,
+  // and does not bring Data to a face registered later with the same ID
+  face_id = many_faces[2].face_id;
+  len = many_faces_encode_interest("/order/c", 3, buf, sizeof(buf));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[2], buf, len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_unregister_face(&many_faces[2]), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(many_faces_sent[1], 2);
+  many_faces[3].send = many_faces[2].send;
+  many_faces[3].state = NDN_FACE_STATE_UP;
+  many_faces[3].face_id = NDN_INVALID_ID;
+  CU_ASSERT_EQUAL(ndn_forwarder_register_face(&many_faces[3]), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(many_faces[3].face_id, face_id);
+  len = many_faces_encode_data("/order/c", buf, sizeof(buf));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&many_faces[1], buf, len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_shards_process_all(), 1);
+  CU_ASSERT_EQUAL(many_faces_sent[3], 0);
+  CU_ASSERT_EQUAL(ndn_forwarder_get_shard(0)->forwarder.counters.drop_unsolicited, 1);
+
+  for (i = 0; i < 4; i++) {
+    if (i != 2)
+      CU_ASSERT_EQUAL(ndn_forwarder_unregister_face(&many_faces[i]), NDN_SUCCESS);
+  }
+}
+
+#endif // NDN_FORWARDER_SHARDING
+
+void add_shards_test_suite()
+{
+  CU_pSuite pSuite = NULL;
+
+  /* add a suite to the registry */
+  pSuite = CU_add_suite("Shards Test", NULL, NULL);
+  if (NULL == pSuite)
+  {
+    CU_cleanup_registry();
+    // return CU_get_error();
+    return;
+  }
+#if NDN_FORWARDER_SHARDING
+  if (NULL == CU_add_test(pSuite, "forwarder_shards_test", forwarder_shards_test)) {
+    CU_cleanup_registry();
+    // return CU_get_error();
+    return;
+  }
+  if (NULL == CU_add_test(pSuite, "forwarder_shards_order_test", forwarder_shards_order_test)) {
+    CU_cleanup_registry();
+    // return CU_get_error();
+    return;
+  }
+#endif
+}
@@ -19,6 +19,10 @@
 #include "../CUnit/CUnit.h"
 #include "ndn-lite/util/memory-pool.h"
 #include "ndn-lite/util/msg-queue.h"
+#include "ndn-lite/util/spsc-ring.h"
+#include "ndn-lite/util/mpsc-queue.h"
+#include "ndn-lite/util/scratch.h"
+#include "ndn-lite/ndn-error-code.h"
 #include "ndn-lite/forwarder/name-tree.h"
 #include "ndn-lite/ndn-constants.h"
 #include <string.h>
@@ -203,6 +207,66 @@ bool _run_msg_queue_test(){
   return true;
 }
 
+static int timer_order[8];
+static int timer_fired;
+
+void timer_record(void *arg){
+  timer_order[timer_fired++] = *(int*)arg;
+}
+
+void timer_again(void *arg){
+  timer_order[timer_fired++] = *(int*)arg;
+  // A past deadline runs on the next process, not in a loop
+  ndn_timer_schedule(0, timer_again, arg);
+}
+
+bool _run_timer_test(){
+  static int ids[] = {0, 1, 2, 3};
+  struct ndn_timer *timer, *late;
+  ndn_time_ms_t now = ndn_time_now_ms();
+  int i;
+
+  ndn_msgqueue_init();
+  timer_fired = 0;
+  CU_ASSERT_EQUAL(ndn_timer_next_deadline(), NDN_TIMER_NO_DEADLINE);
+  CU_ASSERT_PTR_NULL(ndn_timer_schedule(now, NULL, NULL));
+
+  // Due timers run in deadline order, the others stay pending
+  late = ndn_timer_schedule(now + 60000, timer_record, &ids[0]);
+  CU_ASSERT_PTR_NOT_NULL(late);
+  CU_ASSERT_PTR_NOT_NULL(ndn_timer_schedule(now - 1, timer_record, &ids[1]));
+  timer = ndn_timer_schedule(now - 2, timer_record, &ids[2]);
+  CU_ASSERT_PTR_NOT_NULL(ndn_timer_schedule(now - 3, timer_record, &ids[3]));
+  CU_ASSERT_EQUAL(ndn_timer_next_deadline(), now - 3);
+  ndn_timer_cancel(timer);
+  ndn_timer_cancel(NULL);
+  ndn_msgqueue_process();
+  CU_ASSERT_EQUAL(timer_fired, 2);
+  CU_ASSERT_EQUAL(timer_order[0], 3);
+  CU_ASSERT_EQUAL(timer_order[1], 1);
+  CU_ASSERT_EQUAL(ndn_timer_next_deadline(), now + 60000);
+  ndn_timer_cancel(late);
+  CU_ASSERT_EQUAL(ndn_timer_next_deadline(), NDN_TIMER_NO_DEADLINE);
+
+  // A periodic task runs once per pass
+  timer_fired = 0;
+  ndn_timer_schedule(0, timer_again, &ids[2]);
+  ndn_msgqueue_process();
+  ndn_msgqueue_process();
+  CU_ASSERT_EQUAL(timer_fired, 2);
+
+  // Capacity
+  ndn_msgqueue_init();
+  for(i = 0; i < NDN_TIMER_MAX_COUNT; i++){
+    CU_ASSERT_PTR_NOT_NULL(ndn_timer_schedule(now + i, timer_record, &ids[0]));
+  }
+  CU_ASSERT_PTR_NULL(ndn_timer_schedule(now, timer_record, &ids[0]));
+  ndn_msgqueue_init();
+  CU_ASSERT_EQUAL(ndn_timer_next_deadline(), NDN_TIMER_NO_DEADLINE);
+
+  return true;
+}
+
 bool _run_nametree_test(){
   uint8_t nametree_buf[NDN_NAMETREE_RESERVE_SIZE(10)];
   ndn_nametree_t *nametree = (ndn_nametree_t*)nametree_buf;
@@ -247,7 +311,7 @@ bool _run_nametree_test(){
   ptr6 = ndn_nametree_prefix_match(nametree, name2, strlen((char*)name2), NDN_NAMETREE_PIT_TYPE);
   CU_ASSERT_PTR_EQUAL(ptr6, ptr2);
 
-  // Autoclear test
+  // Release test
   int i;
   uint8_t name20[] = "\x07\x03\x08\x01\x00";
   ndn_nametree_init(nametree, 10);
@@ -268,6 +332,7 @@ bool _run_nametree_test(){
   ptr1 = ndn_nametree_find_or_insert(nametree, name21, strlen((char*)name21));
   CU_ASSERT_PTR_NOT_NULL(ptr1);
   ptr1->fib_id = NDN_INVALID_ID;
+  ndn_nametree_release(nametree, ptr1);
 
   ptr1 = ndn_nametree_find_or_insert(nametree, name22, strlen((char*)name22));
   CU_ASSERT_PTR_NOT_NULL(ptr1);
@@ -275,6 +340,168 @@ bool _run_nametree_test(){
   return true;
 }
 
+bool _run_spsc_ring_test(){
+  static NDN_CACHE_ALIGNED uint8_t ring_buf[NDN_SPSC_RING_RESERVE_SIZE(4, 12)];
+  ndn_spsc_ring_t *ring = (ndn_spsc_ring_t*)ring_buf;
+  uint32_t *slot;
+  uint32_t i;
+
+  CU_ASSERT_EQUAL(ndn_spscring_init(ring, 3, 12), NDN_INVALID_ARG);
+  CU_ASSERT_EQUAL(ndn_spscring_init(ring, 4, 12), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ring->slot_size, 16);
+  CU_ASSERT_PTR_NULL(ndn_spscring_front(ring));
+
+  // Fill up, then wrap around several times in FIFO order
+  for (i = 0; i < 4; i++) {
+    slot = ndn_spscring_reserve(ring);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(slot);
+    *slot = i;
+    ndn_spscring_commit(ring);
+  }
+  CU_ASSERT_PTR_NULL(ndn_spscring_reserve(ring));
+  for (i = 0; i < 20; i++) {
+    slot = ndn_spscring_front(ring);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(slot);
+    CU_ASSERT_EQUAL(*slot, i);
+    ndn_spscring_pop(ring);
+    slot = ndn_spscring_reserve(ring);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(slot);
+    *slot = i + 4;
+    ndn_spscring_commit(ring);
+  }
+  for (i = 20; i < 24; i++) {
+    slot = ndn_spscring_front(ring);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(slot);
+    CU_ASSERT_EQUAL(*slot, i);
+    ndn_spscring_pop(ring);
+  }
+  CU_ASSERT_PTR_NULL(ndn_spscring_front(ring));
+
+  return true;
+}
+
+static uint32_t mpsc_order[16];
+static int mpsc_received;
+static int mpsc_wakeups;
+
+void mpsc_record(void *self, size_t param_length, void *param){
+  (void)self;
+  mpsc_order[mpsc_received++] = param_length > 0 ? *(uint32_t*)param : 0xFFFFFFFF;
+}
+
+void mpsc_wakeup(void *userdata){
+  *(int*)userdata += 1;
+}
+
+bool _run_mpsc_queue_test(){
+  static NDN_CACHE_ALIGNED uint8_t queue_buf[NDN_MPSC_QUEUE_RESERVE_SIZE(4, 8)];
+  ndn_mpsc_queue_t *queue = (ndn_mpsc_queue_t*)queue_buf;
+  uint64_t msg_buf[2][(sizeof(ndn_mpsc_msg_t) + sizeof(uint64_t)) / sizeof(uint64_t)];
+  ndn_mpsc_msg_t *msg;
+  uint8_t big[64] = {0};
+  uint32_t i;
+
+  CU_ASSERT_EQUAL(ndn_mpscqueue_init(queue, 1, 8), NDN_INVALID_ARG);
+  CU_ASSERT_EQUAL(ndn_mpscqueue_init(queue, 6, 8), NDN_INVALID_ARG);
+  CU_ASSERT_EQUAL(ndn_mpscqueue_init(queue, 4, 8), NDN_SUCCESS);
+  ndn_mpscqueue_set_wakeup(queue, mpsc_wakeup, &mpsc_wakeups);
+  CU_ASSERT_TRUE(ndn_mpscqueue_empty(queue));
+  CU_ASSERT_EQUAL(ndn_mpscqueue_post(queue, NULL, mpsc_record, sizeof(big), big), NDN_OVERSIZE);
+
+  // Fill up, with one wakeup until processed
+  mpsc_received = mpsc_wakeups = 0;
+  for (i = 0; i < 4; i++) {
+    CU_ASSERT_EQUAL(ndn_mpscqueue_post(queue, NULL, mpsc_record, sizeof(i), &i), NDN_SUCCESS);
+  }
+  CU_ASSERT_EQUAL(ndn_mpscqueue_post(queue, NULL, mpsc_record, sizeof(i), &i), NDN_FWD_MSGQUEUE_FULL);
+  CU_ASSERT_EQUAL(mpsc_wakeups, 1);
+  CU_ASSERT_FALSE(ndn_mpscqueue_empty(queue));
+
+  // Messages that do not fit are chained in posting order
+  for (i = 0; i < 2; i++) {
+    msg = (ndn_mpsc_msg_t*)msg_buf[i];
+    msg->obj = NULL;
+    msg->func = mpsc_record;
+    msg->length = sizeof(uint32_t);
+    *(uint32_t*)msg->param = 10 + i;
+    ndn_mpscqueue_post_msg(queue, msg);
+  }
+  CU_ASSERT_EQUAL(mpsc_wakeups, 1);
+  CU_ASSERT_EQUAL(ndn_mpscqueue_process(queue), 6);
+  CU_ASSERT_EQUAL(mpsc_received, 6);
+  for (i = 0; i < 4; i++) {
+    CU_ASSERT_EQUAL(mpsc_order[i], i);
+  }
+  CU_ASSERT_EQUAL(mpsc_order[4], 10);
+  CU_ASSERT_EQUAL(mpsc_order[5], 11);
+  CU_ASSERT_TRUE(ndn_mpscqueue_empty(queue));
+
+  // Wrap around, with a wakeup again after processing
+  mpsc_received = 0;
+  for (i = 0; i < 3; i++) {
+    CU_ASSERT_EQUAL(ndn_mpscqueue_post(queue, NULL, mpsc_record, sizeof(i), &i), NDN_SUCCESS);
+  }
+  CU_ASSERT_EQUAL(ndn_mpscqueue_post(queue, NULL, mpsc_record, 0, NULL), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(mpsc_wakeups, 2);
+  CU_ASSERT_EQUAL(ndn_mpscqueue_process(queue), 4);
+  CU_ASSERT_EQUAL(mpsc_order[2], 2);
+  CU_ASSERT_EQUAL(mpsc_order[3], 0xFFFFFFFF);
+  CU_ASSERT_EQUAL(ndn_mpscqueue_process(queue), 0);
+
+  // Through the forwarder queue
+  ndn_msgqueue_init();
+  mpsc_received = mpsc_wakeups = 0;
+  ndn_msgqueue_set_wakeup(mpsc_wakeup, &mpsc_wakeups);
+  CU_ASSERT_TRUE(ndn_msgqueue_mt_empty());
+  i = 7;
+  CU_ASSERT_EQUAL(ndn_msgqueue_post_mt(NULL, mpsc_record, sizeof(i), &i), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_msgqueue_post_mt(NULL, mpsc_record, NDN_MSGQUEUE_MT_PARAM_SIZE + 1, big),
+                  NDN_OVERSIZE);
+  CU_ASSERT_EQUAL(mpsc_wakeups, 1);
+  CU_ASSERT_FALSE(ndn_msgqueue_mt_empty());
+  ndn_msgqueue_process();
+  CU_ASSERT_EQUAL(mpsc_received, 1);
+  CU_ASSERT_EQUAL(mpsc_order[0], 7);
+  CU_ASSERT_TRUE(ndn_msgqueue_mt_empty());
+  ndn_msgqueue_set_wakeup(NULL, NULL);
+
+  return true;
+}
+
+bool _run_scratch_test(){
+  ndn_scratch_mark_t outer, inner;
+  size_t available = ndn_scratch_available();
+  uint8_t *a, *b, *c;
+
+  outer = ndn_scratch_mark();
+  a = ndn_scratch_alloc(3);
+  b = ndn_scratch_alloc(16);
+  CU_ASSERT_PTR_NOT_NULL(a);
+  CU_ASSERT_PTR_NOT_NULL(b);
+  CU_ASSERT_EQUAL((uintptr_t)b % 8, 0);
+  CU_ASSERT_EQUAL(b - a, 8);
+  CU_ASSERT_EQUAL(ndn_scratch_available(), available - 24);
+
+  // Nested users release back to their own mark
+  inner = ndn_scratch_mark();
+  c = ndn_scratch_alloc(8);
+  CU_ASSERT_EQUAL(c - b, 16);
+  ndn_scratch_release(inner);
+  CU_ASSERT_PTR_EQUAL(ndn_scratch_alloc(8), c);
+  ndn_scratch_release(inner);
+
+  // Exhaustion fails without using any memory
+  CU_ASSERT_PTR_NULL(ndn_scratch_alloc(available));
+  CU_ASSERT_EQUAL(ndn_scratch_available(), available - 24);
+  CU_ASSERT_PTR_NOT_NULL(ndn_scratch_alloc(available - 24));
+  CU_ASSERT_EQUAL(ndn_scratch_available(), 0);
+  CU_ASSERT_PTR_NULL(ndn_scratch_alloc(1));
+
+  ndn_scratch_release(outer);
+  CU_ASSERT_EQUAL(ndn_scratch_available(), available);
+  return true;
+}
+
 void _run_util_test(util_test_t *test) {
   
   _current_test_name = test->test_names[test->test_name_index];
@@ -282,7 +509,11 @@ void _run_util_test(util_test_t *test) {
 
   _all_function_calls_succeeded = (_all_function_calls_succeeded && _run_memory_pool_test());
   _all_function_calls_succeeded = (_all_function_calls_succeeded && _run_msg_queue_test());
+  _all_function_calls_succeeded = (_all_function_calls_succeeded && _run_timer_test());
   _all_function_calls_succeeded = (_all_function_calls_succeeded && _run_nametree_test());
+  _all_function_calls_succeeded = (_all_function_calls_succeeded && _run_spsc_ring_test());
+  _all_function_calls_succeeded = (_all_function_calls_succeeded && _run_mpsc_queue_test());
+  _all_function_calls_succeeded = (_all_function_calls_succeeded && _run_scratch_test());
 
   if (_all_function_calls_succeeded)
   {
@@ -41,7 +41,7 @@ static inline ndn_bitset_t bitset_unset(ndn_bitset_t set, size_t val){
 
 static inline size_t bitset_log2(ndn_bitset_t val){
 #if defined(__GNUC__) || defined(__clang__)
-  return __builtin_ctz(val);
+  return __builtin_ctzll(val);
 #else
   size_t n = 0;
   if((x & 0x00000000FFFFFFFFllu) == 0){
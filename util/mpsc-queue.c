@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include "mpsc-queue.h"
+#include "../ndn-error-code.h"
+#include <string.h>
+
+#define MPSC_SLOT(queue, pos) \
+  ((uint8_t*)(queue)->slots + (size_t)((pos) & (queue)->mask) * (queue)->slot_size)
+#define MPSC_SLOT_SEQ(slot) ((atomic_uint_fast32_t*)(slot))
+#define MPSC_SLOT_MSG(slot) ((ndn_mpsc_msg_t*)((slot) + NDN_MPSC_QUEUE_SEQ_SIZE))
+
+int
+ndn_mpscqueue_init(void* memory, uint32_t slot_count, uint32_t param_size)
+{
+  ndn_mpsc_queue_t* queue = (ndn_mpsc_queue_t*)memory;
+  uint32_t i;
+
+  // With one slot, a published message would look free to the next lap
+  if (slot_count < 2 || (slot_count & (slot_count - 1)) != 0) {
+    return NDN_INVALID_ARG;
+  }
+  atomic_init(&queue->tail, 0);
+  atomic_init(&queue->chain, NULL);
+  atomic_init(&queue->signaled, false);
+  queue->head = 0;
+  queue->mask = slot_count - 1;
+  queue->slot_size = NDN_MPSC_QUEUE_SLOT_SIZE(param_size);
+  queue->wakeup = NULL;
+  queue->wakeup_userdata = NULL;
+  for (i = 0; i < slot_count; i++) {
+    atomic_init(MPSC_SLOT_SEQ(MPSC_SLOT(queue, i)), i);
+  }
+  return NDN_SUCCESS;
+}
+
+void
+ndn_mpscqueue_set_wakeup(ndn_mpsc_queue_t* queue, ndn_msgqueue_wakeup_func wakeup, void* userdata)
+{
+  queue->wakeup = wakeup;
+  queue->wakeup_userdata = userdata;
+}
+
+// Wake up the consumer if no producer did since it last ran
+static inline void
+mpsc_signal(ndn_mpsc_queue_t* queue)
+{
+  // Pairs with the fence in ndn_mpscqueue_process(): either the consumer
+  // sees the message, or this sees signaled cleared
+  atomic_thread_fence(memory_order_seq_cst);
+  if (!atomic_exchange(&queue->signaled, true) && queue->wakeup != NULL) {
+    queue->wakeup(queue->wakeup_userdata);
+  }
+}
+
+int
+ndn_mpscqueue_post(ndn_mpsc_queue_t* queue, void* target, ndn_msg_callback reason,
+                   size_t param_length, const void* param)
+{
+  uint_fast32_t pos, seq;
+  ndn_mpsc_msg_t* msg;
+  uint8_t* slot;
+
+  if (param_length > queue->slot_size - NDN_MPSC_QUEUE_SEQ_SIZE - sizeof(ndn_mpsc_msg_t)) {
+    return NDN_OVERSIZE;
+  }
+  pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+  for (;;) {
+    slot = MPSC_SLOT(queue, pos);
+    seq = atomic_load_explicit(MPSC_SLOT_SEQ(slot), memory_order_acquire);
+    if (seq == pos) {
+      // On failure pos is reloaded with the current tail
+      if (atomic_compare_exchange_weak_explicit(&queue->tail, &pos, pos + 1,
+                                                memory_order_relaxed, memory_order_relaxed)) {
+        break;
+      }
+    }
+    else if (seq == pos - queue->mask) {
+      // Still holding the message of the previous lap
+      return NDN_FWD_MSGQUEUE_FULL;
+    }
+    else {
+      pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    }
+  }
+
+  msg = MPSC_SLOT_MSG(slot);
+  msg->obj = target;
+  msg->func = reason;
+  msg->length = param_length;
+  msg->next = NULL;
+  if (param_length > 0) {
+    memcpy(msg->param, param, param_length);
+  }
+  atomic_store_explicit(MPSC_SLOT_SEQ(slot), pos + 1, memory_order_release);
+  mpsc_signal(queue);
+  return NDN_SUCCESS;
+}
+
+void
+ndn_mpscqueue_post_msg(ndn_mpsc_queue_t* queue, ndn_mpsc_msg_t* msg)
+{
+  ndn_mpsc_msg_t* head = atomic_load_explicit(&queue->chain, memory_order_relaxed);
+  do {
+    msg->next = head;
+  } while (!atomic_compare_exchange_weak_explicit(&queue->chain, &head, msg,
+                                                  memory_order_release, memory_order_relaxed));
+  mpsc_signal(queue);
+}
+
+uint32_t
+ndn_mpscqueue_process(ndn_mpsc_queue_t* queue)
+{
+  uint_fast32_t end;
+  ndn_mpsc_msg_t *chain, *msg, *prev = NULL;
+  uint8_t* slot;
+  uint32_t count = 0;
+
+  atomic_store(&queue->signaled, false);
+  atomic_thread_fence(memory_order_seq_cst);
+
+  // A slot claimed but not published yet stops the round.
+  // Its producer wakes the consumer up again once it is published.
+  end = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+  while (queue->head != end) {
+    slot = MPSC_SLOT(queue, queue->head);
+    if (atomic_load_explicit(MPSC_SLOT_SEQ(slot), memory_order_acquire) != queue->head + 1) {
+      break;
+    }
+    msg = MPSC_SLOT_MSG(slot);
+    msg->func(msg->obj, msg->length, msg->param);
+    atomic_store_explicit(MPSC_SLOT_SEQ(slot), queue->head + queue->mask + 1, memory_order_release);
+    queue->head ++;
+    count ++;
+  }
+
+  // The chain is taken at once and reversed into posting order
+  chain = atomic_exchange_explicit(&queue->chain, NULL, memory_order_acquire);
+  while (chain != NULL) {
+    msg = chain->next;
+    chain->next = prev;
+    prev = chain;
+    chain = msg;
+  }
+  while (prev != NULL) {
+    // The callback may reuse the message
+    msg = prev;
+    prev = prev->next;
+    msg->func(msg->obj, msg->length, msg->param);
+    count ++;
+  }
+  return count;
+}
+
+bool
+ndn_mpscqueue_empty(ndn_mpsc_queue_t* queue)
+{
+  uint8_t* slot = MPSC_SLOT(queue, queue->head);
+  return atomic_load_explicit(MPSC_SLOT_SEQ(slot), memory_order_acquire) != queue->head + 1 &&
+         atomic_load_explicit(&queue->chain, memory_order_relaxed) == NULL;
+}
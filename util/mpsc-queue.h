@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef UTIL_MPSC_QUEUE_H_
+#define UTIL_MPSC_QUEUE_H_
+
+#include "../ndn-constants.h"
+#include "msg-queue.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNUtilMpscQueue MPSC Message Queue
+ * @ingroup NDNUtil
+ *
+ * Lock-free message queue posted to by any thread and dispatched by one.
+ *
+ * Messages are copied into a bounded ring of fixed-size slots, so posting
+ * does not allocate. A message that does not fit, because the ring is full or
+ * its parameters are larger than a slot, can be posted in memory of the caller
+ * instead, which is chained after the ring without a bound.
+ * Messages in the ring are dispatched in order, and so are chained messages,
+ * but the two are not ordered with each other.
+ * @{
+ */
+
+/** A message posted in memory of the caller.
+ * @sa ndn_mpscqueue_post_msg
+ */
+typedef struct ndn_mpsc_msg {
+  /** The object to receive this message.
+   */
+  void* obj;
+
+  /** The message callback function.
+   */
+  ndn_msg_callback func;
+
+  /** Bytes of @c param.
+   */
+  size_t length;
+
+  /** Next message in the chain.
+   */
+  struct ndn_mpsc_msg* next;
+
+  uint8_t param[];
+} ndn_mpsc_msg_t;
+
+/** Multi-producer single-consumer message queue.
+ *
+ * The ring is a bounded queue of sequenced slots: a slot can be written when
+ * its sequence equals the position of a producer, and read when it is one more.
+ */
+typedef struct ndn_mpsc_queue {
+  /** Next position to write. Claimed by producers.
+   */
+  NDN_CACHE_ALIGNED atomic_uint_fast32_t tail;
+
+  /** Chained messages, newest first.
+   */
+  NDN_CACHE_ALIGNED _Atomic(ndn_mpsc_msg_t*) chain;
+
+  /** Set once a producer has woken up the consumer, until the consumer runs.
+   */
+  atomic_bool signaled;
+
+  /** Next position to read. Written by the consumer.
+   */
+  NDN_CACHE_ALIGNED uint_fast32_t head;
+
+  /** Number of slots minus one. The number of slots is a power of 2.
+   */
+  uint32_t mask;
+
+  /** Bytes of each slot, a multiple of @c sizeof(uint64_t).
+   */
+  uint32_t slot_size;
+
+  ndn_msgqueue_wakeup_func wakeup;
+  void* wakeup_userdata;
+
+  uint64_t slots[];
+} ndn_mpsc_queue_t;
+
+/** Bytes before the message in a slot, holding its sequence.
+ */
+#define NDN_MPSC_QUEUE_SEQ_SIZE \
+  ((sizeof(atomic_uint_fast32_t) + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t))
+
+/** Bytes of a slot holding @c param_size bytes of parameters.
+ */
+#define NDN_MPSC_QUEUE_SLOT_SIZE(param_size) \
+  ((NDN_MPSC_QUEUE_SEQ_SIZE + sizeof(ndn_mpsc_msg_t) + (param_size) + sizeof(uint64_t) - 1) / \
+   sizeof(uint64_t) * sizeof(uint64_t))
+
+/** The memory reserved for a queue.
+ * @param[in] slot_count Number of slots, a power of 2 and at least 2.
+ * @param[in] param_size Maximum bytes of parameters of a message in the ring.
+ */
+#define NDN_MPSC_QUEUE_RESERVE_SIZE(slot_count, param_size) \
+  (sizeof(ndn_mpsc_queue_t) + NDN_MPSC_QUEUE_SLOT_SIZE(param_size) * (slot_count))
+
+/** Initialize a queue at specified memory space.
+ * @param[in, out] memory Memory reserved for the queue, aligned to #NDN_CACHE_LINE_SIZE.
+ * @param[in] slot_count Number of slots, a power of 2 and at least 2.
+ * @param[in] param_size Maximum bytes of parameters of a message in the ring.
+ * @return #NDN_SUCCESS if the call succeeded.
+ * @retval #NDN_INVALID_ARG @c slot_count is not a power of 2, or less than 2.
+ */
+int
+ndn_mpscqueue_init(void* memory, uint32_t slot_count, uint32_t param_size);
+
+/** Set the function to wake up the consumer. Consumer only.
+ *
+ * It is called at most once between two calls of ndn_mpscqueue_process(),
+ * by the first producer posting meanwhile.
+ * @param[in] wakeup The function. NULL if the consumer polls.
+ * @param[in] userdata [Optional] User-defined data, copied to @c wakeup.
+ */
+void
+ndn_mpscqueue_set_wakeup(ndn_mpsc_queue_t* queue, ndn_msgqueue_wakeup_func wakeup, void* userdata);
+
+/** Post a message to the ring. Thread-safe.
+ * @param[in] target The object to receive this message.
+ * @param[in] reason The message callback function.
+ * @param[in] param_length [Optional] The length of parameters @c param.
+ * @param[in] param [Optional] The parameters of this message, copied into the ring.
+ * @return #NDN_SUCCESS if the call succeeded.
+ * @retval #NDN_OVERSIZE @c param_length is larger than a slot holds.
+ * @retval #NDN_FWD_MSGQUEUE_FULL The ring is full.
+ */
+int
+ndn_mpscqueue_post(ndn_mpsc_queue_t* queue, void* target, ndn_msg_callback reason,
+                   size_t param_length, const void* param);
+
+/** Post a message in memory of the caller. Thread-safe, and never fails.
+ *
+ * @c msg is owned by the queue until its callback is called,
+ * with @c param pointing into it.
+ * @param[in] msg The message, with @c obj, @c func, @c length and @c param set.
+ */
+void
+ndn_mpscqueue_post_msg(ndn_mpsc_queue_t* queue, ndn_mpsc_msg_t* msg);
+
+/** Dispatch the messages posted so far. Consumer only.
+ *
+ * Messages posted meanwhile are left for the next call.
+ * @return The number of messages dispatched.
+ */
+uint32_t
+ndn_mpscqueue_process(ndn_mpsc_queue_t* queue);
+
+/** Check whether any message is waiting. Consumer only.
+ */
+bool
+ndn_mpscqueue_empty(ndn_mpsc_queue_t* queue);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTIL_MPSC_QUEUE_H_
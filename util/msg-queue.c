@@ -9,6 +9,7 @@
  */
 
 #include "msg-queue.h"
+#include "mpsc-queue.h"
 #include <string.h>
 
 /** Padding message
@@ -31,6 +32,25 @@ typedef struct ndn_msg{
 static uint8_t msg_queue[NDN_MSGQUEUE_SIZE];
 static ndn_msg_t *pfront, *ptail, *psplit;
 
+typedef struct ndn_timer{
+  ndn_time_ms_t deadline;
+  /** NULL if the timer is free. */
+  ndn_timer_callback func;
+  void* arg;
+  /** Position in timer_heap. */
+  int index;
+} ndn_timer_t;
+
+// Pending timers are kept in a binary min-heap ordered by deadline
+static ndn_timer_t timers[NDN_TIMER_MAX_COUNT];
+static ndn_timer_t* timer_heap[NDN_TIMER_MAX_COUNT];
+static int timer_count;
+
+// Messages posted by other threads
+static NDN_CACHE_ALIGNED uint8_t mt_queue_memory[
+  NDN_MPSC_QUEUE_RESERVE_SIZE(NDN_MSGQUEUE_MT_SLOT_COUNT, NDN_MSGQUEUE_MT_PARAM_SIZE)];
+static ndn_mpsc_queue_t* const mt_queue = (ndn_mpsc_queue_t*)mt_queue_memory;
+
 #define MSGQUEUE_NEXT(ptr) \
   ptr = (ndn_msg_t*)(((uint8_t*)ptr) + ptr->length); \
   if(((uint8_t*)ptr) >= &msg_queue[NDN_MSGQUEUE_SIZE]){ \
@@ -40,7 +60,42 @@ static ndn_msg_t *pfront, *ptail, *psplit;
 
 void
 ndn_msgqueue_init(void) {
+  ndn_msgqueue_wakeup_func wakeup = mt_queue->wakeup;
+  void* userdata = mt_queue->wakeup_userdata;
+  int i;
+
   pfront = ptail = psplit = (ndn_msg_t*)&msg_queue;
+  for(i = 0; i < NDN_TIMER_MAX_COUNT; i++){
+    timers[i].func = NULL;
+  }
+  timer_count = 0;
+  // The event loop may have set the wakeup before
+  ndn_mpscqueue_init(mt_queue, NDN_MSGQUEUE_MT_SLOT_COUNT, NDN_MSGQUEUE_MT_PARAM_SIZE);
+  ndn_mpscqueue_set_wakeup(mt_queue, wakeup, userdata);
+}
+
+int
+ndn_msgqueue_post_mt(void *target,
+                     ndn_msg_callback reason,
+                     size_t param_length,
+                     const void *param)
+{
+  return ndn_mpscqueue_post(mt_queue, target, reason, param_length, param);
+}
+
+void
+ndn_msgqueue_post_mt_msg(struct ndn_mpsc_msg* msg){
+  ndn_mpscqueue_post_msg(mt_queue, msg);
+}
+
+void
+ndn_msgqueue_set_wakeup(ndn_msgqueue_wakeup_func wakeup, void *userdata){
+  ndn_mpscqueue_set_wakeup(mt_queue, wakeup, userdata);
+}
+
+bool
+ndn_msgqueue_mt_empty(void){
+  return mt_queue->slot_size == 0 || ndn_mpscqueue_empty(mt_queue);
 }
 
 bool
@@ -119,8 +174,102 @@ ndn_msgqueue_post(void *target,
   return ret;
 }
 
+static void
+timer_heap_set(int index, ndn_timer_t* timer){
+  timer_heap[index] = timer;
+  timer->index = index;
+}
+
+// Move the timer at index to its place, up or down
+static void
+timer_heap_fix(int index){
+  ndn_timer_t* timer = timer_heap[index];
+  int child;
+
+  while(index > 0 && timer_heap[(index - 1) / 2]->deadline > timer->deadline){
+    timer_heap_set(index, timer_heap[(index - 1) / 2]);
+    index = (index - 1) / 2;
+  }
+  while((child = 2 * index + 1) < timer_count){
+    if(child + 1 < timer_count && timer_heap[child + 1]->deadline < timer_heap[child]->deadline){
+      child ++;
+    }
+    if(timer_heap[child]->deadline >= timer->deadline){
+      break;
+    }
+    timer_heap_set(index, timer_heap[child]);
+    index = child;
+  }
+  timer_heap_set(index, timer);
+}
+
+static void
+timer_heap_remove(ndn_timer_t* timer){
+  int index = timer->index;
+
+  timer->func = NULL;
+  timer_count --;
+  if(index < timer_count){
+    timer_heap_set(index, timer_heap[timer_count]);
+    timer_heap_fix(index);
+  }
+}
+
+struct ndn_timer*
+ndn_timer_schedule(ndn_time_ms_t deadline, ndn_timer_callback callback, void *arg){
+  ndn_timer_t* timer = NULL;
+  int i;
+
+  for(i = 0; i < NDN_TIMER_MAX_COUNT; i++){
+    if(timers[i].func == NULL){
+      timer = &timers[i];
+      break;
+    }
+  }
+  if(timer == NULL || callback == NULL){
+    return NULL;
+  }
+  timer->deadline = deadline;
+  timer->func = callback;
+  timer->arg = arg;
+  timer_heap_set(timer_count, timer);
+  timer_count ++;
+  timer_heap_fix(timer->index);
+  return timer;
+}
+
+void
+ndn_timer_cancel(struct ndn_timer* timer){
+  if(timer != NULL && timer->func != NULL){
+    timer_heap_remove(timer);
+  }
+}
+
+ndn_time_ms_t
+ndn_timer_next_deadline(void){
+  return timer_count > 0 ? timer_heap[0]->deadline : NDN_TIMER_NO_DEADLINE;
+}
+
 void
 ndn_msgqueue_process(void) {
+  ndn_time_ms_t now = ndn_time_now_ms();
+  ndn_timer_callback func;
+  void* arg;
+  int due = timer_count;
+
+  // Only timers pending before this call may run, so a callback
+  // scheduling itself again with a past deadline runs on the next call
+  while(due-- > 0 && timer_count > 0 && timer_heap[0]->deadline <= now){
+    func = timer_heap[0]->func;
+    arg = timer_heap[0]->arg;
+    timer_heap_remove(timer_heap[0]);
+    func(arg);
+  }
+
+  if(mt_queue->slot_size > 0){
+    ndn_mpscqueue_process(mt_queue);
+  }
+
   psplit = ptail;
   while(pfront != psplit){
     ndn_msgqueue_dispatch();
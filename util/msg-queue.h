@@ -14,6 +14,7 @@
 #include <inttypes.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include "uniform-time.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,6 +27,13 @@ extern "C" {
  * @ingroup NDNUtil
  *
  * Message queue of the forwarder.
+ *
+ * Deferred work is either posted as a message, run on the next pass,
+ * or scheduled as a timer, run on the first pass after its deadline.
+ *
+ * Other threads post through ndn_msgqueue_post_mt() instead, to a lock-free
+ * queue dispatched on the same pass. The thread processing the queue is woken
+ * up by the function set with ndn_msgqueue_set_wakeup().
  * @{
  */
 
@@ -33,10 +41,35 @@ extern "C" {
  */
 #define NDN_MSGQUEUE_SIZE 4096
 
+/** The number of slots of the queue posted to by other threads. A power of 2.
+ */
+#ifndef NDN_MSGQUEUE_MT_SLOT_COUNT
+#define NDN_MSGQUEUE_MT_SLOT_COUNT 64
+#endif
+
+/** The maximum bytes of parameters of a message posted by ndn_msgqueue_post_mt().
+ */
+#ifndef NDN_MSGQUEUE_MT_PARAM_SIZE
+#define NDN_MSGQUEUE_MT_PARAM_SIZE 64
+#endif
+
+/** The maximum number of pending timers.
+ */
+#ifndef NDN_TIMER_MAX_COUNT
+#define NDN_TIMER_MAX_COUNT 16
+#endif
+
+/** Returned by ndn_timer_next_deadline() when no timer is pending.
+ */
+#define NDN_TIMER_NO_DEADLINE ((ndn_time_ms_t)UINT64_MAX)
+
 #pragma pack(1)
 struct ndn_msg;
 #pragma pack()
 
+struct ndn_timer;
+struct ndn_mpsc_msg;
+
 /** The callback function of message.
  *
  * @param[in, out] self The object to receive this message.
@@ -47,7 +80,23 @@ typedef void(*ndn_msg_callback)(void *self,
                                 size_t param_length,
                                 void *param);
 
+/** The callback function of timer.
+ *
+ * @param[in, out] arg The argument given to ndn_timer_schedule().
+ */
+typedef void(*ndn_timer_callback)(void *arg);
+
+/** The function to wake up the thread processing the queue.
+ *
+ * Called from the posting thread. It must be async-signal-safe if
+ * messages are posted from signal handlers.
+ * @param[in] userdata The data given with the function.
+ */
+typedef void(*ndn_msgqueue_wakeup_func)(void *userdata);
+
 /** Init the message queue.
+ *
+ * Pending timers are dropped as well.
  */
 void
 ndn_msgqueue_init(void);
@@ -85,8 +134,8 @@ ndn_msgqueue_empty(void);
 
 /** Dispatch current messages.
  *
- * Process all messages currently in the queue.
- * New messages posted during this function will not be dispatched.
+ * Run the timers due, and then process all messages currently in the queue.
+ * New messages posted and timers scheduled during this function will not be dispatched.
  * @warning Calling this function in any callback functions is not allowed.
  */
 void
@@ -100,6 +149,76 @@ ndn_msgqueue_process(void);
 void
 ndn_msgqueue_cancel(struct ndn_msg* msg);
 
+/** Post a message to the queue from any thread.
+ *
+ * The message is dispatched by ndn_msgqueue_process() in the thread processing the queue.
+ * Messages posted by the same thread are dispatched in order.
+ * @param[in] target The object to receive this message.
+ * @param[in] reason The message callback function.
+ * @param[in] param_length [Optional] The length of parameters @c param.
+ * @param[in] param [Optional] The parameters of this message. Its context will be copied.
+ * @return #NDN_SUCCESS if the call succeeded.
+ * @retval #NDN_OVERSIZE @c param_length is larger than #NDN_MSGQUEUE_MT_PARAM_SIZE.
+ * @retval #NDN_FWD_MSGQUEUE_FULL #NDN_MSGQUEUE_MT_SLOT_COUNT messages are waiting.
+ *         Post with ndn_msgqueue_post_mt_msg() instead, or try again later.
+ */
+int
+ndn_msgqueue_post_mt(void *target,
+                     ndn_msg_callback reason,
+                     size_t param_length,
+                     const void *param);
+
+/** Post a message in memory of the caller from any thread. It never fails.
+ *
+ * The memory is owned by the queue until the message callback is called.
+ * Such messages are not ordered with ones posted by ndn_msgqueue_post_mt().
+ * @param[in] msg The message, with @c obj, @c func, @c length and @c param set.
+ */
+void
+ndn_msgqueue_post_mt_msg(struct ndn_mpsc_msg* msg);
+
+/** Set the function to wake up the thread processing the queue.
+ *
+ * It is called by the first message posted by ndn_msgqueue_post_mt() or
+ * ndn_msgqueue_post_mt_msg() after each ndn_msgqueue_process().
+ * @param[in] wakeup The function. NULL if the thread polls.
+ * @param[in] userdata [Optional] The argument of @c wakeup.
+ */
+void
+ndn_msgqueue_set_wakeup(ndn_msgqueue_wakeup_func wakeup, void *userdata);
+
+/** Return if no message posted by other threads is waiting.
+ */
+bool
+ndn_msgqueue_mt_empty(void);
+
+/** Schedule a callback at a deadline.
+ *
+ * The callback runs from ndn_msgqueue_process() once @c deadline is reached.
+ * A periodic task schedules itself again from its callback.
+ * @param[in] deadline When to run, as given by ndn_time_now_ms().
+ * @param[in] callback The callback function.
+ * @param[in] arg [Optional] The argument of @c callback.
+ * @return A pointer to cancel the timer. NULL if @c callback is NULL
+ *         or #NDN_TIMER_MAX_COUNT timers are pending.
+ */
+struct ndn_timer*
+ndn_timer_schedule(ndn_time_ms_t deadline, ndn_timer_callback callback, void *arg);
+
+/** Cancel a scheduled timer.
+ *
+ * Please make sure the pointer is used before the timer runs.
+ * @param[in] timer Pointer to timer. Ignored if NULL.
+ */
+void
+ndn_timer_cancel(struct ndn_timer* timer);
+
+/** Get the earliest deadline of all pending timers.
+ * @return The earliest deadline. #NDN_TIMER_NO_DEADLINE if no timer is pending.
+ */
+ndn_time_ms_t
+ndn_timer_next_deadline(void);
+
 /*@}*/
 
 #ifdef __cplusplus
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include "scratch.h"
+
+#define SCRATCH_ALIGN_SIZE(size) \
+  (((size) + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t))
+
+static NDN_THREAD_LOCAL uint64_t scratch_memory[NDN_SCRATCH_SIZE / sizeof(uint64_t)];
+static NDN_THREAD_LOCAL ndn_scratch_mark_t scratch_top;
+
+ndn_scratch_mark_t
+ndn_scratch_mark(void)
+{
+  return scratch_top;
+}
+
+void*
+ndn_scratch_alloc(size_t size)
+{
+  void* ret;
+
+  if (size > sizeof(scratch_memory) - scratch_top) {
+    return NULL;
+  }
+  // The top stays aligned, and so does the end of the arena
+  ret = (uint8_t*)scratch_memory + scratch_top;
+  scratch_top += (ndn_scratch_mark_t)SCRATCH_ALIGN_SIZE(size);
+  return ret;
+}
+
+void
+ndn_scratch_release(ndn_scratch_mark_t mark)
+{
+  if (mark < scratch_top) {
+    scratch_top = mark;
+  }
+}
+
+size_t
+ndn_scratch_available(void)
+{
+  return sizeof(scratch_memory) - scratch_top;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef UTIL_SCRATCH_H_
+#define UTIL_SCRATCH_H_
+
+#include "../ndn-constants.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNUtilScratch Scratch Arena
+ * @ingroup NDNUtil
+ *
+ * Per-thread memory for transient encodes, such as a packet encoded only to
+ * be handed to the forwarder.
+ *
+ * Allocations are taken from the top of a fixed buffer and given back together
+ * by releasing to a mark taken before them, so nested users, e.g. a callback
+ * encoding a packet while its caller still holds one, do not overwrite each other.
+ * @code
+ * ndn_scratch_mark_t mark = ndn_scratch_mark();
+ * uint8_t* buf = ndn_scratch_alloc(size);
+ * if (buf == NULL) return NDN_OVERSIZE;
+ * // ... encode into buf and send it ...
+ * ndn_scratch_release(mark);
+ * @endcode
+ * @{
+ */
+
+/** Bytes of the arena of each thread.
+ */
+#ifndef NDN_SCRATCH_SIZE
+#define NDN_SCRATCH_SIZE 4096
+#endif
+
+/** A position in the arena of the calling thread.
+ */
+typedef uint32_t ndn_scratch_mark_t;
+
+/** Get the current position, to release allocations made after it.
+ */
+ndn_scratch_mark_t
+ndn_scratch_mark(void);
+
+/** Allocate from the arena of the calling thread.
+ *
+ * The memory is not zeroed, and is aligned to @c sizeof(uint64_t).
+ * @param[in] size Bytes to allocate.
+ * @return The memory. NULL if less than @c size bytes are left.
+ */
+void*
+ndn_scratch_alloc(size_t size);
+
+/** Give back all allocations made after @c mark.
+ * @param[in] mark A position returned by ndn_scratch_mark() on the same thread.
+ */
+void
+ndn_scratch_release(ndn_scratch_mark_t mark);
+
+/** Get the bytes left in the arena of the calling thread.
+ */
+size_t
+ndn_scratch_available(void);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTIL_SCRATCH_H_
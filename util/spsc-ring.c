@@ -0,0 +1,26 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include "spsc-ring.h"
+#include "../ndn-error-code.h"
+
+int
+ndn_spscring_init(void* memory, uint32_t slot_count, uint32_t slot_size)
+{
+  ndn_spsc_ring_t* ring = (ndn_spsc_ring_t*)memory;
+  if (slot_count == 0 || (slot_count & (slot_count - 1)) != 0) {
+    return NDN_INVALID_ARG;
+  }
+  atomic_init(&ring->head, 0);
+  atomic_init(&ring->tail, 0);
+  ring->mask = slot_count - 1;
+  ring->slot_size = NDN_SPSC_RING_SLOT_SIZE(slot_size);
+  return NDN_SUCCESS;
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef UTIL_SPSC_RING_H_
+#define UTIL_SPSC_RING_H_
+
+#include "../ndn-constants.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNUtilSpscRing SPSC Ring
+ * @ingroup NDNUtil
+ *
+ * Lock-free ring of fixed-size slots between one producer thread and one consumer thread.
+ * @{
+ */
+
+/** Round a slot size up so every slot stays aligned to @c uint64_t.
+ */
+#define NDN_SPSC_RING_SLOT_SIZE(size) \
+  (((size) + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t))
+
+/** Single-producer single-consumer ring.
+ *
+ * @c head and @c tail run freely and are masked on access.
+ * Each of them is written by one side only, and lives on its own cache line.
+ */
+typedef struct ndn_spsc_ring {
+  /** Next slot to read. Written by the consumer.
+   */
+  NDN_CACHE_ALIGNED atomic_uint_fast32_t head;
+
+  /** Next slot to write. Written by the producer.
+   */
+  NDN_CACHE_ALIGNED atomic_uint_fast32_t tail;
+
+  /** Number of slots minus one. The number of slots is a power of 2.
+   */
+  NDN_CACHE_ALIGNED uint32_t mask;
+
+  /** Bytes of each slot, a multiple of @c sizeof(uint64_t).
+   */
+  uint32_t slot_size;
+
+  uint64_t slots[];
+} ndn_spsc_ring_t;
+
+/** The memory reserved for a ring.
+ * @param[in] slot_count Number of slots, a power of 2.
+ * @param[in] slot_size Bytes of each slot.
+ */
+#define NDN_SPSC_RING_RESERVE_SIZE(slot_count, slot_size) \
+  (sizeof(ndn_spsc_ring_t) + NDN_SPSC_RING_SLOT_SIZE(slot_size) * (slot_count))
+
+/** Initialize a ring at specified memory space.
+ * @param[in, out] memory Memory reserved for the ring, aligned to #NDN_CACHE_LINE_SIZE.
+ * @param[in] slot_count Number of slots, a power of 2.
+ * @param[in] slot_size Bytes of each slot.
+ * @return #NDN_SUCCESS if the call succeeded.
+ * @retval #NDN_INVALID_ARG @c slot_count is not a power of 2.
+ */
+int
+ndn_spscring_init(void* memory, uint32_t slot_count, uint32_t slot_size);
+
+/** Get the slot to write next. Producer only.
+ * @return The slot, or NULL if the ring is full.
+ */
+static inline void*
+ndn_spscring_reserve(ndn_spsc_ring_t* ring)
+{
+  uint_fast32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  uint_fast32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+  if (tail - head > ring->mask) {
+    return NULL;
+  }
+  return (uint8_t*)ring->slots + (size_t)(tail & ring->mask) * ring->slot_size;
+}
+
+/** Publish the slot returned by ndn_spscring_reserve(). Producer only.
+ */
+static inline void
+ndn_spscring_commit(ndn_spsc_ring_t* ring)
+{
+  uint_fast32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+/** Get the oldest published slot. Consumer only.
+ * @return The slot, or NULL if the ring is empty.
+ */
+static inline void*
+ndn_spscring_front(ndn_spsc_ring_t* ring)
+{
+  uint_fast32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  uint_fast32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+  if (head == tail) {
+    return NULL;
+  }
+  return (uint8_t*)ring->slots + (size_t)(head & ring->mask) * ring->slot_size;
+}
+
+/** Free the slot returned by ndn_spscring_front(). Consumer only.
+ */
+static inline void
+ndn_spscring_pop(ndn_spsc_ring_t* ring)
+{
+  uint_fast32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTIL_SPSC_RING_H_